@@ -23,6 +23,8 @@
  *          of its deficiencies.
  * NOTES:
  * HISTORY: 04/1996, Todd Plessel, EPA/MMTSI, Created.
+ *          10/2026, Carlie J. Coats, Jr.:  readM3IOSubset() computes its
+ *          timestep dates once and reads large subsets in parallel.
  *****************************************************************************/
 
 /*=============================== INCLUDES ==================================*/
@@ -33,7 +35,11 @@
 #include <string.h>     /* For strncpy(), strstr(), memset().                */
 #include <ctype.h>      /* For isspace().                                    */
 #include <math.h>       /* For log().                                        */
-//#include <unistd.h>     /* For unlink().                                     */
+#include <unistd.h>     /* For fork(), _exit(), sysconf().                   */
+#include <sys/types.h>  /* For pid_t.                                        */
+#include <sys/mman.h>   /* For mmap(), munmap().                             */
+#include <sys/time.h>   /* For gettimeofday().                               */
+#include <sys/wait.h>   /* For waitpid().                                    */
 
 #include "iodecl3.h"    /* init3c(), shut3c(), open3c(), close3c(), read3c().*/
 
@@ -50,6 +56,11 @@
 #define MAX( a, b ) ((a) > (b) ? (a) : (b))
 #endif
 
+/* readM3IOSubset() reads subsets of at least this many bytes in up to this
+   many processes: */
+
+enum { SUBSET_PARALLEL_BYTES = 4 * 1024 * 1024, SUBSET_MAXIMUM_JOBS = 8 };
+
 /*=========================== PRIVATE VARIABLES =============================*/
 
 static const char SVN_ID[] = "$Id: DataImport.c 83 2018-03-12 19:24:33Z coats $";
@@ -1107,6 +1118,116 @@ int writeM3IOVariables ( const M3IOFile* file, int timestep, const void* data )
     }
 
 
+/******************************************************************************
+ * PURPOSE: readM3IOSubsetChunk - Reads one (timestep, variable) chunk of a
+ *          subset from an open Models-3 file.
+ * INPUTS:  const M3IOFile* file       The Models-3 file to read from.
+ *          const int subset[ NUMBER_OF_DATA_DIMENSIONS ][ 2 ] Subset spec.
+ *          const char* variableNames[] The selected variable names.
+ *          int variable               Which of them to read.
+ *          int jdate, jtime           Date and time of the timestep.
+ * OUTPUTS: void* chunk                Buffer to fill. chunk[L][R][C].
+ * RETURNS: 1 if successful, else 0.
+ * NOTES:
+ *****************************************************************************/
+
+static int readM3IOSubsetChunk ( const M3IOFile* file, const int subset[][ 2 ],
+                                 const char* variableNames[], int variable,
+                                 int jdate, int jtime, void* chunk )
+    {
+    const int type = file->bdesc.vtype[ variable ];
+    int ok = 1; /* Only M3INT and M3REAL variables are read. */
+
+    if ( AND2 ( OR2 ( type == M3INT, type == M3REAL ),
+                file->bdesc.ftype == GRDDED3 ) )
+        {
+        ok = xtract3c ( file->logicalFileName, variableNames[ variable ],
+                        1 + subset[ LAYER  ][ FIRST ],
+                        1 + subset[ LAYER  ][ LAST  ],
+                        1 + subset[ ROW    ][ FIRST ],
+                        1 + subset[ ROW    ][ LAST  ],
+                        1 + subset[ COLUMN ][ FIRST ],
+                        1 + subset[ COLUMN ][ LAST  ],
+                        jdate, jtime, chunk );
+        }
+    else if ( OR2 ( type == M3INT, type == M3REAL ) )
+        {
+        ok = read3c ( file->logicalFileName, variableNames[ variable ],
+                      ALLAYS3, jdate, jtime, chunk );
+        }
+
+    return ok;
+    }
+
+
+/******************************************************************************
+ * PURPOSE: readM3IOSubsetChunks - Reads chunks [first, last) of a subset,
+ *          chunk k being timestep k / nv, variable k % nv of the subset.
+ * INPUTS:  const M3IOFile* file       The Models-3 file to read from.
+ *          const int subset[ NUMBER_OF_DATA_DIMENSIONS ][ 2 ] Subset spec.
+ *          const char* variableNames[] The selected variable names.
+ *          const int jdates[], jtimes[] Date and time of each subset timestep.
+ *          size_t first, last         The chunks to read.
+ *          size_t chunkBytes          The size of a chunk.
+ * OUTPUTS: char* data                 Buffer to fill, indexed by chunk.
+ *          size_t* failed             The chunk that failed, if any.
+ * RETURNS: 1 if successful, else 0.
+ * NOTES:   M3INT and M3REAL values are both 4 bytes.
+ *****************************************************************************/
+
+static int readM3IOSubsetChunks ( const M3IOFile* file, const int subset[][ 2 ],
+                                  const char* variableNames[],
+                                  const int jdates[], const int jtimes[],
+                                  size_t first, size_t last, size_t chunkBytes,
+                                  char* data, size_t* failed )
+    {
+    const size_t variables = subset[ VARIABLE ][ COUNT ];
+    int ok = 1;
+    size_t chunk;
+
+    for ( chunk = first; AND2 ( ok, chunk < last ); ++chunk )
+        {
+        const int timestep = chunk / variables; /* Relative to subset.       */
+        const int variable = chunk % variables;
+
+        DEBUG ( printf ( "timestep = %d, variable = '%s'\n",
+                         subset[ TIMESTEP ][ FIRST ] + timestep,
+                         variableNames[ variable ] ); )
+
+        ok = readM3IOSubsetChunk ( file, subset, variableNames, variable,
+                                   jdates[ timestep ], jtimes[ timestep ],
+                                   data + chunk * chunkBytes );
+
+        if ( ! ok ) *failed = chunk;
+        }
+
+    return ok;
+    }
+
+
+/******************************************************************************
+ * PURPOSE: readM3IOSubsetJobs - How many processes should read a subset.
+ * INPUTS:  size_t chunks      Number of (timestep, variable) chunks.
+ *          size_t bytes       Size of the subset.
+ * OUTPUTS: None
+ * RETURNS: int  1 (read serially) or more.
+ * NOTES:   PAVE_SUBSET_JOBS overrides the number of processors.
+ *****************************************************************************/
+
+static int readM3IOSubsetJobs ( size_t chunks, size_t bytes )
+    {
+    const char* const jobsVariable = getenv ( "PAVE_SUBSET_JOBS" );
+    long jobs = jobsVariable ? atol ( jobsVariable )
+                             : sysconf ( _SC_NPROCESSORS_ONLN );
+
+    if ( jobs > SUBSET_MAXIMUM_JOBS ) jobs = SUBSET_MAXIMUM_JOBS;
+    if ( ( size_t ) jobs > chunks )   jobs = chunks;
+    if ( OR2 ( jobs < 2, bytes < SUBSET_PARALLEL_BYTES ) ) jobs = 1;
+
+    return jobs;
+    }
+
+
 /******************************************************************************
  * PURPOSE: readM3IOSubset - Reads a subset of data from an open Models-3 file.
  * INPUTS:  const M3IOFile* file       The Models-3 file to read from.
@@ -1115,6 +1236,14 @@ int writeM3IOVariables ( const M3IOFile* file, int timestep, const void* data )
  * OUTPUTS: void* data                Buffer to fill. data[T][V][L][R][C].
  * RETURNS: 1 if successful, else 0.
  * NOTES:   If a failure occurs, error() is called.
+ *          The dates and times of the subset's timesteps are computed once.
+ *          Large subsets are split into runs of (timestep, variable) chunks
+ *          read concurrently:  libm3io is not reentrant, so the extra runs
+ *          are read by forked processes, each opening the file afresh (its
+ *          own file handle) and reading into a shared buffer, while this
+ *          process reads the first run with its own handle.  Any run that
+ *          fails is re-read here, so that the error is reported as usual.
+ *          With PAVE_SUBSET_STATS set, the throughput is reported on stderr.
  *****************************************************************************/
 
 int readM3IOSubset ( const M3IOFile* file, const int subset[][ 2 ],
@@ -1125,86 +1254,147 @@ int readM3IOSubset ( const M3IOFile* file, const int subset[][ 2 ],
                                      variableNames ), data );
 
     int ok = 1;
-    int timestep, variable = 0; /* Current timestep and variable being read. */
-    int jdate, jtime;       /* Julian date and time of the current timestep. */
-    size_t chunk = 0;                 /* Which chunk are we reading?         */
+    int timestep, job;
+    size_t failed = 0;                /* Which chunk failed, if any.          */
+    struct timeval start, finish;
 
     /* Reads occur in chunks of this size: */
     const size_t chunkSize = countInRange ( subset[ LAYER  ] ) *
                              countInRange ( subset[ ROW    ] ) *
                              countInRange ( subset[ COLUMN ] );
+    const size_t chunkBytes = chunkSize * sizeof ( float );
+    const int    timesteps  = countInRange ( subset[ TIMESTEP ] );
+    const size_t chunks     = ( size_t ) timesteps * subset[ VARIABLE ][ COUNT ];
+    const int    jobs       = readM3IOSubsetJobs ( chunks, chunks * chunkBytes );
+    const size_t perJob     = ( chunks + jobs - 1 ) / jobs;
 
-    getM3IODateTime ( file->bdesc.sdate, file->bdesc.stime, file->bdesc.tstep,
-                      subset[ TIMESTEP ][ FIRST ], &jdate, &jtime );
+    int*   jdates = NEW ( int, timesteps );
+    int*   jtimes = NEW ( int, timesteps );
+    char*  shared       = 0;
+    pid_t* pids         = 0;
+
+    gettimeofday ( &start, 0 );
 
-    for (       timestep  = subset[ TIMESTEP ][ FIRST ];
-                AND2 ( timestep <= subset[ TIMESTEP ][ LAST  ], ok ); ++timestep )
+    ok = AND2 ( jdates, jtimes );
+
+    if ( ok )
         {
-        for ( variable = 0; AND2 ( ok, variable < subset[ VARIABLE ][ COUNT ] );
-                ++variable )
+        getM3IODateTime ( file->bdesc.sdate, file->bdesc.stime, file->bdesc.tstep,
+                          subset[ TIMESTEP ][ FIRST ], jdates, jtimes );
+
+        for ( timestep = 1; timestep < timesteps; ++timestep )
             {
-            DEBUG ( printf ( "timestep = %d, variable = '%s'\n",
-                             timestep, variableNames[ variable ] ); )
+            jdates[ timestep ] = jdates[ timestep - 1 ];
+            jtimes[ timestep ] = jtimes[ timestep - 1 ];
+            nextimec ( jdates + timestep, jtimes + timestep, file->bdesc.tstep );
+            }
+        }
 
-            if ( file->bdesc.vtype[ variable ] == M3INT )
-                {
-                int* idata = data;
+    if ( AND2 ( ok, jobs > 1 ) )
+        {
+        shared = mmap ( 0, chunks * chunkBytes, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+        pids   = NEW ( pid_t, jobs );
 
-                if ( file->bdesc.ftype == GRDDED3 )
-                    {
-                    ok = xtract3c ( file->logicalFileName, variableNames[ variable ],
-                                    1 + subset[ LAYER  ][ FIRST ],
-                                    1 + subset[ LAYER  ][ LAST  ],
-                                    1 + subset[ ROW    ][ FIRST ],
-                                    1 + subset[ ROW    ][ LAST  ],
-                                    1 + subset[ COLUMN ][ FIRST ],
-                                    1 + subset[ COLUMN ][ LAST  ],
-                                    jdate, jtime,
-                                    idata + chunk * chunkSize );
-                    }
-                else
-                    {
-                    ok = read3c ( file->logicalFileName, variableNames[ variable ],
-                                  ALLAYS3, jdate, jtime, idata + chunk * chunkSize );
-                    }
-                }
-            else if ( file->bdesc.vtype[ variable ] == M3REAL )
+        if ( OR2 ( shared == MAP_FAILED, ! pids ) )
+            {
+            if ( shared != MAP_FAILED ) munmap ( shared, chunks * chunkBytes );
+            shared = 0;
+            }
+        }
+
+    if ( shared )
+        {
+        fflush ( 0 );
+
+        for ( job = 1; job < jobs; ++job )
+            {
+            const size_t first = MIN ( job * perJob, chunks );
+            const size_t last  = MIN ( first + perJob, chunks );
+
+            pids[ job ] = fork();
+
+            if ( pids[ job ] == 0 )
                 {
-                float* fdata = data;
+                M3IOFile mine;         /* This process's own handle.          */
+                int childOk = openM3IOFileForReading ( file->fileName, &mine );
+                childOk = AND2 ( childOk,
+                                 readM3IOSubsetChunks ( &mine, subset, variableNames,
+                                                        jdates, jtimes, first, last,
+                                                        chunkBytes, shared,
+                                                        &failed ) );
+                _exit ( childOk ? 0 : 1 );
+                }
+            }
 
-                if ( file->bdesc.ftype == GRDDED3 )
-                    {
-                    ok = xtract3c ( file->logicalFileName, variableNames[ variable ],
-                                    1 + subset[ LAYER  ][ FIRST ],
-                                    1 + subset[ LAYER  ][ LAST  ],
-                                    1 + subset[ ROW    ][ FIRST ],
-                                    1 + subset[ ROW    ][ LAST  ],
-                                    1 + subset[ COLUMN ][ FIRST ],
-                                    1 + subset[ COLUMN ][ LAST  ],
-                                    jdate, jtime,
-                                    fdata + chunk * chunkSize );
-                    }
-                else
-                    {
-                    ok = read3c ( file->logicalFileName, variableNames[ variable ],
-                                  ALLAYS3, jdate, jtime, fdata + chunk * chunkSize );
-                    }
+        ok = readM3IOSubsetChunks ( file, subset, variableNames, jdates, jtimes,
+                                    0, MIN ( perJob, chunks ), chunkBytes,
+                                    data, &failed );
+
+        for ( job = 1; job < jobs; ++job )
+            {
+            const size_t first = MIN ( job * perJob, chunks );
+            const size_t last  = MIN ( first + perJob, chunks );
+            int status = 1;
+
+            if ( pids[ job ] > 0 )
+                {
+                waitpid ( pids[ job ], &status, 0 );
                 }
 
-            ++chunk;
+            if ( AND3 ( pids[ job ] > 0, WIFEXITED ( status ),
+                        WEXITSTATUS ( status ) == 0 ) )
+                {
+                memcpy ( ( char* ) data + first * chunkBytes,
+                         shared + first * chunkBytes, ( last - first ) * chunkBytes );
+                }
+            else if ( ok ) /* Retry here (and report the error, if any). */
+                {
+                ok = readM3IOSubsetChunks ( file, subset, variableNames,
+                                            jdates, jtimes, first, last, chunkBytes,
+                                            data, &failed );
+                }
             }
 
-        nextimec ( &jdate, &jtime, file->bdesc.tstep );
+        munmap ( shared, chunks * chunkBytes );
+        }
+    else if ( ok )
+        {
+        ok = readM3IOSubsetChunks ( file, subset, variableNames, jdates, jtimes,
+                                    0, chunks, chunkBytes, data, &failed );
+        }
+
+    FREE ( pids );
+    FREE ( jdates );
+    FREE ( jtimes );
+
+    gettimeofday ( &finish, 0 );
+
+    if ( AND2 ( ok, getenv ( "PAVE_SUBSET_STATS" ) ) )
+        {
+        const double seconds   = finish.tv_sec - start.tv_sec +
+                                 1e-6 * ( finish.tv_usec - start.tv_usec );
+        const double megabytes = chunks * chunkBytes / ( 1024.0 * 1024.0 );
+
+        fprintf ( stderr, "readM3IOSubset: %.1f MB from '%s' in %.3f s "
+                  "(%.1f MB/s, %d process%s)\n",
+                  megabytes, file->fileName, seconds,
+                  seconds > 0.0 ? megabytes / seconds : 0.0,
+                  jobs, jobs == 1 ? "" : "es" );
         }
 
     if ( ! ok )
         {
+        const int variables = subset[ VARIABLE ][ COUNT ];
+
         error ( "Failed to read subset data from Models-3 file '%s',\n"
                 "  timestep = %d, variable = '%s',\n"
                 "  layers   = %d through %d,\n"
                 "  rows     = %d through %d,\n"
                 "  columns  = %d through %d.\n",
-                file->fileName, timestep, variableNames[ variable - 1 ],
+                file->fileName,
+                subset[ TIMESTEP ][ FIRST ] + ( int ) ( failed / variables ),
+                variableNames[ failed % variables ],
                 1 + subset[ LAYER  ][ FIRST ],  1 + subset[ LAYER  ][ LAST ],
                 1 + subset[ ROW    ][ FIRST ],  1 + subset[ ROW    ][ LAST ],
                 1 + subset[ COLUMN ][ FIRST ],  1 + subset[ COLUMN ][ LAST ] );
@@ -48,6 +48,16 @@
 // SRT  960517  Added hooks to netCDF exporting
 // SRT  960826  Added documentation menu
 // CJC  2018058 Version for PAVE-3.0
+// CJC  202610  N-hour and N-layer plots use sliding-window reductions
+//              (winagg.c);  new -NhourMax option
+// CJC  202610  Data Explorer export, through dump_VIS_DATA_to_DX_file()
+// CJC  202610  -probePoints batch point extraction, through gridprobe.c
+// CJC  202610  -pairModelObs model/obs statistics, through obspair.c
+// CJC  202610  -resample hourly/daily/monthly/yearly plots, in UTC or
+//              local time, through tresample.c
+// CJC  202610  -histogram distribution plots, -percentileRange, and
+//              -legendQuantiles, through gridhist.c
+// CJC  202610  freeObsPlotData() frees the -pairModelObs obs data whole
 ///////////////////////////////////////////////////////////////////////////////
 
 /* check if character is white space */
@@ -73,6 +83,10 @@
 
 #include "DriverWnd.h"
 #include "iodecl3.h"
+#include "winagg.h"
+#include "gridprobe.h"
+#include "obspair.h"
+#include "tresample.h"
 
 extern void pave_version  ( void );
 extern void pave_log_stop ( void );
@@ -91,6 +105,32 @@ static void killmykids ( void )
     killpg ( ( int ) pgrp, SIGKILL );
     }
 
+
+// freeObsPlotData() frees an OBS_PLOT PLOT_DATA from getPlotData(), with
+// its obs data, coordinates, steps, and station IDs
+
+static void freeObsPlotData ( PLOT_DATA *pdata )
+    {
+    int k;
+
+    if ( !pdata ) return;
+    if ( pdata->vdata )
+        {
+        free_vis ( pdata->vdata );
+        free ( pdata->vdata );
+        }
+    if ( pdata->coord_x ) free ( pdata->coord_x );
+    if ( pdata->coord_y ) free ( pdata->coord_y );
+    if ( pdata->jstep ) free ( pdata->jstep );
+    if ( pdata->stnid )
+        {
+        for ( k = 0; k < pdata->nstnid; k++ )
+            if ( pdata->stnid[k] ) free ( pdata->stnid[k] );
+        free ( pdata->stnid );
+        }
+    delete pdata;
+    }
+
 DriverWnd::DriverWnd
 ( AppInit *app, char *name, char *historyfile,
   int argc, char *argv[], char *errorMsg ) :
@@ -122,6 +162,9 @@ DriverWnd::DriverWnd
     max_num_hours_ = 0;
     tileSliceType_ = XYTSLICE;
     obsIdListP_ = NULL;
+    pairObs_ = NULL;
+    pairObsKey_ = NULL;
+    memset ( &pairing_, 0, sizeof ( pairing_ ) );
     int i, nodisplay = 0;
 
 #ifndef USE_OLDMAP
@@ -259,8 +302,9 @@ DriverWnd::DriverWnd
     exportAVS_UI_    = new ExportServer ( PAVE_EXPORT_AVS,    "AVS",    info_window_, "AVS" );
     exportTabbed_UI_ = new ExportServer ( PAVE_EXPORT_TABBED, "ASCII",  info_window_, "ASCII" );
     exportnetCDF_UI_ = new ExportServer ( PAVE_EXPORT_NETCDF, "netCDF", info_window_, "netCDF" );
+    exportDX_UI_     = new ExportServer ( PAVE_EXPORT_DX,     "DX",     info_window_, "DX" );
 
-    assert ( exportAVS_UI_ && exportTabbed_UI_ && exportnetCDF_UI_ );
+    assert ( exportAVS_UI_ && exportTabbed_UI_ && exportnetCDF_UI_ && exportDX_UI_ );
 
     species_->setScreenPosition ( xpos, ypos+360 ); // SRT 960411
     ( ( CaseServer * ) case_ )->setScreenPosition ( xpos+185, ypos+360 ); // SRT 960411
@@ -287,6 +331,19 @@ DriverWnd::~DriverWnd()
         delete exportTabbed_UI_;
         exportTabbed_UI_ = NULL;
         }
+    if ( exportDX_UI_ )
+        {
+        delete exportDX_UI_;
+        exportDX_UI_ = NULL;
+        }
+    obspair_free ( &pairing_ );
+    freeObsPlotData ( pairObs_ );
+    pairObs_ = NULL;
+    if ( pairObsKey_ )
+        {
+        free ( pairObsKey_ );
+        pairObsKey_ = NULL;
+        }
     if ( history_file_ )
         {
         delete history_file_;
@@ -1911,7 +1968,47 @@ void DriverWnd::dxExportCB ( Widget, XtPointer clientData, XtPointer )
 
 void DriverWnd::dx_export_cb()
     {
+#ifdef DIAGNOSTICS
     fprintf ( stderr, "Enter DriverWnd::dx_export_cb()\n" );
+#endif // DIAGNOSTICS
+
+    if ( formula_->getCurrSelection() )
+        {
+        char formulaname[512], statusMsg[512];
+        Formula *formula;
+        VIS_DATA *vdata = NULL;
+
+        // Miscellaneous setup junk
+        stop_cb();
+        strcpy ( formulaname, formula_->getCurrSelection() );
+        updateStatus ( "Exporting DX data file..." );
+
+        // Find the currently selected formula's Formula object
+        if ( ! ( formula = ( Formula * ) ( formulaList_.find ( formulaname ) ) ) )
+            {
+            sprintf ( statusMsg, "Didn't find '%s'\non the formulaList!\n", formulaname );
+            Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+            return;
+            }
+
+        // Retrieve a copy of that Formula object's data
+        if ( ! ( vdata = get_VIS_DATA_struct ( formula,statusMsg,XYZTSLICE ) ) )
+            {
+            if ( strstr ( statusMsg, "==" ) )
+                displaySingleNumberFormula ( statusMsg, formula );
+            else
+                {
+                Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+                }
+            return;
+            }
+
+        exportDX_UI_->ShowUI ( ( void * ) vdata );
+        }
+    else
+        {
+        Message error ( info_window_, XmDIALOG_ERROR, "There is no formula currently selected!" );
+        }
     }
 
 
@@ -2873,8 +2970,8 @@ int DriverWnd::grp_plot_nhour_avg ( int nhour, int AvgOrSum )
     int index;
     int ncol, nrow, nlay;
     int n_per_hour;
-    int n_good;
-    float sum;
+    long nplane;
+    WinAgg win;
     float val, grid_min, grid_max;
     char title[512];
 
@@ -2993,6 +3090,30 @@ int DriverWnd::grp_plot_nhour_avg ( int nhour, int AvgOrSum )
         vdata_nh->step_max = nh;
         vdata_nh->step_incr = 1;
 
+        // AvgOrSum:  WINAGG_SUM, WINAGG_MEAN or WINAGG_MAX
+        nplane = ( long ) ncol * nrow;
+        if ( !winagg_init ( &win, AvgOrSum, nhour, nplane ) )
+            {
+            fprintf ( stderr, "%s %d %s\n","ERROR: Allocation failure for",
+                      nhour,"hour average" );
+            return 1;
+            }
+
+        // each of the n_per_hour phases of the steps is a sequence of
+        // its own:  output step t is the window of steps t, t+n_per_hour,
+        // ..., t+(nhour-1)*n_per_hour, so slide along each phase
+        for ( i = 0; ( i < n_per_hour ) && ( i < nh ); i++ )
+            {
+            winagg_reset ( &win );
+            for ( t = i - ( nhour-1 ) *n_per_hour; t < nh; t += n_per_hour )
+                {
+                winagg_push ( &win, vdata->grid + ( t + ( nhour-1 ) *n_per_hour ) * nplane );
+                if ( t >= 0 )
+                    winagg_result ( &win, vdata_nh->grid + t * nplane );
+                }
+            }
+        winagg_free ( &win );
+
         jdate = vdata->first_date;
         jtime = vdata->first_time;
 
@@ -3005,33 +3126,7 @@ int DriverWnd::grp_plot_nhour_avg ( int nhour, int AvgOrSum )
                 for ( c = 0; c < ncol; c++ )
                     {
                     index = INDEX (  c, r, 0, t, ncol, nrow, 1 );
-                    sum    = 0.0;
-                    n_good = 0;
-                    for ( i=0; i<nhour; i++ )
-                        {
-                        val = vdata->grid[INDEX (  c,r,0, t+i*n_per_hour, ncol, nrow, 1 )];
-                        if ( !isnanf ( val ) )
-                            {
-                            sum += val;
-                            n_good++;
-                            }
-                        }
-                    if ( n_good != 0 )
-                        {
-                        if ( AvgOrSum )
-                            {
-                            val = sum / n_good;
-                            }
-                        else
-                            {
-                            val = sum;
-                            }
-                        }
-                    else
-                        {
-                        val = setNaNf();
-                        }
-                    vdata_nh->grid[index] = val;
+                    val = vdata_nh->grid[index];
                     if ( !isnanf ( val ) )
                         {
                         if ( val < grid_min ) grid_min = val;
@@ -3056,7 +3151,11 @@ int DriverWnd::grp_plot_nhour_avg ( int nhour, int AvgOrSum )
                   formulaname );
 
         sprintf ( strbuf_,"%s", str512_ ); // 961009 SRT
-        if ( AvgOrSum )
+        if ( AvgOrSum == WINAGG_MAX )
+            {
+            sprintf ( title,"%d%s:%s",nhour,"-hour max",str512_ );
+            }
+        else if ( AvgOrSum )
             {
             sprintf ( title,"%d%s:%s",nhour,"-hour average",str512_ );
             }
@@ -3083,6 +3182,272 @@ int DriverWnd::grp_plot_nhour_avg ( int nhour, int AvgOrSum )
     }
 
 
+/* =:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:= */
+
+// set_formula_steps() sets formula's steps to hr0..hr1 (0 based):
+// set_hr_min() clamps to the old maximum, and set_hr_max() to the
+// old minimum, so the order matters
+
+static void set_formula_steps ( Formula *formula, int hr0, int hr1 )
+    {
+    if ( hr1 >= formula->get_hrMin() )
+        {
+        formula->set_hr_max ( hr1 );
+        formula->set_hr_min ( hr0 );
+        }
+    else
+        {
+        formula->set_hr_min ( hr0 );
+        formula->set_hr_max ( hr1 );
+        }
+    }
+
+
+// grp_plot_resample() plots the currently selected formula resampled
+// to hourly, daily, monthly or yearly (period TRESAMPLE_HOUR, ...) sums,
+// means, maxima or minima (mode TRESAMPLE_SUM, ...), by the steps' own
+// dates and times:  in UTC offset by tzoff hours, or (local) in each
+// cell's solar time zone, from its longitude.  See tresample.h
+//
+// The formula is retrieved RESAMPLE_STEPS steps at a time, and each
+// chunk freed once it is pushed, so that only the output and a chunk
+// of the input are ever in memory
+
+#define RESAMPLE_STEPS  (24)
+
+int DriverWnd::grp_plot_resample ( int period, int mode, int local, int tzoff )
+    {
+    static const char *periodName[] = { "hourly", "daily", "monthly", "yearly" };
+    static const char *modeName[]   = { "sum", "average", "max", "min" };
+    static const int   periodSec[]  = { 3600, 86400, 30*86400, 365*86400 };
+    char formulaname[512], statusMsg[512];
+    Formula *formula;
+    char *caseString;
+    VIS_DATA *vdata = NULL;
+    VIS_DATA *vdata_rs = NULL;
+    TResample rs;
+    int *zonesec = NULL;
+    int ncol, nrow, nlay, nstep;
+    int h, w, t, ok, hr0, hr1, t0, last_date, last_time;
+    long nxy, nplane, k;
+    float val, grid_min, grid_max;
+    char title[512];
+
+    if ( ! ( formula_->getCurrSelection() &&
+             strlen ( formula_->getCurrSelection() ) ) )
+        {
+        Message error ( info_window_, XmDIALOG_ERROR, "There isn't a currently selected formula!" );
+        return 1;
+        }
+    stop_cb();
+    strcpy ( formulaname, formula_->getCurrSelection() );
+    if ( ! ( formula = ( Formula * ) ( formulaList_.find ( formulaname ) ) ) )
+        {
+        sprintf ( statusMsg,"Can't find '%s'\non the formulaList!\n", formulaname );
+        Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+        return 1;
+        }
+
+    // the last step alone, for the span of the periods and the grid
+    hr0 = formula->get_hrMin();
+    hr1 = formula->get_hrMax();
+    set_formula_steps ( formula, hr1, hr1 );
+    if ( ! ( vdata = get_VIS_DATA_struct ( formula,statusMsg,tileSliceType_ ) ) )
+        {
+        set_formula_steps ( formula, hr0, hr1 );
+        if ( strstr ( statusMsg, "==" ) )
+            displaySingleNumberFormula ( statusMsg, formula );
+        else
+            {
+            Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+            }
+        return 1;
+        }
+    formula->invalidateThisData();
+    if ( vdata->incr_sec == 0 )
+        {
+        fprintf ( stderr,"%s\n",
+                  "ERROR: cannot resample a time independent file" );
+        set_formula_steps ( formula, hr0, hr1 );
+        free_vis ( vdata );
+        free ( vdata );
+        return 1;
+        }
+
+    ncol   = vdata->col_max-vdata->col_min+1;
+    nrow   = vdata->row_max-vdata->row_min+1;
+    nlay   = vdata->level_max-vdata->level_min+1;
+    nstep  = vdata->step_max-vdata->step_min+1;
+    nxy    = ( long ) ncol * nrow;
+    nplane = nxy * nlay;
+    last_date = vdata->sdate[nstep-1];
+    last_time = vdata->stime[nstep-1];
+
+    // local time:  each cell's zone is its longitude / 15 degrees
+    ok = 1;
+    if ( local )
+        {
+        double *col = ( double * ) malloc ( 4 * nxy * sizeof ( double ) );
+
+        zonesec = ( int * ) malloc ( nxy * sizeof ( int ) );
+        ok = ( col && zonesec );
+        if ( !ok )
+            {
+            sprintf ( statusMsg, "Allocation failure for resampling" );
+            }
+        else
+            {
+            double *row = col + nxy, *lon = row + nxy, *lat = lon + nxy;
+
+            for ( k = 0; k < nxy; k++ )
+                {
+                col[k] = vdata->col_min + k % ncol;
+                row[k] = vdata->row_min + k / ncol;
+                }
+            ok = gridprobe_unproject ( vdata->map_info, nxy, col, row,
+                                       lon, lat, statusMsg );
+            for ( k = 0; ok && k < nxy; k++ )
+                zonesec[k] = 3600 * ( int ) floor ( lon[k] / 15.0 + 0.5 );
+            }
+        if ( col ) free ( col );
+        }
+    if ( ok && ! ( vdata_rs = VIS_DATA_dup ( vdata, statusMsg ) ) ) ok = 0;
+    free_vis ( vdata );
+    free ( vdata );
+    vdata = NULL;
+    if ( vdata_rs )
+        {
+        free ( vdata_rs->grid );
+        free ( vdata_rs->sdate );
+        free ( vdata_rs->stime );
+        vdata_rs->grid  = NULL;
+        vdata_rs->sdate = NULL;
+        vdata_rs->stime = NULL;
+        }
+
+    // a chunk at a time, and within it a step at a time:  only the
+    // periods the step reaches are open
+    memset ( &rs, 0, sizeof ( rs ) );
+    for ( t0 = hr0; ok && t0 <= hr1; t0 += RESAMPLE_STEPS )
+        {
+        set_formula_steps ( formula, t0, ( t0 + RESAMPLE_STEPS - 1 < hr1 )
+                                         ? t0 + RESAMPLE_STEPS - 1 : hr1 );
+        if ( ! ( vdata = get_VIS_DATA_struct ( formula,statusMsg,tileSliceType_ ) ) )
+            {
+            ok = 0;
+            break;
+            }
+        formula->invalidateThisData();
+        nstep = vdata->step_max-vdata->step_min+1;
+        if ( ( vdata->col_max-vdata->col_min+1 != ncol ) ||
+             ( vdata->row_max-vdata->row_min+1 != nrow ) ||
+             ( vdata->level_max-vdata->level_min+1 != nlay ) )
+            {
+            sprintf ( statusMsg, "The grid of '%s' changes from step to step!", formulaname );
+            ok = 0;
+            }
+        if ( ok && ( t0 == hr0 ) )
+            {
+            ok = tresample_init ( &rs, mode, period, nplane, nxy, zonesec, 3600*tzoff,
+                                  vdata->sdate[0], vdata->stime[0],
+                                  last_date, last_time, statusMsg );
+            if ( ok )
+                {
+                vdata_rs->grid  = ( float * ) malloc ( ( size_t ) rs.nout * nplane * sizeof ( float ) );
+                vdata_rs->sdate = ( int * ) malloc ( ( size_t ) rs.nout * sizeof ( int ) );
+                vdata_rs->stime = ( int * ) malloc ( ( size_t ) rs.nout * sizeof ( int ) );
+                if ( !vdata_rs->grid || !vdata_rs->sdate || !vdata_rs->stime )
+                    {
+                    sprintf ( statusMsg, "Allocation failure for resampling" );
+                    ok = 0;
+                    }
+                }
+            }
+        for ( t = 0; ok && t < nstep; t++ )
+            {
+            ok = tresample_push ( &rs, vdata->grid + t * nplane,
+                                  vdata->sdate[t], vdata->stime[t],
+                                  vdata_rs->grid, statusMsg );
+            }
+        free_vis ( vdata );
+        free ( vdata );
+        vdata = NULL;
+        }
+    set_formula_steps ( formula, hr0, hr1 );
+    if ( zonesec ) free ( zonesec );
+    if ( !ok )
+        {
+        Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+        tresample_free ( &rs );
+        if ( vdata_rs )
+            {
+            free_vis ( vdata_rs );
+            free ( vdata_rs );
+            }
+        return 1;
+        }
+    tresample_finish ( &rs, vdata_rs->grid );
+    tresample_dates ( &rs, vdata_rs->sdate, vdata_rs->stime );
+
+    vdata_rs->nstep      = rs.nout;
+    vdata_rs->step_min   = 1;
+    vdata_rs->step_max   = rs.nout;
+    vdata_rs->step_incr  = 1;
+    vdata_rs->incr_sec   = periodSec[period];   // nominal, for months and years
+    vdata_rs->first_date = vdata_rs->sdate[0];
+    vdata_rs->first_time = vdata_rs->stime[0];
+    vdata_rs->last_date  = vdata_rs->sdate[rs.nout-1];
+    vdata_rs->last_time  = vdata_rs->stime[rs.nout-1];
+    tresample_free ( &rs );
+
+    grid_max = BADVAL3;
+    grid_min = -grid_max;
+    for ( k = 0; k < vdata_rs->nstep * nplane; k++ )
+        {
+        val = vdata_rs->grid[k];
+        if ( !isnanf ( val ) )
+            {
+            if ( val < grid_min ) grid_min = val;
+            if ( val > grid_max ) grid_max = val;
+            }
+        }
+    vdata_rs->grid_min = grid_min;
+    vdata_rs->grid_max = grid_max;
+
+    calcWidthHeight ( &w, &h, vdata_rs );
+    caseString = formula->getCasesUsedString();
+    if ( subTitle1String_[0] )
+        {
+        if ( vdata_rs->data_label ) free ( vdata_rs->data_label );
+        vdata_rs->data_label = strdup ( subTitle1String_ );
+        }
+    sprintf ( strbuf_,"%s", formulaname );
+    if ( local )
+        sprintf ( title, "%s %s (local time):%s",
+                  periodName[period], modeName[mode], formulaname );
+    else if ( tzoff )
+        sprintf ( title, "%s %s (UTC%+d):%s",
+                  periodName[period], modeName[mode], tzoff, formulaname );
+    else
+        sprintf ( title, "%s %s:%s",
+                  periodName[period], modeName[mode], formulaname );
+    TileWnd *tile  = new TileWnd ( &cfg_, ( void * ) this, app_,
+                                   strbuf_,
+                                   bd_,
+                                   vdata_rs,
+                                   "Resample",
+                                   title,
+                                   subTitle2String_[0] ? subTitle2String_ : caseString,
+                                   ( Dimension ) w,
+                                   ( Dimension ) h,
+                                   &frameDelayInTenthsOfSeconds_,
+                                   0 );
+    // Register the tile plot with the synchronize dialog box
+    registerSynWnd ( tile );
+    return 0;
+    }
+
+
 /* =:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:=:= */
 
 int DriverWnd::grp_plot_nlayer_avg ( int AvgOrSum )
@@ -3098,10 +3463,10 @@ int DriverWnd::grp_plot_nlayer_avg ( int AvgOrSum )
     int r, c, l, t;
     int index;
     int ncol, nrow, nlay;
-    int n_good;
     int nlay_org;
     int zmin, zmax;
-    float sum;
+    long nplane;
+    WinAgg win;
     float val, grid_min, grid_max;
     char title[512];
 
@@ -3182,6 +3547,23 @@ int DriverWnd::grp_plot_nlayer_avg ( int AvgOrSum )
         vdata_nl->step_max = nh;
         vdata_nl->step_incr = 1;
 
+        // the layers of each step make one window
+        nplane = ( long ) ncol * nrow;
+        if ( !winagg_init ( &win, AvgOrSum, nlay_org, nplane ) )
+            {
+            fprintf ( stderr, "%s %s\n","ERROR: Allocation failure for",
+                      "Nlayer average" );
+            return 1;
+            }
+        for ( t=0; t<nh; t++ )
+            {
+            winagg_reset ( &win );
+            for ( l=0; l<nlay_org; l++ )
+                winagg_push ( &win, vdata[l]->grid + t * nplane );
+            winagg_result ( &win, vdata_nl->grid + t * nplane );
+            }
+        winagg_free ( &win );
+
         grid_max = BADVAL3;
         grid_min = -grid_max;
         for ( t=0; t<nh; t++ )
@@ -3190,34 +3572,8 @@ int DriverWnd::grp_plot_nlayer_avg ( int AvgOrSum )
                 {
                 for ( c = 0; c < ncol; c++ )
                     {
-                    sum = 0.0;
-                    n_good = 0;
                     index = INDEX (  c, r, 0, t, ncol, nrow, 1 );
-                    for ( l=0; l<nlay_org; l++ )
-                        {
-                        val = vdata[l]->grid[index];
-                        if ( !isnanf ( val ) )
-                            {
-                            sum += val;
-                            n_good++;
-                            }
-                        }
-                    if ( n_good != 0 )
-                        {
-                        if ( AvgOrSum )
-                            {
-                            val = sum / n_good;
-                            }
-                        else
-                            {
-                            val = sum;
-                            }
-                        }
-                    else
-                        {
-                        val = setNaNf();
-                        }
-                    vdata_nl->grid[index] = val;
+                    val = vdata_nl->grid[index];
                     if ( !isnanf ( val ) )
                         {
                         if ( val < grid_min ) grid_min = val;
@@ -4421,6 +4777,24 @@ int DriverWnd::processArgs ( int argc, char *argv[], char *estring )
             sprintf ( legendbins, "LEGEND_BINS=%s", argv[i] );
             putenv ( legendbins );
             }
+        else if ( !strcasecmp ( p, "-legendQuantiles" ) ) // next arg is <nbins>
+            {
+            int nbins;
+
+            i++;
+            if ( ( i == argc ) || ( sscanf ( argv[i], "%d", &nbins ) != 1 ) ||
+                 ( nbins < 2 ) || ( nbins > 64 ) )
+                {
+                sprintf ( estring, "-legendQuantiles needs 2 to 64 <nbins>!" );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            if ( legendQuantiles ( nbins, estring ) )
+                {
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            }
         else if ( !strcasecmp ( p, "-MapCounties" ) )
             {
             static char *mapchoice = "MAPCHOICE=1";
@@ -5203,6 +5577,65 @@ int DriverWnd::processArgs ( int argc, char *argv[], char *estring )
                 }
             multiVarNcf ( argv[i-2], argv[i-1], argv[i] );
             }
+        else if ( !strcasecmp ( p, "-probePoints" ) ) // next args are <lonlat|colrow> <nearest|bilinear> <pointfile> <filename>
+            {
+            int coords, method;
+
+            i+=4;
+            if ( i >= argc )
+                {
+                sprintf ( estring,
+                          "No <lonlat|colrow> <nearest|bilinear> <pointfile> <filename> supplied to -probePoints option!" );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            if ( !strcasecmp ( argv[i-3], "lonlat" ) )
+                coords = GRIDPROBE_LONLAT;
+            else if ( !strcasecmp ( argv[i-3], "colrow" ) )
+                coords = GRIDPROBE_COLROW;
+            else
+                {
+                sprintf ( estring, "-probePoints needs lonlat or colrow, not '%s'!", argv[i-3] );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            if ( !strcasecmp ( argv[i-2], "nearest" ) )
+                method = GRIDPROBE_NEAREST;
+            else if ( !strcasecmp ( argv[i-2], "bilinear" ) )
+                method = GRIDPROBE_BILINEAR;
+            else
+                {
+                sprintf ( estring, "-probePoints needs nearest or bilinear, not '%s'!", argv[i-2] );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            probePoints2file ( argv[i-1], argv[i], coords, method );
+            }
+        else if ( !strcasecmp ( p, "-pairModelObs" ) ) // next args are <modelformula> <obsformula> <filename>
+            {
+            i+=3;
+            if ( i >= argc )
+                {
+                sprintf ( estring,
+                          "No <modelformula> <obsformula> <filename> supplied to -pairModelObs option!" );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            pairModelObs2file ( argv[i-2], argv[i-1], argv[i] );
+            }
+        else if ( !strcasecmp ( p, "-histogram" ) ) // next arg is <nbins>
+            {
+            int nbins;
+
+            i++;
+            if ( ( i == argc ) || ( sscanf ( argv[i], "%d", &nbins ) != 1 ) || ( nbins < 1 ) )
+                {
+                sprintf ( estring, "No positive <nbins> supplied to -histogram option!" );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            histogramPlot ( nbins );
+            }
         else if ( !strcasecmp ( p, "-ts" ) ) // next arg is <time step>
             {
             i++;
@@ -5301,6 +5734,32 @@ int DriverWnd::processArgs ( int argc, char *argv[], char *estring )
 #endif // DIAGNOSTICS
             }
 
+        else if ( !strcasecmp ( p, "-percentileRange" ) ) //next args are <plo> <phi>
+            {
+            float plo, phi;
+
+            if ( ( i+2 >= argc ) ||
+                 ( sscanf ( argv[i+1], "%f", &plo ) != 1 ) ||
+                 ( sscanf ( argv[i+2], "%f", &phi ) != 1 ) ||
+                 ( plo < 0.0 ) || ( plo >= phi ) || ( phi > 100.0 ) )
+                {
+                sprintf ( estring,
+                          "-percentileRange needs percentiles 0 <= <plo> < <phi> <= 100!" );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            i+=2;
+            if ( percentileRange ( plo, phi, estring ) )
+                {
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+#ifdef DIAGNOSTICS
+            fprintf ( stderr, "Using contourRange %f to %f\n",
+                      minCut_, maxCut_ );
+#endif // DIAGNOSTICS
+            }
+
         else if ( !strcasecmp ( p,"-subdomain" ) ) //next args are <xmin> <ymin> <xmax> <ymax>
             {
             sdomain = 1;
@@ -5773,6 +6232,53 @@ int DriverWnd::processArgs ( int argc, char *argv[], char *estring )
             grp_plot_nhour_avg ( nhr,1 );
 
             }
+        else if ( !strcasecmp ( p, "-NhourMax" ) )
+            {
+            int nhr;
+            i+=1;
+            if ( i >= argc )
+                {
+                sprintf ( estring,
+                          "Need <hnours> -NhourMax option!" );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            nhr = atoi ( argv[i] );
+            grp_plot_nhour_avg ( nhr,WINAGG_MAX );
+
+            }
+        else if ( !strcasecmp ( p, "-resample" ) ) // next args are <hour|day|month|year> <sum|average|max|min> <utc|local|offset>
+            {
+            static const char *periods[] = { "hour", "day", "month", "year" };
+            static const char *modes[]   = { "sum", "average", "max", "min" };
+            int period, mode;
+
+            i+=3;
+            if ( i >= argc )
+                {
+                sprintf ( estring,
+                          "Need <hour|day|month|year> <sum|average|max|min> <utc|local|offset> for -resample option!" );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            for ( period = 0; period < 4; period++ )
+                if ( !strcasecmp ( argv[i-2], periods[period] ) ) break;
+            for ( mode = 0; mode < 4; mode++ )
+                if ( !strcasecmp ( argv[i-1], modes[mode] ) ) break;
+            if ( period == 4 || mode == 4 )
+                {
+                sprintf ( estring, "-resample needs hour|day|month|year and sum|average|max|min, not '%s %s'!",
+                          argv[i-2], argv[i-1] );
+                fprintf ( stderr, "%s\n", estring );
+                return 1;
+                }
+            if ( !strcasecmp ( argv[i], "local" ) )
+                grp_plot_resample ( period, mode, 1, 0 );
+            else if ( !strcasecmp ( argv[i], "utc" ) )
+                grp_plot_resample ( period, mode, 0, 0 );
+            else
+                grp_plot_resample ( period, mode, 0, atoi ( argv[i] ) );
+            }
         else if ( !strcasecmp ( p, "-NlayerSum" ) )
             {
             grp_plot_nlayer_avg ( 0 );
@@ -5965,9 +6471,11 @@ void pave_usage ( void )
               "[ -gtype <tile|line|mesh|bar> ]                 \n       "
               "[ -height <tile plot height in pixels> ]        \n       "
               "[ -help|fullhelp|usage ]                        \n       "
+              "[ -histogram <nbins> ]                          \n       "
               "[ -imageMagickArgs 'args' ] (NEW!!!)             \n       "
               "[ -kedamode ]                                   \n       "
               "[ -legendBins \"<bin0,bin1,...,bin_n>\" ]       \n       "
+              "[ -legendQuantiles <nbins> ]                    \n       "
               "[ -level <level> ]                              \n       "
               "[ -levelRange <levelMax> <levelMin> ]           \n       "
               "[ -mapCounties ]                                \n       "
@@ -5977,6 +6485,7 @@ void pave_usage ( void )
               "[ -multiVarNcf <formulaList> <varList> <fileName>\" ] \n       "
               "[ -multitime <Nformulas> \"<formula1>\" ... \"<formulaN>\" ] \n       "
               "[ -nHourAverage <nhours> ]                      \n       "
+              "[ -nHourMax <nhours> ]                          \n       "
               "[ -nHourSum <nhours> ]                          \n       "
               "[ -nLayerAverage ]                              \n       "
               "[ -nLayerSum ]                                  \n       "
@@ -5986,10 +6495,14 @@ void pave_usage ( void )
               "[ -obsThick<size> ]                             \n       "
               "[ -obsTimeSeries  ]                             \n       "
               "[ -onlyDrawLegend ON|OFF\" ] (NEW!!!)           \n       "
+              "[ -pairModelObs <modelFormula> <obsFormula> <fileName> ] \n       "
+              "[ -percentileRange <plo> <phi> ]                \n       "
               "[ -preClip <llLat> <llLon> <urLat> <urLon> ]    \n       "
               "[ -printAlias ]                                 \n       "
+              "[ -probePoints <lonlat|colrow> <nearest|bilinear> <pointFile> <fileName> ] \n       "
               "[ -quit|exit ]                                  \n       "
               "[ -raiseWindow <windowid> ]                     \n       "
+              "[ -resample <hour|day|month|year> <sum|average|max|min> <utc|local|offset> ] \n       "
               "[ -s \"<formula>\" ]                            \n       "
               "[ -save2ascii <filename> ]                      \n       "
               "[ -save2d <imagetype> <filename> ]              \n       "
@@ -7440,6 +7953,9 @@ PLOT_DATA *DriverWnd::getPlotData ( char *formulaName, int mode )
 
 
     pdata->plot_type=mode;
+    pdata->obspair = NULL;
+    pdata->stnid = NULL;
+    pdata->nstnid = 0;
 
     if ( mode == OBSVECTOR_PLOT )
         {
@@ -7650,6 +8166,7 @@ PLOT_DATA *DriverWnd::getPlotData ( char *formulaName, int mode )
                     }
                 pdata->stnid[k] = strdup ( str );
                 }
+            pdata->nstnid = ktot;
             if ( stnidOnce )
                 {
                 int t, j;
@@ -7837,6 +8354,451 @@ void DriverWnd::export2file ( char *filename, int exportType )
         }
 
     }
+
+
+// probePoints2file() samples the currently selected formula at each of
+// the points listed in pointfile, for every level and step, and writes
+// the time series as one table (see gridprobe.h)
+
+void DriverWnd::probePoints2file ( char *pointfile, char *filename, int coords, int method )
+    {
+    char formulaname[512], statusMsg[512];
+    Formula *formula;
+    VIS_DATA *vdata = NULL;
+
+    if ( formula_->getCurrSelection() )
+        {
+        stop_cb();
+        strcpy ( formulaname, formula_->getCurrSelection() );
+        updateStatus ( "Extracting point time series..." );
+
+        // Find the currently selected formula's Formula object
+        if ( ! ( formula = ( Formula * ) ( formulaList_.find ( formulaname ) ) ) )
+            {
+            sprintf ( statusMsg, "Didn't find '%s'\non the formulaList!\n",
+                      formulaname );
+            Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+            return;
+            }
+
+        // Retrieve a copy of that Formula object's data
+        if ( ! ( vdata = get_VIS_DATA_struct ( formula,statusMsg,XYZTSLICE ) ) )
+            {
+            if ( strstr ( statusMsg, "==" ) )
+                displaySingleNumberFormula ( statusMsg, formula );
+            else
+                {
+                Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+                }
+            return;
+            }
+
+        if ( !gridprobe_extract ( vdata, pointfile, coords, method, filename, statusMsg ) )
+            {
+            Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+            }
+        free_vis ( vdata );
+        free ( vdata );
+        updateStatus ( "" );
+        }
+    else
+        {
+        Message error ( info_window_, XmDIALOG_ERROR,
+                        "There is no formula currently selected!" );
+        }
+    }
+
+
+// pairModelObs2file() pairs formula modelname with the observations of
+// formula obsname (as for -obs), and writes bias, RMSE, NMB, NME, and
+// correlation, for each station and over all of them, to filename.
+// The obs data and their pairing with the grid are kept:  further model
+// formulas on the same grid, against the same obs, re-read only the
+// model side (see obspair.h)
+
+void DriverWnd::pairModelObs2file ( char *modelname, char *obsname, char *filename )
+    {
+    char statusMsg[512];
+    char *key;
+    Formula *formula;
+    VIS_DATA *vdata, *odata;
+    ObsPairStats *st, all;
+    float *mod;
+    int *jstep;
+    int nt, t, j, tstep;
+    FILE *fp;
+
+    stop_cb();
+    if ( ! ( formula = ( Formula * ) ( formulaList_.find ( modelname ) ) ) )
+        {
+        sprintf ( statusMsg, "Didn't find '%s'\non the formulaList!\n",
+                  modelname );
+        Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+        return;
+        }
+    updateStatus ( "Pairing model and observations..." );
+    if ( ! ( vdata = get_VIS_DATA_struct ( formula,statusMsg,XYTSLICE ) ) )
+        {
+        Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+        updateStatus ( "" );
+        return;
+        }
+
+    key = ( char * ) malloc ( strlen ( obsname ) +
+                              strlen ( vdata->map_info ? vdata->map_info : "" ) + 2 );
+    sprintf ( key, "%s\n%s", obsname, vdata->map_info ? vdata->map_info : "" );
+    if ( !pairObsKey_ || strcmp ( key, pairObsKey_ ) )
+        {
+        long k, n;
+        double *lon, *lat, *col, *row;
+        float *x, *y;
+        int ok;
+
+        // new obs, or a new grid:  pair them afresh
+        obspair_free ( &pairing_ );
+        if ( pairObsKey_ ) free ( pairObsKey_ );
+        pairObsKey_ = NULL;
+        freeObsPlotData ( pairObs_ );
+        if ( ! ( pairObs_ = getPlotData ( obsname, OBS_PLOT ) ) )
+            {
+            sprintf ( statusMsg, "Can't get observations '%s'!", obsname );
+            Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+            free ( key );
+            free_vis ( vdata );
+            free ( vdata );
+            updateStatus ( "" );
+            return;
+            }
+        odata = pairObs_->vdata;
+        n   = ( long ) odata->ncol * ( odata->step_max - odata->step_min + 1 );
+        lon = ( double * ) malloc ( 4 * n * sizeof ( double ) );
+        x   = ( float * ) malloc ( 2 * n * sizeof ( float ) );
+        if ( !lon || !x )
+            {
+            sprintf ( statusMsg, "Memory allocation failure in pairModelObs2file()" );
+            ok = 0;
+            }
+        else
+            {
+            lat = lon + n;
+            col = lat + n;
+            row = col + n;
+            y   = x + n;
+            for ( k = 0; k < n; k++ )
+                {
+                lon[k] = pairObs_->coord_x[k];
+                lat[k] = pairObs_->coord_y[k];
+                }
+
+            // 1-based cell centers to grid units from the lower-left corner
+            ok = gridprobe_project ( vdata->map_info, n, lon, lat, col, row, statusMsg );
+            for ( k = 0; ok && k < n; k++ )
+                {
+                x[k] = col[k] - 0.5;
+                y[k] = row[k] - 0.5;
+                }
+            ok = ok && obspair_build ( &pairing_, odata->ncol,
+                                       odata->step_max - odata->step_min + 1,
+                                       x, y, vdata->ncol, vdata->nrow, statusMsg );
+            }
+        if ( lon ) free ( lon );
+        if ( x ) free ( x );
+        if ( !ok )
+            {
+            Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+            free ( key );
+            free_vis ( vdata );
+            free ( vdata );
+            updateStatus ( "" );
+            return;
+            }
+        pairObsKey_ = key;
+        }
+    else
+        {
+        free ( key );
+        }
+    odata = pairObs_->vdata;
+
+    // which obs step each model step falls in, as TileWnd::overlay_create()
+    nt    = vdata->step_max - vdata->step_min + 1;
+    jstep = ( int * ) malloc ( nt * sizeof ( int ) );
+    mod   = ( float * ) malloc ( pairing_.nsta * pairing_.nobs * sizeof ( float ) );
+    st    = ( ObsPairStats * ) malloc ( pairing_.nsta * sizeof ( ObsPairStats ) );
+    if ( !jstep || !mod || !st )
+        {
+        Message error ( info_window_, XmDIALOG_ERROR,
+                        "Memory allocation failure in pairModelObs2file()" );
+        }
+    else if ( ( fp = fopen ( filename, "w" ) ) == NULL )
+        {
+        sprintf ( statusMsg, "Can't open '%s' for writing!", filename );
+        Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+        }
+    else
+        {
+        tstep = sec2timec ( odata->incr_sec );
+        for ( t = 0; t < nt; t++ )
+            {
+            j = JSTEP3 ( &vdata->sdate[t], &vdata->stime[t],
+                         &odata->sdate[0], &odata->stime[0], &tstep ) - 1;
+            jstep[t] = ( j < pairing_.nobs ) ? j : -1;
+            }
+
+        obspair_model ( &pairing_, vdata->grid, vdata->col_min - 1,
+                        vdata->row_min - 1,
+                        vdata->col_max - vdata->col_min + 1,
+                        vdata->row_max - vdata->row_min + 1,
+                        nt, jstep, mod );
+        obspair_stats ( &pairing_, odata->grid, mod, st, &all );
+
+        fprintf ( fp, "# Model: %s\n# Obs:   %s\n", modelname, obsname );
+        fprintf ( fp, "Station\tCol\tRow\tN\tMeanObs\tMeanModel"
+                  "\tBias\tRMSE\tNMB\tNME\tR\n" );
+        for ( j = 0; j < pairing_.nsta; j++ )
+            {
+            int c = pairing_.home[j];
+
+            if ( c < 0 ) continue;      // never on the grid
+            fprintf ( fp, "%s\t%d\t%d\t%ld\t%g\t%g\t%g\t%g\t%g\t%g\t%g\n",
+                      pairObs_->stnid ? pairObs_->stnid[j] : "-",
+                      c % pairing_.ncol + 1, c / pairing_.ncol + 1, st[j].n,
+                      st[j].mean_obs, st[j].mean_mod, st[j].bias, st[j].rmse,
+                      st[j].nmb, st[j].nme, st[j].r );
+            }
+        fprintf ( fp, "ALL\t-\t-\t%ld\t%g\t%g\t%g\t%g\t%g\t%g\t%g\n",
+                  all.n, all.mean_obs, all.mean_mod, all.bias, all.rmse,
+                  all.nmb, all.nme, all.r );
+        fclose ( fp );
+        }
+
+    if ( jstep ) free ( jstep );
+    if ( mod ) free ( mod );
+    if ( st ) free ( st );
+    free_vis ( vdata );
+    free ( vdata );
+    updateStatus ( "" );
+    }
+
+
+// formulaHistogram() adds the values of the currently selected formula,
+// over its domain, its layers, and its steps, into h (set up by
+// gridhist_init()):  the formula, or NULL with an error message in
+// estring
+
+Formula *DriverWnd::formulaHistogram ( GridHist *h, char *estring )
+    {
+    Formula *formula;
+    Domain *domain;
+    VIS_DATA *vdata;
+    char minfo[192], *percents, *window;
+    int *target[3];
+    int ni, nj, imax, jmax, i, j, ok;
+
+    estring[0] = '\0';
+    if ( !formula_->getCurrSelection() )
+        {
+        sprintf ( estring, "There is no formula currently selected!" );
+        return NULL;
+        }
+    if ( ! ( formula = ( Formula * ) ( formulaList_.find ( formula_->getCurrSelection() ) ) ) )
+        {
+        sprintf ( estring, "Didn't find '%s'\non the formulaList!\n",
+                  formula_->getCurrSelection() );
+        return NULL;
+        }
+    ni = formula->get_ncol();
+    nj = formula->get_nrow();
+    if ( formula->getMapInfo ( minfo, estring ) )
+        return NULL;
+    target[0] = &ni;
+    target[1] = &nj;
+    target[2] = ( int * ) minfo;
+    if ( ! ( domain = ( Domain * ) ( domainList_.find ( target ) ) ) )
+        {
+        sprintf ( estring, "Didn't find Domain %dx%d %s on the DomainList!",
+                  ni, nj, minfo );
+        return NULL;
+        }
+    if ( ! ( vdata = get_VIS_DATA_struct ( formula,estring,XYZTSLICE ) ) )
+        return NULL;
+    if ( ! ( percents = domain->getCopyOfPercents ( estring ) ) )
+        {
+        free_vis ( vdata );
+        free ( vdata );
+        return NULL;
+        }
+
+    // the domain's percents, over vdata's window, as for calc_stats()
+    imax = vdata->col_max - vdata->col_min + 1;
+    jmax = vdata->row_max - vdata->row_min + 1;
+    if ( ( window = ( char * ) malloc ( imax * jmax ) ) != NULL )
+        {
+        for ( j = 0; j < jmax; j++ )
+            for ( i = 0; i < imax; i++ )
+                window[i + j*imax] = percents[vdata->col_min - 1 + i +
+                                              ( vdata->row_min - 1 + j ) * ni];
+        ok = gridhist_vdata ( h, vdata, window, NULL, -1, estring );
+        free ( window );
+        }
+    else
+        {
+        sprintf ( estring, "Memory allocation failure in formulaHistogram()" );
+        ok = 0;
+        }
+    free ( percents );
+    free_vis ( vdata );
+    free ( vdata );
+    if ( ok && !h->n )
+        {
+        sprintf ( estring, "No values of '%s' in its domain!",
+                  formula->getFormulaName() );
+        ok = 0;
+        }
+    return ok ? formula : NULL;
+    }
+
+
+// histogramPlot() shows the distribution of the currently selected
+// formula's values, over its domain, layers, and steps, as a bar plot
+// of the percentage of them in each of nbins equal bins from their
+// minimum to their maximum, with the median and the 2nd and 98th
+// percentiles in the title
+
+void DriverWnd::histogramPlot ( int nbins )
+    {
+    char statusMsg[512], xLabel[192], yLabel[64];
+    char *caseString;
+    Formula *formula;
+    GridHist h;
+    float *x, *y;
+    int b;
+
+    stop_cb();
+    if ( !gridhist_init ( &h, nbins, 0.0, 0.0 ) )
+        {
+        Message error ( info_window_, XmDIALOG_ERROR,
+                        "Memory allocation failure in histogramPlot()" );
+        return;
+        }
+    updateStatus ( "Computing the distribution..." );
+    if ( ! ( formula = formulaHistogram ( &h, statusMsg ) ) )
+        {
+        if ( strstr ( statusMsg, "==" ) &&
+             ( formula = ( Formula * ) ( formulaList_.find ( formula_->getCurrSelection() ) ) ) )
+            displaySingleNumberFormula ( statusMsg, formula );
+        else
+            Message error ( info_window_, XmDIALOG_ERROR, statusMsg );
+        gridhist_free ( &h );
+        updateStatus ( "" );
+        return;
+        }
+
+    x = new float[nbins];
+    y = new float[nbins];
+    for ( b = 0; b < nbins; b++ )
+        {
+        x[b] = h.lo + ( b + 0.5 ) * ( h.hi - h.lo ) / nbins;
+        y[b] = 100.0 * h.count[b] / h.n;
+        }
+    combo_obj_.initialize();
+    combo_obj_.setDataArray ( x, y, 1, nbins );
+    sprintf ( str512_, "%s Distribution:  median %g, 2%%-98%% %g to %g",
+              formula->getFormulaName(), gridhist_quantile ( &h, 0.50 ),
+              gridhist_quantile ( &h, 0.02 ), gridhist_quantile ( &h, 0.98 ) );
+    sprintf ( xLabel, "Value" );
+    if ( formula->getUnits() && strlen ( formula->getUnits() ) )
+        {
+        strcat ( xLabel, " (" );
+        strcat ( xLabel, formula->getUnits() );
+        strcat ( xLabel, ")" );
+        }
+    sprintf ( yLabel, "Percent of %ld Values", h.n );
+    caseString = formula->getCasesUsedString();
+    combo_obj_.setTitles ( formula->getSelectedCellRange(), str512_, caseString, xLabel, yLabel );
+    free ( caseString );
+    caseString = NULL;
+    sprintf ( strbuf_, "%s Distribution", formula->getFormulaName() );
+    BarWnd *window1 = new BarWnd ( app_, strbuf_, "BAR", &combo_obj_, 500, 450, 0 );
+
+    delete [] x;
+    delete [] y;
+    gridhist_free ( &h );
+    updateStatus ( "" );
+    }
+
+
+// percentileRange() sets the contour range of the plots that follow to
+// the plo-th through phi-th percentiles of the currently selected
+// formula's values, over its domain, layers, and steps:  0 if OK, else
+// 1 with an error message in estring
+
+int DriverWnd::percentileRange ( float plo, float phi, char *estring )
+    {
+    GridHist h;
+
+    if ( !gridhist_init ( &h, 1, 0.0, 0.0 ) )
+        {
+        sprintf ( estring, "Memory allocation failure in percentileRange()" );
+        return 1;
+        }
+    if ( !formulaHistogram ( &h, estring ) )
+        {
+        gridhist_free ( &h );
+        return 1;
+        }
+    contourRange_ = 1;
+    minCut_ = gridhist_quantile ( &h, 0.01 * plo );
+    maxCut_ = gridhist_quantile ( &h, 0.01 * phi );
+    gridhist_free ( &h );
+    return 0;
+    }
+
+
+// legendQuantiles() sets the legend bins of the plots that follow (as
+// -LegendBins does) at the nbins-quantiles of the currently selected
+// formula's values, over its domain, layers, and steps, so that each
+// color covers about the same number of values.  Bins that collapse
+// (many values the same) are merged.  0 if OK, else 1 with an error
+// message in estring
+
+int DriverWnd::legendQuantiles ( int nbins, char *estring )
+    {
+    static char legendbins[64 + 65*16];     // for putenv():  see -LegendBins
+    char edge[32], last[32];
+    GridHist h;
+    int b, n;
+
+    if ( !gridhist_init ( &h, 1, 0.0, 0.0 ) )
+        {
+        sprintf ( estring, "Memory allocation failure in legendQuantiles()" );
+        return 1;
+        }
+    if ( !formulaHistogram ( &h, estring ) )
+        {
+        gridhist_free ( &h );
+        return 1;
+        }
+    strcpy ( legendbins, "LEGEND_BINS=" );
+    last[0] = '\0';
+    for ( b = n = 0; b <= nbins; b++ )
+        {
+        sprintf ( edge, "%g", gridhist_quantile ( &h, ( double ) b / nbins ) );
+        if ( !strcmp ( edge, last ) ) continue;
+        if ( n++ ) strcat ( legendbins, "," );
+        strcat ( legendbins, edge );
+        strcpy ( last, edge );
+        }
+    gridhist_free ( &h );
+    if ( n < 2 )
+        {
+        sprintf ( estring, "All the values of '%s' are %s:  no legend bins!",
+                  formula_->getCurrSelection(), last );
+        return 1;
+        }
+    putenv ( legendbins );
+    return 0;
+    }
 // ============================================================
 
 void DriverWnd::animatedGIF ( char *fname )
@@ -52,6 +52,11 @@
 // SRT  951227  Added logic to handle tile/mesh plots of YZT and XZT planes
 // SRT  960517  Added hooks to netCDF exporting
 // SRT  960826  Added documentation menu
+// CJC  202610  Added DX exporting
+// CJC  202610  Model/obs pairing for -pairModelObs (obspair.h)
+// CJC  202610  Calendar-period resampling for -resample (tresample.h)
+// CJC  202610  Distributions for -histogram, -percentileRange, and
+//              -legendQuantiles (gridhist.h)
 //
 //////////////////////////////////////////////////////////////////////////////
 
@@ -109,6 +114,7 @@
 #include <string.h>
 #include "bts.h" // added 950911 SRT
 #include "MultiSel.h"
+#include "gridhist.h"
 #include "StringPair.h"
 
 extern char *get_user_name(void); // in Main.cc, added 951106 SRT
@@ -204,6 +210,10 @@ class DriverWnd : public Shell, public Menus, public BusConnect {
 	linkedList      levelList_;
 	linkedList      *obsIdListP_;
 
+	PLOT_DATA	*pairObs_;	// -pairModelObs:  the obs data, and
+	char		*pairObsKey_;	// their pairing with the grid, kept
+	ObsPair		pairing_;	// for the next model formula
+
 	VIS_DATA	info;
 	enum		{ MAX_STR_LEN = 1024 };
 	enum		{ MAX_WINDOWS = 20 };
@@ -307,6 +317,7 @@ class DriverWnd : public Shell, public Menus, public BusConnect {
 	ExportServer	*exportAVS_UI_;
 	ExportServer	*exportTabbed_UI_;
 	ExportServer	*exportnetCDF_UI_;
+	ExportServer	*exportDX_UI_;
 
 	static void modify_formulaCB(Widget, XtPointer clientData, XtPointer callData);
 	void        modify_formula_cb();
@@ -395,6 +406,7 @@ class DriverWnd : public Shell, public Menus, public BusConnect {
 
 	int grp_plot_XYT(int ptype);
 	int grp_plot_nhour_avg(int, int);
+	int grp_plot_resample(int period, int mode, int local, int tzoff);
 	int grp_plot_nlayer_avg(int);
 
 	static void grp_plot_linegraphCB(Widget, XtPointer, XtPointer);
@@ -456,6 +468,12 @@ class DriverWnd : public Shell, public Menus, public BusConnect {
 
 	void tzSet(char *, char *);
 	void export2file(char *, int);
+	void probePoints2file(char *pointfile, char *filename, int coords, int method);
+	void pairModelObs2file(char *modelname, char *obsname, char *filename);
+	Formula *formulaHistogram(GridHist *h, char *estring);
+	void histogramPlot(int nbins);
+	int percentileRange(float plo, float phi, char *estring);
+	int legendQuantiles(int nbins, char *estring);
 	void animatedGIF(char *);
 	void multiVarNcf(char *flist, char *vlist, char *fname);
         void changeTitleFontSize(int size);
@@ -36,6 +36,7 @@
 // SRT  950908  added int removeAllItems(Widget dialog)
 // SRT  960517  Added hooks to netCDF exporting
 // SRT  961011  Added release_edata(), save_cancelCB(), and save_cancel_cb()
+// CJC  202610  Added DX exporting
 //
 /////////////////////////////////////////////////////////////
 //
@@ -125,6 +126,15 @@ void ExportServer::saveSelectionListToFile              // override SelectLoadSa
                 }
             break;
 
+        case PAVE_EXPORT_DX:
+            if ( dump_VIS_DATA_to_DX_file ( ( VIS_DATA * ) edata_,
+                                            filename,
+                                            estring ) )
+                {
+                Message error ( parent_, XmDIALOG_ERROR, estring );
+                }
+            break;
+
         case PAVE_EXPORT_TABBED:
             if ( dump_VIS_DATA_to_tabbed_ascii_file ( ( VIS_DATA * ) edata_,
                     filename,
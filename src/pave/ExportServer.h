@@ -42,6 +42,7 @@
 // SRT  950908  added int removeAllItems(Widget dialog)
 // SRT  960517  Added hooks to netCDF exporting
 // SRT	961011  Added release_edata() and save_cancel_cb()
+// CJC  202610  Added DX exporting
 //
 /////////////////////////////////////////////////////////////
 
@@ -57,6 +58,7 @@
 #define PAVE_EXPORT_AVS		1
 #define PAVE_EXPORT_TABBED	2
 #define PAVE_EXPORT_NETCDF	3
+#define PAVE_EXPORT_DX		4
 
 
 class ExportServer:public SelectLoadSaveServer {
@@ -1,6 +1,7 @@
 #include "LinkedList.h"
 #include "ContourData.h"
 #include "Vector2d.h"
+#include "obspair.h"
 
 enum plt_type {
 	UNDETERMINED_PLOT = 0,		/* undetermined data format type */
@@ -20,6 +21,9 @@ class PLOT_DATA: public linkedList {
    float *coord_x;
    float *coord_y;
    char **stnid;
+   int nstnid;			/* stnid[0..nstnid-1] are strdup()ed;  any
+				   more repeat them */
+   ObsPair *obspair;		/* OBS_PLOT:  stations by grid cell, or NULL */
    union {
      VIS_DATA *vdata;
      VECTOR2D_DATA *vect2d;
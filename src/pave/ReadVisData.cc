@@ -30,6 +30,7 @@
 //         Changed map_overlay failure from ERROR to Warning and
 //         also reset npolylines to 0
 //  SRT 950911 added getUnits() routine
+//  CJC 10/2026 added compactGrid(), gridValue(), storedValue()
 //
 //////////////////////////////////////////////////////////////////////
 
@@ -56,6 +57,7 @@ ReadVisData::ReadVisData ( char *drawtype, BusData *ibd, VIS_DATA *vdata )
     map_y_ = ( float * ) NULL;  // added 960918 SRT for memory purposes
     map_n_ = ( int * ) NULL;    // added 960918 SRT for memory purposes
 #endif /* #ifndef USE_OLDMAP */
+    memset ( &pack_, 0, sizeof ( pack_ ) );
 
     drawtype_ = strdup ( drawtype );
 
@@ -77,6 +79,7 @@ ReadVisData::~ReadVisData() // 960918 added SRT for memory management
         free ( ( char * ) info );
         info = ( VIS_DATA * ) NULL;
         }
+    gridpack_free ( &pack_ );
     if ( title1_ ) free ( title1_ );
     title1_ = NULL;
     if ( title2_ ) free ( title2_ );
@@ -277,6 +280,28 @@ void ReadVisData::setMapData()
 
 
 
+int ReadVisData::compactGrid()
+    {
+    int    mode = gridpack_mode();
+    size_t n;
+
+    if ( pack_.mode || mode == GRIDPACK_NONE || !info || !info->grid )
+        return 0;
+    n = ( size_t ) ( info->col_max - info->col_min + 1 ) *
+        ( size_t ) ( info->row_max - info->row_min + 1 ) *
+        ( size_t ) ( info->level_max - info->level_min + 1 ) *
+        ( size_t ) ( info->step_max - info->step_min + 1 );
+    if ( !gridpack_encode ( &pack_, info->grid, n, mode ) )
+        {
+        fprintf ( stderr, "\nWARNING - could not compact the plot data; keeping it at full precision\n" );
+        return 0;
+        }
+    free ( info->grid );
+    info->grid = ( float * ) NULL;
+    return 1;
+    }
+
+
 char *ReadVisData::getUnits()
     {
     return ( ( info ) &&
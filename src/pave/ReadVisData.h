@@ -74,6 +74,7 @@ extern "C" {
 #include "vis_data.h"
 #include "vis_proto.h"
 #include "visDataClient.h"
+#include "gridpack.h"
 }
 #include "bts.h"
 
@@ -136,6 +137,14 @@ class ReadVisData {
 
 	char *getUnits(void); // added 950911 SRT
 
+	// PAVE_COMPACT_GRID:  replaces info->grid by a GridPack (gridpack.h);
+	// from then on read the data through gridValue() only
+	int compactGrid();
+	float gridValue(long index) const
+		{ return pack_.mode ? gridpack_value(&pack_, (size_t) index) : info->grid[index]; };
+	float storedValue(float v) const
+		{ return pack_.mode ? gridpack_round(&pack_, v) : v; };
+
 	void setTileData();
 	void setMapData();
 
@@ -170,6 +179,7 @@ class ReadVisData {
 
   private:
 	FILE *fp_;
+	GridPack pack_;
 	void initialize();
 
 };
@@ -37,6 +37,11 @@
 //  960529 SRT Added callbacks for map setting routines
 //  960530 SRT Added logic for saving RGB, XWD, PNG, and GIF Images
 // 2018058 CJC Version for PAVE-3.0.  Major grid-loop reorganization.
+// 202610  CJC Plot data read through ReadVisData::gridValue(), so that
+//             it may be kept compact (PAVE_COMPACT_GRID, gridpack.h)
+// 202610  CJC OBS_PLOT overlays keep their stations hashed by grid cell
+//             (obspair.h):  drawing and probes visit only the stations
+//             within the rectangle at hand
 //////////////////////////////////////////////////////////////////////////////
 
 /** NOTE: all drawing is done in drawDetail */
@@ -134,6 +139,7 @@ TileWnd::TileWnd (   Config *cfgp, void *dwnd, AppInit *app, char *name, BusData
     initTileWnd();
     tiles_on_ = 1;
     vectors_on_ = 0;
+    vis_->compactGrid();
     overlay_ = 0;
     obs_dialog_ = cntr_dialog_ = NULL;
     draw_dist_counties_ = 0;
@@ -264,6 +270,7 @@ TileWnd::TileWnd (   Config *cfgp, void *dwnd, AppInit *app, char *name, ReadVis
     initTileWnd();
     tiles_on_ = 1;
     vectors_on_ = 0;
+    vis_->compactGrid();
     overlay_ = 0;
     obs_dialog_ = cntr_dialog_ = NULL;
     draw_dist_counties_ = 0;
@@ -364,6 +371,7 @@ TileWnd::TileWnd (   Config *cfgp, void *dwnd, AppInit *app, char *name, BusData
     initTileWnd();
     tiles_on_ = ( vdata->grid != NULL );
     vectors_on_ = 1;
+    if ( tiles_on_ ) vis_->compactGrid();
     overlay_ = 0;
     obs_dialog_ = cntr_dialog_ = NULL;
     if ( vectors_on_ && !tiles_on_ )    interact_mode_ = ZOOM_MODE;
@@ -2212,8 +2220,7 @@ void TileWnd::drawSmoothTile ( int t )
 
                     // lower left value
 
-                    y1 = vis_->info->grid
-                         [INDEX
+                    y1 = vis_->gridValue ( INDEX
                           (
                               j-vis_->col_min_,   // Eng reversed i & j SRT
                               i-vis_->row_min_,   // Eng reversed i & j SRT
@@ -2223,11 +2230,10 @@ void TileWnd::drawSmoothTile ( int t )
                               vis_->row_max_-vis_->row_min_+1, // SRT
                               1
                           )
-                         ];
+                         );
 
                     // lower right value
-                    y2 = vis_->info->grid
-                         [INDEX
+                    y2 = vis_->gridValue ( INDEX
                           (
                               j-vis_->col_min_+1, // Eng reversed i & j SRT
                               i-vis_->row_min_,   // Eng reversed i & j SRT
@@ -2237,11 +2243,10 @@ void TileWnd::drawSmoothTile ( int t )
                               vis_->row_max_-vis_->row_min_+1, // SRT
                               1
                           )
-                         ];
+                         );
 
                     // upper right value
-                    y3 = vis_->info->grid
-                         [INDEX
+                    y3 = vis_->gridValue ( INDEX
                           (
                               j-vis_->col_min_+1, // Eng reversed i & j SRT
                               i-vis_->row_min_+1, // Eng reversed i & j SRT
@@ -2251,11 +2256,10 @@ void TileWnd::drawSmoothTile ( int t )
                               vis_->row_max_-vis_->row_min_+1, // SRT
                               1
                           )
-                         ];
+                         );
 
                     // upper left value
-                    y4 = vis_->info->grid
-                         [INDEX
+                    y4 = vis_->gridValue ( INDEX
                           (
                               j-vis_->col_min_,   // Eng reversed i & j SRT
                               i-vis_->row_min_+1, // Eng reversed i & j SRT
@@ -2265,7 +2269,7 @@ void TileWnd::drawSmoothTile ( int t )
                               vis_->row_max_-vis_->row_min_+1, // SRT
                               1
                           )
-                         ];
+                         );
 
 
                     // loop over all the pixels in this cell
@@ -2458,7 +2462,7 @@ void TileWnd::drawBlockTile ( int t )
             index = INDEX ( i-vis_->col_min_+1, j-vis_->row_min_+1, 0, t,
                             vis_->col_max_-vis_->col_min_+1,
                             vis_->row_max_-vis_->row_min_+1, 1 );
-            val = vis_->info->grid[index];
+            val = vis_->gridValue ( index );
             if ( isnanf ( val ) )
                 {
                 XFillRectangle
@@ -3149,7 +3153,7 @@ void TileWnd::writeProbeFile ( float x1, float x2, float y1, float y2 )
                                  -vis_->info->row_min+1,
                                  1 );
 
-                fprintf ( fp, format, vis_->info->grid[index] );
+                fprintf ( fp, format, vis_->gridValue ( index ) );
                 yes = 1;
                 }
             }
@@ -3210,9 +3214,12 @@ void TileWnd::writeProbeObsFile ( int x1, int x2, int y1, int y2 )
             if ( ts>=0 )
                 {
                 int n=pdata->vdata->ncol;
+                int *sta = ( int * ) malloc ( n*sizeof ( int ) );
+                int m = sta ? obsStations ( pdata, xx1, yy2, xx2, yy1, sta ) : 0;
 
-                for ( j=0; j<n; j++ )
+                for ( i=0; i<m; i++ )
                     {
+                    j = sta[i];
                     k = n*ts+j;
                     x = pdata->coord_x[k];
                     y = pdata->coord_y[k];
@@ -3229,6 +3236,7 @@ void TileWnd::writeProbeObsFile ( int x1, int x2, int y1, int y2 )
                             }
                         }
                     }
+                free ( sta );
                 }
             }
         pdata = ( PLOT_DATA * ) plotDataListP_->next();
@@ -3914,15 +3922,14 @@ void TileWnd::drawMinMax ( int t )
             if ( ( j>=i_xmin+1 ) && ( j<=i_xmax+1 ) &&
                  ( i>=i_ymin+1 ) && ( i<=i_ymax+1 ) )
                 {
-                val = vis_->info->grid
-                      [INDEX (
+                val = vis_->gridValue ( INDEX (
                            j-vis_->col_min_,   // Eng reversed i & j SRT
                            i-vis_->row_min_,   // Eng reversed i & j SRT
                            0,
                            t,
                            vis_->col_max_-vis_->col_min_+1,
                            vis_->row_max_-vis_->row_min_+1,
-                           1 )];
+                           1 ) );
                 if ( isnanf ( val ) ) continue;
                 if ( !set )
                     {
@@ -4154,9 +4161,9 @@ void TileWnd::timeSeriesProbe (  int x1, int x2, int y1, int y2  )
             {
             for ( i = x1; i <= x2; i++ )
                 {
-                val = vis_->info->grid[INDEX ( i-vis_->col_min_,
+                val = vis_->gridValue ( INDEX ( i-vis_->col_min_,
                                                j-vis_->row_min_,
-                                               0, t, ni, nj, 1 )];
+                                               0, t, ni, nj, 1 ) );
 
                 if ( isnanf ( val ) ) continue;
                 tsdata[t] += val;
@@ -4245,14 +4252,15 @@ void TileWnd::minOrMaxPointTimeSeriesCB ( int minOrMax )
             nj = vis_->row_max_-vis_->row_min_+1,
             nt = vis_->step_max_-vis_->step_min_+1,
             i, j, t, iloc, jloc ;
-    float   val = minOrMax ? vis_->info->grid_max : vis_->info->grid_min;
+    float   val = vis_->storedValue ( minOrMax ? vis_->info->grid_max
+                                            : vis_->info->grid_min );
 
     iloc = -1,
     jloc = -1;
     for ( t = 0; t < nt; t++ )    
         for ( j = 0; j < nj; j++ )
             for ( i = 0; i < ni; i++ )
-                if ( vis_->info->grid[INDEX ( i, j, 0, t, ni, nj, 1 )] == val )
+                if ( vis_->gridValue ( INDEX ( i, j, 0, t, ni, nj, 1 ) ) == val )
                     {
                     iloc = i;
                     jloc = j;
@@ -4523,6 +4531,25 @@ void TileWnd::overlay_create ( char *newtext )
                     pdata->coord_y[j] = ( y-origy ) /dy;
 
                     }
+
+                // stations by grid cell, for the per-frame culls
+                if ( overlay_mode_ == OBS_PLOT )
+                    {
+                    ObsPair *op = ( ObsPair * ) malloc ( sizeof ( ObsPair ) );
+
+                    if ( op && obspair_build ( op, vdt->ncol, n1,
+                                               pdata->coord_x, pdata->coord_y,
+                                               params.ncols, params.nrows,
+                                               message ) )
+                        {
+                        pdata->obspair = op;
+                        }
+                    else
+                        {
+                        if ( op ) fprintf ( stderr, "%s\n", message );
+                        free ( op );
+                        }
+                    }
                 }
 
 #ifdef DEBUG
@@ -4612,6 +4639,7 @@ void TileWnd::overlay_ts ( int x1, int x2, int y1, int y2 )
     PLOT_DATA *pdata;
     int found;
     char *title;
+    int *sta, ns, is;
 
     nsteps = vis_->step_max_-vis_->step_min_+1;
 
@@ -4642,7 +4670,13 @@ void TileWnd::overlay_ts ( int x1, int x2, int y1, int y2 )
 
     //  units = vis_->getUnits();
 
-
+    sta = ( int * ) malloc ( obsStationsMax() * sizeof ( int ) );
+    if ( !sta )
+        {
+        fprintf ( stderr,
+                  "Memory allocation failure in TileWnd::overlay_ts()!\n" );
+        return;
+        }
 
     imax=0;
     for ( t = 0; t < nsteps; t++ )
@@ -4668,8 +4702,10 @@ void TileWnd::overlay_ts ( int x1, int x2, int y1, int y2 )
                             }
                         }
 
-                    for ( j=0; j<n; j++ )
+                    ns = obsStations ( pdata, xx1, yy1, xx2, yy2, sta );
+                    for ( is=0; is<ns; is++ )
                         {
+                        j = sta[is];
                         k = n*ts+j;
                         px = pdata->coord_x[k];
                         py = pdata->coord_y[k];
@@ -4698,6 +4734,7 @@ void TileWnd::overlay_ts ( int x1, int x2, int y1, int y2 )
         }
     if ( imax == 0 )
         {
+        free ( sta );
         fprintf ( stderr,"Error in overlay_ts: IMAX=0\n" );
         fprintf ( stderr,"In overlay_ts with (%d,%d) - (%d,%d)\n", x1,y1,x2,y2 );
         fprintf ( stderr,"In overlay_ts with (%f,%f) - (%f,%f)\n", xx1,yy1,xx2,yy2 );
@@ -4784,9 +4821,9 @@ void TileWnd::overlay_ts ( int x1, int x2, int y1, int y2 )
             {
             for ( i = x1; i <= x2; i++ )
                 {
-                val = vis_->info->grid[INDEX ( i-x1,
+                val = vis_->gridValue ( INDEX ( i-x1,
                                                j-y1,
-                                               0, t, ni, nj, 1 )];
+                                               0, t, ni, nj, 1 ) );
 
                 if ( !isnanf ( val ) )
                     {
@@ -4809,8 +4846,10 @@ void TileWnd::overlay_ts ( int x1, int x2, int y1, int y2 )
                     {
                     n=pdata->vdata->ncol;
                     tsdata[nsteps*imax+t] = 0.0;
-                    for ( j=0; j<n; j++ )
+                    ns = obsStations ( pdata, xx1, yy1, xx2, yy2, sta );
+                    for ( is=0; is<ns; is++ )
                         {
+                        j = sta[is];
                         k = n*ts+j;
                         px = pdata->coord_x[k];
                         py = pdata->coord_y[k];
@@ -4842,6 +4881,7 @@ void TileWnd::overlay_ts ( int x1, int x2, int y1, int y2 )
         tsdata[nsteps*imax+t] /= nperstep; // average obs
 
         }
+    free ( sta );
 
     title = strdup ( vis_->title1_ );
     //fprintf(stderr,"DEBUG:: title=%s\n",vis_->title1_);
@@ -4957,6 +4997,40 @@ int TileWnd::compute_this_contour ( PLOT_DATA *pdata, int n1, int auto_lvl,
 
 // ============================================================
 
+// the stations of OBS_PLOT pdata that may lie in x1 <= x <= x2,
+// y1 <= y <= y2 (grid units), into list[]:  all of them, if pdata has
+// no station hash
+int TileWnd::obsStations ( PLOT_DATA *pdata, float x1, float y1,
+                           float x2, float y2, int *list )
+    {
+    int j, n = pdata->vdata->ncol;
+
+    if ( pdata->obspair )
+        {
+        return obspair_stations_in ( pdata->obspair, x1, y1, x2, y2, list );
+        }
+    for ( j=0; j<n; j++ ) list[j] = j;
+    return n;
+    }
+
+// the most stations in any OBS_PLOT overlay
+int TileWnd::obsStationsMax()
+    {
+    int n = 1;
+    PLOT_DATA *pdata = ( PLOT_DATA * ) plotDataListP_->head();
+
+    while ( pdata )
+        {
+        if ( pdata->plot_type == OBS_PLOT && pdata->vdata->ncol > n )
+            {
+            n = pdata->vdata->ncol;
+            }
+        pdata = ( PLOT_DATA * ) plotDataListP_->next();
+        }
+    return n;
+    }
+
+
 void TileWnd::drawOverlays ( int t )
     {
 
@@ -4996,12 +5070,16 @@ void TileWnd::drawOverlays ( int t )
             if ( pdata->plot_type == OBS_PLOT )
                 {
                 int n=pdata->vdata->ncol;
-                int j;
+                int i, j, m;
+                int *sta = ( int * ) malloc ( n*sizeof ( int ) );
 
                 values.line_width = obs_thick_;
                 XChangeGC ( display, blackGC, GCLineWidth, &values );
-                for ( j=0; j<n; j++ )
+                m = sta ? obsStations ( pdata, s.xmin_, s.ymin_,
+                                        s.xmax_, s.ymax_, sta ) : 0;
+                for ( i=0; i<m; i++ )
                     {
+                    j = sta[i];
                     k = n*ts+j;
                     x = pdata->coord_x[k];
                     y = pdata->coord_y[k];
@@ -5042,6 +5120,7 @@ void TileWnd::drawOverlays ( int t )
                             }
                         }
                     }
+                free ( sta );
                 } // OBS_PLOT
             if ( pdata->plot_type == OBSVECTOR_PLOT
                     && scale_vectors_on_ )
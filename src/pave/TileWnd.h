@@ -340,6 +340,8 @@ class TileWnd : public DrawWnd, public Menus, public RubberBand, public ColorLeg
 	PLOT_DATA *current_pdata_cntr_config_;
 	void	initTileWnd();
 	void    drawOverlays(int);
+	int     obsStations(PLOT_DATA *, float, float, float, float, int *);
+	int     obsStationsMax();
 
 	static void overlay_obsCB(Widget, XtPointer, XtPointer);
 	static void overlay_vectorobsCB(Widget, XtPointer, XtPointer);
@@ -22,6 +22,10 @@
  *      KLP  01/31/95
  *      SRT  04/06/95   Added #ifdef __cplusplus lines
  *      CJC  02/27/2018 Version for PAVE-3.0
+ *      CJC  10/2026    Chunk-aligned reads for netCDF-4 files:  see
+ *                      alpha_planned_read()
+ *      CJC  10/2026    Grids come from grid_alloc(), so that META-meta
+ *                      members land in place:  see gridtarget.h
  *****************************************************************************/
 
 
@@ -45,6 +49,7 @@ extern "C" {
 #include "vis_data.h"
 #include "utils.h"
 #include "parms3.h"
+#include "gridtarget.h"
 
 /* in order to get the linker to resolve Kathy's
    subroutines when using CC to compile */
@@ -123,7 +128,14 @@ int alpha_open ( int *vis_fd, VIS_DATA *info, char *message )
                     if ( (
                                 ( buffer[0] == 'C' ) &&
                                 ( buffer[1] == 'D' ) &&
-                                ( buffer[2] == 'F' ) ) )
+                                ( buffer[2] == 'F' ) )
+#ifdef NC_NETCDF4
+                            || (                        /* netCDF-4/HDF5 */
+                                ( buffer[0] == '\211' ) &&
+                                ( buffer[1] == 'H' ) &&
+                                ( buffer[2] == 'D' ) )
+#endif  /* NC_NETCDF4 */
+                       )
                         {
                         if ( ( *vis_fd = ncopen ( ( *info ).filename,
                                                   NC_NOWRITE ) ) != NC_SYSERR )
@@ -617,6 +629,111 @@ int alpha_get_info ( VIS_DATA *info, char *message )
     return ( FAILURE );
     }
 
+#ifdef NC_NETCDF4
+
+/*******************************************************************/
+/* alpha_planned_read                                              */
+/* Function: read the (step,level,row,col) window start[]/count[]  */
+/* of variable varid, every incr'th step, into grid, in the order  */
+/* of the variable's netCDF-4 chunks:  one strided call per slab   */
+/* of time-chunks, with the chunk cache sized to hold one slab's   */
+/* chunks, so that no chunk is decompressed more than once.        */
+/* Returns PAVE_SUCCESS, or FAILURE to fall back on ncvarget()     */
+/*******************************************************************/
+
+#define ALPHA_CACHE_ENV     "PAVE_NC_CHUNK_CACHE"       /* MB */
+#define ALPHA_CACHE_MAX     ( 256 )                     /* MB */
+
+static size_t next_prime ( size_t n )
+    {
+    size_t d;
+
+    for ( n |= 1; ; n += 2 )
+        {
+        for ( d = 3; d * d <= n; d += 2 )
+            if ( n % d == 0 ) break;
+        if ( d * d > n ) return n;
+        }
+    }
+
+static int alpha_planned_read ( int ncid, int varid, long *start, long *count,
+                                int incr, float *grid )
+    {
+    size_t   vstart[4], vcount[4], chunks[4], nchunk, bytes, want;
+    size_t   cache, nelems, slab, nslice;
+    ptrdiff_t vstride[4];
+    float    preempt;
+    nc_type  vtype;
+    char    *env;
+    int      storage, d, status, t, tlast, n;
+
+    if ( ( nc_inq_vartype ( ncid, varid, &vtype ) != NC_NOERR ) ||
+            ( ( vtype != NC_FLOAT ) && ( vtype != NC_INT ) ) )
+        return ( FAILURE );
+    if ( nc_inq_var_chunking ( ncid, varid, &storage, chunks ) != NC_NOERR )
+        return ( FAILURE );
+
+    nslice = count[1] * count[2] * count[3];
+    tlast  = start[0] + ( count[0] - 1 ) * incr;
+    if ( storage == NC_CHUNKED )
+        {
+        /* chunks touched by one time-slab of the request */
+        nchunk = 1;
+        for ( d = 1; d < 4; d++ )
+            nchunk *= ( start[d] + count[d] - 1 ) / chunks[d] - start[d] / chunks[d] + 1;
+        bytes = nchunk * chunks[0] * chunks[1] * chunks[2] * chunks[3] * sizeof ( float );
+
+        want = ALPHA_CACHE_MAX;
+        if ( ( env = getenv ( ALPHA_CACHE_ENV ) ) != NULL && atoi ( env ) > 0 )
+            want = ( size_t ) atoi ( env );
+        want <<= 20;
+        if ( bytes < want ) want = bytes + bytes / 8;
+
+        if ( ( nc_get_var_chunk_cache ( ncid, varid, &cache, &nelems, &preempt ) == NC_NOERR ) &&
+                ( want > cache ) )
+            {
+            /* HDF5 wants a prime slot count well above the chunks held;
+               whole slabs are consumed in order, so evict read chunks first */
+            nc_set_var_chunk_cache ( ncid, varid, want,
+                                     next_prime ( 10 * nchunk + 100 ), 1.0f );
+            }
+        slab = chunks[0];
+        }
+    else
+        slab = ( size_t ) tlast + 1;        /* contiguous:  one call */
+
+    for ( d = 1; d < 4; d++ )
+        {
+        vstart[d]  = start[d];
+        vcount[d]  = count[d];
+        vstride[d] = 1;
+        }
+    vstride[0] = incr;
+
+    for ( t = start[0], n = 0; t <= tlast; )
+        {
+        /* requested steps up to the end of t's time-chunk */
+        vstart[0] = t;
+        vcount[0] = ( ( t / slab + 1 ) * slab - 1 - t ) / incr + 1;
+        if ( t + ( long ) ( vcount[0] - 1 ) * incr > tlast )
+            vcount[0] = ( tlast - t ) / incr + 1;
+
+        if ( vtype == NC_FLOAT )
+            status = nc_get_vars_float ( ncid, varid, vstart, vcount, vstride,
+                                         grid + n * nslice );
+        else
+            status = nc_get_vars_int ( ncid, varid, vstart, vcount, vstride,
+                                       ( int * ) ( grid + n * nslice ) );
+        if ( status != NC_NOERR )
+            return ( FAILURE );
+        n += vcount[0];
+        t += vcount[0] * incr;
+        }
+    return ( PAVE_SUCCESS );
+    }
+
+#endif  /* NC_NETCDF4 */
+
 int alpha_get_data ( VIS_DATA *info, char *message )
     {
     static long start[4];       /* starting positions for extracting data */
@@ -765,12 +882,19 @@ int alpha_get_data ( VIS_DATA *info, char *message )
         return ( FAILURE );
         }
     if ( ( *info ).grid != NULL )
-        free ( ( *info ).grid );
-    if ( ( ( *info ).grid = ( ( float * ) malloc ( sizeof ( float ) * ( n ) ) ) ) == NULL )
+        grid_free ( info, ( *info ).grid );
+    if ( ( ( *info ).grid = grid_alloc ( info, n ) ) == NULL )
         {
         sprintf ( message, "Cannnot allocate memory for data grid.\n" );
         goto DATA_FAILURE;
         }
+#ifdef NC_NETCDF4
+    if ( alpha_planned_read ( vis_fd, i, start, count, ( *info ).step_incr, ( *info ).grid ) )
+        {
+        /* done */
+        }
+    else
+#endif  /* NC_NETCDF4 */
     if ( ( *info ).step_incr == 1 )
         {
         if ( ( ncvarget ( vis_fd, i, start, count, ( void * ) ( ( *info ).grid ) ) )
@@ -940,8 +1064,8 @@ int get_ncf_bdry_data ( int vis_fd, VIS_DATA *info, char *message )
     return FAILURE;
     */
     if ( info->grid != NULL )
-        free ( info->grid );
-    if ( ( info->grid = ( ( float * ) malloc ( sizeof ( float ) * ( n ) ) ) ) == NULL )
+        grid_free ( info, info->grid );
+    if ( ( info->grid = grid_alloc ( info, n ) ) == NULL )
         {
         sprintf ( message, "Cannnot allocate memory for data grid.\n" );
         return FAILURE;
@@ -0,0 +1,1021 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: busBench.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ * ABOUT:  busBench.c
+ *
+ *     Benchmark for the software bus and the visd data path.  Starts a
+ *     private busMaster, N echo servers, and a stand-in visd that
+ *     serves generated VIS_DATA grids, then measures
+ *
+ *       latency     bus message round-trip percentiles, per server count
+ *       throughput  pipelined bus messages per second, per server count
+ *       visdata     sendVisData()/getVisData() MB/s and call latency, per
+ *                   grid size, over fresh (BusCallRemote), pooled
+ *                   (BusCallRemotePooled) and, on Linux, shared-memory
+ *                   (sendGridShm) transports
+ *       clients     bus message round-trip percentiles and aggregate
+ *                   messages per second, per number of concurrent clients
+ *                   of one echo server
+ *       visclients  VIS_DATA call latency percentiles and aggregate calls
+ *                   and MB per second, per grid size and number of
+ *                   concurrent clients of the stand-in visd, over the
+ *                   pooled and shared-memory transports
+ *
+ *     Results go to a tab-separated report (one header line, one line per
+ *     measurement; "#" lines are comments), so that runs before and after
+ *     a protocol or transport change can be compared with diff/awk/etc.
+ *
+ *     The latency and throughput tests have one sender (busBench itself),
+ *     sending to the N echo servers in turn:  they measure busMaster's
+ *     routing to N modules.  The clients and visclients tests fork N
+ *     client processes, each with a bus connection of its own, which
+ *     start together and each make -msgs (or -reps) calls, one at a time;
+ *     rates are totals over the span from the first client's start to
+ *     the last one's finish.
+ *
+ *     USAGE:
+ *       busBench [-master <busMaster executable>] [-servers 1,2,4,8]
+ *                [-clients 1,2,4,8] [-msgs 2000] [-window 32] [-bytes 64]
+ *                [-grids 10x10x1x1,100x100x1x24,...] [-reps 20]
+ *                [-o <report file>]
+ *
+ *     Grid sizes are NCOLSxNROWSxNLAYSxNSTEPS.  sendFloat() stages the
+ *     grid on the stack, so grids are limited to BENCH_MAXPOINTS points.
+ *
+ *     NETWORKING:  loopback only; SBUSPORT/SBUSHOST are set for the
+ *     private busMaster, and any existing settings are ignored.
+ *
+ ********************************************************************
+ * REVISION HISTORY - busBench.c
+ *
+ * Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *
+ * Version 10/2026:  the clients and visclients tests, with N concurrent
+ * client processes;  the report has a "clients" column.
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+
+#include "visDataClient.h"
+#include "spill.h"
+
+#define BENCH_MAXSERVERS   64
+#define BENCH_MAXCLIENTS   64
+#define BENCH_MAXGRIDS     16
+#define BENCH_MAXPOINTS    1000000  /* 4 MB:  sendFloat()'s stack copy */
+#define BENCH_MAXBYTES   4096
+#define BENCH_WAIT_SECS    15   /* give up on a reply after this long */
+
+static const char *PING_TYPE = "BUSBENCH_Ping";
+static const char *PONG_TYPE = "BUSBENCH_Pong";
+static const char *DATA_TYPE = "BUSBENCH_VisData";
+static const char *SHM_TYPE  = "BUSBENCH_VisDataShm";
+
+static FILE *report;
+
+/* ---------------------------  utilities  --------------------------- */
+
+static double now_usec ( void )
+    {
+    struct timespec ts;
+
+    clock_gettime ( CLOCK_MONOTONIC, &ts );
+    return 1.0e6 * ( double ) ts.tv_sec + 1.0e-3 * ( double ) ts.tv_nsec;
+    }
+
+static int cmp_double ( const void *a, const void *b )
+    {
+    double x = * ( const double * ) a;
+    double y = * ( const double * ) b;
+
+    return ( x < y ) ? -1 : ( ( x > y ) ? 1 : 0 );
+    }
+
+static double percentile ( double *sorted, int n, double p )
+    {
+    int k;
+
+    if ( n <= 0 )
+        return 0.0;
+    k = ( int ) ( p * ( double ) ( n - 1 ) + 0.5 );
+    return sorted[k];
+    }
+
+static int parse_list ( char *arg, int *vals, int maxvals )
+    {
+    char *tok;
+    int   n = 0;
+
+    for ( tok = strtok ( arg, "," ); tok && ( n < maxvals ); tok = strtok ( NULL, "," ) )
+        vals[n++] = atoi ( tok );
+    return n;
+    }
+
+static void report_line ( const char *test, const char *transport, int servers,
+                          int clients, long size, double *samples, int n,
+                          double rate, double mbps )
+/* samples (usec) are sorted in place */
+    {
+    qsort ( samples, n, sizeof ( double ), cmp_double );
+    fprintf ( report, "%s\t%s\t%d\t%d\t%ld\t%d\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.3f\n",
+              test, transport, servers, clients, size, n,
+              percentile ( samples, n, 0.50 ), percentile ( samples, n, 0.90 ),
+              percentile ( samples, n, 0.99 ), ( n > 0 ) ? samples[n-1] : 0.0,
+              rate, mbps );
+    fflush ( report );
+    }
+
+/* ---------------------  the private busMaster  --------------------- */
+
+static pid_t start_master ( char *master )
+/* starts busMaster, with its output in a scratch file, and sets
+   SBUSPORT and SBUSHOST from what it reports */
+    {
+    char   logname[64], line[256];
+    FILE  *log;
+    pid_t  pid;
+    int    fd, i, port;
+
+    strcpy ( logname, "/tmp/busBench_XXXXXX" );
+    fd = mkstemp ( logname );
+    if ( fd < 0 )
+        {
+        perror ( "busBench: mkstemp" );
+        return -1;
+        }
+
+    /* busMaster names its port file after $USER */
+    if ( getenv ( "USER" ) == NULL )
+        setenv ( "USER", "busBench", 1 );
+
+    pid = fork();
+    if ( pid == 0 )
+        {
+        dup2 ( fd, 1 );
+        dup2 ( fd, 2 );
+        close ( fd );
+        execlp ( master, master, ( char * ) NULL );
+        perror ( "busBench: exec busMaster" );
+        _exit ( 1 );
+        }
+    close ( fd );
+    if ( pid < 0 )
+        {
+        perror ( "busBench: fork" );
+        return -1;
+        }
+
+    port = 0;
+    for ( i = 0; ( i < 100 ) && ( port == 0 ); i++ )
+        {
+        usleep ( 100000 );
+        log = fopen ( logname, "r" );
+        if ( log == NULL )
+            continue;
+        while ( fgets ( line, sizeof ( line ), log ) )
+            {
+            if ( !strncmp ( line, "SBUSPORT=", 9 ) )
+                port = atoi ( line+9 );
+            }
+        fclose ( log );
+        }
+    unlink ( logname );
+
+    if ( port == 0 )
+        {
+        fprintf ( stderr, "busBench: busMaster \"%s\" did not report its port\n", master );
+        kill ( pid, SIGKILL );
+        waitpid ( pid, NULL, 0 );
+        return -1;
+        }
+    sprintf ( line, "%d", port );
+    setenv ( "SBUSPORT", line, 1 );
+    setenv ( "SBUSHOST", "127.0.0.1", 1 );
+    return pid;
+    }
+
+static void stop_child ( pid_t pid )
+    {
+    int i;
+
+    kill ( pid, SIGINT );
+    for ( i = 0; i < 50; i++ )
+        {
+        if ( waitpid ( pid, NULL, WNOHANG ) == pid )
+            return;
+        usleep ( 20000 );
+        }
+    kill ( pid, SIGKILL );
+    waitpid ( pid, NULL, 0 );
+    }
+
+static int wait_for_module ( struct BusData *bd, char *name )
+    {
+    int i, id;
+
+    for ( i = 0; i < 10*BENCH_WAIT_SECS; i++ )
+        {
+        id = BusFindModuleByName ( bd, name );
+        if ( id >= 0 )
+            return id;
+        usleep ( 100000 );
+        }
+    return -1;
+    }
+
+/* ------------------------  echo servers  ------------------------- */
+
+static int pongTypeId;
+
+static void echo_ping ( struct BusData *bd, struct BusMessage *bmsg )
+    {
+    struct BusMessage reply;
+
+    reply.toModule      = bmsg->fromModule;
+    reply.messageType   = pongTypeId;
+    reply.messageLength = bmsg->messageLength;
+    reply.message       = bmsg->message;
+    BusSendMessage ( bd, &reply );
+    }
+
+static void run_echo ( char *name )
+    {
+    struct BusData bd;
+
+    bd.name = name;
+    if ( BusInitialize ( &bd, -1, 0, NULL ) != SBUSERROR_NOT )
+        _exit ( 1 );
+    pongTypeId = BusFindTypeByName ( &bd, PONG_TYPE );
+    BusAddTypeCallback ( &bd, BusFindTypeByName ( &bd, PING_TYPE ), echo_ping );
+    BusEventLoop ( &bd );
+    _exit ( 0 );
+    }
+
+/* ------------------------  stand-in visd  ------------------------ */
+
+static void fake_request ( int fd, VIS_DATA *info )
+/* reads a request, and fills in a generated grid of the requested size */
+    {
+    int i, npts;
+
+    memset ( ( void * ) info, 0, sizeof ( VIS_DATA ) );
+    if ( getVisData ( fd, info ) == XFER_ERR )
+        return;
+    npts = ( info->col_max - info->col_min + 1 ) * ( info->row_max - info->row_min + 1 ) *
+           ( info->level_max - info->level_min + 1 ) * ( info->step_max - info->step_min + 1 );
+    info->grid = ( float * ) malloc ( sizeof ( float ) * ( size_t ) npts );
+    for ( i = 0; info->grid && ( i < npts ); i++ )
+        info->grid[i] = ( float ) ( i % 1000 ) * 0.001f;
+    info->grid_min = 0.0f;
+    info->grid_max = 0.999f;
+    }
+
+static void fake_visd_data ( int fd, char *data )
+    {
+    VIS_DATA info;
+    int val = PAVE_SUCCESS;
+
+    fake_request ( fd, &info );
+    sendInteger ( fd, 1, &val );
+    sendVisData ( fd, &info );
+    if ( info.grid ) free ( info.grid );
+    }
+
+#ifdef VIS_SHM_TRANSPORT
+static void fake_visd_shm ( int fd, char *data )
+    {
+    VIS_DATA info;
+    float *grid;
+    int val = PAVE_SUCCESS;
+
+    fake_request ( fd, &info );
+    sendInteger ( fd, 1, &val );
+    grid = info.grid;
+    info.grid = NULL;
+    sendVisData ( fd, &info );
+    info.grid = grid;
+    sendGridShm ( fd, &info );
+    if ( grid ) free ( grid );
+    }
+#endif /* VIS_SHM_TRANSPORT */
+
+static void run_visd ( void )
+    {
+    struct BusData bd;
+
+    bd.name = "busBench_visd";
+    if ( BusInitialize ( &bd, -1, 0, NULL ) != SBUSERROR_NOT )
+        _exit ( 1 );
+    BusAddDirectCallback ( &bd, BusFindTypeByName ( &bd, DATA_TYPE ), fake_visd_data, NULL );
+#ifdef VIS_SHM_TRANSPORT
+    BusAddDirectCallback ( &bd, BusFindTypeByName ( &bd, SHM_TYPE ), fake_visd_shm, NULL );
+#endif /* VIS_SHM_TRANSPORT */
+    BusServePooledConnections ( &bd );
+    BusEventLoop ( &bd );
+    _exit ( 0 );
+    }
+
+static pid_t fork_child ( struct BusData *bd, char *echoName )
+/* starts the echo server echoName, or the stand-in visd if NULL */
+    {
+    pid_t pid;
+
+    fflush ( NULL );
+    pid = fork();
+    if ( pid == 0 )
+        {
+        if ( bd && ( bd->fd >= 0 ) )
+            close ( bd->fd );           /* the parent's bus connection */
+        if ( echoName )
+            run_echo ( echoName );
+        else
+            run_visd();
+        }
+    return pid;
+    }
+
+/* -------------------  bus message measurements  ------------------ */
+
+static int     pongsSeen;
+static double *pongTimes;       /* receive times, by sequence number */
+
+static void bench_pong ( struct BusData *bd, struct BusMessage *bmsg )
+    {
+    int seq;
+
+    if ( bmsg->messageLength < ( int ) sizeof ( int ) )
+        return;
+    memcpy ( &seq, bmsg->message, sizeof ( int ) );
+    if ( pongTimes && ( seq >= 0 ) )
+        pongTimes[seq] = now_usec();
+    pongsSeen++;
+    }
+
+static int pump ( struct BusData *bd, int target )
+/* dispatches bus traffic until pongsSeen reaches target; 0 on timeout */
+    {
+    struct timeval tv;
+    fd_set rfds;
+    double limit;
+
+    limit = now_usec() + 1.0e6 * BENCH_WAIT_SECS;
+    while ( pongsSeen < target )
+        {
+        BusProcessRecvdMessages ( bd );
+        if ( pongsSeen >= target )
+            break;
+        if ( now_usec() > limit )
+            return 0;
+        FD_ZERO ( &rfds );
+        FD_SET ( bd->fd, &rfds );
+        tv.tv_sec  = 0;
+        tv.tv_usec = 100000;
+        if ( select ( bd->fd+1, &rfds, NULL, NULL, &tv ) > 0 )
+            {
+            if ( BusDispatch ( bd ) != SBUSERROR_NOT )
+                return 0;
+            }
+        }
+    return 1;
+    }
+
+static int send_ping ( struct BusData *bd, int toModule, int pingType,
+                       int seq, char *payload, int bytes )
+    {
+    struct BusMessage bmsg;
+
+    memcpy ( payload, &seq, sizeof ( int ) );
+    bmsg.toModule      = toModule;
+    bmsg.messageType   = pingType;
+    bmsg.messageLength = bytes;
+    bmsg.message       = payload;
+    return BusSendMessage ( bd, &bmsg );
+    }
+
+static int ping_loop ( struct BusData *bd, int *echoIds, int nservers, int pingType,
+                       int nmsgs, int bytes, char *payload, double *rtt )
+/* one message in flight at a time, to the servers in turn;  returns the
+   number of round trips timed (in rtt), stopping at the first lost one.
+   rtt must hold nmsgs entries. */
+    {
+    double sent;
+    int    i, n;
+
+    pongsSeen = 0;
+    for ( i = n = 0; i < nmsgs; i++ )
+        {
+        sent = now_usec();
+        send_ping ( bd, echoIds[i % nservers], pingType, i, payload, bytes );
+        if ( !pump ( bd, i+1 ) )
+            {
+            fprintf ( stderr, "busBench: no reply to message %d\n", i );
+            break;
+            }
+        rtt[n++] = pongTimes[i] - sent;
+        }
+    return n;
+    }
+
+static void bench_messages ( struct BusData *bd, int *echoIds, int nservers,
+                             int nmsgs, int window, int bytes )
+    {
+    double *sent, *rtt, t0, t1;
+    char    payload[BENCH_MAXBYTES];
+    int     pingType, i, n;
+
+    pingType = BusFindTypeByName ( bd, PING_TYPE );
+    sent     = ( double * ) calloc ( nmsgs, sizeof ( double ) );
+    rtt      = ( double * ) calloc ( nmsgs, sizeof ( double ) );
+    pongTimes = ( double * ) calloc ( nmsgs, sizeof ( double ) );
+    if ( !sent || !rtt || !pongTimes )
+        {
+        fprintf ( stderr, "busBench: out of memory\n" );
+        exit ( 1 );
+        }
+    memset ( payload, 0, sizeof ( payload ) );
+
+    /* latency:  one message in flight at a time */
+
+    n = ping_loop ( bd, echoIds, nservers, pingType, nmsgs, bytes, payload, rtt );
+    report_line ( "latency", "bus", nservers, 1, ( long ) bytes, rtt, n, 0.0, 0.0 );
+
+    /* throughput:  up to "window" messages in flight */
+
+    pongsSeen = 0;
+    memset ( pongTimes, 0, nmsgs * sizeof ( double ) );
+    t0 = now_usec();
+    for ( i = 0; i < nmsgs; i++ )
+        {
+        if ( ( i - pongsSeen >= window ) && !pump ( bd, i - window + 1 ) )
+            break;
+        sent[i] = now_usec();
+        send_ping ( bd, echoIds[i % nservers], pingType, i, payload, bytes );
+        }
+    pump ( bd, i );
+    t1 = now_usec();
+    for ( i = n = 0; i < nmsgs; i++ )
+        {
+        if ( pongTimes[i] > 0.0 )
+            rtt[n++] = pongTimes[i] - sent[i];
+        }
+    report_line ( "throughput", "bus", nservers, 1, ( long ) bytes, rtt, n,
+                  ( t1 > t0 ) ? 1.0e6 * n / ( t1 - t0 ) : 0.0,
+                  ( t1 > t0 ) ? ( double ) n * bytes / ( t1 - t0 ) : 0.0 );
+
+    free ( sent );
+    free ( rtt );
+    free ( pongTimes );
+    pongTimes = NULL;
+    }
+
+/* -------------------  VIS_DATA measurements  --------------------- */
+
+static void bench_recv ( int fd, char *data, char *res, int shm )
+/* the client side of fake_visd_data()/fake_visd_shm():  as EVAPLocalStub(),
+   without pulling visDataClient.o into the benchmark */
+    {
+    VIS_DATA *info = ( VIS_DATA * ) data;
+    int val = FAILURE;
+
+    strcpy ( res, "0" );
+    if ( sendVisData ( fd, info ) == XFER_ERR )
+        return;
+    if ( ( getInteger ( fd, &val ) == XFER_ERR ) || ( val != PAVE_SUCCESS ) )
+        return;
+    if ( getVisData ( fd, info ) == XFER_ERR )
+        return;
+#ifdef VIS_SHM_TRANSPORT
+    if ( shm && ( getGridShm ( fd, info ) == XFER_ERR ) )
+        return;
+#endif /* VIS_SHM_TRANSPORT */
+    sprintf ( res, "%d", val );
+    }
+
+static void bench_stub ( int fd, char *data, char *res )
+    {
+    bench_recv ( fd, data, res, 0 );
+    }
+
+#ifdef VIS_SHM_TRANSPORT
+static void bench_stub_shm ( int fd, char *data, char *res )
+    {
+    bench_recv ( fd, data, res, 1 );
+    }
+#endif /* VIS_SHM_TRANSPORT */
+
+static double visdata_call ( struct BusData *bd, int visdId, int typeId, int pooled,
+                             void ( *stub ) ( int, char *, char * ),
+                             int *dims, const char *tname )
+/* one VIS_DATA request for a dims grid:  its latency (usec), or -1 */
+    {
+    static char filename[] = "busBench";
+    VIS_DATA info;
+    double   t0, t1;
+    char     res[512];
+    int      err;
+
+    memset ( ( void * ) &info, 0, sizeof ( VIS_DATA ) );
+    info.filename  = filename;
+    info.slice     = XYTSLICE;
+    info.ncol      = dims[0];
+    info.nrow      = dims[1];
+    info.nlevel    = dims[2];
+    info.nstep     = dims[3];
+    info.col_min   = info.row_min = info.level_min = 1;
+    info.step_min  = 0;
+    info.col_max   = dims[0];
+    info.row_max   = dims[1];
+    info.level_max = dims[2];
+    info.step_max  = dims[3] - 1;
+    info.step_incr = 1;
+
+    t0 = now_usec();
+    if ( pooled )
+        err = BusCallRemotePooled ( bd, visdId, typeId, stub, ( char * ) &info, res );
+    else
+        err = BusCallRemote ( bd, visdId, typeId, stub, ( char * ) &info, res );
+    t1 = now_usec();
+
+    if ( ( err != SBUSERROR_NOT ) || ( atoi ( res ) != PAVE_SUCCESS ) || !info.grid )
+        {
+        fprintf ( stderr, "busBench: %s VIS_DATA call failed (%d, \"%s\")\n",
+                  tname, err, res );
+        t1 = t0 - 1.0;
+        }
+    if ( info.filename != filename ) free ( info.filename );
+    if ( info.grid  ) spill_release ( info.grid );
+    if ( info.sdate ) free ( info.sdate );
+    if ( info.stime ) free ( info.stime );
+    return t1 - t0;
+    }
+
+static void bench_visdata ( struct BusData *bd, int visdId, int *dims, int reps )
+    {
+    double  *lat, t, total;
+    long     npts;
+    int      transport, typeId, i, n;
+    const char *tname;
+    void   ( *stub ) ( int, char *, char * );
+
+    npts = ( long ) dims[0] * dims[1] * dims[2] * dims[3];
+    lat  = ( double * ) calloc ( reps, sizeof ( double ) );
+
+    for ( transport = 0; transport < 3; transport++ )
+        {
+        stub   = bench_stub;
+        typeId = BusFindTypeByName ( bd, DATA_TYPE );
+        tname  = ( transport == 0 ) ? "fresh" : "pooled";
+        if ( transport == 2 )
+            {
+#ifdef VIS_SHM_TRANSPORT
+            stub   = bench_stub_shm;
+            typeId = BusFindTypeByName ( bd, SHM_TYPE );
+            tname  = "shm";
+#else
+            continue;
+#endif /* VIS_SHM_TRANSPORT */
+            }
+
+        total = 0.0;
+        for ( i = n = 0; i < reps; i++ )
+            {
+            t = visdata_call ( bd, visdId, typeId, transport != 0, stub, dims, tname );
+            if ( t >= 0.0 )
+                {
+                lat[n++] = t;
+                total   += t;
+                }
+            }
+
+        report_line ( "visdata", tname, 1, 1, npts, lat, n,
+                      ( total > 0.0 ) ? 1.0e6 * n / total : 0.0,
+                      ( total > 0.0 ) ? ( double ) n * npts * sizeof ( float ) / total : 0.0 );
+        }
+    free ( lat );
+    }
+
+/* -------------------  concurrent clients  ------------------------ */
+
+#define CLIENT_BUS      0       /* pings to an echo server */
+#define CLIENT_POOLED   1       /* VIS_DATA calls, pooled connections */
+#define CLIENT_SHM      2       /* VIS_DATA calls, shared-memory grids */
+
+static int write_all ( int fd, const void *buf, size_t n )
+    {
+    const char *p = ( const char * ) buf;
+    ssize_t k;
+
+    while ( n > 0 )
+        {
+        k = write ( fd, p, n );
+        if ( ( k < 0 ) && ( errno == EINTR ) ) continue;
+        if ( k <= 0 ) return 0;
+        p += k;
+        n -= ( size_t ) k;
+        }
+    return 1;
+    }
+
+static int read_all ( int fd, void *buf, size_t n )
+    {
+    char *p = ( char * ) buf;
+    ssize_t k;
+
+    while ( n > 0 )
+        {
+        k = read ( fd, p, n );
+        if ( ( k < 0 ) && ( errno == EINTR ) ) continue;
+        if ( k <= 0 ) return 0;
+        p += k;
+        n -= ( size_t ) k;
+        }
+    return 1;
+    }
+
+static void run_client ( struct BusData *parent, char *name, int kind, int serverId,
+                         int *dims, int calls, int bytes,
+                         int readyFd, int goFd, int resFd )
+/* a client process:  attaches to the bus, says it is ready ('r', or 'x'
+   if it cannot run), waits for the go, makes its calls, and writes back
+   the count, the latencies and its start and finish times */
+    {
+    struct BusData bd;
+    char    payload[BENCH_MAXBYTES], c;
+    double *lat, t, t0, t1;
+    int     typeId = -1, n, i;
+    void  ( *stub ) ( int, char *, char * ) = bench_stub;
+
+    if ( parent && ( parent->fd >= 0 ) )
+        close ( parent->fd );           /* the parent's bus connection */
+    bd.name = name;
+    lat = ( double * ) calloc ( calls, sizeof ( double ) );
+    pongTimes = ( double * ) calloc ( calls, sizeof ( double ) );
+    if ( !lat || !pongTimes || ( BusInitialize ( &bd, -1, 0, NULL ) != SBUSERROR_NOT ) )
+        {
+        write_all ( readyFd, "x", 1 );
+        _exit ( 1 );
+        }
+    if ( kind == CLIENT_BUS )
+        {
+        BusAddTypeCallback ( &bd, BusFindTypeByName ( &bd, PONG_TYPE ), bench_pong );
+        typeId = BusFindTypeByName ( &bd, PING_TYPE );
+        memset ( payload, 0, sizeof ( payload ) );
+        }
+    else
+        {
+        typeId = BusFindTypeByName ( &bd, DATA_TYPE );
+#ifdef VIS_SHM_TRANSPORT
+        if ( kind == CLIENT_SHM )
+            {
+            typeId = BusFindTypeByName ( &bd, SHM_TYPE );
+            stub   = bench_stub_shm;
+            }
+#endif /* VIS_SHM_TRANSPORT */
+        }
+    write_all ( readyFd, "r", 1 );
+    if ( !read_all ( goFd, &c, 1 ) )
+        _exit ( 1 );
+
+    t0 = now_usec();
+    if ( kind == CLIENT_BUS )
+        n = ping_loop ( &bd, &serverId, 1, typeId, calls, bytes, payload, lat );
+    else
+        for ( i = n = 0; i < calls; i++ )
+            {
+            t = visdata_call ( &bd, serverId, typeId, 1, stub, dims,
+                               ( kind == CLIENT_SHM ) ? "shm" : "pooled" );
+            if ( t >= 0.0 )
+                lat[n++] = t;
+            }
+    t1 = now_usec();
+
+    write_all ( resFd, &n, sizeof ( int ) );
+    write_all ( resFd, lat, n * sizeof ( double ) );
+    write_all ( resFd, &t0, sizeof ( double ) );
+    write_all ( resFd, &t1, sizeof ( double ) );
+    BusPoolClose ( &bd );
+    BusClose ( &bd );
+    _exit ( 0 );
+    }
+
+static void bench_clients ( struct BusData *bd, int kind, int nclients, int serverId,
+                            int *dims, int calls, int bytes )
+/* nclients client processes at once;  one report line for them all */
+    {
+    char    name[64], c;
+    double *lat, t0, t1, first, last;
+    long    size;
+    pid_t   pids[BENCH_MAXCLIENTS];
+    int     resFd[BENCH_MAXCLIENTS], ready[2], go[2], res[2];
+    int     k, m, n, total, started, got;
+    const char *test, *tname;
+
+    if ( kind == CLIENT_BUS )
+        {
+        test  = "clients";
+        tname = "bus";
+        size  = ( long ) bytes;
+        }
+    else
+        {
+        test  = "visclients";
+        tname = ( kind == CLIENT_SHM ) ? "shm" : "pooled";
+        size  = ( long ) dims[0] * dims[1] * dims[2] * dims[3];
+        }
+    lat = ( double * ) malloc ( ( size_t ) nclients * calls * sizeof ( double ) );
+    if ( !lat || ( pipe ( ready ) < 0 ) || ( pipe ( go ) < 0 ) )
+        {
+        fprintf ( stderr, "busBench: cannot set up %d clients\n", nclients );
+        exit ( 1 );
+        }
+
+    fflush ( NULL );
+    for ( k = started = 0; k < nclients; k++ )
+        {
+        resFd[k] = -1;
+        pids[k]  = -1;
+        if ( pipe ( res ) < 0 )
+            break;
+        sprintf ( name, "busBench_client_%d_%d", nclients, k );
+        pids[k] = fork();
+        if ( pids[k] == 0 )
+            {
+            close ( ready[0] );
+            close ( go[1] );
+            close ( res[0] );
+            run_client ( bd, name, kind, serverId, dims, calls, bytes,
+                         ready[1], go[0], res[1] );
+            }
+        close ( res[1] );
+        if ( pids[k] < 0 )
+            {
+            close ( res[0] );
+            break;
+            }
+        resFd[k] = res[0];
+        started++;
+        }
+    close ( ready[1] );
+    close ( go[0] );
+
+    /* all attached:  go */
+
+    for ( k = m = 0; k < started; k++ )
+        if ( read_all ( ready[0], &c, 1 ) && ( c == 'r' ) )
+            m++;
+    for ( k = 0; k < started; k++ )
+        write_all ( go[1], "g", 1 );
+    close ( go[1] );
+    close ( ready[0] );
+
+    total = got = 0;
+    first = last = 0.0;
+    for ( k = 0; k < started; k++ )
+        {
+        if ( read_all ( resFd[k], &n, sizeof ( int ) ) && ( n >= 0 ) && ( n <= calls ) &&
+                read_all ( resFd[k], lat + total, n * sizeof ( double ) ) &&
+                read_all ( resFd[k], &t0, sizeof ( double ) ) &&
+                read_all ( resFd[k], &t1, sizeof ( double ) ) )
+            {
+            if ( !got || ( t0 < first ) ) first = t0;
+            if ( !got || ( t1 > last  ) ) last  = t1;
+            total += n;
+            got    = 1;
+            }
+        close ( resFd[k] );
+        waitpid ( pids[k], NULL, 0 );
+        }
+    if ( ( m < nclients ) || ( started < nclients ) )
+        fprintf ( stderr, "busBench: only %d of %d %s clients ran\n", m, nclients, tname );
+
+    report_line ( test, tname, 1, nclients, size, lat, total,
+                  ( last > first ) ? 1.0e6 * total / ( last - first ) : 0.0,
+                  ( last > first ) ? ( double ) total * size *
+                  ( ( kind == CLIENT_BUS ) ? 1.0 : ( double ) sizeof ( float ) ) /
+                  ( last - first ) : 0.0 );
+    free ( lat );
+    }
+
+/* ------------------------------  main  ------------------------------ */
+
+static void usage ( char *prog )
+    {
+    fprintf ( stderr,
+              "usage: %s [-master busMaster] [-servers 1,2,4,8] [-clients 1,2,4,8]\n"
+              "          [-msgs 2000] [-window 32] [-bytes 64] [-grids 10x10x1x1,...]\n"
+              "          [-reps 20] [-o report]\n", prog );
+    exit ( 2 );
+    }
+
+int main ( int argc, char *argv[] )
+    {
+    struct BusData bd;
+    char   *master = "busMaster";
+    char   *outname = NULL;
+    char    name[64], host[256], *tok;
+    int     servers[BENCH_MAXSERVERS], nserverCounts;
+    int     clients[BENCH_MAXCLIENTS], nclientCounts;
+    int     grids[BENCH_MAXGRIDS][4], ngrids;
+    int     echoIds[BENCH_MAXSERVERS];
+    pid_t   echoPids[BENCH_MAXSERVERS], masterPid, visdPid;
+    int     nmsgs = 2000, window = 32, bytes = 64, reps = 20;
+    int     i, c, k, visdId, echoId;
+    time_t  t;
+
+    servers[0] = 1;
+    servers[1] = 2;
+    servers[2] = 4;
+    servers[3] = 8;
+    nserverCounts = 4;
+    for ( c = 0; c < 4; c++ )
+        clients[c] = servers[c];
+    nclientCounts = 4;
+    ngrids = 0;
+
+    for ( i = 1; i < argc; i++ )
+        {
+        if ( ( i+1 < argc ) && !strcmp ( argv[i], "-master" ) )
+            master = argv[++i];
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-servers" ) )
+            nserverCounts = parse_list ( argv[++i], servers, BENCH_MAXSERVERS );
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-clients" ) )
+            nclientCounts = parse_list ( argv[++i], clients, BENCH_MAXCLIENTS );
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-msgs" ) )
+            nmsgs = atoi ( argv[++i] );
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-window" ) )
+            window = atoi ( argv[++i] );
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-bytes" ) )
+            bytes = atoi ( argv[++i] );
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-reps" ) )
+            reps = atoi ( argv[++i] );
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-o" ) )
+            outname = argv[++i];
+        else if ( ( i+1 < argc ) && !strcmp ( argv[i], "-grids" ) )
+            {
+            for ( tok = strtok ( argv[++i], "," ); tok && ( ngrids < BENCH_MAXGRIDS );
+                    tok = strtok ( NULL, "," ) )
+                {
+                if ( sscanf ( tok, "%dx%dx%dx%d", &grids[ngrids][0], &grids[ngrids][1],
+                              &grids[ngrids][2], &grids[ngrids][3] ) != 4 )
+                    continue;
+                if ( ( grids[ngrids][0] <= 0 ) || ( grids[ngrids][1] <= 0 ) ||
+                        ( grids[ngrids][2] <= 0 ) || ( grids[ngrids][3] <= 0 ) ||
+                        ( ( double ) grids[ngrids][0] * grids[ngrids][1] *
+                          grids[ngrids][2] * grids[ngrids][3] > BENCH_MAXPOINTS ) )
+                    {
+                    fprintf ( stderr, "busBench: grid %s is empty or over %d points\n",
+                              tok, BENCH_MAXPOINTS );
+                    usage ( argv[0] );
+                    }
+                ngrids++;
+                }
+            }
+        else
+            usage ( argv[0] );
+        }
+
+    if ( ngrids == 0 )
+        {
+        static int defgrids[4][4] = { { 10, 10, 1, 1 }, { 100, 100, 1, 1 },
+                                      { 100, 100, 1, 24 }, { 100, 100, 4, 24 } };
+        memcpy ( grids, defgrids, sizeof ( defgrids ) );
+        ngrids = 4;
+        }
+    if ( ( nmsgs <= 0 ) || ( window <= 0 ) || ( reps <= 0 ) ||
+            ( bytes < ( int ) sizeof ( int ) ) || ( bytes > BENCH_MAXBYTES ) )
+        usage ( argv[0] );
+    for ( c = 0; c < nserverCounts; c++ )
+        {
+        if ( ( servers[c] <= 0 ) || ( servers[c] > BENCH_MAXSERVERS ) )
+            usage ( argv[0] );
+        }
+    for ( c = 0; c < nclientCounts; c++ )
+        {
+        if ( ( clients[c] <= 0 ) || ( clients[c] > BENCH_MAXCLIENTS ) )
+            usage ( argv[0] );
+        }
+
+    report = stdout;
+    if ( outname && ( ( report = fopen ( outname, "w" ) ) == NULL ) )
+        {
+        perror ( outname );
+        return 1;
+        }
+
+    signal ( SIGPIPE, SIG_IGN );
+    masterPid = start_master ( master );
+    if ( masterPid < 0 )
+        return 1;
+
+    bd.name = "busBench";
+    if ( BusInitialize ( &bd, -1, 0, NULL ) != SBUSERROR_NOT )
+        {
+        fprintf ( stderr, "busBench: could not attach to the bus\n" );
+        stop_child ( masterPid );
+        return 1;
+        }
+    BusAddTypeCallback ( &bd, BusFindTypeByName ( &bd, PONG_TYPE ), bench_pong );
+
+    t = time ( NULL );
+    gethostname ( host, sizeof ( host ) );
+    fprintf ( report, "# busBench report\n" );
+    fprintf ( report, "# host %s  date %s", host, ctime ( &t ) );
+    fprintf ( report, "# msgs %d  window %d  bytes %d  reps %d\n", nmsgs, window, bytes, reps );
+    fprintf ( report, "# clients" );
+    for ( c = 0; c < nclientCounts; c++ )
+        fprintf ( report, " %d", clients[c] );
+    fprintf ( report, "\n" );
+    fprintf ( report, "test\ttransport\tservers\tclients\tsize\tcount\tp50_us\tp90_us\tp99_us\tmax_us\trate_per_s\tMB_per_s\n" );
+
+    /* bus messages, from one sender, scaling with the number of echo
+       servers */
+
+    for ( c = 0; c < nserverCounts; c++ )
+        {
+        /* busMaster may still list the previous round's servers */
+        for ( k = 0; k < servers[c]; k++ )
+            {
+            sprintf ( name, "busBench_echo_%d_%d", c, k );
+            echoPids[k] = fork_child ( &bd, name );
+            }
+        for ( k = 0; k < servers[c]; k++ )
+            {
+            sprintf ( name, "busBench_echo_%d_%d", c, k );
+            echoIds[k] = wait_for_module ( &bd, name );
+            if ( echoIds[k] < 0 )
+                {
+                fprintf ( stderr, "busBench: echo server %d did not start\n", k );
+                break;
+                }
+            }
+        if ( k == servers[c] )
+            bench_messages ( &bd, echoIds, servers[c], nmsgs, window, bytes );
+        for ( k = 0; k < servers[c]; k++ )
+            stop_child ( echoPids[k] );
+        }
+
+    /* bus messages, from N concurrent clients to one echo server */
+
+    strcpy ( name, "busBench_echo_clients" );
+    echoPids[0] = fork_child ( &bd, name );
+    echoId = wait_for_module ( &bd, name );
+    if ( echoId < 0 )
+        fprintf ( stderr, "busBench: echo server for the clients test did not start\n" );
+    else
+        for ( c = 0; c < nclientCounts; c++ )
+            bench_clients ( &bd, CLIENT_BUS, clients[c], echoId, NULL, nmsgs, bytes );
+    stop_child ( echoPids[0] );
+
+    /* VIS_DATA transfers, by grid size:  from busBench, then from N
+       concurrent clients */
+
+    visdPid = fork_child ( &bd, NULL );
+    visdId  = wait_for_module ( &bd, "busBench_visd" );
+    if ( visdId < 0 )
+        fprintf ( stderr, "busBench: stand-in visd did not start\n" );
+    else
+        for ( i = 0; i < ngrids; i++ )
+            {
+            bench_visdata ( &bd, visdId, grids[i], reps );
+            for ( c = 0; c < nclientCounts; c++ )
+                {
+                bench_clients ( &bd, CLIENT_POOLED, clients[c], visdId, grids[i], reps, bytes );
+#ifdef VIS_SHM_TRANSPORT
+                bench_clients ( &bd, CLIENT_SHM, clients[c], visdId, grids[i], reps, bytes );
+#endif /* VIS_SHM_TRANSPORT */
+                }
+            }
+    BusPoolClose ( &bd );
+    stop_child ( visdPid );
+
+    BusClose ( &bd );
+    stop_child ( masterPid );
+    if ( report != stdout )
+        fclose ( report );
+    return 0;
+    }
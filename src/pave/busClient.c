@@ -126,6 +126,9 @@
  * Change author: R. Balay
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  BusDHandleDirect() keeps pooled direct connections
+ * open, and BusPooledInput() serves the requests that arrive on them.
  ********************************************************************/
 
 #include <string.h>
@@ -150,6 +153,7 @@
 #include "busError.h"
 #include "busDebug.h"
 #include "busXtClient.h"
+#include "busRpc.h"
 #include "busVersion.h"
 
 int clientNotDone;
@@ -218,6 +222,10 @@ int BusInitialize ( struct BusData *bd, int setTimeout, int minsToLive,
     bd->DirectCallbacks=NULL;
     bd-> InputCallbacks=NULL;
     bd->TimeoutCallback = NULL;
+    bd->     AsyncCalls=NULL;
+    bd->       ConnPool=NULL;
+    bd->PooledTypeId    = -1;
+    bd->PoolServer      = 0;
 
     err = BusMakeConnection ( & ( bd->fd ) );
     if ( err != SBUSERROR_NOT )
@@ -307,6 +315,7 @@ void BusClose ( struct BusData *bd )
     char procfname[256];
 
     debug0 ( DEBUG_CLIENT,"BusClose : Module leaving \n" );
+    BusPoolClose ( bd );
     BusSendBusByte ( bd, MASTERID, BUSBYTE_MODULE_LEAVING, 0, NULL );
     shutdown ( bd->fd, 2 );
     close ( bd->fd );
@@ -578,6 +587,85 @@ void DirectInputCallback( void (*callback)(int), int fd)
 }
 */
 
+/* Serving pooled direct connections (see busRpc.h):  the connection
+   stays open, and BusEventLoop() calls BusPooledInput() whenever a
+   request arrives on it. */
+
+int BusServePooledConnections ( struct BusData *bd )
+    {
+    bd->PooledTypeId = BusFindTypeByName ( bd, BUSPOOL_TYPENAME );
+    if ( bd->PooledTypeId < 0 )
+        return SBUSERROR_GENERAL_FAILURE;
+    bd->PoolServer = 1;
+    return SBUSERROR_NOT;
+    }
+
+static void BusPooledClose ( struct BusData *bd, int fd )
+    {
+    debug1 ( DEBUG_CLIENT,"BusPooledInput : closing pooled connection %d\n", fd );
+    BusRemoveInputCallback ( bd, fd );
+    shutdown ( fd,2 );
+    close ( fd );
+    }
+
+static void BusPooledInput ( int fd, struct BusData *bd )
+/* read an opcode from a pooled connection, and dispatch it to the
+   direct callback for that type; then echo the opcode, to mark
+   the end of the reply */
+    {
+    struct BusDirectCallbackNode *bdcn;
+    int op;
+
+    if ( BusReadInteger ( fd, &op ) != SBUSERROR_NOT )
+        {
+        BusPooledClose ( bd, fd );       /* client has gone away */
+        return;
+        }
+
+    if ( op != BUSPOOL_PING )
+        {
+        bdcn = bd->DirectCallbacks;
+        while ( bdcn && ( bdcn->typeId != op ) )
+            bdcn = bdcn -> next;
+        if ( bdcn == NULL )
+            {
+            printf ( "BusPooledInput : no callback for type %d\n", op );
+            BusPooledClose ( bd, fd );
+            return;
+            }
+        ( bdcn->callback ) ( fd,bdcn->data );
+        }
+
+    if ( BusWriteInteger ( fd, op ) != SBUSERROR_NOT )
+        BusPooledClose ( bd, fd );
+    }
+
+static void BusDHandlePooled ( struct BusData *bd, struct BusMessage *bmsg,
+                               char *host_addr, int port )
+    {
+    int   s, on = 1;
+    unsigned char busByte;
+
+    s = busSocket_makeConnection ( host_addr, port );
+    busByte = BUSBYTE_DIRECT_CONNECT_FAIL;
+    if ( s > 0 )
+        {
+        if ( BusAddInputCallback ( bd, s, BusPooledInput, NULL, NULL ) == SBUSERROR_NOT )
+            {
+            setsockopt ( s, SOL_SOCKET, SO_KEEPALIVE, ( char * ) &on, sizeof ( on ) );
+            busByte = BUSBYTE_DIRECT_CONNECT_OK;
+            }
+        else
+            {
+            close ( s );
+            }
+        }
+    debug2 ( DEBUG_CLIENT,"BusHandlePooled : Replying %d to %d \n",
+             ( int ) busByte, bmsg->fromModule );
+    BusReplyBusByte ( bd->fd, bmsg->serial, bmsg->fromModule, bd->moduleId,
+                      BUSBYTE_REPLY_DIRECT_CONNECT, 2, ( char * ) &busByte );
+    }
+
 void BusDHandleDirect ( struct BusData *bd, struct BusMessage *bmsg )
 /* check for a callback function that can handle the
    request for a message over a point-to-point connection,
@@ -592,6 +680,12 @@ void BusDHandleDirect ( struct BusData *bd, struct BusMessage *bmsg )
     sscanf ( bmsg->message, "%d %d %s", &typeId, &port, host_addr );
     debug1 ( DEBUG_CLIENT,"BusHandleDirect : Request for type %d\n", typeId );
 
+    if ( bd->PoolServer && ( typeId == bd->PooledTypeId ) )
+        {
+        BusDHandlePooled ( bd, bmsg, host_addr, port );
+        return;
+        }
+
     bdcn = bd->DirectCallbacks;
     while ( bdcn && ( bdcn->typeId != typeId ) )
         bdcn = bdcn -> next;
@@ -747,6 +841,11 @@ void BusProcessOption ( struct BusData *bd, struct BusMessage *bmsg )
             debug0 ( DEBUG_DISP, "BusProcessOption : Got BUSBYTE_REQ_DIRECT_CONNECT.\n" );
             BusDHandleDirect ( bd, bmsg );
             break;
+        case BUSBYTE_REPLY_DIRECT_CONNECT:
+            debug0 ( DEBUG_DISP, "BusProcessOption : Got BUSBYTE_REPLY_DIRECT_CONNECT.\n" );
+            if ( !BusAsyncReply ( bd, bmsg ) )
+                debug1 ( DEBUG_DISP, "WARNING: no pending call for direct-connect reply %d\n", bmsg->serial );
+            break;
         case BUSBYTE_I_DONT_UNDERSTAND:
             debug0 ( DEBUG_DISP, "WARNING: bus byte sent to bus master wasn't understood!!!\n" );
             break;
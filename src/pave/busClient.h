@@ -85,6 +85,9 @@
  * Change author: Rajini Balay, NCSU, CSC
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  BusData fields for asynchronous calls and pooled
+ * direct connections (see busRpc.h)
  ********************************************************************/
 
 /* so that this header isn't included twice... */
@@ -158,6 +161,16 @@ struct BusData
        a list of file descriptors in use, and
        callback associated with them */
     struct BusInputCallback *InputCallbacks;
+
+    /* outstanding BusCallRemoteAsync() calls (see busRpc.h) */
+    struct BusAsyncCall *AsyncCalls;
+
+    /* pooled direct connections (see busRpc.h):  the type id used to
+       ask for one (-1 until looked up), whether this module serves them,
+       and the connections held to other modules */
+    int   PooledTypeId;
+    int   PoolServer;
+    struct BusPooledConn *ConnPool;
     };
 
 struct BusModuleData
@@ -68,9 +68,14 @@
  * Change author: Rajini Balay, NCSU, CSC
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  is_localhost() caches host-name lookups and the
+ * local address list; new is_local_ipaddr().
  ********************************************************************/
 
 #include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
 #include "busFtp.h"
 
 /* This file contains the FTP functions that a Client module can call:
@@ -280,54 +285,125 @@ int FTP_dirLocal ( char *directory, int code, char **fList )
     }
 
 /**************************************************************************
-   Routine to check if the hostname given in the variable "hname" is the
-   local hostname. It also checks for the validity of the hostname. If the
-   name is valid, it fills in the variable "ipaddr" with the IPaddress
-   of the hostname. Return values :
-   -1 : Invalid hostname (host does not exist)
-    0 : Not the local host.
-    1 : "hname" is the local host.
+   Host-name resolution cache for is_localhost() and is_local_ipaddr():
+   every remote get_info()/get_data() asks about the file's host, and
+   a resolver round-trip per call adds up quickly.  Entries expire after
+   BUSFTP_HOST_TTL seconds; failed lookups are not cached.
 ****************************************************************************/
-int is_localhost ( char *hname, char *ipaddr )
+
+#define BUSFTP_HOST_TTL     300
+#define BUSFTP_HOSTCACHE     16
+#define BUSFTP_MAXLOCAL      16
+
+struct BusHostCacheEntry
+    {
+    char   name[256];
+    char   ipaddr[32];
+    time_t when;
+    };
+
+static struct BusHostCacheEntry hostCache[BUSFTP_HOSTCACHE];
+static int    hostCacheNext = 0;
+
+static char   localAddrs[BUSFTP_MAXLOCAL][32];
+static int    nLocalAddrs   = 0;
+static time_t localAddrTime = 0;
+
+static int lookup_host ( char *hname, char *ipaddr )
+/* fills in ipaddr; returns 0, or -1 if the host does not exist */
     {
     struct hostent *h_info;
     struct in_addr *hptr;
-    char local_hname[256];
+    time_t now;
+    int i;
 
-    /* Obtain IP address of "hname" */
-    h_info = gethostbyname ( hname );
+    now = time ( NULL );
+    for ( i = 0; i < BUSFTP_HOSTCACHE; i++ )
+        {
+        if ( hostCache[i].name[0] && !strcmp ( hostCache[i].name, hname ) &&
+                ( now - hostCache[i].when < BUSFTP_HOST_TTL ) )
+            {
+            strcpy ( ipaddr, hostCache[i].ipaddr );
+            return 0;
+            }
+        }
 
+    h_info = gethostbyname ( hname );
     if ( h_info == NULL )
         {
         debug1 ( DEBUG_FTP, "is_localhost : %s does not exist \n", hname );
         return -1;
         }
-
-
-    hptr = ( struct in_addr * ) *h_info->h_addr_list;
-
-    /* Illegal hostname */
+    hptr = ( struct in_addr * ) h_info->h_addr_list[0];
     if ( hptr == NULL ) return -1;
+    sprintf ( ipaddr, "%s", inet_ntoa ( *hptr ) );
 
-    /* Fill in the variable "ipaddr" with the IPaddress of the host */
-    sprintf ( ipaddr,"%s", inet_ntoa ( *hptr ) );
+    if ( strlen ( hname ) < sizeof ( hostCache[0].name ) )
+        {
+        i = hostCacheNext;
+        hostCacheNext = ( hostCacheNext + 1 ) % BUSFTP_HOSTCACHE;
+        strcpy ( hostCache[i].name,   hname );
+        strcpy ( hostCache[i].ipaddr, ipaddr );
+        hostCache[i].when = now;
+        }
+    return 0;
+    }
 
-    /* Get IP information of local host */
-    gethostname ( local_hname, 256 );
-    h_info = gethostbyname ( local_hname );
+/**************************************************************************
+   Returns 1 if the dotted-decimal address "ipaddr" belongs to the local
+   host, else 0.
+****************************************************************************/
+int is_local_ipaddr ( char *ipaddr )
+    {
+    struct hostent *h_info;
+    char local_hname[256];
+    time_t now;
+    int i;
 
-    /* Check if the IP address of the file host matches that of the local
-       machine */
-    while ( ( hptr = ( struct in_addr * ) *h_info->h_addr_list++ ) != NULL )
+    now = time ( NULL );
+    if ( ( nLocalAddrs == 0 ) || ( now - localAddrTime >= BUSFTP_HOST_TTL ) )
         {
-        sprintf ( local_hname, "%s", inet_ntoa ( *hptr ) );
-        if ( ! strcmp ( ipaddr, local_hname ) )
+        nLocalAddrs = 0;
+        gethostname ( local_hname, 256 );
+        h_info = gethostbyname ( local_hname );
+        if ( h_info != NULL )
             {
-            return 1;    /* Match found */
+            for ( i = 0; ( i < BUSFTP_MAXLOCAL ) && h_info->h_addr_list[i]; i++ )
+                {
+                sprintf ( localAddrs[i], "%s",
+                          inet_ntoa ( * ( struct in_addr * ) h_info->h_addr_list[i] ) );
+                nLocalAddrs++;
+                }
             }
+        localAddrTime = now;
         }
-    return 0;    /* File is not on local machine */
 
+    for ( i = 0; i < nLocalAddrs; i++ )
+        {
+        if ( ! strcmp ( ipaddr, localAddrs[i] ) )
+            return 1;    /* Match found */
+        }
+    return 0;    /* Not on the local machine */
+    }
+
+/**************************************************************************
+   Routine to check if the hostname given in the variable "hname" is the
+   local hostname. It also checks for the validity of the hostname. If the
+   name is valid, it fills in the variable "ipaddr" with the IPaddress
+   of the hostname. Return values :
+   -1 : Invalid hostname (host does not exist)
+    0 : Not the local host.
+    1 : "hname" is the local host.
+****************************************************************************/
+int is_localhost ( char *hname, char *ipaddr )
+    {
+    /* Obtain IP address of "hname" */
+    if ( lookup_host ( hname, ipaddr ) < 0 )
+        return -1;      /* Illegal hostname */
+
+    /* Check if the IP address of the file host matches that of the local
+       machine */
+    return is_local_ipaddr ( ipaddr );
     }
 
 /* routine to determine if a file is accessible, or a directory,
@@ -105,6 +105,7 @@ int FTP_dirRemote ( struct BusData *bd, char *ipaddr, char *directory,
 int FTP_dirLocal ( char *directory, int code, char **fList );
 
 int is_localhost ( char *hname, char *ipaddr );
+int is_local_ipaddr ( char *ipaddr );
 int is_accessible ( char *file );
 
 #endif  /* SBUS_FTP_H_INCLUDED */
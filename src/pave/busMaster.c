@@ -720,35 +720,9 @@ void debugBusMasterData ( struct BusMasterData *bmd )
                 }
             else
                 {
-                struct BusMessageQueue *bmq;
-                int count=0;
-
-                bmq = bmn->Messages;
-                do
-                    {
-                    count ++;
-                    bmq = bmq->next;
-                    }
-                while ( bmq && bmq != bmn->Messages );
-
-                printf ( "%d message(s)", count );
+                printf ( "%d message(s) queued.\n",
+                         Bus_MessageCount ( bmn->Messages ) );
                 fflush ( stdout );
-
-                if ( bmq == NULL )
-                    {
-                    printf ( " in a grounded queue.\n" );
-                    fflush ( stdout );
-                    }
-                else if ( bmq == bmn->Messages )
-                    {
-                    printf ( " in a circular queue.\n" );
-                    fflush ( stdout );
-                    }
-                else
-                    {
-                    printf ( " in a DEAD MESS!!!\n" );
-                    fflush ( stdout );
-                    }
                 }
 
             bmn = bmn->next;
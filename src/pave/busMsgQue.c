@@ -54,6 +54,15 @@
  * Change author: Rajini Balay, NCSU, CSC
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  Queue is an intrusive doubly linked FIFO under a
+ * header with hash indices by serial and by (fromModule,messageOption),
+ * so lookups and deques are O(1) instead of a walk around the ring.
+ * Hash chains are appended at the tail, so a lookup stops at its first
+ * (oldest) match.
+ * Nodes, message buffers, and queue headers are recycled through
+ * free-lists, so steady-state enqueue/deque does no malloc.
+ * BusCopyBusMessage() now uses memcpy() (message bodies are binary).
  ********************************************************************/
 
 #include <stdio.h>
@@ -63,6 +72,18 @@
 #include "busMsgQue.h"
 #include "busDebug.h"
 
+/* Message buffers larger than this are not kept on the free-list */
+
+#define BUSQ_POOL_MAXBUF   65536
+
+/* Free-list of nodes (linked through "next"), and stack of queue headers */
+
+#define BUSQ_POOL_MAXQUEUES  32
+
+static struct BusMessageNode  *freeNodes  = NULL;
+static struct BusMessageQueue *freeQueues[ BUSQ_POOL_MAXQUEUES ];
+static int                     nFreeQueues = 0;
+
 void debugShowMessage ( struct BusMessage *bmsg )
     {
     printf ( "Seq: %d To: %d From: %d Option: %x Type: %d Len: %d",
@@ -93,151 +114,299 @@ void BusCopyBusMessage ( struct BusMessage *dst,
         {
         dst->message = ( char * ) malloc ( dst->messageLength );
 
-        strncpy ( dst->message, src->message, dst->messageLength );
+        memcpy ( dst->message, src->message, dst->messageLength );
+        }
+    else
+        {
+        dst->message = NULL;
         }
     }
 
-struct BusMessage *
-BusGetFirstMessage ( struct BusMessageQueue *last )
+/* ---------------------  hash-index helpers  --------------------- */
+
+static int seqHash ( int seq )
     {
-    if ( last )
-        {
-        if ( last->next )
-            {
-            debug0 ( DEBUG_QUEUE, "Get First: " );
-            fflush ( stdout );
-            if ( DEBUG_QUEUE ) debugShowMessage ( & ( last->next->data ) );
+    return ( ( unsigned ) seq ) & ( BUSQ_HASH_SIZE - 1 );
+    }
 
-            return & ( last->next->data );
-            }
-        else
-            {
-            debug0 ( DEBUG_QUEUE, "Get First: " );
-            fflush ( stdout );
-            if ( DEBUG_QUEUE ) debugShowMessage ( & ( last->data ) );
+static int optionHash ( int moduleId, unsigned char option )
+    {
+    return ( ( ( unsigned ) moduleId ) * 31u + option ) & ( BUSQ_HASH_SIZE - 1 );
+    }
 
-            return & ( last->data );
-            }
+/* ---------------------  pool management  ------------------------ */
+
+static struct BusMessageQueue *newQueue ( void )
+    {
+    struct BusMessageQueue *q;
+
+    if ( nFreeQueues > 0 )
+        {
+        /* all hash buckets of a released queue are already empty */
+        q = freeQueues[ --nFreeQueues ];
         }
     else
-        return NULL;
+        {
+        q = ( struct BusMessageQueue * ) calloc ( 1, sizeof ( struct BusMessageQueue ) );
+        }
+    return q;
     }
 
-int Bus_MessagesLeft ( struct BusMessageQueue *last )
+static void releaseQueue ( struct BusMessageQueue *q )
     {
-    return last!=NULL;
+    if ( nFreeQueues < BUSQ_POOL_MAXQUEUES )
+        freeQueues[ nFreeQueues++ ] = q;
+    else
+        free ( q );
     }
 
-struct BusMessageQueue *
-Bus_DequeMessage ( struct BusMessageQueue *last )
+/* Get a node whose buffer holds at least "len" bytes */
+
+static struct BusMessageNode *newNode ( int len )
     {
-    if ( last )
+    struct BusMessageNode *n;
+
+    if ( freeNodes )
+        {
+        n = freeNodes;
+        freeNodes = n->next;
+        }
+    else
         {
-        if ( ( last->next != NULL ) && ( last->next != last ) )
+        n = ( struct BusMessageNode * ) malloc ( sizeof ( struct BusMessageNode ) );
+        if ( n == NULL )
+            return NULL;
+        n->capacity     = 0;
+        n->data.message = NULL;
+        }
+
+    if ( len > n->capacity )
+        {
+        char *buf = ( char * ) realloc ( n->data.message, len );
+        if ( buf == NULL )
             {
-            struct BusMessageQueue *tmp;
+            n->next   = freeNodes;
+            freeNodes = n;
+            return NULL;
+            }
+        n->data.message = buf;
+        n->capacity     = len;
+        }
+    return n;
+    }
 
-            debug0 ( DEBUG_QUEUE, "Dequing message: " );
-            fflush ( stdout );
-            if ( DEBUG_QUEUE ) debugShowMessage ( & ( last->data ) );
+static void releaseNode ( struct BusMessageNode *n )
+    {
+    if ( n->capacity > BUSQ_POOL_MAXBUF )
+        {
+        free ( n->data.message );
+        n->data.message = NULL;
+        n->capacity     = 0;
+        }
+    n->next   = freeNodes;
+    freeNodes = n;
+    }
 
-            tmp = last->next;
-            last->next = tmp->next;
+/* ---------------------  link / unlink  -------------------------- */
 
-            /* Check if the message length is > 0 and then free the message
-               Modified by Rajini after version 6.3 */
-            if ( tmp->data.messageLength > 0 )
-                free ( tmp->data.message );
-            free ( tmp );
+static void linkNode ( struct BusMessageQueue *q, struct BusMessageNode *n )
+    {
+    int h;
 
-            return last;
-            }
-        else
+    n->next = NULL;
+    n->prev = q->last;
+    if ( q->last )
+        q->last->next = n;
+    else
+        q->first = n;
+    q->last = n;
+    q->count++;
+
+    /* append at the tail of each hash chain, to keep it oldest-first */
+
+    h = seqHash ( n->data.serial );
+    if ( q->seqTail[ h ] == NULL )
+        q->seqTail[ h ] = & ( q->bySeq[ h ] );
+    n->seqNext  = NULL;
+    n->seqPrevp = q->seqTail[ h ];
+    *( q->seqTail[ h ] ) = n;
+    q->seqTail[ h ] = & ( n->seqNext );
+
+    h = optionHash ( n->data.fromModule, n->data.messageOption );
+    if ( q->optTail[ h ] == NULL )
+        q->optTail[ h ] = & ( q->byOption[ h ] );
+    n->optNext  = NULL;
+    n->optPrevp = q->optTail[ h ];
+    *( q->optTail[ h ] ) = n;
+    q->optTail[ h ] = & ( n->optNext );
+    }
+
+/* Remove node "n" from queue "q" and recycle it;
+   returns "q", or NULL if "q" is now empty (and recycled too) */
+
+static struct BusMessageQueue *unlinkNode ( struct BusMessageQueue *q,
+                                            struct BusMessageNode  *n )
+    {
+    if ( DEBUG_QUEUE ) debugShowMessage ( & ( n->data ) );
+
+    if ( n->prev )
+        n->prev->next = n->next;
+    else
+        q->first = n->next;
+    if ( n->next )
+        n->next->prev = n->prev;
+    else
+        q->last = n->prev;
+    q->count--;
+
+    *( n->seqPrevp ) = n->seqNext;
+    if ( n->seqNext )
+        n->seqNext->seqPrevp = n->seqPrevp;
+    else
+        q->seqTail[ seqHash ( n->data.serial ) ] = n->seqPrevp;
+
+    *( n->optPrevp ) = n->optNext;
+    if ( n->optNext )
+        n->optNext->optPrevp = n->optPrevp;
+    else
+        q->optTail[ optionHash ( n->data.fromModule,
+                                 n->data.messageOption ) ] = n->optPrevp;
+
+    releaseNode ( n );
+
+    if ( q->first == NULL )
+        {
+        releaseQueue ( q );
+        return NULL;
+        }
+    return q;
+    }
+
+/* Chains are oldest-first, so the first match found is the oldest */
+
+static struct BusMessageNode *findBySeq ( struct BusMessageQueue *q,
+                                          int seq, int moduleId, int useModule )
+    {
+    struct BusMessageNode *n;
+
+    for ( n = q->bySeq[ seqHash ( seq ) ]; n; n = n->seqNext )
+        {
+        if ( ( n->data.serial == seq ) &&
+                ( !useModule || ( n->data.fromModule == moduleId ) ) )
             {
-            debug0 ( DEBUG_QUEUE, "Dequing only message: " );
-            fflush ( stdout );
-            if ( DEBUG_QUEUE ) debugShowMessage ( & ( last->data ) );
+            debug0 ( DEBUG_QUEUE, "Found matching entry in queue \n" );
+            return n;
+            }
+        }
+    return NULL;
+    }
 
-            /* Check if the message length is > 0 and then free the message
-               Modified by Rajini after version 6.3 */
-            if ( last->data.messageLength > 0 )
-                free ( last->data.message );
-            free ( last );
+static struct BusMessageNode *findByOption ( struct BusMessageQueue *q,
+                                             int moduleId, unsigned char option )
+    {
+    struct BusMessageNode *n;
 
-            return NULL;
+    for ( n = q->byOption[ optionHash ( moduleId, option ) ]; n; n = n->optNext )
+        {
+        if ( ( n->data.fromModule == moduleId ) &&
+                ( n->data.messageOption == option ) )
+            {
+            debug0 ( DEBUG_QUEUE, "Found corresponding node in Queue \n" );
+            return n;
             }
         }
+    return NULL;
+    }
+
+/* ---------------------  public interface  ----------------------- */
+
+struct BusMessage *
+BusGetFirstMessage ( struct BusMessageQueue *last )
+    {
+    if ( last && last->first )
+        {
+        debug0 ( DEBUG_QUEUE, "Get First: " );
+        fflush ( stdout );
+        if ( DEBUG_QUEUE ) debugShowMessage ( & ( last->first->data ) );
+
+        return & ( last->first->data );
+        }
     else
         return NULL;
     }
 
+int Bus_MessagesLeft ( struct BusMessageQueue *last )
+    {
+    return last!=NULL;
+    }
+
+int Bus_MessageCount ( struct BusMessageQueue *last )
+    {
+    return last ? last->count : 0;
+    }
+
 struct BusMessageQueue *
-Bus_EnqueMessage ( struct BusMessageQueue *last,
-                   struct BusMessage *bmsg )
+Bus_DequeMessage ( struct BusMessageQueue *last )
     {
-    struct BusMessageQueue *tmp;
-    if ( last )
+    if ( last && last->first )
         {
-        tmp = ( struct BusMessageQueue * )
-              malloc ( sizeof ( struct BusMessageQueue ) );
-        if ( tmp == NULL )
-            return NULL;
-        BusCopyBusMessage ( & ( tmp->data ), bmsg );
-        tmp->next = last->next;
-        last->next = tmp;
+        debug0 ( DEBUG_QUEUE, "Dequing message: " );
+        fflush ( stdout );
+        return unlinkNode ( last, last->first );
         }
     else
+        return NULL;
+    }
+
+struct BusMessageQueue *
+Bus_EnqueMessage ( struct BusMessageQueue *last,
+                   struct BusMessage *bmsg )
+    {
+    struct BusMessageQueue *q;
+    struct BusMessageNode  *tmp;
+    int                     len;
+
+    len = ( bmsg->messageLength > 0 ) ? bmsg->messageLength : 0;
+    tmp = newNode ( len );
+    if ( tmp == NULL )
+        return NULL;
+
+    q = last ? last : newQueue();
+    if ( q == NULL )
         {
-        tmp = ( struct BusMessageQueue * )
-              malloc ( sizeof ( struct BusMessageQueue ) );
-        if ( tmp == NULL )
-            return NULL;
-        BusCopyBusMessage ( & ( tmp->data ), bmsg );
-        tmp->next = tmp;
+        releaseNode ( tmp );
+        return NULL;
         }
 
+    tmp->data.toModule      = bmsg->toModule;
+    tmp->data.fromModule    = bmsg->fromModule;
+    tmp->data.serial        = bmsg->serial;
+    tmp->data.messageOption = bmsg->messageOption;
+    tmp->data.messageType   = bmsg->messageType;
+    tmp->data.messageLength = bmsg->messageLength;
+    if ( len > 0 )
+        memcpy ( tmp->data.message, bmsg->message, len );
+
+    linkNode ( q, tmp );
+
     debug0 ( DEBUG_QUEUE, "Enqued Message : " );
     if ( DEBUG_QUEUE )
         debugShowMessage ( & ( tmp->data ) );
 
-    return tmp;
+    return q;
     }
 
 struct BusMessage *
 BusGetMessageByModuleOption ( struct BusMessageQueue *last, int moduleId,
                               unsigned char option )
     {
-
-    struct BusMessageQueue *tmpNode;
-    int found = 0;
+    struct BusMessageNode *tmpNode;
 
     debug2 ( DEBUG_QUEUE, "BusGetMessageByModuleOption : module = %d option = %x \n", moduleId, option );
     if ( last )
         {
-        tmpNode = last;
-        do
-            {
-            if ( DEBUG_QUEUE )
-                debugShowMessage ( & ( tmpNode->data ) );
-            if ( ( tmpNode->data.fromModule == moduleId ) &&
-                    ( tmpNode->data.messageOption == option ) )
-                {
-                found = 1;
-                }
-            else
-                {
-                tmpNode = tmpNode->next;
-                }
-            }
-        while ( ( tmpNode != last ) && ( !found ) );
-        if ( found )
-            {
-            return ( & ( tmpNode->data ) );
-            }
-        else
-            {
-            return NULL;
-            }
+        tmpNode = findByOption ( last, moduleId, option );
+        return tmpNode ? & ( tmpNode->data ) : NULL;
         }
     else
         {
@@ -248,37 +417,30 @@ BusGetMessageByModuleOption ( struct BusMessageQueue *last, int moduleId,
 struct BusMessage *
 BusGetMessageBySeq ( struct BusMessageQueue *last, int seq )
     {
-
-    struct BusMessageQueue *tmpNode;
-    int found = 0;
+    struct BusMessageNode *tmpNode;
 
     debug1 ( DEBUG_QUEUE, "BusGetMessageBySeq : seq = %d \n", seq );
     if ( last )
         {
-        tmpNode = last;
-        do
-            {
-            if ( DEBUG_QUEUE )
-                debugShowMessage ( & ( tmpNode->data ) );
-            if ( tmpNode->data.serial == seq )
-                {
-                found = 1;
-                debug0 ( DEBUG_QUEUE, "Found matching entry in queue \n" );
-                }
-            else
-                {
-                tmpNode = tmpNode->next;
-                }
-            }
-        while ( ( tmpNode != last ) && ( !found ) );
-        if ( found )
-            {
-            return ( & ( tmpNode->data ) );
-            }
-        else
-            {
-            return NULL;
-            }
+        tmpNode = findBySeq ( last, seq, 0, 0 );
+        return tmpNode ? & ( tmpNode->data ) : NULL;
+        }
+    else
+        {
+        return NULL;
+        }
+    }
+
+struct BusMessage *
+BusGetMessageByModuleSeq ( struct BusMessageQueue *last, int moduleId, int seq )
+    {
+    struct BusMessageNode *tmpNode;
+
+    debug2 ( DEBUG_QUEUE, "BusGetMessageByModuleSeq : module = %d seq = %d \n", moduleId, seq );
+    if ( last )
+        {
+        tmpNode = findBySeq ( last, seq, moduleId, 1 );
+        return tmpNode ? & ( tmpNode->data ) : NULL;
         }
     else
         {
@@ -290,65 +452,13 @@ struct BusMessageQueue *
 Bus_DequeMessageByModuleOption ( struct BusMessageQueue *last, int moduleId,
                                  unsigned char option )
     {
-    struct BusMessageQueue *prevNode, *tmpNode;
-    int found = 0;
+    struct BusMessageNode *tmpNode;
 
     debug2 ( DEBUG_QUEUE, "Bus_DequeMessageByModuleOption : module = %d option = %x \n", moduleId, option );
     if ( last )
         {
-        prevNode = tmpNode = last;
-        do
-            {
-            if ( DEBUG_QUEUE )
-                debugShowMessage ( & ( tmpNode->data ) );
-            if ( ( tmpNode->data.fromModule == moduleId ) &&
-                    ( tmpNode->data.messageOption == option ) )
-                {
-                found = 1;
-                debug0 ( DEBUG_QUEUE, "Found corresponding node in Queue \n" );
-                }
-            else
-                {
-                prevNode = tmpNode;
-                tmpNode = tmpNode->next;
-                }
-            }
-        while ( ( tmpNode != last ) && ( !found ) );
-        if ( found )
-            {
-            if ( prevNode->next == prevNode )
-                {
-                if ( tmpNode->data.messageLength > 0 )
-                    free ( tmpNode->data.message );
-                free ( tmpNode );
-                return NULL;
-                }
-            else
-                {
-                if ( prevNode == tmpNode )
-                    {
-                    struct BusMessageQueue *lastNode;
-
-                    lastNode = tmpNode->next;
-                    while ( lastNode->next != tmpNode )
-                        lastNode = lastNode->next;
-                    lastNode->next = tmpNode->next;
-                    return lastNode;
-                    }
-                else
-                    {
-                    prevNode->next = tmpNode->next;
-                    if ( tmpNode->data.messageLength > 0 )
-                        free ( tmpNode->data.message );
-                    free ( tmpNode );
-                    return last;
-                    }
-                }
-            }
-        else
-            {
-            return last;
-            }
+        tmpNode = findByOption ( last, moduleId, option );
+        return tmpNode ? unlinkNode ( last, tmpNode ) : last;
         }
     else
         {
@@ -359,64 +469,13 @@ Bus_DequeMessageByModuleOption ( struct BusMessageQueue *last, int moduleId,
 struct BusMessageQueue *
 Bus_DequeMessageBySeq ( struct BusMessageQueue *last, int seq )
     {
-    struct BusMessageQueue *prevNode, *tmpNode;
-    int found = 0;
+    struct BusMessageNode *tmpNode;
 
     debug1 ( DEBUG_QUEUE, "Bus_DequeMessageBySeq : seq = %d \n", seq );
     if ( last )
         {
-        prevNode = tmpNode = last;
-        do
-            {
-            if ( DEBUG_QUEUE )
-                debugShowMessage ( & ( tmpNode->data ) );
-            if ( tmpNode->data.serial == seq )
-                {
-                found = 1;
-                debug0 ( DEBUG_QUEUE, "Found matching entry in queue \n" );
-                }
-            else
-                {
-                prevNode = tmpNode;
-                tmpNode = tmpNode->next;
-                }
-            }
-        while ( ( tmpNode != last ) && ( !found ) );
-        if ( found )
-            {
-            if ( prevNode->next == prevNode )
-                {
-                if ( tmpNode->data.messageLength > 0 )
-                    free ( tmpNode->data.message );
-                free ( tmpNode );
-                return NULL;
-                }
-            else
-                {
-                if ( prevNode == tmpNode )
-                    {
-                    struct BusMessageQueue *lastNode;
-
-                    lastNode = tmpNode->next;
-                    while ( lastNode->next != tmpNode )
-                        lastNode = lastNode->next;
-                    lastNode->next = tmpNode->next;
-                    return lastNode;
-                    }
-                else
-                    {
-                    prevNode->next = tmpNode->next;
-                    if ( tmpNode->data.messageLength > 0 )
-                        free ( tmpNode->data.message );
-                    free ( tmpNode );
-                    return last;
-                    }
-                }
-            }
-        else
-            {
-            return last;
-            }
+        tmpNode = findBySeq ( last, seq, 0, 0 );
+        return tmpNode ? unlinkNode ( last, tmpNode ) : last;
         }
     else
         {
@@ -427,65 +486,13 @@ Bus_DequeMessageBySeq ( struct BusMessageQueue *last, int seq )
 struct BusMessageQueue *
 Bus_DequeMessageByModuleSeq ( struct BusMessageQueue *last, int moduleId, int seq )
     {
-    struct BusMessageQueue *prevNode, *tmpNode;
-    int found = 0;
+    struct BusMessageNode *tmpNode;
 
     debug2 ( DEBUG_QUEUE, "Bus_DequeMessageByModuleSeq : module = %d seq = %d \n", moduleId, seq );
     if ( last )
         {
-        prevNode = tmpNode = last;
-        do
-            {
-            if ( DEBUG_QUEUE )
-                debugShowMessage ( & ( tmpNode->data ) );
-            if ( ( tmpNode->data.serial == seq ) &&
-                    ( tmpNode->data.fromModule == moduleId ) )
-                {
-                found = 1;
-                debug0 ( DEBUG_QUEUE, "Found matching entry in queue \n" );
-                }
-            else
-                {
-                prevNode = tmpNode;
-                tmpNode = tmpNode->next;
-                }
-            }
-        while ( ( tmpNode != last ) && ( !found ) );
-        if ( found )
-            {
-            if ( prevNode->next == prevNode )
-                {
-                if ( tmpNode->data.messageLength > 0 )
-                    free ( tmpNode->data.message );
-                free ( tmpNode );
-                return NULL;
-                }
-            else
-                {
-                if ( prevNode == tmpNode )
-                    {
-                    struct BusMessageQueue *lastNode;
-
-                    lastNode = tmpNode->next;
-                    while ( lastNode->next != tmpNode )
-                        lastNode = lastNode->next;
-                    lastNode->next = tmpNode->next;
-                    return lastNode;
-                    }
-                else
-                    {
-                    prevNode->next = tmpNode->next;
-                    if ( tmpNode->data.messageLength > 0 )
-                        free ( tmpNode->data.message );
-                    free ( tmpNode );
-                    return last;
-                    }
-                }
-            }
-        else
-            {
-            return last;
-            }
+        tmpNode = findBySeq ( last, seq, moduleId, 1 );
+        return tmpNode ? unlinkNode ( last, tmpNode ) : last;
         }
     else
         {
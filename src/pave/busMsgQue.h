@@ -57,6 +57,10 @@
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
  *
+ * Version 10/2026:  BusMessageQueue is now a queue header with hash
+ * indices by serial and by (module,option); nodes are pooled.
+ * Hash chains are oldest-first, with tail links.
+ *
  ********************************************************************/
 
 /* so that this header isn't included twice... */
@@ -118,52 +122,90 @@ struct BusMessage
    sender (could be used to find the current module bus id) */
 
 
-/* BusMessageQueue structure is intended to be a node in a
-   circular singly linked list (used as a queue) */
-struct BusMessageQueue
+/* BusMessageNode is one queued message.  Nodes form a doubly linked
+   FIFO, and are also threaded onto two hash chains of the owning
+   queue:  one keyed by serial number, one keyed by (fromModule,
+   messageOption).  The "...Prevp" members point at whichever link
+   points at this node, so that unlinking is O(1).  Each chain is
+   oldest-first, like the FIFO, so that a lookup stops at the first
+   match.
+   Nodes and their message buffers are recycled through a free-list
+   in busMsgQue.c, so that steady-state enqueue/dequeue does no malloc. */
+struct BusMessageNode
     {
-    struct BusMessageQueue *next;
+    struct BusMessageNode  *next;
+    struct BusMessageNode  *prev;
+
+    struct BusMessageNode  *seqNext;
+    struct BusMessageNode **seqPrevp;
+
+    struct BusMessageNode  *optNext;
+    struct BusMessageNode **optPrevp;
+
+    int                     capacity;   /* allocated size of data.message */
 
     struct BusMessage       data;
     };
 
+#define BUSQ_HASH_SIZE   128    /* must be a power of 2 */
+
+/* BusMessageQueue is the queue header:  FIFO ends, count, and the two
+   hash indices.  A NULL (struct BusMessageQueue *) is the empty queue;
+   the functions below return NULL when the last message is removed,
+   and a (possibly new) queue pointer otherwise.  */
+struct BusMessageQueue
+    {
+    struct BusMessageNode  *first;
+    struct BusMessageNode  *last;
+    int                     count;
+
+    struct BusMessageNode  *bySeq   [ BUSQ_HASH_SIZE ];
+    struct BusMessageNode  *byOption[ BUSQ_HASH_SIZE ];
+
+    /* the last link of each chain (NULL:  the chain's head) */
+    struct BusMessageNode **seqTail [ BUSQ_HASH_SIZE ];
+    struct BusMessageNode **optTail [ BUSQ_HASH_SIZE ];
+    };
+
 struct BusMessage *
 BusGetFirstMessage ( struct BusMessageQueue *last );
 /* returns a pointer to the first BusMessage in the queue,
    this pointer should not be freed - the memory it
    points to is allocated and deallocated by
    Bus_EnqueMessage and Bus_DequeMessage
-   last - in - pointer to the last node in a circular list of
-   BusMessageQueue Nodes
+   last - in - pointer to the queue
    returns a pointer to a BusMessage structure that is part
-   of a BusMessageQueue Node */
+   of a BusMessageNode */
 
 int Bus_MessagesLeft ( struct BusMessageQueue *last );
 /* returns true(1) if their is a message in the queue,
    0 otherwise */
 
+int Bus_MessageCount ( struct BusMessageQueue *last );
+/* returns the number of messages in the queue */
+
 struct BusMessageQueue *
 Bus_DequeMessage ( struct BusMessageQueue *last );
 /* removes the first item from the queue,
-   last - in - pointer to the last node in a circular linked
-   list of BusMessageQueue Nodes
-   returns a pointer to the last node in the "new" list
+   last - in - pointer to the queue
+   returns a pointer to the queue
    (which may be NULL for an empty list)
    */
 
 struct BusMessageQueue *
 Bus_EnqueMessage ( struct BusMessageQueue *last,
                    struct BusMessage *bmsg );
-/* adds a message to the queue,
-   last - in - pointer to the last node in a circular linked
-   list of BusMessageQueue Nodes
+/* adds a (copy of a) message to the end of the queue,
+   last - in - pointer to the queue (NULL for an empty queue)
    bm   - in - a BusMessage structure containing the message
    to be added to the queue
-   returns a pointer to the last node in a circular linked
-   list of BusMessageQueue Nodes
+   returns a pointer to the queue
    or NULL if an error occurs
    */
 
+void BusCopyBusMessage ( struct BusMessage *dst, struct BusMessage *src );
+/* copies src, and its body, into dst */
+
 struct BusMessage *
 BusGetMessageByModuleOption ( struct BusMessageQueue *last, int moduleId,
                               unsigned char option );
@@ -178,7 +220,14 @@ BusGetMessageBySeq ( struct BusMessageQueue *last, int seq );
 struct BusMessageQueue *
 Bus_DequeMessageBySeq ( struct BusMessageQueue *last, int seq );
 
+struct BusMessage *
+BusGetMessageByModuleSeq ( struct BusMessageQueue *last, int moduleId, int seq );
+
 struct BusMessageQueue *
 Bus_DequeMessageByModuleSeq ( struct BusMessageQueue *last, int moduleId, int seq );
 
+/* The ...ByModuleOption and ...BySeq lookups use the hash indices;
+   when several queued messages match, the oldest one is used.
+   The Deque... versions return the queue, or NULL if it is now empty. */
+
 #endif
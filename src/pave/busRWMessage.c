@@ -86,6 +86,9 @@
  * Change author: Balay, R.
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  BusGetResponse() passes the direct-connect replies it
+ * saved for outstanding asynchronous calls on to BusAsyncClaimQueued().
  ********************************************************************/
 
 #include <stdio.h>
@@ -96,6 +99,7 @@
 #include "busSocket.h"
 #include "busRW.h"
 #include "busRepReq.h"
+#include "busRpc.h"
 #include "busError.h"
 #include "busDebug.h"
 
@@ -301,6 +305,12 @@ int  BusGetResponse ( struct BusData *bd, int seq, unsigned char busByte, char *
         }
     if ( ! err )
         *result = bmsg.message;
+
+    /* anything read on the way may include replies that outstanding
+       asynchronous calls are waiting for */
+
+    if ( bd->AsyncCalls && bd->RecvdMessages )
+        BusAsyncClaimQueued ( bd );
     return err;
     }
 
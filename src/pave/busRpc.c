@@ -40,16 +40,34 @@
  * Change author: Rajini Balay, NCSU, CSC
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  BusCallRemoteAsync() and friends, for issuing many
+ * remote calls at once and collecting the results as they arrive.
+ *
+ * Version 10/2026:  BusCallRemotePooled() and the connection pool;
+ * asynchronous calls use pooled connections too.
+ *
+ * Version 10/2026:  asynchronous results are read on a worker thread
+ * for Xt clients (BusAsyncReceiveBackground()).
+ *
+ * Version 10/2026:  BusAsyncClaimQueued():  direct-connect replies that
+ * BusGetResponse() saved on bd->RecvdMessages no longer go astray.
  ********************************************************************/
 
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
 #include <malloc.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/select.h>
 #include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "bus.h"
@@ -132,3 +150,677 @@ int BusCallRemote ( struct BusData *bd, int toModule, int typeId,
         }
     }
 
+
+/* ---------------------  pooled connections  --------------------- */
+
+static int poolTypeId ( struct BusData *bd )
+    {
+    if ( bd->PooledTypeId < 0 )
+        bd->PooledTypeId = BusFindTypeByName ( bd, BUSPOOL_TYPENAME );
+    return bd->PooledTypeId;
+    }
+
+static int poolSendOp ( int fd, int op )
+/* MSG_NOSIGNAL:  a connection the other end has dropped gives
+   an error here rather than a SIGPIPE */
+    {
+    int netop;
+
+    netop = htonl ( op );
+    return send ( fd, ( char * ) &netop, 4, MSG_NOSIGNAL ) == 4;
+    }
+
+static int poolAlive ( int fd, int idle )
+/* An idle connection should have nothing to read:  if it is readable,
+   the other end has closed it (or it is out of step).  One that has been
+   idle for a while is pinged, too, in case the remote host went away;
+   this runs on the caller's (perhaps the Xt) thread, so a slow answer
+   counts as none. */
+    {
+    struct pollfd pfd;
+    int op;
+
+    pfd.fd      = fd;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+    if ( poll ( &pfd, 1, 0 ) != 0 )
+        return 0;
+    if ( idle < BUSPOOL_CHECK_SECS )
+        return 1;
+
+    if ( !poolSendOp ( fd, BUSPOOL_PING ) )
+        return 0;
+    if ( poll ( &pfd, 1, BUSPOOL_PING_MSECS ) != 1 )
+        return 0;
+    if ( BusReadInteger ( fd, &op ) != SBUSERROR_NOT )
+        return 0;
+    return op == BUSPOOL_PING;
+    }
+
+static void poolUnlink ( struct BusData *bd, struct BusPooledConn *conn )
+    {
+    struct BusPooledConn **pp;
+
+    for ( pp = & ( bd->ConnPool ); *pp; pp = & ( ( *pp )->next ) )
+        {
+        if ( *pp == conn )
+            {
+            *pp = conn->next;
+            break;
+            }
+        }
+    if ( conn->fd >= 0 )
+        {
+        shutdown ( conn->fd,2 );
+        close ( conn->fd );
+        }
+    free ( conn );
+    }
+
+static struct BusPooledConn *poolAdd ( struct BusData *bd, int toModule, int fd )
+    {
+    struct BusPooledConn *conn;
+    int on = 1;
+
+    conn = ( struct BusPooledConn * ) calloc ( 1, sizeof ( struct BusPooledConn ) );
+    if ( conn == NULL )
+        {
+        if ( fd >= 0 )
+            close ( fd );
+        return NULL;
+        }
+    if ( fd >= 0 )
+        setsockopt ( fd, SOL_SOCKET, SO_KEEPALIVE, ( char * ) &on, sizeof ( on ) );
+    conn->toModule = toModule;
+    conn->fd       = fd;
+    conn->busy     = ( fd >= 0 );
+    conn->lastUsed = time ( NULL );
+    conn->next     = bd->ConnPool;
+    bd->ConnPool   = conn;
+    return conn;
+    }
+
+static int poolRefused ( struct BusData *bd, int toModule )
+/* has toModule refused a pooled connection?  (module ids may be re-used,
+   so the answer is only remembered for BUSPOOL_IDLE_SECS) */
+    {
+    struct BusPooledConn *conn;
+
+    for ( conn = bd->ConnPool; conn; conn = conn->next )
+        {
+        if ( ( conn->toModule == toModule ) && ( conn->fd < 0 ) )
+            {
+            if ( time ( NULL ) - conn->lastUsed <= BUSPOOL_IDLE_SECS )
+                return 1;
+            poolUnlink ( bd, conn );
+            return 0;
+            }
+        }
+    return 0;
+    }
+
+static struct BusPooledConn *poolGet ( struct BusData *bd, int toModule )
+/* returns an idle, healthy connection to toModule, marked busy, or NULL */
+    {
+    struct BusPooledConn *conn, *next;
+    time_t now;
+
+    now = time ( NULL );
+    for ( conn = bd->ConnPool; conn; conn = next )
+        {
+        next = conn->next;
+        if ( conn->busy || ( conn->fd < 0 ) || ( conn->toModule != toModule ) )
+            continue;
+        if ( ( now - conn->lastUsed > BUSPOOL_IDLE_SECS ) ||
+                !poolAlive ( conn->fd, ( int ) ( now - conn->lastUsed ) ) )
+            {
+            debug2 ( DEBUG_CLIENT,"BusPool : dropping connection %d to module %d\n",
+                     conn->fd, toModule );
+            poolUnlink ( bd, conn );
+            continue;
+            }
+        conn->busy = 1;
+        return conn;
+        }
+    return NULL;
+    }
+
+static struct BusPooledConn *poolOpen ( struct BusData *bd, int toModule )
+/* asks toModule for a new pooled connection; on refusal, remembers
+   that toModule does not do pooling */
+    {
+    int portSock, s, portNumber, reqSeq;
+    struct sockaddr_in sin;
+    char tmp_msg[512];
+    char *res;
+
+    if ( poolTypeId ( bd ) < 0 )
+        return NULL;
+
+    portNumber = 0;
+    portSock = busSocket_createAcceptorSocket ( &portNumber );
+    if ( portSock < 0 )
+        return NULL;
+
+    sprintf ( tmp_msg,"%d %d", portNumber, bd->PooledTypeId );
+    reqSeq = BusSendBusByte ( bd, toModule,
+                              BUSBYTE_REQ_DIRECT_CONNECT, strlen ( tmp_msg )+1, tmp_msg );
+    if ( ( reqSeq == SBUSERROR_MASTER_ABSENT ) ||
+            ( BusGetResponse ( bd, reqSeq, BUSBYTE_REPLY_DIRECT_CONNECT, &res ) != SBUSERROR_NOT ) )
+        {
+        close ( portSock );
+        return NULL;
+        }
+
+    if ( res[0] != BUSBYTE_DIRECT_CONNECT_OK )
+        {
+        debug1 ( DEBUG_CLIENT,"BusPool : module %d refused a pooled connection\n", toModule );
+        free ( res );
+        close ( portSock );
+        poolAdd ( bd, toModule, -1 );
+        return NULL;
+        }
+    free ( res );
+
+    s = busSocket_acceptConnection ( portSock, &sin );
+    close ( portSock );
+    if ( s < 0 )
+        {
+        perror ( "Call Remote Pooled - accept failed" );
+        return NULL;
+        }
+    debug2 ( DEBUG_CLIENT,"BusPool : new connection %d to module %d\n", s, toModule );
+    return poolAdd ( bd, toModule, s );
+    }
+
+void BusPoolRelease ( struct BusData *bd, struct BusPooledConn *conn, int ok )
+    {
+    struct BusPooledConn *c;
+    int idle;
+
+    if ( !ok )
+        {
+        poolUnlink ( bd, conn );
+        return;
+        }
+
+    idle = 0;
+    for ( c = bd->ConnPool; c; c = c->next )
+        {
+        if ( ( c->toModule == conn->toModule ) && ( c->fd >= 0 ) && !c->busy )
+            idle++;
+        }
+    if ( idle >= BUSPOOL_MAXIDLE )
+        {
+        poolUnlink ( bd, conn );
+        return;
+        }
+    conn->busy     = 0;
+    conn->lastUsed = time ( NULL );
+    }
+
+void BusPoolClose ( struct BusData *bd )
+    {
+    while ( bd->ConnPool )
+        poolUnlink ( bd, bd->ConnPool );
+    }
+
+static int poolRequest ( struct BusPooledConn *conn, int typeId,
+                         void ( *stub ) ( int, char *, char * ), char *args, char *res )
+/* returns 1 if the call was made and the connection is still in step,
+   0 if the request could not be sent (so that it may be retried), and
+   -1 if the call was made but the connection is no longer usable */
+    {
+    int op;
+
+    if ( !poolSendOp ( conn->fd, typeId ) )
+        return 0;
+    stub ( conn->fd, args, res );
+    if ( ( BusReadInteger ( conn->fd, &op ) != SBUSERROR_NOT ) || ( op != typeId ) )
+        return -1;
+    return 1;
+    }
+
+int BusCallRemotePooled ( struct BusData *bd, int toModule, int typeId,
+                          void ( *stub ) ( int, char *, char * ), char *params, char *results )
+/* As BusCallRemote(), over a pooled connection when toModule allows */
+    {
+    struct BusPooledConn *conn;
+    int tries, err;
+
+    for ( tries = 0; tries < 2; tries++ )
+        {
+        if ( poolRefused ( bd, toModule ) )
+            break;
+        conn = poolGet ( bd, toModule );
+        if ( conn == NULL )
+            conn = poolOpen ( bd, toModule );
+        if ( conn == NULL )
+            break;
+
+        err = poolRequest ( conn, typeId, stub, params, results );
+        BusPoolRelease ( bd, conn, err > 0 );
+        if ( err > 0 )
+            return SBUSERROR_NOT;
+        if ( err < 0 )
+            {
+            debug1 ( DEBUG_CLIENT,"BusCallRemotePooled : connection to module %d lost during a call\n", toModule );
+            return SBUSERROR_READ;
+            }
+        debug1 ( DEBUG_CLIENT,"BusCallRemotePooled : stale connection to module %d\n", toModule );
+        }
+
+    return BusCallRemote ( bd, toModule, typeId, stub, params, results );
+    }
+
+
+
+/* ---------------------  asynchronous calls  --------------------- */
+
+static void asyncFinish ( struct BusAsyncCall *call, int err )
+/* unlink a call from its BusData, close its sockets, and call done() */
+    {
+    struct BusAsyncCall **pp;
+
+    for ( pp = & ( call->bd->AsyncCalls ); *pp; pp = & ( ( *pp )->next ) )
+        {
+        if ( *pp == call )
+            {
+            *pp = call->next;
+            break;
+            }
+        }
+    call->next = NULL;
+
+    BusXtUnwatchRemote ( call );
+    if ( call->conn )
+        {
+        BusPoolRelease ( call->bd, call->conn, ( err == SBUSERROR_NOT ) && call->connOk );
+        call->conn = NULL;
+        call->fd   = -1;
+        }
+    if ( call->portSock >= 0 )
+        {
+        close ( call->portSock );
+        call->portSock = -1;
+        }
+    if ( call->fd >= 0 )
+        {
+        shutdown ( call->fd,2 );
+        close ( call->fd );
+        call->fd = -1;
+        }
+
+    call->err   = err;
+    call->state = BUSASYNC_DONE;
+    debug2 ( DEBUG_CLIENT,"BusAsync : call seq %d done, err = %d\n", call->reqSeq, err );
+    if ( call->done )
+        call->done ( call );
+    }
+
+static int asyncRequest ( struct BusAsyncCall *call, int typeId )
+/* sends the direct-connect request; returns 0 if it could not be sent */
+    {
+    char tmp_msg[512];
+
+    debug3 ( DEBUG_CLIENT,"BusCallRemoteAsync : toModule = %d typeId = %d portNumber = %d\n",
+             call->toModule, typeId, call->portNumber );
+    sprintf ( tmp_msg,"%d %d", call->portNumber, typeId );
+    call->reqSeq = BusSendBusByte ( call->bd, call->toModule,
+                                    BUSBYTE_REQ_DIRECT_CONNECT, strlen ( tmp_msg )+1, tmp_msg );
+    return call->reqSeq != SBUSERROR_MASTER_ABSENT;
+    }
+
+static void asyncSend ( struct BusAsyncCall *call )
+/* the connection is up:  send the arguments */
+    {
+    if ( call->conn && !poolSendOp ( call->fd, call->typeId ) )
+        {
+        asyncFinish ( call, SBUSERROR_WRITE );
+        return;
+        }
+    call->send_stub ( call->fd, call->args );
+    call->state = BUSASYNC_WAITING;
+    BusXtWatchRemote ( call );
+    }
+
+struct BusAsyncCall *
+BusCallRemoteAsync ( struct BusData *bd, int toModule, int typeId,
+                     void ( *send_stub ) ( int, char * ),
+                     void ( *recv_stub ) ( int, char *, char * ),
+                     char *args, char *res,
+                     void ( *done ) ( struct BusAsyncCall * ),
+                     void *clientData )
+    {
+    struct BusAsyncCall *call;
+
+    call = ( struct BusAsyncCall * ) calloc ( 1, sizeof ( struct BusAsyncCall ) );
+    if ( call == NULL )
+        return NULL;
+
+    call->bd         = bd;
+    call->toModule   = toModule;
+    call->typeId     = typeId;
+    call->portSock   = -1;
+    call->fd         = -1;
+    call->donePipe[0] = call->donePipe[1] = -1;
+    call->state      = BUSASYNC_CONNECTING;
+    call->err        = SBUSERROR_NOT;
+    call->send_stub  = send_stub;
+    call->recv_stub  = recv_stub;
+    call->args       = args;
+    call->res        = res;
+    call->done       = done;
+    call->clientData = clientData;
+
+    /* an idle pooled connection saves the bus round-trip altogether */
+
+    while ( !poolRefused ( bd, toModule ) &&
+            ( ( call->conn = poolGet ( bd, toModule ) ) != NULL ) )
+        {
+        if ( poolSendOp ( call->conn->fd, typeId ) )
+            break;
+        BusPoolRelease ( bd, call->conn, 0 );
+        call->conn = NULL;
+        }
+    if ( call->conn )
+        {
+        call->fd   = call->conn->fd;
+        call->next = bd->AsyncCalls;
+        bd->AsyncCalls = call;
+        send_stub ( call->fd, args );
+        call->state = BUSASYNC_WAITING;
+        BusXtWatchRemote ( call );
+        return call;
+        }
+
+    call->portNumber = 0;
+    call->portSock = busSocket_createAcceptorSocket ( &call->portNumber );
+    if ( call->portSock < 0 )
+        {
+        free ( call );
+        return NULL;
+        }
+
+    call->pooled = ( !poolRefused ( bd, toModule ) && ( poolTypeId ( bd ) >= 0 ) );
+    if ( !asyncRequest ( call, call->pooled ? bd->PooledTypeId : typeId ) )
+        {
+        close ( call->portSock );
+        free ( call );
+        return NULL;
+        }
+
+    call->next = bd->AsyncCalls;
+    bd->AsyncCalls = call;
+    return call;
+    }
+
+int BusAsyncReply ( struct BusData *bd, struct BusMessage *bmsg )
+    {
+    struct BusAsyncCall *call;
+    struct sockaddr_in sin;
+    unsigned char busByte;
+
+    for ( call = bd->AsyncCalls; call; call = call->next )
+        {
+        if ( ( call->state == BUSASYNC_CONNECTING ) &&
+                ( call->reqSeq == bmsg->serial ) )
+            break;
+        }
+    if ( call == NULL )
+        return 0;
+
+    busByte = ( bmsg->messageLength > 0 ) ? bmsg->message[0] : BUSBYTE_DIRECT_CONNECT_FAIL;
+    if ( ( busByte != BUSBYTE_DIRECT_CONNECT_OK ) && call->pooled )
+        {
+        /* the module doesn't do pooling:  ask again, the old way */
+        debug1 ( DEBUG_CLIENT,"BusCallRemoteAsync : module %d refused a pooled connection\n",
+                 call->toModule );
+        if ( !poolRefused ( bd, call->toModule ) )
+            poolAdd ( bd, call->toModule, -1 );
+        call->pooled = 0;
+        if ( !asyncRequest ( call, call->typeId ) )
+            asyncFinish ( call, SBUSERROR_MASTER_ABSENT );
+        return 1;
+        }
+    if ( busByte != BUSBYTE_DIRECT_CONNECT_OK )
+        {
+        printf ( "BusCallRemoteAsync : Received BUSBYTE_DIRECT_CONNECT_FAIL \n" );
+        asyncFinish ( call, SBUSERROR_MSG_NOT_UNDERSTOOD );
+        return 1;
+        }
+
+    call->fd = busSocket_acceptConnection ( call->portSock, &sin );
+    close ( call->portSock );
+    call->portSock = -1;
+    if ( call->fd < 0 )
+        {
+        perror ( "Call Remote Async - accept failed" );
+        asyncFinish ( call, SBUSERROR_ACCEPT_FAILED );
+        return 1;
+        }
+
+    if ( call->pooled )
+        {
+        call->conn = poolAdd ( bd, call->toModule, call->fd );
+        if ( call->conn == NULL )
+            {
+            call->fd = -1;
+            asyncFinish ( call, SBUSERROR_NOMEMORY );
+            return 1;
+            }
+        }
+
+    asyncSend ( call );
+    return 1;
+    }
+
+int BusAsyncClaimQueued ( struct BusData *bd )
+    {
+    struct BusAsyncCall *call;
+    struct BusMessage   *queued;
+    struct BusMessage    bmsg;
+    int                  n = 0;
+
+    call = bd->AsyncCalls;
+    while ( call && bd->RecvdMessages )
+        {
+        queued = NULL;
+        if ( call->state == BUSASYNC_CONNECTING )
+            queued = BusGetMessageBySeq ( bd->RecvdMessages, call->reqSeq );
+        if ( ( queued == NULL ) ||
+                ( queued->messageOption != BUSBYTE_REPLY_DIRECT_CONNECT ) )
+            {
+            call = call->next;
+            continue;
+            }
+
+        /* BusAsyncReply() may finish calls (and so change the list):
+           start again from the top afterwards */
+
+        BusCopyBusMessage ( &bmsg, queued );
+        bd->RecvdMessages = Bus_DequeMessageBySeq ( bd->RecvdMessages, call->reqSeq );
+        BusAsyncReply ( bd, &bmsg );
+        if ( bmsg.messageLength > 0 ) free ( bmsg.message );
+        n++;
+        call = bd->AsyncCalls;
+        }
+    return n;
+    }
+
+static void asyncReceive ( struct BusAsyncCall *call )
+/* reads the results, and the echoed opcode of a pooled connection;
+   touches nothing outside the call, so may run on a worker thread */
+    {
+    int op;
+
+    call->recv_stub ( call->fd, call->args, call->res );
+    if ( call->conn )
+        call->connOk = ( BusReadInteger ( call->fd, &op ) == SBUSERROR_NOT ) &&
+                       ( op == call->typeId );
+    }
+
+/* as for BusCallRemotePooled():  a pooled connection that did not echo
+   the opcode lost the results along the way */
+static int asyncStatus ( struct BusAsyncCall *call )
+    {
+    return ( call->conn && !call->connOk ) ? SBUSERROR_READ : SBUSERROR_NOT;
+    }
+
+void BusAsyncReadable ( struct BusAsyncCall *call )
+    {
+    if ( call->state != BUSASYNC_WAITING )
+        return;
+    asyncReceive ( call );
+    asyncFinish ( call, asyncStatus ( call ) );
+    }
+
+static void *asyncWorker ( void *arg )
+    {
+    struct BusAsyncCall *call = ( struct BusAsyncCall * ) arg;
+    char c = 0;
+
+    asyncReceive ( call );
+    while ( ( write ( call->donePipe[1], &c, 1 ) < 0 ) && ( errno == EINTR ) )
+        ;
+    return NULL;
+    }
+
+int BusAsyncReceiveBackground ( struct BusAsyncCall *call )
+    {
+    if ( call->state != BUSASYNC_WAITING )
+        return 0;
+    if ( pipe ( call->donePipe ) < 0 )
+        {
+        call->donePipe[0] = call->donePipe[1] = -1;
+        return 0;
+        }
+    call->state = BUSASYNC_RECEIVING;
+    if ( pthread_create ( &call->worker, NULL, asyncWorker, call ) != 0 )
+        {
+        close ( call->donePipe[0] );
+        close ( call->donePipe[1] );
+        call->donePipe[0] = call->donePipe[1] = -1;
+        call->state = BUSASYNC_WAITING;
+        return 0;
+        }
+    return 1;
+    }
+
+void BusAsyncReceived ( struct BusAsyncCall *call )
+    {
+    if ( call->state != BUSASYNC_RECEIVING )
+        return;
+    pthread_join ( call->worker, NULL );
+    close ( call->donePipe[0] );
+    close ( call->donePipe[1] );
+    call->donePipe[0] = call->donePipe[1] = -1;
+    asyncFinish ( call, asyncStatus ( call ) );
+    }
+
+static int asyncPending ( struct BusData *bd, struct BusAsyncCall *call )
+    {
+    struct BusAsyncCall *c;
+
+    if ( call )
+        return call->state != BUSASYNC_DONE;
+
+    for ( c = bd->AsyncCalls; c; c = c->next )
+        {
+        if ( c->state != BUSASYNC_DONE )
+            return 1;
+        }
+    return 0;
+    }
+
+/* Block until "call" (or, if NULL, every outstanding call) is done.
+   Bus traffic other than the direct-connect replies is saved on
+   bd->RecvdMessages, as for BusGetResponse(), and is processed
+   by the next BusDispatch().  Replies that a BusGetResponse() (from
+   a callback) has already saved there are claimed before each select(). */
+
+static int asyncWait ( struct BusData *bd, struct BusAsyncCall *call )
+    {
+    struct BusAsyncCall *c, *nextc;
+    struct BusMessage    bmsg;
+    struct BusMessageQueue *bmq;
+    fd_set rfds;
+    int    maxfd, err;
+
+    while ( asyncPending ( bd, call ) )
+        {
+        if ( BusAsyncClaimQueued ( bd ) )
+            continue;
+
+        FD_ZERO ( &rfds );
+        FD_SET ( bd->fd, &rfds );
+        maxfd = bd->fd;
+        for ( c = bd->AsyncCalls; c; c = c->next )
+            {
+            if ( c->state == BUSASYNC_WAITING )
+                {
+                FD_SET ( c->fd, &rfds );
+                if ( c->fd > maxfd ) maxfd = c->fd;
+                }
+            else if ( c->state == BUSASYNC_RECEIVING )
+                {
+                FD_SET ( c->donePipe[0], &rfds );
+                if ( c->donePipe[0] > maxfd ) maxfd = c->donePipe[0];
+                }
+            }
+
+        if ( select ( maxfd+1, &rfds, NULL, NULL, NULL ) < 0 )
+            {
+            perror ( "BusWaitRemote : select failed" );
+            return SBUSERROR_READ;
+            }
+
+        for ( c = bd->AsyncCalls; c; c = nextc )
+            {
+            nextc = c->next;
+            if ( ( c->state == BUSASYNC_WAITING ) && FD_ISSET ( c->fd, &rfds ) )
+                {
+                BusAsyncReadable ( c );
+                }
+            else if ( ( c->state == BUSASYNC_RECEIVING ) && FD_ISSET ( c->donePipe[0], &rfds ) )
+                {
+                BusAsyncReceived ( c );
+                }
+            }
+
+        if ( FD_ISSET ( bd->fd, &rfds ) )
+            {
+            err = BusReadMessage ( bd->fd, &bmsg );
+            if ( err != SBUSERROR_NOT )
+                return err;
+            if ( ( bmsg.messageOption != BUSBYTE_REPLY_DIRECT_CONNECT ) ||
+                    !BusAsyncReply ( bd, &bmsg ) )
+                {
+                bmq = Bus_EnqueMessage ( bd->RecvdMessages, &bmsg );
+                if ( bmq != NULL )
+                    bd->RecvdMessages = bmq;
+                }
+            if ( bmsg.messageLength > 0 ) free ( bmsg.message );
+            }
+        }
+
+    return call ? call->err : SBUSERROR_NOT;
+    }
+
+int BusWaitRemote ( struct BusData *bd, struct BusAsyncCall *call )
+    {
+    if ( call == NULL )
+        return SBUSERROR_BADPARAMETER;
+    return asyncWait ( bd, call );
+    }
+
+int BusWaitAllRemote ( struct BusData *bd )
+    {
+    return asyncWait ( bd, NULL );
+    }
+
+void BusFreeRemote ( struct BusAsyncCall *call )
+    {
+    if ( call && ( call->state == BUSASYNC_DONE ) )
+        free ( call );
+    }
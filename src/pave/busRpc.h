@@ -33,11 +33,19 @@
  * Change author: Rajini Balay, NCSU, CSC
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  asynchronous (pipelined) remote calls
+ *
+ * Version 10/2026:  pooled persistent direct connections
  ********************************************************************/
 
 #ifndef SBUS_RPC_H_INCLUDED
 #define SBUS_RPC_H_INCLUDED
 
+#include <time.h>
+#include <pthread.h>
+#include "busClient.h"
+
 #ifdef SBUS_INCLUDE_HDR_DEFN
 static char *vhbusRpc= "$Id: busRpc.h 83 2018-03-12 19:24:33Z coats $" ;
 #endif
@@ -46,4 +54,157 @@ static char *vhbusRpc= "$Id: busRpc.h 83 2018-03-12 19:24:33Z coats $" ;
 int BusCallRemote ( struct BusData *bd, int toModule, int typeId,
                     void ( *stub ) ( int, char *, char * ), char *args, char *res );
 
+/***********************************************************
+  Pooled remote procedure calls.
+
+  BusCallRemotePooled() is BusCallRemote() over a persistent direct
+  connection, kept in bd->ConnPool and re-used by later calls to the
+  same module, so that the bus round-trip and TCP set-up are paid
+  once per connection rather than once per call.  A module that has
+  several requests in flight (see BusCallRemoteAsync()) holds several
+  connections.  Idle connections are checked before re-use, pinged
+  when they have been idle a while (and dropped if the answer is slow,
+  rather than hold up the caller), and closed after BUSPOOL_IDLE_SECS.
+  A call whose connection fails after the request went out returns
+  SBUSERROR_READ:  it is not retried, as the remote end may have acted
+  on it.
+
+  On the wire, each request on a pooled connection is
+      opcode (the call's typeId), stub traffic, opcode echoed back
+  and opcode BUSPOOL_PING is answered with BUSPOOL_PING.
+
+  The serving module calls BusServePooledConnections() once; its
+  BusAddDirectCallback() functions then serve pooled requests as
+  well, from BusEventLoop().  Modules that don't are remembered, and
+  calls to them fall back on BusCallRemote().
+  **********************************************************/
+
+#define BUSPOOL_TYPENAME   "BusPooledConnection"
+#define BUSPOOL_PING       (-1)
+#define BUSPOOL_MAXIDLE      4  /* idle connections kept per module       */
+#define BUSPOOL_CHECK_SECS  30  /* ping connections idle longer than this */
+#define BUSPOOL_PING_MSECS 250  /* drop them if the answer takes longer     */
+#define BUSPOOL_IDLE_SECS  600  /* close connections idle longer than this */
+
+struct BusPooledConn
+    {
+    struct BusPooledConn *next;     /* in bd->ConnPool */
+    int                   toModule;
+    int                   fd;       /* -1:  toModule does not do pooling */
+    int                   busy;
+    time_t                lastUsed;
+    };
+
+int BusCallRemotePooled ( struct BusData *bd, int toModule, int typeId,
+                          void ( *stub ) ( int, char *, char * ), char *args, char *res );
+
+int BusServePooledConnections ( struct BusData *bd );
+
+void BusPoolRelease ( struct BusData *bd, struct BusPooledConn *conn, int ok );
+/* (internal function) returns a busy connection to the pool, or closes
+   it if !ok */
+
+void BusPoolClose ( struct BusData *bd );
+/* closes all pooled connections (called by BusClose()) */
+
+/***********************************************************
+  Asynchronous remote procedure calls.
+
+  BusCallRemoteAsync() sends the direct-connect request and returns
+  at once.  When the remote client accepts, the connection is made
+  and send_stub() packs the arguments; when the results arrive,
+  recv_stub() unpacks them and then done() is called.  Many calls,
+  to one or several remote clients, may be outstanding at once.
+  Calls use an idle pooled connection when there is one, and ask for
+  a new pooled connection (which joins the pool when the call is
+  done) otherwise.
+
+  Progress is made by the BusXtInitialize() input handlers (for Xt
+  programs) or by BusWaitRemote() / BusWaitAllRemote(), which block
+  until the given call / all calls are complete.  The Xt handlers do
+  not read the results themselves:  once they start to arrive, a
+  worker thread runs recv_stub() (which must touch nothing but its
+  own args and res) and the handler for its completion pipe calls
+  done(), back on the Xt thread.
+
+  The call struct belongs to the caller, who must BusFreeRemote() it,
+  either from done() or after BusWaitRemote() returns (but not both:
+  a call that is being waited for must not be freed by its done()).
+  **********************************************************/
+
+#define BUSASYNC_CONNECTING  1  /* waiting for BUSBYTE_REPLY_DIRECT_CONNECT */
+#define BUSASYNC_WAITING     2  /* arguments sent, waiting for results      */
+#define BUSASYNC_DONE        3  /* complete; "err" holds the status         */
+#define BUSASYNC_RECEIVING   4  /* a worker thread is reading the results   */
+
+struct BusXtCall;               /* Xt input watch:  see busXtClient.h */
+
+struct BusAsyncCall
+    {
+    struct BusAsyncCall *next;      /* in bd->AsyncCalls, while pending */
+    struct BusData      *bd;
+    int                  toModule;
+    int                  typeId;
+    int                  reqSeq;    /* serial of the direct-connect request */
+    int                  portNumber;
+    int                  portSock;  /* acceptor socket, while CONNECTING    */
+    int                  fd;        /* direct connection, while WAITING     */
+    int                  state;
+    int                  err;       /* SBUSERROR_* when DONE */
+    struct BusXtCall    *xt;        /* Xt input watch, if any              */
+    pthread_t            worker;    /* while RECEIVING                     */
+    int                  donePipe[2];   /* worker's completion signal      */
+    int                  pooled;    /* requested a pooled connection       */
+    struct BusPooledConn *conn;     /* the pooled connection, if any       */
+    int                  connOk;    /* conn is fit for re-use              */
+
+    void               ( *send_stub ) ( int, char * );
+    void               ( *recv_stub ) ( int, char *, char * );
+    void               ( *done ) ( struct BusAsyncCall * );
+    char                *args;
+    char                *res;
+    void                *clientData;
+    };
+
+struct BusAsyncCall *
+BusCallRemoteAsync ( struct BusData *bd, int toModule, int typeId,
+                     void ( *send_stub ) ( int, char * ),
+                     void ( *recv_stub ) ( int, char *, char * ),
+                     char *args, char *res,
+                     void ( *done ) ( struct BusAsyncCall * ),
+                     void *clientData );
+/* returns NULL if the request could not be sent */
+
+int BusAsyncReply ( struct BusData *bd, struct BusMessage *bmsg );
+/* (internal function) handles a BUSBYTE_REPLY_DIRECT_CONNECT for an
+   outstanding asynchronous call:  returns 1 if it was one, else 0 */
+
+int BusAsyncClaimQueued ( struct BusData *bd );
+/* (internal function) hands to BusAsyncReply() any direct-connect
+   replies for outstanding calls that a synchronous BusGetResponse()
+   read and saved on bd->RecvdMessages;  returns how many */
+
+void BusAsyncReadable ( struct BusAsyncCall *call );
+/* (internal function) results are ready to read on call->fd:  reads
+   them, and finishes the call */
+
+int BusAsyncReceiveBackground ( struct BusAsyncCall *call );
+/* (internal function) as BusAsyncReadable(), but reads on a worker
+   thread, which writes to call->donePipe[1] when it is done;  returns
+   0 (and does nothing) if the thread cannot be started */
+
+void BusAsyncReceived ( struct BusAsyncCall *call );
+/* (internal function) call->donePipe[0] is readable:  collects the
+   worker and finishes the call, on the calling thread */
+
+int BusWaitRemote ( struct BusData *bd, struct BusAsyncCall *call );
+/* blocks until "call" is DONE; returns call->err */
+
+int BusWaitAllRemote ( struct BusData *bd );
+/* blocks until no asynchronous calls are pending; returns SBUSERROR_NOT
+   unless the bus connection failed (per-call status is in call->err) */
+
+void BusFreeRemote ( struct BusAsyncCall *call );
+/* frees a DONE call */
+
 #endif
@@ -53,6 +53,9 @@
  * Change author: R. Balay, NCSU, CSC
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  BusEventLoop() no longer touches a callback node
+ * after calling it, so that callbacks may remove themselves.
  ********************************************************************/
 
 #include <stdio.h>
@@ -315,25 +318,35 @@ void BusEventLoop ( struct BusData *bd )
             /* don't bother just checking the first guy -
             make sure everybody gets a turn... */
 
+            /* a callback may remove itself (or add others), so take
+               what we need from the node before calling anything;
+               pooled-connection handlers close their fd this way */
+
             cur_callback = bd->InputCallbacks;
             while ( cur_callback )
                 {
-                if ( FD_ISSET ( cur_callback->fd,&rfds ) )
-                    if ( cur_callback->read_callback != NULL )
+                struct BusInputCallback *next_callback = cur_callback->next;
+                int            cb_fd  = cur_callback->fd;
+                BusInputCBfunc   rd_cb = cur_callback->  read_callback;
+                BusInputCBfunc   wr_cb = cur_callback-> write_callback;
+                BusInputCBfunc   ex_cb = cur_callback->except_callback;
+
+                if ( FD_ISSET ( cb_fd,&rfds ) )
+                    if ( rd_cb != NULL )
                         {
-                        /* printf("Input from descriptor %d\n",cur_callback->fd); */
+                        /* printf("Input from descriptor %d\n",cb_fd); */
                         debug0 ( DEBUG_CLIENT,"BusInputCallback : Invoking function \n" );
-                        ( cur_callback->read_callback ) ( cur_callback->fd,bd );
+                        ( rd_cb ) ( cb_fd,bd );
                         debug0 ( DEBUG_CLIENT,"BusInputCallback : Returning \n" );
                         }
-                if ( FD_ISSET ( cur_callback->fd,&wfds ) )
-                    if ( cur_callback->write_callback!=NULL )
-                        ( cur_callback->write_callback ) ( cur_callback->fd,bd );
-                if ( FD_ISSET ( cur_callback->fd,&efds ) )
-                    if ( cur_callback->except_callback!=NULL )
-                        ( cur_callback->except_callback ) ( cur_callback->fd,bd );
-
-                cur_callback = cur_callback->next;
+                if ( FD_ISSET ( cb_fd,&wfds ) )
+                    if ( wr_cb!=NULL )
+                        ( wr_cb ) ( cb_fd,bd );
+                if ( FD_ISSET ( cb_fd,&efds ) )
+                    if ( ex_cb!=NULL )
+                        ( ex_cb ) ( cb_fd,bd );
+
+                cur_callback = next_callback;
                 }
             }
         else
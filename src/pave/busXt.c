@@ -57,9 +57,14 @@
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
  *
+ * Version 10/2026:  Xt input handlers for asynchronous remote calls
+ *
+ * Version 10/2026:  their results are read on a worker thread
+ *
  ********************************************************************/
 
 #include "busXtClient.h"
+#include "busRpc.h"
 #include "busError.h"
 #include "busDebug.h"
 
@@ -92,6 +97,8 @@ int BusXtInitialize ( struct BusData *bd,XtAppContext app_context )
     err = BusInitialize ( bd, -1, 0, NULL );
 
     if ( err == SBUSERROR_NOT )
+        {
+        bd->xtd->app  = app_context;
         bd->xtd->xtid = XtAppAddInput (
                             app_context,
                             bd->fd,
@@ -99,6 +106,7 @@ int BusXtInitialize ( struct BusData *bd,XtAppContext app_context )
                             BusXtInputDispatch,
                             ( XtPointer ) bd
                         );
+        }
     return err;
     }
 
@@ -109,7 +117,62 @@ void BusXtClose ( struct BusData *bd )
         XtRemoveInput ( bd->xtd->xtid );
         bd->xtd->xtid = NULL;
         }
+    if ( bd->xtd != NULL )
+        bd->xtd->app = NULL;
 
     BusClose ( bd );
     }
 
+static void xtWatch ( struct BusAsyncCall *call, int fd, XtInputCallbackProc proc )
+    {
+    struct BusData *bd = call->bd;
+
+    if ( call->xt == NULL )
+        call->xt = ( struct BusXtCall * ) calloc ( 1, sizeof ( struct BusXtCall ) );
+    if ( call->xt == NULL )
+        return;
+    call->xt->xtid = XtAppAddInput ( bd->xtd->app,
+                                     fd,
+                                     ( XtPointer ) XtInputReadMask,
+                                     proc,
+                                     ( XtPointer ) call );
+    }
+
+static void BusXtRemoteDone ( XtPointer call, int *dummy, XtInputId *id )
+    {
+    BusAsyncReceived ( ( struct BusAsyncCall * ) call );
+    }
+
+static void BusXtRemoteInput ( XtPointer call, int *dummy, XtInputId *id )
+/* the results have started to arrive:  a big grid would hold up the
+   event loop, so they are read on a worker thread, and the call
+   finished when that signals its completion pipe */
+    {
+    struct BusAsyncCall *c = ( struct BusAsyncCall * ) call;
+
+    BusXtUnwatchRemote ( c );
+    if ( BusAsyncReceiveBackground ( c ) )
+        xtWatch ( c, c->donePipe[0], BusXtRemoteDone );
+    else
+        BusAsyncReadable ( c );
+    }
+
+void BusXtWatchRemote ( struct BusAsyncCall *call )
+    {
+    struct BusData *bd = call->bd;
+
+    if ( bd->xtd == NULL || bd->xtd->app == NULL ||
+            ( call->xt != NULL && call->xt->xtid != 0 ) )
+        return;
+    xtWatch ( call, call->fd, BusXtRemoteInput );
+    }
+
+void BusXtUnwatchRemote ( struct BusAsyncCall *call )
+    {
+    if ( call->xt == NULL )
+        return;
+    if ( call->xt->xtid != 0 )
+        XtRemoveInput ( call->xt->xtid );
+    free ( call->xt );
+    call->xt = NULL;
+    }
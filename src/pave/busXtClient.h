@@ -36,6 +36,9 @@
  * Change author: Vouk
  *
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  struct BusXtCall, the Xt side of an asynchronous
+ * remote call, kept here so that busRpc.h needs no X headers
  ********************************************************************/
 
 
@@ -54,7 +57,8 @@ static char *vhbusXtClient= "$Id: busXtClient.h 83 2018-03-12 19:24:33Z coats $"
 
 struct BusXtData
     {
-    XtInputId xtid;
+    XtInputId    xtid;
+    XtAppContext app;   /* set by BusXtInitialize(); NULL for non-Xt clients */
     };
 
 /***********************************************************
@@ -71,4 +75,17 @@ void BusXtClose ( struct BusData *bd );
 /* should be used to close a connection created by
    BusXtInitialize */
 
+struct BusAsyncCall;
+
+struct BusXtCall
+    {
+    XtInputId    xtid;  /* on call->fd, then on call->donePipe[0] */
+    };
+
+void BusXtWatchRemote   ( struct BusAsyncCall *call );
+void BusXtUnwatchRemote ( struct BusAsyncCall *call );
+/* (internal functions) add/remove the Xt input handlers that collect
+   the results of an asynchronous remote call (see busRpc.h), through
+   a worker thread;  no-ops for non-Xt clients */
+
 #endif
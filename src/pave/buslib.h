@@ -165,15 +165,49 @@ struct BusMessage
    sender (could be used to find the current module bus id) */
 
 
-/* BusMessageQueue structure is intended to be a node in a
-   circular singly linked list (used as a queue) */
-struct BusMessageQueue
+/* BusMessageNode is one queued message.  Nodes form a doubly linked
+   FIFO, and are also threaded onto two hash chains of the owning
+   queue:  one keyed by serial number, one keyed by (fromModule,
+   messageOption).  The "...Prevp" members point at whichever link
+   points at this node, so that unlinking is O(1).
+   Nodes and their message buffers are recycled through a free-list
+   in busMsgQue.c, so that steady-state enqueue/dequeue does no malloc. */
+struct BusMessageNode
     {
-    struct BusMessageQueue *next;
+    struct BusMessageNode  *next;
+    struct BusMessageNode  *prev;
+
+    struct BusMessageNode  *seqNext;
+    struct BusMessageNode **seqPrevp;
+
+    struct BusMessageNode  *optNext;
+    struct BusMessageNode **optPrevp;
+
+    int                     capacity;   /* allocated size of data.message */
 
     struct BusMessage       data;
     };
 
+#define BUSQ_HASH_SIZE   128    /* must be a power of 2 */
+
+/* BusMessageQueue is the queue header:  FIFO ends, count, and the two
+   hash indices.  A NULL (struct BusMessageQueue *) is the empty queue;
+   the functions below return NULL when the last message is removed,
+   and a (possibly new) queue pointer otherwise.  */
+struct BusMessageQueue
+    {
+    struct BusMessageNode  *first;
+    struct BusMessageNode  *last;
+    int                     count;
+
+    struct BusMessageNode  *bySeq   [ BUSQ_HASH_SIZE ];
+    struct BusMessageNode  *byOption[ BUSQ_HASH_SIZE ];
+
+    /* the last link of each chain (NULL:  the chain's head) */
+    struct BusMessageNode **seqTail [ BUSQ_HASH_SIZE ];
+    struct BusMessageNode **optTail [ BUSQ_HASH_SIZE ];
+    };
+
 struct BusMessage *
 BusGetFirstMessage ( struct BusMessageQueue *last );
 /* returns a pointer to the first BusMessage in the queue,
@@ -189,6 +223,9 @@ int Bus_MessagesLeft ( struct BusMessageQueue *last );
 /* returns true(1) if their is a message in the queue,
    0 otherwise */
 
+int Bus_MessageCount ( struct BusMessageQueue *last );
+/* returns the number of messages in the queue */
+
 struct BusMessageQueue *
 Bus_DequeMessage ( struct BusMessageQueue *last );
 /* removes the first item from the queue,
@@ -211,6 +248,9 @@ Bus_EnqueMessage ( struct BusMessageQueue *last,
    or NULL if an error occurs
    */
 
+void BusCopyBusMessage ( struct BusMessage *dst, struct BusMessage *src );
+/* copies src, and its body, into dst */
+
 struct BusMessage *
 BusGetMessageByModuleOption ( struct BusMessageQueue *last, int moduleId,
                               unsigned char option );
@@ -225,6 +265,9 @@ BusGetMessageBySeq ( struct BusMessageQueue *last, int seq );
 struct BusMessageQueue *
 Bus_DequeMessageBySeq ( struct BusMessageQueue *last, int seq );
 
+struct BusMessage *
+BusGetMessageByModuleSeq ( struct BusMessageQueue *last, int moduleId, int seq );
+
 struct BusMessageQueue *
 Bus_DequeMessageByModuleSeq ( struct BusMessageQueue *last, int moduleId, int seq );
 
@@ -290,6 +333,16 @@ struct BusData
        a list of file descriptors in use, and
        callback associated with them */
     struct BusInputCallback *InputCallbacks;
+
+    /* outstanding BusCallRemoteAsync() calls (see busRpc.h) */
+    struct BusAsyncCall *AsyncCalls;
+
+    /* pooled direct connections (see busRpc.h):  the type id used to
+       ask for one (-1 until looked up), whether this module serves them,
+       and the connections held to other modules */
+    int   PooledTypeId;
+    int   PoolServer;
+    struct BusPooledConn *ConnPool;
     };
 
 struct BusModuleData
@@ -561,6 +614,11 @@ int BusGetResponse ( struct BusData *, int, unsigned char, char ** );
 int BusCallRemote ( struct BusData *bd, int toModule, int typeId,
                     void ( *stub ) ( int, char *, char * ), char *args, char *res );
 
+int BusCallRemotePooled ( struct BusData *bd, int toModule, int typeId,
+                          void ( *stub ) ( int, char *, char * ), char *args, char *res );
+
+int BusServePooledConnections ( struct BusData *bd );
+
 
 /**************************  From busRw.h  **************************/
 
@@ -624,6 +682,7 @@ int FTP_dirRemote ( struct BusData *bd, char *ipaddr, char *directory,
 int FTP_dirLocal ( char *directory, int code, char **fList );
 
 int is_localhost ( char *hname, char *ipaddr );
+int is_local_ipaddr ( char *ipaddr );
 int is_accessible( char *file );
 
 
@@ -0,0 +1,184 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: colop.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Vertical column operators;  see colop.h.
+ *
+ *  The (step, block) pairs are independent, and are shared out among
+ *  the OpenMP threads;  within one, acc[] holds the weighted sum (or
+ *  the max) and wt[] the total weight of the non-missing values seen so
+ *  far in each cell of the block.  The inner loops are branch-free, so
+ *  that the compiler can vectorize them.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+#include "netcdf.h"
+#include "parms3.h"
+#include "DataImport.h"
+#include "colop.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define COLOP_GRAV      ( 9.80622 )     /* m/s2, as IO/API's GRAV */
+
+
+int colop_type ( const char *name )
+    {
+    if ( !strcasecmp ( name, "colsum" ) ) return COLOP_SUM;
+    if ( !strcasecmp ( name, "colint" ) ) return COLOP_INT;
+    if ( !strcasecmp ( name, "colmax" ) ) return COLOP_MAX;
+    if ( !strcasecmp ( name, "colavg" ) ) return COLOP_AVG;
+    return -1;
+    }
+
+
+int colop_layer_mass ( const char *filename, int level0, int nlev,
+                       float *mass, char *message )
+    {
+    int      fd, vgtyp, nlays, n, k, ok;
+    float    vgtop, *vglvls;
+    nc_type  type;
+    double   ptop, p0, p1;
+
+    if ( !filename || ( ( fd = ncopen ( filename, NC_NOWRITE ) ) == NC_SYSERR ) )
+        {
+        sprintf ( message, "Can't open '%s' for its vertical grid",
+                  filename ? filename : "" );
+        return FAILURE;
+        }
+
+    /* Turn off NetCDF gripes about attributes that aren't present */
+
+    ncopts = 0;
+    ok = ( ncattget ( fd, NC_GLOBAL, "VGTYP", &vgtyp ) != NC_SYSERR ) &&
+         ( ncattget ( fd, NC_GLOBAL, "VGTOP", &vgtop ) != NC_SYSERR ) &&
+         ( ncattget ( fd, NC_GLOBAL, "NLAYS", &nlays ) != NC_SYSERR ) &&
+         ( ncattinq ( fd, NC_GLOBAL, "VGLVLS", &type, &n ) != NC_SYSERR ) &&
+         ( type == NC_FLOAT ) && ( n >= nlays + 1 ) &&
+         ( level0 >= 0 ) && ( level0 + nlev <= nlays );
+    vglvls = NULL;
+    if ( ok && ( ( vglvls = ( float * ) malloc ( n * sizeof ( float ) ) ) != NULL ) )
+        ok = ( ncattget ( fd, NC_GLOBAL, "VGLVLS", vglvls ) != NC_SYSERR );
+    ncopts = ( NC_VERBOSE );
+    ncclose ( fd );
+    if ( !ok || !vglvls )
+        {
+        sprintf ( message, "'%s' has no usable IO/API vertical grid", filename );
+        if ( vglvls ) free ( vglvls );
+        return FAILURE;
+        }
+
+    /* layer k lies between levels k and k+1, decreasing in pressure */
+
+    ptop = vgtop / 100.0;                       /* mb */
+    for ( k = 0; k < nlev; k++ )
+        {
+        switch ( vgtyp )
+            {
+            case VGSGPH3:       /* hydrostatic sigma-P */
+            case VGSGPN3:       /* non-h sigma-P */
+#ifdef VGWRFEM
+            case VGWRFEM:       /* WRF mass-core eta */
+#endif
+                p0 = pressureAtSigmaLevel ( vglvls[level0+k],   ptop );
+                p1 = pressureAtSigmaLevel ( vglvls[level0+k+1], ptop );
+                break;
+
+            case VGPRES3:       /* pressure (pascals) */
+                p0 = vglvls[level0+k]   / 100.0;
+                p1 = vglvls[level0+k+1] / 100.0;
+                break;
+
+            default:
+                sprintf ( message, "'%s':  colint() and colavg() need "
+                          "sigma-P or pressure layers, not VGTYP %d",
+                          filename, vgtyp );
+                free ( vglvls );
+                return FAILURE;
+            }
+        mass[k] = ( float ) ( fabs ( p0 - p1 ) * 100.0 / COLOP_GRAV );
+        }
+    free ( vglvls );
+    return PAVE_SUCCESS;
+    }
+
+
+void colop_reduce ( int op, const float *grid, long ncell, int nlev,
+                    int nstep, const int *levels, const float *weight,
+                    float *out )
+    {
+    long nblock = ( ncell + COLOP_BLOCK - 1 ) / COLOP_BLOCK, p;
+
+#pragma omp parallel for schedule(static) if ( ncell * nlev * ( long ) nstep > 65536 )
+    for ( p = 0; p < nblock * nstep; p++ )
+        {
+        double       acc[COLOP_BLOCK], wt[COLOP_BLOCK], w;
+        const float *v;
+        float       *o;
+        long         b0 = ( p % nblock ) * COLOP_BLOCK, c, nb;
+        int          t = ( int ) ( p / nblock ), k;
+
+        nb = ( ncell - b0 < COLOP_BLOCK ) ? ncell - b0 : COLOP_BLOCK;
+        for ( c = 0; c < nb; c++ )
+            {
+            acc[c] = ( op == COLOP_MAX ) ? -HUGE_VAL : 0.0;
+            wt[c]  = 0.0;
+            }
+
+        for ( k = 0; k < nlev; k++ )
+            {
+            if ( levels && !levels[k] ) continue;
+            v = grid + ( ( long ) t * nlev + k ) * ncell + b0;
+            if ( op == COLOP_MAX )
+                {
+                for ( c = 0; c < nb; c++ )
+                    {
+                    acc[c] = ( v[c] > acc[c] ) ? v[c] : acc[c];     /* NaN:  no */
+                    wt[c] += ( v[c] == v[c] ) ? 1.0 : 0.0;
+                    }
+                }
+            else
+                {
+                w = ( weight && ( op != COLOP_SUM ) ) ? weight[k] : 1.0;
+                for ( c = 0; c < nb; c++ )
+                    {
+                    acc[c] += ( v[c] == v[c] ) ? w * v[c] : 0.0;
+                    wt[c]  += ( v[c] == v[c] ) ? w : 0.0;
+                    }
+                }
+            }
+
+        o = out + ( long ) t * ncell + b0;
+        for ( c = 0; c < nb; c++ )
+            {
+            if ( wt[c] == 0.0 )
+                o[c] = NAN;
+            else if ( op == COLOP_AVG )
+                o[c] = ( float ) ( acc[c] / wt[c] );
+            else
+                o[c] = ( float ) acc[c];
+            }
+        }
+    }
@@ -0,0 +1,76 @@
+#ifndef COLOP_H
+#define COLOP_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: colop.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Vertical column operators, for the formula functions
+ *
+ *      colsum(x)   sum of x over the selected layers
+ *      colint(x)   mass-weighted integral:  sum of x times the layer's
+ *                  air mass per unit area (kg/m2)
+ *      colmax(x)   max of x over the selected layers
+ *      colavg(x)   mass-weighted mean over the selected layers:  with
+ *                  the PBL layers selected, the PBL average
+ *
+ *  each of which reduces every column of a 3-D formula operand to a
+ *  single value, giving a 2-D (per step) result.  Missing (NaN) values
+ *  are skipped;  a column with none left yields NaN.
+ *
+ *  The grid is swept in storage order a block of COLOP_BLOCK cells at
+ *  a time:  for each block the layers are visited innermost, each one a
+ *  contiguous run of the layer plane, into per-cell accumulators that
+ *  stay in cache, so a column product reads its operand exactly once,
+ *  sequentially, however many layers there are.
+ *
+ *  Layer masses come from the file's IO/API vertical grid (VGTYP, VGTOP,
+ *  VGLVLS) through pressureAtSigmaLevel() in DataImport.c, for sigma-P
+ *  (hydrostatic, non-hydrostatic and WRF-eta) and pressure coordinates.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define COLOP_SUM       (0)     /* colsum() */
+#define COLOP_INT       (1)     /* colint() */
+#define COLOP_MAX       (2)     /* colmax() */
+#define COLOP_AVG       (3)     /* colavg() */
+
+#define COLOP_BLOCK     (512)   /* cells per block */
+
+/* the operator named by a formula atom, or -1 */
+int colop_type ( const char *name );
+
+/* mass[0..nlev-1] (kg/m2) of layers level0..level0+nlev-1 (0-based) of
+   filename's vertical grid:  PAVE_SUCCESS, or FAILURE with an error
+   string written into message */
+int colop_layer_mass ( const char *filename, int level0, int nlev,
+                       float *mass, char *message );
+
+/* reduces each column of grid[ncell*nlev*nstep] (cells fastest, then
+   layers, then steps) over the layers k with levels[k] != 0 (all, if
+   levels is NULL), into out[ncell*nstep].  weight[] is the layer mass,
+   needed for COLOP_INT;  COLOP_AVG weights the layers equally if it
+   is NULL */
+void colop_reduce ( int op, const float *grid, long ncell, int nlev,
+                    int nstep, const int *levels, const float *weight,
+                    float *out );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* COLOP_H */
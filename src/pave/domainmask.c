@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: domainmask.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Compiled domain masks;  see domainmask.h.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "domainmask.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+
+int domainmask_build ( DomainMask *mask, const char *percents, int imax, int jmax )
+    {
+    int      i, j, n, w, cap = 0;
+    MaskRun *run;
+
+    memset ( mask, 0, sizeof ( DomainMask ) );
+    mask->imax = imax;
+    mask->jmax = jmax;
+    if ( percents == NULL || imax <= 0 || jmax <= 0 )
+        return FAILURE;
+
+    for ( j = 0; j < jmax; j++ )
+        for ( i = 0; i < imax; i = n )
+            {
+            w = percents[i + j*imax];
+            for ( n = i+1; n < imax && percents[n + j*imax] == w; n++ ) ;
+            if ( w == 0 )
+                continue;
+            if ( mask->nrun == cap )
+                {
+                cap = cap ? 2*cap : 64;
+                if ( ( run = ( MaskRun * ) realloc ( mask->run, cap*sizeof ( MaskRun ) ) ) == NULL )
+                    {
+                    domainmask_free ( mask );
+                    return FAILURE;
+                    }
+                mask->run = run;
+                }
+            run = mask->run + mask->nrun++;
+            run->row    = j;
+            run->col0   = i;
+            run->col1   = n-1;
+            run->weight = w;
+            mask->ncells += n-i;
+            mask->total  += ( double ) w * ( n-i );
+            }
+    return PAVE_SUCCESS;
+    }
+
+void domainmask_free ( DomainMask *mask )
+    {
+    if ( mask->run ) free ( mask->run );
+    mask->run    = NULL;
+    mask->nrun   = 0;
+    mask->ncells = 0;
+    mask->total  = 0.0;
+    }
@@ -0,0 +1,70 @@
+#ifndef DOMAINMASK_H
+#define DOMAINMASK_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: domainmask.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Compiled domain masks.
+ *
+ *  A domain reaches the analysis code as a "percents" array, one char
+ *  per (column,row) giving the percentage (0..100) of the cell in the
+ *  domain, and calc_stats(), fillZlevels() and totalIntegration() used
+ *  to test every cell of the plane for every level and step.  For a
+ *  state or county on a national grid nearly all of those cells are
+ *  off.  domainmask_build() compiles the array once into the runs of
+ *  consecutive cells of a row with the same (non-zero) percentage, in
+ *  row-major order, together with the total of the percentages, so
+ *  that a reduction visits only the cells in the domain, a whole run
+ *  at a time:
+ *
+ *      for ( r = 0; r < mask.nrun; r++ )
+ *          {
+ *          p = grid + INDEX ( 0, mask.run[r].row, k, t, IMAX, JMAX, KMAX );
+ *          for ( i = mask.run[r].col0; i <= mask.run[r].col1; i++ )
+ *              ... p[i] ...
+ *          }
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+typedef struct
+    {
+    int row;            /* 0 based */
+    int col0, col1;     /* 0 based, inclusive */
+    int weight;         /* the cells' percentage, 1..100 */
+    } MaskRun;
+
+typedef struct
+    {
+    int      imax, jmax;
+    int      nrun;
+    MaskRun *run;
+    long     ncells;    /* cells in the domain */
+    double   total;     /* sum of their percentages */
+    } DomainMask;
+
+/* compiles percents[imax*jmax]:  PAVE_SUCCESS, or FAILURE (no memory) */
+int domainmask_build ( DomainMask *mask, const char *percents, int imax, int jmax );
+
+/* frees the runs, leaving an empty mask */
+void domainmask_free ( DomainMask *mask );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* DOMAINMASK_H */
@@ -19,6 +19,8 @@
  ****************************************************************************
  *  Author:  Kathy Pearson, MCNC, kathyp@mcnc.org
  *  Date:    December 12, 1994
+ *  Version 10/2026 by Carlie J. Coats, Jr.:  grid may be a spilled
+ *        formula grid (spill.c)
  ****************************************************************************/
 
 #include <stdio.h>
@@ -28,6 +30,7 @@
 
 #include "netcdf.h"
 #include "vis_data.h"
+#include "spill.h"
 
 /* This function frees the malloced pointers in the VIS_DATA structure */
 void free_vis ( VIS_DATA *info )
@@ -69,7 +72,7 @@ void free_vis ( VIS_DATA *info )
     if ( ( *info ).data_label != NULL )
         free ( ( *info ).data_label );
     if ( ( *info ).grid != NULL )
-        free ( ( *info ).grid );
+        spill_release ( ( *info ).grid );
     if ( ( *info ).sdate != NULL )
         free ( ( *info ).sdate );
     if ( ( *info ).stime != NULL )
@@ -21,6 +21,27 @@
  * Date:    December 12, 1994
  * Modified by : Rajini Balay
  *        Date : Feb 26, 1995
+ * Version 10/2026 by Carlie J. Coats, Jr.:  get_data_local1() reads
+ *        legacy files through the netCDF-4 sidecar cache (nccache.c)
+ *        when PAVE_NCCACHE is set
+ * Version 10/2026 by Carlie J. Coats, Jr.:  get_info_local1() consults
+ *        the persistent header index (metaindex.c) before opening a
+ *        file, and get_info_local() prefetches a chained file's members
+ *        into it in parallel
+ * Version 10/2026 by Carlie J. Coats, Jr.:  get_data_local1() serves
+ *        single-step slices through the read-ahead (readahead.c)
+ * Version 10/2026 by Carlie J. Coats, Jr.:  get_data_local() reads the
+ *        members of a META-meta file straight into the final grid
+ *        (gridtarget.c), from shallow copies of their headers
+ * Version 10/2026 by Carlie J. Coats, Jr.:  get_info_local2() and
+ *        get_data_local2() find the reader through the reader registry
+ *        (readers.c) instead of probing every format in turn
+ * Version 10/2026 by Carlie J. Coats, Jr.:  the META-meta grid comes
+ *        from spill_alloc() (spill.c)
+ * Version 10/2026 by Carlie J. Coats, Jr.:  get_data_local() keeps
+ *        per-plane summaries of what it reads (planesum.c)
+ * Version 10/2026 by Carlie J. Coats, Jr.:  each member's place in the
+ *        META-meta grid goes in the member's request (grid_dest)
  *****************************************************************************/
  
 #include <stdio.h>
@@ -60,6 +81,12 @@ typedef  struct metalist
     } MetaList;
 
 #include "toplats.h"
+#include "metaindex.h"
+#include "readahead.h"
+#include "gridtarget.h"
+#include "readers.h"
+#include "spill.h"
+#include "planesum.h"
 
 /*********************** GLOBAL VARIABLES *********************/
 
@@ -68,19 +95,48 @@ static MetaList *mlhead=NULL;
 
 /*********************** FUNCTION PROTOTYPES ******************/
 
-int alpha_open ( int *vis_fd, VIS_DATA *info, char *message );
-int alpha_get_data ( VIS_DATA *info, char *message );
-int alpha_get_info ( VIS_DATA *info, char *message );
+VIS_DATA *VIS_DATA_dup ( VIS_DATA *, char * );
 
-int uam_open     ( VIS_DATA *info, char *message );
-int uam_get_data ( VIS_DATA *info, char *message );
-int uam_get_info ( VIS_DATA *info, char *message );
+int get_info_local1 ( VIS_DATA *info, char *message );
+int get_info_local2 ( VIS_DATA *info, char *message );
+static int get_info_indexed ( VIS_DATA *info, char *message );
+int get_data_local1 ( VIS_DATA *info, char *message );
+static int get_data_local2 ( VIS_DATA *info, char *message );
 
-VIS_DATA *VIS_DATA_dup ( VIS_DATA *, char * );
 
 
 
 
+/* reads the headers of all the files named in the rest of fp (a chained
+   file, just past its first line) into the header index, in parallel,
+   and leaves fp where it was */
+static void prefetch_chained ( FILE *fp )
+    {
+    char line[MAXLINE], filename[MAXLINE];
+    char **names = NULL, **tmp;
+    int n = 0, cap = 0, i;
+    long pos;
+
+    pos = ftell ( fp );
+    while ( fgets ( line, MAXLINE, fp ) != NULL )
+        {
+        if ( sscanf ( line, "%s", filename ) != 1 ) continue;
+        if ( n == cap )
+            {
+            cap = cap ? 2*cap : 64;
+            tmp = ( char ** ) realloc ( names, cap * sizeof ( char * ) );
+            if ( tmp == NULL ) break;
+            names = tmp;
+            }
+        names[n++] = strdup ( filename );
+        }
+    metaindex_prefetch ( names, n, get_info_local2 );
+    for ( i = 0; i < n; i++ )
+        free ( names[i] );
+    free ( names );
+    fseek ( fp, pos, SEEK_SET );
+    }
+
 
 int get_info_local ( VIS_DATA *info, char *message )
     {
@@ -148,6 +204,8 @@ int get_info_local ( VIS_DATA *info, char *message )
             if ( tail==NULL ) tail=mlhead=mlist;
             else tail->next=mlist;
 
+            prefetch_chained ( fp );
+
             first=1;
             while ( fgets ( line, MAXLINE, fp ) != NULL )
                 {
@@ -292,7 +350,7 @@ FILE time = %s, DATABASE time = %s\n",
                 free_vis ( vdlist->vdata );
 
                 vdlist->mtime=time ( NULL );
-                ret=get_info_local2 ( info, message );
+                ret=get_info_indexed ( info, message );
                 vdlist->vdata = VIS_DATA_dup ( info,message );
 
                 return ( vdlist->vdata ? ret : FAILURE );
@@ -341,7 +399,7 @@ FILE time = %s, DATABASE time = %s\n",
 #endif
 
     vdlist->mtime=time ( NULL );
-    ret=get_info_local2 ( info, message );
+    ret=get_info_indexed ( info, message );
 
 #ifdef DO_TIMING
     t2=times ( &tm2 );
@@ -358,12 +416,26 @@ FILE time = %s, DATABASE time = %s\n",
     }
 
 
+/* get_info_local2(), unless the header index already has this file */
+static int get_info_indexed ( VIS_DATA *info, char *message )
+    {
+    int ret;
+
+    if ( metaindex_lookup ( info ) )
+        return PAVE_SUCCESS;
+    ret = get_info_local2 ( info, message );
+    if ( ret == PAVE_SUCCESS )
+        metaindex_store ( info );
+    return ret;
+    }
+
+
+/* as for get_data_local1(), the readers (and their sniff/probe) are not
+   reentrant:  run them under readahead_lock() */
 int get_info_local2 ( VIS_DATA *info, char *message )
     {
-    int fd;
-    FILE *mfp;
+    const PaveReader *reader;
     int ret;
-    TOPLATS_INFO tinfo;
 
     /* check for memory leaks!!! */
     if ( info->sdate!=NULL )
@@ -381,27 +453,16 @@ int get_info_local2 ( VIS_DATA *info, char *message )
         info->stime=NULL;
         }
 
-    if ( alpha_open ( &fd, info, message ) )
-        {
-        ncclose ( fd );
-        return ( alpha_get_info ( info, message ) );
-        }
-    else if ( toplats_open ( &tinfo,info,message ) )
-        {
-        return toplats_get_info ( &tinfo,info,message );
-        }
-    else if ( uamv_open ( info, message ) )
+    readahead_lock();
+    if ( ( reader = reader_find ( info, message ) ) == NULL )
         {
-        return ( uamv_get_info ( info, message ) );
-
-        }
-    else if ( uam_open ( info, message ) )
-        {
-        return ( uam_get_info ( info, message ) );
+        readahead_unlock();
+        fprintf ( stderr,"%s\n", message );
+        return FAILURE;
         }
-    fprintf ( stderr,"%s\n",
-              "File FMT not recognized. Not NETCDF, UAM-IV, UAM-V nor TOPLATS" );
-    return FAILURE;
+    ret = reader->get_info ( info, message );
+    readahead_unlock();
+    return ret;
     }
 
 #define min(a,b) (a)<(b) ? (a):(b)
@@ -413,26 +474,28 @@ int get_data_local ( VIS_DATA *info, char *message )
     int i, n, nfloats;
     MetaList *mlist;
     VisDataList *vdlist=NULL;
-    VIS_DATA *vdata, *vdatadup = ( VIS_DATA * ) NULL;
+    VIS_DATA *vdata, member;
     int *sdate, *stime;
     int smin, smax, step_min, step_max;
 
-
-    nfloats = ( info->col_max-info->col_min+1 ) *
-              ( info->row_max-info->row_min+1 ) *
-              ( info->level_max-info->level_min+1 ) *
-              ( info->step_max-info->step_min+1 );
-
-
-    info->grid= ( float * ) malloc ( ( nfloats ) *sizeof ( float ) );
-    if ( info->grid==NULL )
-        {
-        sprintf ( message, "malloc failure in get_data_local!" );
-        return FAILURE;
-        }
+    /* destinations are only for the members' requests, below */
+    info->grid_dest   = NULL;
+    info->grid_dest_n = 0;
 
     if ( metameta )
         {
+        nfloats = ( info->col_max-info->col_min+1 ) *
+                  ( info->row_max-info->row_min+1 ) *
+                  ( info->level_max-info->level_min+1 ) *
+                  ( info->step_max-info->step_min+1 );
+
+        info->grid = spill_alloc ( ( size_t ) nfloats );
+        if ( info->grid==NULL )
+            {
+            sprintf ( message, "malloc failure in get_data_local!" );
+            return FAILURE;
+            }
+
         mlist = mlhead;
         while ( mlist != NULL )
             {
@@ -444,6 +507,7 @@ int get_data_local ( VIS_DATA *info, char *message )
             mlist=mlist->next;
             }
 
+        ret = PAVE_SUCCESS;
         step_min = info->step_min;
         step_max = info->step_max;
         sdate = info->sdate;
@@ -457,45 +521,61 @@ int get_data_local ( VIS_DATA *info, char *message )
             smax = min ( vdata->step_max, step_max );
             if ( smin <= smax )
                 {
-                if ( vdatadup )              /* added 960919 SRT for memory management */
+                /*  Read the member straight into its place in info->grid:
+                 *  the readers only read its names, so a shallow copy of
+                 *  its header will do, except for the step dates and times,
+                 *  which they overwrite (or replace).
+                 */
+                member = *vdata;
+                member.grid  = NULL;
+                member.sdate = ( int * ) malloc ( vdata->nstep*sizeof ( int ) );
+                member.stime = ( int * ) malloc ( vdata->nstep*sizeof ( int ) );
+                if ( member.sdate==NULL || member.stime==NULL )
                     {
-                    /* added 960919 SRT for memory management */
-                    free_vis ( vdatadup );       /* added 960919 SRT for memory management */
-                    free ( ( char * ) vdatadup ); /* added 960920 SRT for memory management */
-                    vdatadup = ( VIS_DATA * ) NULL; /* added 960919 SRT for memory management */
-                    }                /* added 960919 SRT for memory management */
-                vdatadup = VIS_DATA_dup ( vdata,message );
-                if ( vdatadup==NULL ) return FAILURE;
-
-                vdatadup->slice = info->slice;
-                vdatadup->selected_species = info->selected_species;
-                vdatadup->selected_col = info->selected_col;
-                vdatadup->selected_row = info->selected_row;
-                vdatadup->selected_level = info->selected_level;
-                vdatadup->col_min = info->col_min;     /*SRT added 961025 prevents crash*/
-                vdatadup->col_max = info->col_max;     /*SRT added 961025 prevents crash*/
-                vdatadup->row_min = info->row_min;     /*SRT added 961025 prevents crash*/
-                vdatadup->row_max = info->row_max;     /*SRT added 961025 prevents crash*/
-                vdatadup->level_min = info->level_min; /*SRT added 961025 prevents crash*/
-                vdatadup->level_max = info->level_max; /*SRT added 961025 prevents crash*/
-                vdatadup->step_min=smin;
-                vdatadup->step_max=smax;
-                nfloats = ( vdatadup->col_max-vdatadup->col_min+1 ) *
-                          ( vdatadup->row_max-vdatadup->row_min+1 ) *
-                          ( vdatadup->level_max-vdatadup->level_min+1 ) *
+                    if ( member.sdate ) free ( member.sdate );
+                    if ( member.stime ) free ( member.stime );
+                    sprintf ( message, "malloc failure in get_data_local!" );
+                    return FAILURE;
+                    }
+                memcpy ( member.sdate, vdata->sdate, vdata->nstep*sizeof ( int ) );
+                memcpy ( member.stime, vdata->stime, vdata->nstep*sizeof ( int ) );
+
+                member.slice = info->slice;
+                member.selected_species = info->selected_species;
+                member.selected_col = info->selected_col;
+                member.selected_row = info->selected_row;
+                member.selected_level = info->selected_level;
+                member.col_min = info->col_min;     /*SRT added 961025 prevents crash*/
+                member.col_max = info->col_max;     /*SRT added 961025 prevents crash*/
+                member.row_min = info->row_min;     /*SRT added 961025 prevents crash*/
+                member.row_max = info->row_max;     /*SRT added 961025 prevents crash*/
+                member.level_min = info->level_min; /*SRT added 961025 prevents crash*/
+                member.level_max = info->level_max; /*SRT added 961025 prevents crash*/
+                member.step_min=smin;
+                member.step_max=smax;
+                nfloats = ( member.col_max-member.col_min+1 ) *
+                          ( member.row_max-member.row_min+1 ) *
+                          ( member.level_max-member.level_min+1 ) *
                           ( smax-smin+1 );
 
-                ret = get_data_local1 ( vdatadup, message );
-                memcpy ( info->grid+n, vdatadup->grid, ( size_t ) ( nfloats*sizeof ( float ) ) );
+                member.grid_dest   = info->grid+n;
+                member.grid_dest_n = nfloats;
+                ret = get_data_local1 ( &member, message );
+
+                /* a reader that did not use the destination (or a read-ahead hit) */
+                if ( member.grid && member.grid != info->grid+n )
+                    {
+                    memcpy ( info->grid+n, member.grid, ( size_t ) ( nfloats*sizeof ( float ) ) );
+                    spill_release ( member.grid );
+                    }
                 n += nfloats;
                 for ( i=0; i<=smax-smin; i++ )
                     {
-                    *sdate++=vdatadup->sdate[i];
-                    *stime++=vdatadup->stime[i];
+                    *sdate++=member.sdate[i];
+                    *stime++=member.stime[i];
                     }
-                free_vis ( vdatadup );
-                free ( ( char * ) vdatadup );
-                vdatadup= ( VIS_DATA * ) NULL;
+                if ( member.sdate ) free ( member.sdate );
+                if ( member.stime ) free ( member.stime );
                 }
             step_min -= vdata->nstep;
             step_max -= vdata->nstep;
@@ -503,25 +583,34 @@ int get_data_local ( VIS_DATA *info, char *message )
         }
     else
         {
+        info->grid = NULL;     /* the reader allocates it */
         ret = get_data_local1 ( info, message );
+        if ( ret ) planesum_record ( info );
         }
-    if ( vdatadup )             /* added 960919 SRT for memory management */
-        {
-        /* added 960919 SRT for memory management */
-        free_vis ( vdatadup );       /* added 960919 SRT for memory management */
-        free ( ( char * ) vdatadup ); /* added 960920 SRT for memory management */
-        vdatadup = ( VIS_DATA * ) NULL; /* added 960919 SRT for memory management */
-        }                /* added 960919 SRT for memory management */
     return ret;
     }
 
 
+/* single-step slices may already have been read ahead (from readers
+   that read just the slice);  the readers themselves are not
+   reentrant, so they run under readahead_lock() */
 int get_data_local1 ( VIS_DATA *info, char *message )
     {
-    int fd;
-    FILE *mfp;
     int ret;
-    TOPLATS_INFO tinfo;
+
+    if ( ( reader_caps ( info->filename ) & READER_HYPERSLAB ) &&
+            readahead_fetch ( info, message, get_data_local2 ) )
+        return PAVE_SUCCESS;
+    readahead_lock();
+    ret = get_data_local2 ( info, message );
+    readahead_unlock();
+    return ret;
+    }
+
+
+static int get_data_local2 ( VIS_DATA *info, char *message )
+    {
+    const PaveReader *reader;
 
 #ifdef DIAGNOSTICS
     if ( info ) if ( info->filename ) fprintf ( stderr, "Enter get_data_local1() with '%s'\n",
@@ -529,23 +618,8 @@ int get_data_local1 ( VIS_DATA *info, char *message )
 #endif /* #ifdef DIAGNOSTICS */
 
     fflush ( stdout );
-    if ( alpha_open ( &fd, info, message ) )
-        {
-        ncclose ( fd );
-        return ( alpha_get_data ( info, message ) );
-        }
-    else if ( toplats_open ( &tinfo,info,message ) )
-        {
-        return toplats_get_data ( &tinfo,info,message );
-        }
-    else if ( uamv_open ( info, message ) )
-        {
-        return ( uamv_get_data ( info, message ) );
-        }
-    else if ( uam_open ( info, message ) )
-        {
-        return ( uam_get_data ( info, message ) );
-        }
-    return FAILURE;
+    if ( ( reader = reader_find ( info, message ) ) == NULL )
+        return FAILURE;
+    return reader->get_data ( info, message );
     }
 
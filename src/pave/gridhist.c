@@ -0,0 +1,351 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridhist.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Histograms and quantiles;  see gridhist.h.
+ *
+ *  The t-digest uses the k1 scale function,
+ *      k(q) = delta / ( 2 pi ) * asin ( 2q - 1 ),
+ *  and a centroid may grow only while it spans at most one unit of k,
+ *  so that there are at most about delta of them.  A merge sorts the
+ *  buffered values, merges them with the (sorted) centroids into the
+ *  scratch space after the centroids, and sweeps the result back.
+ *
+ *  gridhist_vdata() splits the (step,layer) planes into at most
+ *  GRIDHIST_NBLOCK contiguous blocks, each with its own GridHist, and
+ *  merges those in block order.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "domainmask.h"
+#include "gridhist.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define GRIDHIST_NBLOCK (64)        /* partials per gridhist_vdata() */
+#define GRIDHIST_PAR    (65536)     /* fewer values than this:  serial */
+
+#ifndef M_PI
+#define M_PI            (3.14159265358979323846)
+#endif
+
+
+static int float_compare ( const void *a, const void *b )
+    {
+    float x = *( const float * ) a,
+          y = *( const float * ) b;
+
+    return ( x < y ) ? -1 : ( x > y );
+    }
+
+
+static double k_scale ( double q )
+    {
+    return GRIDHIST_DELTA / ( 2.0 * M_PI ) * asin ( 2.0 * q - 1.0 );
+    }
+
+
+static double k_inverse ( double k )
+    {
+    double x = 2.0 * M_PI * k / GRIDHIST_DELTA;
+
+    return ( x >= 0.5 * M_PI ) ? 1.0 : 0.5 * ( sin ( x ) + 1.0 );
+    }
+
+
+/* sweeps the sorted s[0..m-1] into h's centroids */
+
+static void sweep ( GridHist *h, const HistCentroid *s, int m )
+    {
+    HistCentroid cur;
+    double       total = 0.0, sofar = 0.0, limit;
+    int          i, out = 0;
+
+    for ( i = 0; i < m; i++ ) total += s[i].weight;
+    limit = total * k_inverse ( k_scale ( 0.0 ) + 1.0 );
+    cur   = s[0];
+    for ( i = 1; i < m; i++ )
+        {
+        if ( sofar + cur.weight + s[i].weight <= limit )
+            {
+            cur.weight += s[i].weight;
+            cur.mean   += ( s[i].mean - cur.mean ) * s[i].weight / cur.weight;
+            }
+        else
+            {
+            sofar += cur.weight;
+            h->cent[out++] = cur;
+            limit = total * k_inverse ( k_scale ( sofar / total ) + 1.0 );
+            cur   = s[i];
+            }
+        }
+    h->cent[out++] = cur;
+    h->ncent = out;
+    }
+
+
+/* merges the buffered values into the centroids */
+
+static void flush ( GridHist *h )
+    {
+    HistCentroid *s = h->cent + GRIDHIST_MAXCENT;
+    int           i = 0, j = 0, m = 0;
+
+    if ( !h->nbuf ) return;
+    qsort ( h->buf, h->nbuf, sizeof ( float ), float_compare );
+    while ( i < h->ncent || j < h->nbuf )
+        {
+        if ( j == h->nbuf || ( i < h->ncent && h->cent[i].mean <= h->buf[j] ) )
+            s[m++] = h->cent[i++];
+        else
+            {
+            s[m].mean     = h->buf[j++];
+            s[m++].weight = 1.0;
+            }
+        }
+    h->nbuf = 0;
+    sweep ( h, s, m );
+    }
+
+
+int gridhist_init ( GridHist *h, int nbins, float lo, float hi )
+    {
+    memset ( h, 0, sizeof ( GridHist ) );
+    if ( nbins <= 0 )
+        return FAILURE;
+    h->nbins = nbins;
+    h->lo    = lo;
+    h->hi    = hi;
+    h->count = ( long * ) calloc ( nbins, sizeof ( long ) );
+    h->cent  = ( HistCentroid * ) malloc ( ( 2*GRIDHIST_MAXCENT + GRIDHIST_BUFSIZE ) * sizeof ( HistCentroid ) );
+    h->buf   = ( float * ) malloc ( GRIDHIST_BUFSIZE * sizeof ( float ) );
+    if ( !h->count || !h->cent || !h->buf )
+        {
+        gridhist_free ( h );
+        return FAILURE;
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+void gridhist_range ( GridHist *h, float lo, float hi )
+    {
+    h->lo = lo;
+    h->hi = hi;
+    }
+
+
+void gridhist_add ( GridHist *h, const float *v, long len )
+    {
+    long   i;
+    int    b, binned = ( h->hi > h->lo );
+    double scale = binned ? h->nbins / ( ( double ) h->hi - h->lo ) : 0.0;
+
+    for ( i = 0; i < len; i++ )
+        {
+        if ( isnan ( v[i] ) ) continue;
+        if ( binned )
+            {
+            if ( v[i] < h->lo )
+                h->under++;
+            else if ( v[i] > h->hi )
+                h->over++;
+            else
+                {
+                b = ( int ) ( ( v[i] - h->lo ) * scale );
+                h->count[b < h->nbins ? b : h->nbins - 1]++;
+                }
+            }
+        if ( !h->n || v[i] < h->min ) h->min = v[i];
+        if ( !h->n || v[i] > h->max ) h->max = v[i];
+        h->n++;
+        h->buf[h->nbuf++] = v[i];
+        if ( h->nbuf == GRIDHIST_BUFSIZE ) flush ( h );
+        }
+    }
+
+
+void gridhist_merge ( GridHist *a, GridHist *b )
+    {
+    HistCentroid *s = a->cent + GRIDHIST_MAXCENT;
+    int           i = 0, j = 0, m = 0;
+
+    if ( b->n == 0 )
+        return;
+    flush ( a );
+    flush ( b );
+    for ( i = 0; i < a->nbins && i < b->nbins; i++ )
+        a->count[i] += b->count[i];
+    a->under += b->under;
+    a->over  += b->over;
+    if ( !a->n || b->min < a->min ) a->min = b->min;
+    if ( !a->n || b->max > a->max ) a->max = b->max;
+    a->n += b->n;
+
+    i = 0;
+    while ( i < a->ncent || j < b->ncent )
+        {
+        if ( j == b->ncent || ( i < a->ncent && a->cent[i].mean <= b->cent[j].mean ) )
+            s[m++] = a->cent[i++];
+        else
+            s[m++] = b->cent[j++];
+        }
+    sweep ( a, s, m );
+    }
+
+
+float gridhist_quantile ( GridHist *h, double q )
+    {
+    const HistCentroid *c;
+    double index, cum, dw, x;
+    int    i, last;
+
+    if ( !h->n ) return NAN;
+    if ( q <= 0.0 ) return h->min;
+    if ( q >= 1.0 ) return h->max;
+    flush ( h );
+
+    /* interpolate between the centroids' centers, and from the extremes
+       to the outermost centers */
+    c     = h->cent;
+    last  = h->ncent - 1;
+    index = q * ( double ) h->n;
+    if ( index < 0.5 * c[0].weight )
+        x = h->min + ( c[0].mean - h->min ) * index / ( 0.5 * c[0].weight );
+    else
+        {
+        cum = 0.5 * c[0].weight;
+        for ( i = 0; i < last; i++, cum += dw )
+            {
+            dw = 0.5 * ( c[i].weight + c[i+1].weight );
+            if ( index < cum + dw ) break;
+            }
+        if ( i < last )
+            x = c[i].mean + ( c[i+1].mean - c[i].mean ) * ( index - cum ) / dw;
+        else
+            x = c[last].mean + ( h->max - c[last].mean ) * ( index - cum ) / ( 0.5 * c[last].weight );
+        }
+    if ( x < h->min ) x = h->min;
+    if ( x > h->max ) x = h->max;
+    return ( float ) x;
+    }
+
+
+void gridhist_free ( GridHist *h )
+    {
+    if ( h->count ) free ( h->count );
+    if ( h->cent  ) free ( h->cent );
+    if ( h->buf   ) free ( h->buf );
+    memset ( h, 0, sizeof ( GridHist ) );
+    }
+
+
+int gridhist_vdata ( GridHist *h, const VIS_DATA *vdata, const char *percents,
+                     const int *layers, int step, char *message )
+    {
+    DomainMask mask;
+    GridHist  *part;
+    long       ij, nijk, off;
+    int        IMAX, JMAX, KMAX, nsteps, tmin, tmax, nplane, nblk, b, p, t, k, r;
+    float      lo, hi;
+
+    if ( ( vdata == NULL ) || ( vdata->grid == NULL ) || ( percents == NULL ) )
+        {
+        sprintf ( message, "gridhist_vdata:  no data" );
+        return FAILURE;
+        }
+    if ( ( vdata->slice == XYTSLICE ) || ( vdata->slice == YZTSLICE ) ||
+         ( vdata->slice == XZTSLICE ) || ( vdata->slice == XYZTSLICE ) )
+        nsteps = vdata->step_max - vdata->step_min + 1;
+    else
+        nsteps = 1;
+    if ( step >= nsteps )
+        {
+        sprintf ( message, "gridhist_vdata:  bad step %d", step );
+        return FAILURE;
+        }
+    tmin = ( step >= 0 ) ? step : 0;
+    tmax = ( step >= 0 ) ? step : nsteps - 1;
+
+    IMAX = vdata->col_max - vdata->col_min + 1;
+    JMAX = vdata->row_max - vdata->row_min + 1;
+    KMAX = vdata->level_max - vdata->level_min + 1;
+    ij   = ( long ) IMAX * JMAX;
+    nijk = ij * KMAX;
+
+    if ( !( h->hi > h->lo ) )
+        {
+        lo = vdata->grid_min;
+        hi = vdata->grid_max;
+        gridhist_range ( h, lo, ( hi > lo ) ? hi : lo + 1.0f );
+        }
+
+    if ( !domainmask_build ( &mask, percents, IMAX, JMAX ) )
+        {
+        sprintf ( message, "gridhist_vdata:  domain-mask allocation failure" );
+        return FAILURE;
+        }
+    nplane = ( tmax - tmin + 1 ) * KMAX;
+    nblk   = ( nplane < GRIDHIST_NBLOCK ) ? nplane : GRIDHIST_NBLOCK;
+    if ( ( part = ( GridHist * ) calloc ( nblk, sizeof ( GridHist ) ) ) == NULL )
+        {
+        domainmask_free ( &mask );
+        sprintf ( message, "gridhist_vdata:  allocation failure" );
+        return FAILURE;
+        }
+    for ( b = 0; b < nblk; b++ )
+        if ( !gridhist_init ( part + b, h->nbins, h->lo, h->hi ) )
+            {
+            while ( b >= 0 ) gridhist_free ( part + b-- );
+            free ( part );
+            domainmask_free ( &mask );
+            sprintf ( message, "gridhist_vdata:  allocation failure" );
+            return FAILURE;
+            }
+
+#pragma omp parallel for schedule(dynamic) private(p, t, k, r, off) if ( mask.ncells*(long)nplane > GRIDHIST_PAR )
+    for ( b = 0; b < nblk; b++ )
+        for ( p = ( int ) ( ( long ) b * nplane / nblk );
+              p < ( int ) ( ( long ) ( b+1 ) * nplane / nblk ); p++ )
+            {
+            t = tmin + p / KMAX;
+            k = p % KMAX;
+            if ( layers && !layers[k] ) continue;
+            for ( r = 0; r < mask.nrun; r++ )
+                {
+                off = mask.run[r].col0 + ( long ) mask.run[r].row * IMAX + k * ij + t * nijk;
+                gridhist_add ( part + b, vdata->grid + off,
+                               mask.run[r].col1 - mask.run[r].col0 + 1 );
+                }
+            }
+
+    for ( b = 0; b < nblk; b++ )
+        {
+        gridhist_merge ( h, part + b );
+        gridhist_free ( part + b );
+        }
+    free ( part );
+    domainmask_free ( &mask );
+    return PAVE_SUCCESS;
+    }
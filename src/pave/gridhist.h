@@ -0,0 +1,101 @@
+#ifndef GRIDHIST_H
+#define GRIDHIST_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridhist.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Distributions of float data:  a fixed-bin histogram and approximate
+ *  quantiles, together, in one pass.
+ *
+ *  A GridHist counts the non-missing values it is given into nbins
+ *  equal bins over [lo, hi] (with the values outside counted apart), and
+ *  summarizes them in a merging t-digest (Dunning and Ertl):  at most
+ *  about GRIDHIST_DELTA weighted centroids, small ones near both tails
+ *  and large ones in the middle, so that the 2nd or 98th percentile of
+ *  millions of values is found to a small fraction of a percent of the
+ *  rank.  Values are buffered and merged into the centroids a buffer at
+ *  a time.  Digests merge like the counts do, so that partials computed
+ *  separately -- per block of planes, by different threads -- combine;
+ *  merged in a fixed order, they give the same answer whatever the
+ *  number of threads.
+ *
+ *  gridhist_vdata() does that for a formula result, over the cells of a
+ *  domain mask and a range of layers and steps, as calc_stats() does its
+ *  statistics.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define GRIDHIST_DELTA      (200)   /* t-digest compression */
+#define GRIDHIST_MAXCENT    (GRIDHIST_DELTA+8)
+#define GRIDHIST_BUFSIZE    (4096)  /* values buffered between merges */
+
+typedef struct
+    {
+    double  mean;
+    double  weight;
+    } HistCentroid;
+
+typedef struct
+    {
+    int           nbins;
+    float         lo, hi;       /* bins' range;  lo >= hi:  not yet set */
+    long         *count;        /* [nbins] */
+    long          under, over;  /* values below lo, above hi */
+    long          n;            /* non-missing values */
+    float         min, max;
+    int           ncent;
+    HistCentroid *cent;         /* [2*GRIDHIST_MAXCENT+GRIDHIST_BUFSIZE]:
+                                   ncent centroids, then scratch */
+    int           nbuf;
+    float        *buf;          /* [GRIDHIST_BUFSIZE] */
+    } GridHist;
+
+/* sets up an empty GridHist with nbins bins over [lo, hi] (to be set by
+   gridhist_range(), if lo >= hi):  PAVE_SUCCESS, or FAILURE (no memory) */
+int gridhist_init ( GridHist *h, int nbins, float lo, float hi );
+
+/* sets the range of the bins of an empty GridHist */
+void gridhist_range ( GridHist *h, float lo, float hi );
+
+/* adds v[0..len-1], skipping NaNs */
+void gridhist_add ( GridHist *h, const float *v, long len );
+
+/* merges b (same bins) into a */
+void gridhist_merge ( GridHist *a, GridHist *b );
+
+/* the q-quantile (0 <= q <= 1) of the values added, or NaN if none */
+float gridhist_quantile ( GridHist *h, double q );
+
+void gridhist_free ( GridHist *h );
+
+/* adds the values of vdata's grid at the cells with percents[i+j*IMAX]
+   non-zero (windowed as for calc_stats()), on the layers k with
+   layers[k] non-zero (all, if layers is NULL), and for step (0-based,
+   among vdata's steps), or all steps if step < 0.  If h's range is not
+   yet set, it is set to vdata's [grid_min, grid_max].  PAVE_SUCCESS, or
+   FAILURE with an error string written into message */
+int gridhist_vdata ( GridHist *h, const VIS_DATA *vdata, const char *percents,
+                     const int *layers, int step, char *message );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* GRIDHIST_H */
@@ -0,0 +1,279 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridpack.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Compact storage for display-only data grids;  see gridpack.h.
+ *
+ *  Half-precision values are converted in software (round to nearest
+ *  even) and decoded through one shared 65536-entry table;  8-bit
+ *  codes through a 256-entry table per pack.  16-bit quantized codes
+ *  are decoded arithmetically, since the table would be as large as
+ *  many grids.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  "half" falls back on
+ *          16-bit codes for nonzero values below the normal range too
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "gridpack.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define HALF_MAX        (65504.0f)
+#define HALF_MIN        (6.103515625e-05f)  /* smallest normal half, 2**-14 */
+#define Q16_MISSING     (0xFFFF)
+#define Q8_MISSING      (0xFF)
+
+typedef unsigned short  Code16;
+typedef unsigned char   Code8;
+
+static float          halfTable[65536];
+static pthread_once_t halfOnce = PTHREAD_ONCE_INIT;
+
+
+/* ------------------------- half precision ------------------------ */
+
+static unsigned short float_to_half ( float f )
+    {
+    unsigned int   x, mant, rem, half_way, shift;
+    unsigned short sign, h;
+    int            e;
+
+    memcpy ( &x, &f, sizeof ( x ) );
+    sign = ( x >> 16 ) & 0x8000;
+    mant = x & 0x007FFFFF;
+    e    = ( int ) ( ( x >> 23 ) & 0xFF );
+
+    if ( e == 0xFF )                            /* Inf, NaN */
+        return sign | 0x7C00 | ( mant ? 0x0200 : 0 );
+    e = e - 127 + 15;
+    if ( e >= 31 )                              /* overflow */
+        return sign | 0x7C00;
+    if ( e <= 0 )                               /* subnormal, or zero */
+        {
+        if ( e < -10 )
+            return sign;
+        mant    |= 0x00800000;
+        shift    = ( unsigned int ) ( 14 - e );
+        h        = ( unsigned short ) ( mant >> shift );
+        rem      = mant & ( ( 1u << shift ) - 1 );
+        half_way = 1u << ( shift - 1 );
+        if ( rem > half_way || ( rem == half_way && ( h & 1 ) ) )
+            h++;
+        return sign | h;
+        }
+    h   = ( unsigned short ) ( ( e << 10 ) | ( mant >> 13 ) );
+    rem = mant & 0x1FFF;
+    if ( rem > 0x1000 || ( rem == 0x1000 && ( h & 1 ) ) )
+        h++;                                    /* may carry into Inf */
+    return sign | h;
+    }
+
+static float half_to_float ( unsigned short h )
+    {
+    unsigned int sign = ( unsigned int ) ( h & 0x8000 ) << 16,
+                 e    = ( h >> 10 ) & 0x1F,
+                 mant = h & 0x03FF,
+                 x;
+    int          s;
+    float        f;
+
+    if ( e == 0 && mant == 0 )
+        x = sign;
+    else if ( e == 0 )                          /* subnormal:  normalize */
+        {
+        for ( s = -1; !( mant & 0x0400 ); s++ )
+            mant <<= 1;
+        x = sign | ( ( unsigned int ) ( 112 - s ) << 23 ) | ( ( mant & 0x03FF ) << 13 );
+        }
+    else if ( e == 31 )
+        x = sign | 0x7F800000 | ( mant << 13 );
+    else
+        x = sign | ( ( e + 112 ) << 23 ) | ( mant << 13 );
+    memcpy ( &f, &x, sizeof ( f ) );
+    return f;
+    }
+
+static void init_half_table ( void )
+    {
+    unsigned int i;
+
+    for ( i = 0; i < 65536; i++ )
+        halfTable[i] = half_to_float ( ( unsigned short ) i );
+    }
+
+
+/* --------------------------- quantized --------------------------- */
+
+static unsigned int quantize ( const GridPack *pack, float v, unsigned int missing )
+    {
+    double q;
+
+    if ( !isfinite ( v ) )
+        return missing;
+    if ( pack->scale <= 0.0f )
+        return 0;
+    q = ( ( double ) v - pack->lo ) / pack->scale + 0.5;
+    if ( q < 0.0 ) return 0;
+    if ( q > missing - 1 ) return missing - 1;
+    return ( unsigned int ) q;
+    }
+
+static float dequantize ( const GridPack *pack, unsigned int c, unsigned int missing )
+    {
+    if ( c == missing )
+        return NAN;
+    if ( c == missing - 1 )                     /* so that hi is exact */
+        return pack->hi;
+    return pack->lo + ( float ) c * pack->scale;
+    }
+
+
+/* ----------------------------- API ------------------------------- */
+
+int gridpack_mode ( void )
+    {
+    char *env = getenv ( GRIDPACK_ENV );
+
+    if ( env == NULL )                  return GRIDPACK_NONE;
+    if ( !strcasecmp ( env, "half" ) )  return GRIDPACK_HALF;
+    if ( !strcmp ( env, "16" ) )        return GRIDPACK_Q16;
+    if ( !strcmp ( env, "8" ) )         return GRIDPACK_Q8;
+    return GRIDPACK_NONE;
+    }
+
+int gridpack_encode ( GridPack *pack, const float *grid, size_t n, int mode )
+    {
+    size_t       i;
+    int          set = 0;
+    float        tiny = 0.0f;               /* smallest nonzero |value| */
+    unsigned int c, missing;
+    Code16      *c16;
+    Code8       *c8;
+
+    memset ( pack, 0, sizeof ( GridPack ) );
+    if ( grid == NULL || n == 0 || mode == GRIDPACK_NONE )
+        return FAILURE;
+
+    for ( i = 0; i < n; i++ )
+        if ( isfinite ( grid[i] ) )
+            {
+            if ( !set || grid[i] < pack->lo ) pack->lo = grid[i];
+            if ( !set || grid[i] > pack->hi ) pack->hi = grid[i];
+            if ( grid[i] != 0.0f && ( tiny == 0.0f || fabsf ( grid[i] ) < tiny ) )
+                tiny = fabsf ( grid[i] );
+            set = 1;
+            }
+    if ( mode == GRIDPACK_HALF && ( pack->lo < -HALF_MAX || pack->hi > HALF_MAX ) )
+        {
+        fprintf ( stderr, "Data range [%g,%g] exceeds half precision:  using 16-bit codes\n",
+                  pack->lo, pack->hi );
+        mode = GRIDPACK_Q16;
+        }
+    else if ( mode == GRIDPACK_HALF && tiny != 0.0f && tiny < HALF_MIN )
+        {
+        fprintf ( stderr, "Data value %g is below the half-precision normal range:  using 16-bit codes\n",
+                  tiny );
+        mode = GRIDPACK_Q16;
+        }
+
+    pack->n    = n;
+    pack->mode = mode;
+    if ( mode == GRIDPACK_Q8 )
+        {
+        missing      = Q8_MISSING;
+        pack->scale  = ( pack->hi - pack->lo ) / ( float ) ( missing - 1 );
+        pack->codes  = malloc ( n * sizeof ( Code8 ) );
+        pack->table  = ( float * ) malloc ( ( missing + 1 ) * sizeof ( float ) );
+        if ( pack->codes == NULL || pack->table == NULL )
+            {
+            gridpack_free ( pack );
+            return FAILURE;
+            }
+        for ( c = 0; c <= missing; c++ )
+            pack->table[c] = dequantize ( pack, c, missing );
+        c8 = ( Code8 * ) pack->codes;
+        for ( i = 0; i < n; i++ )
+            c8[i] = ( Code8 ) quantize ( pack, grid[i], missing );
+        return PAVE_SUCCESS;
+        }
+
+    if ( ( pack->codes = malloc ( n * sizeof ( Code16 ) ) ) == NULL )
+        {
+        gridpack_free ( pack );
+        return FAILURE;
+        }
+    c16 = ( Code16 * ) pack->codes;
+    if ( mode == GRIDPACK_HALF )
+        {
+        pthread_once ( &halfOnce, init_half_table );
+        for ( i = 0; i < n; i++ )
+            c16[i] = float_to_half ( grid[i] );
+        }
+    else
+        {
+        pack->scale = ( pack->hi - pack->lo ) / ( float ) ( Q16_MISSING - 1 );
+        for ( i = 0; i < n; i++ )
+            c16[i] = ( Code16 ) quantize ( pack, grid[i], Q16_MISSING );
+        }
+    return PAVE_SUCCESS;
+    }
+
+float gridpack_value ( const GridPack *pack, size_t i )
+    {
+    switch ( pack->mode )
+        {
+        case GRIDPACK_HALF:
+            return halfTable[ ( ( const Code16 * ) pack->codes ) [i] ];
+        case GRIDPACK_Q16:
+            return dequantize ( pack, ( ( const Code16 * ) pack->codes ) [i], Q16_MISSING );
+        case GRIDPACK_Q8:
+            return pack->table[ ( ( const Code8 * ) pack->codes ) [i] ];
+        default:
+            return NAN;
+        }
+    }
+
+float gridpack_round ( const GridPack *pack, float v )
+    {
+    switch ( pack->mode )
+        {
+        case GRIDPACK_HALF:
+            return halfTable[ float_to_half ( v ) ];
+        case GRIDPACK_Q16:
+            return dequantize ( pack, quantize ( pack, v, Q16_MISSING ), Q16_MISSING );
+        case GRIDPACK_Q8:
+            return pack->table[ quantize ( pack, v, Q8_MISSING ) ];
+        default:
+            return v;
+        }
+    }
+
+void gridpack_free ( GridPack *pack )
+    {
+    if ( pack->codes ) free ( pack->codes );
+    if ( pack->table ) free ( pack->table );
+    memset ( pack, 0, sizeof ( GridPack ) );
+    }
@@ -0,0 +1,81 @@
+#ifndef GRIDPACK_H
+#define GRIDPACK_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridpack.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Compact storage for display-only data grids.
+ *
+ *  Every tile-plot window keeps the full float grid of its plot, all
+ *  time steps, for as long as it is open.  With PAVE_COMPACT_GRID set,
+ *  ReadVisData::compactGrid() replaces that grid by a GridPack of
+ *
+ *      "half"  IEEE 16-bit floats (falling back on "16" for data out
+ *              of the half-precision range, or with nonzero values
+ *              below its normal range, about 6.1e-5, where half
+ *              precision loses its significant digits),
+ *      "16"    16-bit codes, quantized over the data's range, or
+ *      "8"     8-bit codes, quantized likewise,
+ *
+ *  halving (or quartering) the window's memory.  Values are decoded on
+ *  access by gridpack_value().  In the quantized forms the top code is
+ *  the missing-value (NaN) sentinel, and the smallest and largest
+ *  values of the grid decode exactly, so the plot's min and max are
+ *  unchanged.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define GRIDPACK_ENV    "PAVE_COMPACT_GRID"
+
+#define GRIDPACK_NONE   (0)
+#define GRIDPACK_HALF   (1)
+#define GRIDPACK_Q16    (2)
+#define GRIDPACK_Q8     (3)
+
+typedef struct
+    {
+    int     mode;       /* GRIDPACK_NONE if empty */
+    size_t  n;
+    float   lo, hi;     /* range of the (non-missing) data */
+    float   scale;      /* quantization step */
+    void   *codes;      /* n codes of 1 or 2 bytes */
+    float  *table;      /* code -> value, for GRIDPACK_Q8 */
+    } GridPack;
+
+/* the mode requested by PAVE_COMPACT_GRID, or GRIDPACK_NONE */
+int gridpack_mode ( void );
+
+/* packs grid[0..n-1]:  PAVE_SUCCESS, or FAILURE (pack left empty) */
+int gridpack_encode ( GridPack *pack, const float *grid, size_t n, int mode );
+
+/* the value of element i */
+float gridpack_value ( const GridPack *pack, size_t i );
+
+/* v, as it would read back from pack */
+float gridpack_round ( const GridPack *pack, float v );
+
+/* frees the codes, leaving pack empty */
+void gridpack_free ( GridPack *pack );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* GRIDPACK_H */
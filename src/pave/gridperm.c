@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridperm.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Axis permutation of VIS_DATA grids;  see gridperm.h.
+ *
+ *  Output axis q is input axis 0 (the input's contiguous one);  r and s
+ *  are the remaining outer axes of the output.  A strip is one tile-row
+ *  (GRIDPERM_TILE values of axis q) at one (r, s):  its tiles are copied
+ *  in turn along output axis 0, each reading GRIDPERM_TILE short
+ *  contiguous input runs and writing GRIDPERM_TILE short contiguous
+ *  output runs, all of which stay in cache for the tile's duration.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gridperm.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define GRIDPERM_PAR    (65536)     /* fewer values than this:  serial */
+
+
+int gridperm_valid ( const int perm[4] )
+    {
+    int a, seen = 0;
+
+    for ( a = 0; a < 4; a++ )
+        {
+        if ( ( perm[a] < 0 ) || ( perm[a] > 3 ) || ( seen & ( 1 << perm[a] ) ) )
+            return FAILURE;
+        seen |= 1 << perm[a];
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+void gridperm ( const float *in, float *out, const int dims[4],
+                const int perm[4] )
+    {
+    long istr[4], sstr[4], ostr[4], odim[4], total, nq, nstrip, p;
+    int  a, q, r, s;
+
+    istr[0] = 1;
+    for ( a = 1; a < 4; a++ ) istr[a] = istr[a-1] * dims[a-1];
+    for ( a = 0; a < 4; a++ )
+        {
+        odim[a] = dims[perm[a]];
+        sstr[a] = istr[perm[a]];        /* input stride along output axis a */
+        }
+    ostr[0] = 1;
+    for ( a = 1; a < 4; a++ ) ostr[a] = ostr[a-1] * odim[a-1];
+    total = ostr[3] * odim[3];
+    if ( total <= 0 ) return;
+
+    for ( q = 0; perm[q] != 0; q++ ) ;
+
+    if ( q == 0 )       /* axis 0 stays put:  its runs are straight copies */
+        {
+        nstrip = odim[1] * odim[2] * odim[3];
+
+#pragma omp parallel for schedule(static) if ( total > GRIDPERM_PAR )
+        for ( p = 0; p < nstrip; p++ )
+            {
+            long i1 = p % odim[1];
+            long i2 = ( p / odim[1] ) % odim[2];
+            long i3 = p / ( odim[1] * odim[2] );
+
+            memcpy ( out + p * odim[0],
+                     in + i1 * sstr[1] + i2 * sstr[2] + i3 * sstr[3],
+                     odim[0] * sizeof ( float ) );
+            }
+        return;
+        }
+
+    r = ( q == 1 ) ? 2 : 1;
+    s = ( q == 3 ) ? 2 : 3;
+    nq     = ( odim[q] + GRIDPERM_TILE - 1 ) / GRIDPERM_TILE;
+    nstrip = nq * odim[r] * odim[s];
+
+#pragma omp parallel for schedule(static) if ( total > GRIDPERM_PAR )
+    for ( p = 0; p < nstrip; p++ )
+        {
+        long         bq = p % nq;
+        long         ir = ( p / nq ) % odim[r];
+        long         is = p / ( nq * odim[r] );
+        long         q0 = bq * GRIDPERM_TILE, q1, b0, b1, iq, i0;
+        const float *ib = in  + ir * sstr[r] + is * sstr[s];
+        float       *ob = out + ir * ostr[r] + is * ostr[s];
+
+        q1 = ( q0 + GRIDPERM_TILE < odim[q] ) ? q0 + GRIDPERM_TILE : odim[q];
+        for ( b0 = 0; b0 < odim[0]; b0 += GRIDPERM_TILE )
+            {
+            b1 = ( b0 + GRIDPERM_TILE < odim[0] ) ? b0 + GRIDPERM_TILE : odim[0];
+            for ( iq = q0; iq < q1; iq++ )
+                {
+                const float *ip = ib + iq;              /* sstr[q] == 1 */
+                float       *op = ob + iq * ostr[q];
+
+                for ( i0 = b0; i0 < b1; i0++ )
+                    op[i0] = ip[i0 * sstr[0]];
+                }
+            }
+        }
+    }
@@ -0,0 +1,58 @@
+#ifndef GRIDPERM_H
+#define GRIDPERM_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridperm.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Axis permutation of VIS_DATA grids.
+ *
+ *  A VIS_DATA grid is stored (col, row, level, step), col fastest;  an
+ *  export format with some other dimension order (DX, for example,
+ *  varies the last position index fastest) needs a copy of the grid
+ *  with its axes reordered.  Done element by element, one side of such
+ *  a copy is a strided sweep through the whole grid, a cache miss per
+ *  value.  gridperm() instead copies GRIDPERM_TILE x GRIDPERM_TILE tiles
+ *  of the two axes that are fastest in the input and in the output, so
+ *  that both sides of every tile stay in cache;  when the fastest axis
+ *  does not move, each run is a straight copy.  The strips of tiles
+ *  (across steps and the other outer axis) are independent, and are
+ *  shared out among the OpenMP threads.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define GRIDPERM_COL    (0)     /* axes of a VIS_DATA grid */
+#define GRIDPERM_ROW    (1)
+#define GRIDPERM_LEVEL  (2)
+#define GRIDPERM_STEP   (3)
+
+#define GRIDPERM_TILE   (32)    /* tile edge, in values */
+
+/* is perm[0..3] a permutation of 0..3? */
+int gridperm_valid ( const int perm[4] );
+
+/* out = in with its axes reordered:  in has extents dims[0..3], axis 0
+   fastest;  axis a of out (axis 0 fastest) is axis perm[a] of in.
+   in and out must not overlap */
+void gridperm ( const float *in, float *out, const int dims[4],
+                const int perm[4] );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* GRIDPERM_H */
@@ -0,0 +1,557 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridprobe.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Batch point extraction;  see gridprobe.h.
+ *
+ *  map_info is parsed as MapServer::generateMap() parses it, with the
+ *  same ellipse and (whole-world) clip corners, so that points land
+ *  where the map overlay and observation sites are drawn.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "MapUtilities.h"
+#include "gridprobe.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define GRIDPROBE_PAR   (65536)     /* fewer samples than this:  serial */
+
+typedef struct
+    {
+    long off;
+    int  pt;
+    } ProbeKey;
+
+
+static int key_compare ( const void *a, const void *b )
+    {
+    const ProbeKey *p = ( const ProbeKey * ) a;
+    const ProbeKey *q = ( const ProbeKey * ) b;
+
+    if ( p->off != q->off ) return ( p->off < q->off ) ? -1 : 1;
+    return p->pt - q->pt;
+    }
+
+
+/* map_info to M3IOParameters, as in MapServer::generateMap() */
+
+static int probe_parameters ( const char *map_info, M3IOParameters *params )
+    {
+    enum { UNUSED = -1 };
+    int    grid_type, ncol, nrow, utm_zone;
+    float  llx, lly, urx, ury, xorig, yorig, xcell,
+           ycell, xcent, ycent, p_gam, p_bet, p_alp;
+
+    memset ( ( void * ) params, 0, sizeof ( M3IOParameters ) );
+    params->corners[LOWER][LAT] =  -90.0;
+    params->corners[LOWER][LON] = -180.0;
+    params->corners[UPPER][LAT] =   90.0;
+    params->corners[UPPER][LON] =  180.0;
+    params->ellipse = MERIT_1983;
+    params->radius  = 0;
+
+    if ( !map_info ) return FAILURE;
+
+    if ( sscanf ( map_info, "%d%g%g%g%g%g%g%g%g%g%d%d",
+                  &grid_type, &xorig, &yorig, &xcell,
+                  &ycell, &xcent, &ycent, &p_gam,
+                  &p_bet, &p_alp, &ncol, &nrow ) == 12 )
+        {
+        params->gdtyp = grid_type;
+        params->p_alp = p_alp;
+        params->p_bet = p_bet;
+        params->p_gam = p_gam;
+        params->xcent = xcent;
+        params->ycent = ycent;
+        params->nrows = nrow;
+        params->ncols = ncol;
+        params->xorig = xorig;
+        params->yorig = yorig;
+        params->xcell = xcell;
+        params->ycell = ycell;
+        }
+    else if ( sscanf ( map_info, "%g%g%g%g%d%d%d",
+                       &llx, &lly, &urx, &ury, &utm_zone, &ncol, &nrow ) == 7 )
+        {
+        if ( ( lly < 90. ) && ( lly>0. ) && ( ury<90. ) && ( ury>0. ) )
+            {
+            params->gdtyp = LATGRD3;
+            params->p_alp = UNUSED;
+            params->xcent = UNUSED;
+            params->ycent = UNUSED;
+            }
+        else
+            {
+            params->gdtyp = UTMGRD3;
+            params->p_alp = utm_zone;
+            params->xcent = 0;
+            params->ycent = 0;
+            }
+        params->p_bet = UNUSED;
+        params->p_gam = UNUSED;
+        params->nrows = nrow;
+        params->ncols = ncol;
+        params->xorig = llx;
+        params->yorig = lly;
+        params->xcell = ( urx-llx ) /ncol;
+        params->ycell = ( ury-lly ) /nrow;
+        }
+    else
+        return FAILURE;
+
+    return ( params->xcell != 0.0 ) && ( params->ycell != 0.0 );
+    }
+
+
+int gridprobe_read ( GridProbe *p, const char *filename, char *message )
+    {
+    FILE   *fp;
+    char    line[1024], name[256];
+    double  x, y;
+    int     n, lineno = 0, cap = 0;
+
+    memset ( ( void * ) p, 0, sizeof ( GridProbe ) );
+    if ( !filename || ! ( fp = fopen ( filename, "r" ) ) )
+        {
+        sprintf ( message, "Couldn't open points file '%s' !",
+                  filename ? filename : "" );
+        return FAILURE;
+        }
+
+    while ( fgets ( line, sizeof ( line ), fp ) )
+        {
+        lineno++;
+        n = sscanf ( line, "%255s %lf %lf", name, &x, &y );
+        if ( ( n <= 0 ) || ( name[0] == '#' ) ) continue;
+        if ( n != 3 )
+            {
+            sprintf ( message, "Bad point at line %d of '%s':  "
+                      "expected <id> <x> <y>", lineno, filename );
+            fclose ( fp );
+            gridprobe_free ( p );
+            return FAILURE;
+            }
+        if ( p->npts == cap )
+            {
+            char   **id;
+            double  *px, *py;
+
+            cap = cap ? 2 * cap : 256;
+            id = ( char ** ) realloc ( p->id, cap * sizeof ( char * ) );
+            if ( id ) p->id = id;
+            px = ( double * ) realloc ( p->x, cap * sizeof ( double ) );
+            if ( px ) p->x = px;
+            py = ( double * ) realloc ( p->y, cap * sizeof ( double ) );
+            if ( py ) p->y = py;
+            if ( !id || !px || !py )
+                {
+                sprintf ( message, "Couldn't allocate %d points for '%s' !",
+                          cap, filename );
+                fclose ( fp );
+                gridprobe_free ( p );
+                return FAILURE;
+                }
+            }
+        if ( ! ( p->id[p->npts] = strdup ( name ) ) )
+            {
+            sprintf ( message, "Couldn't allocate point names for '%s' !", filename );
+            fclose ( fp );
+            gridprobe_free ( p );
+            return FAILURE;
+            }
+        p->x[p->npts] = x;
+        p->y[p->npts] = y;
+        p->npts++;
+        }
+    fclose ( fp );
+
+    if ( !p->npts )
+        {
+        sprintf ( message, "No points in '%s' !", filename );
+        return FAILURE;
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+int gridprobe_project ( const char *map_info, long n, const double *lon,
+                        const double *lat, double *col, double *row,
+                        char *message )
+    {
+    M3IOParameters params;
+    MapProjection  mapProjection;
+    double         origx, origy, x, y;
+    long           i;
+
+    if ( !probe_parameters ( map_info, &params ) )
+        {
+        sprintf ( message, "Can't locate points:  unrecognized map_info '%s'",
+                  map_info ? map_info : "" );
+        return FAILURE;
+        }
+
+    if ( params.gdtyp == LATGRD3 )      /* lon, lat are already grid coordinates */
+        {
+        for ( i = 0; i < n; i++ )
+            {
+            col[i] = ( lon[i] - params.xorig ) / params.xcell + 0.5;
+            row[i] = ( lat[i] - params.yorig ) / params.ycell + 0.5;
+            }
+        return PAVE_SUCCESS;
+        }
+
+    createMapProjection ( &params, &mapProjection );
+    if ( !computeProjectedGridOrigin ( &params, &origx, &origy ) ||
+            !setMapProjection ( &mapProjection ) )
+        {
+        sprintf ( message, "Can't locate points:  bad projection for map_info '%s'",
+                  map_info );
+        return FAILURE;
+        }
+
+    for ( i = 0; i < n; i++ )
+        {
+        projectLatLon ( lat[i], lon[i], &x, &y );
+        col[i] = ( x - origx ) / params.xcell + 0.5;
+        row[i] = ( y - origy ) / params.ycell + 0.5;
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+int gridprobe_unproject ( const char *map_info, long n, const double *col,
+                          const double *row, double *lon, double *lat,
+                          char *message )
+    {
+    M3IOParameters params;
+    MapProjection  mapProjection;
+    double         origx, origy;
+    long           i;
+
+    if ( !probe_parameters ( map_info, &params ) )
+        {
+        sprintf ( message, "Can't locate cells:  unrecognized map_info '%s'",
+                  map_info ? map_info : "" );
+        return FAILURE;
+        }
+
+    if ( params.gdtyp == LATGRD3 )
+        {
+        for ( i = 0; i < n; i++ )
+            {
+            lon[i] = params.xorig + ( col[i] - 0.5 ) * params.xcell;
+            lat[i] = params.yorig + ( row[i] - 0.5 ) * params.ycell;
+            }
+        return PAVE_SUCCESS;
+        }
+
+    createMapProjection ( &params, &mapProjection );
+    if ( !computeProjectedGridOrigin ( &params, &origx, &origy ) ||
+            !isMapProjectionInvertible ( &mapProjection ) ||
+            !setMapProjection ( &mapProjection ) )
+        {
+        sprintf ( message, "Can't locate cells:  bad projection for map_info '%s'",
+                  map_info );
+        return FAILURE;
+        }
+
+    for ( i = 0; i < n; i++ )
+        {
+        projectXY ( origx + ( col[i] - 0.5 ) * params.xcell,
+                    origy + ( row[i] - 0.5 ) * params.ycell,
+                    lat + i, lon + i );
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+int gridprobe_locate ( GridProbe *p, const char *map_info, int coords,
+                       char *message )
+    {
+    free ( p->col );
+    free ( p->row );
+    p->col = ( double * ) malloc ( p->npts * sizeof ( double ) );
+    p->row = ( double * ) malloc ( p->npts * sizeof ( double ) );
+    if ( !p->col || !p->row )
+        {
+        sprintf ( message, "Couldn't allocate %d point locations !", p->npts );
+        return FAILURE;
+        }
+
+    if ( coords == GRIDPROBE_COLROW )
+        {
+        memcpy ( p->col, p->x, p->npts * sizeof ( double ) );
+        memcpy ( p->row, p->y, p->npts * sizeof ( double ) );
+        return PAVE_SUCCESS;
+        }
+
+    return gridprobe_project ( map_info, p->npts, p->x, p->y,
+                               p->col, p->row, message );
+    }
+
+
+int gridprobe_plan ( GridProbe *p, const VIS_DATA *vdata, int method,
+                     char *message )
+    {
+    ProbeKey *key;
+    int       ni, nj, i, m, ic, jr, i0, j0, i1, j1;
+    double    fx, fy, tx, ty;
+
+    ni = vdata->col_max - vdata->col_min + 1;
+    nj = vdata->row_max - vdata->row_min + 1;
+
+    free ( p->off );
+    free ( p->wt );
+    free ( p->order );
+    p->off   = ( long * ) malloc ( 4 * p->npts * sizeof ( long ) );
+    p->wt    = ( float * ) malloc ( 4 * p->npts * sizeof ( float ) );
+    p->order = ( int * ) malloc ( p->npts * sizeof ( int ) );
+    key      = ( ProbeKey * ) malloc ( p->npts * sizeof ( ProbeKey ) );
+    if ( !p->off || !p->wt || !p->order || !key )
+        {
+        sprintf ( message, "Couldn't allocate plans for %d points !", p->npts );
+        free ( key );
+        return FAILURE;
+        }
+
+    for ( i = 0; i < p->npts; i++ )
+        {
+        long  *off = p->off + 4 * i;
+        float *wt  = p->wt  + 4 * i;
+
+        for ( m = 0; m < 4; m++ )
+            {
+            off[m] = -1;
+            wt[m]  = 0.0;
+            }
+
+        /* 0-based, relative to the window:  cell centers at integers */
+
+        fx = p->col[i] - vdata->col_min;
+        fy = p->row[i] - vdata->row_min;
+        ic = ( int ) floor ( fx + 0.5 );
+        jr = ( int ) floor ( fy + 0.5 );
+        if ( ( fx != fx ) || ( fy != fy ) ||
+                ( ic < 0 ) || ( ic >= ni ) || ( jr < 0 ) || ( jr >= nj ) )
+            {
+            key[i].off = -1;
+            key[i].pt  = i;
+            continue;
+            }
+
+        if ( method == GRIDPROBE_NEAREST )
+            {
+            off[0] = ic + ( long ) jr * ni;
+            wt[0]  = 1.0;
+            }
+        else
+            {
+            fx = ( fx < 0.0 ) ? 0.0 : ( ( fx > ni - 1 ) ? ni - 1 : fx );
+            fy = ( fy < 0.0 ) ? 0.0 : ( ( fy > nj - 1 ) ? nj - 1 : fy );
+            i0 = ( int ) floor ( fx );
+            j0 = ( int ) floor ( fy );
+            if ( ( i0 == ni - 1 ) && ( ni > 1 ) ) i0--;
+            if ( ( j0 == nj - 1 ) && ( nj > 1 ) ) j0--;
+            i1 = ( ni > 1 ) ? i0 + 1 : i0;
+            j1 = ( nj > 1 ) ? j0 + 1 : j0;
+            tx = fx - i0;
+            ty = fy - j0;
+            off[0] = i0 + ( long ) j0 * ni;
+            off[1] = i1 + ( long ) j0 * ni;
+            off[2] = i0 + ( long ) j1 * ni;
+            off[3] = i1 + ( long ) j1 * ni;
+            wt[0]  = ( float ) ( ( 1.0 - tx ) * ( 1.0 - ty ) );
+            wt[1]  = ( float ) ( tx * ( 1.0 - ty ) );
+            wt[2]  = ( float ) ( ( 1.0 - tx ) * ty );
+            wt[3]  = ( float ) ( tx * ty );
+            }
+        key[i].off = off[0];
+        key[i].pt  = i;
+        }
+
+    qsort ( key, p->npts, sizeof ( ProbeKey ), key_compare );
+    for ( i = 0; i < p->npts; i++ ) p->order[i] = key[i].pt;
+    free ( key );
+    return PAVE_SUCCESS;
+    }
+
+
+void gridprobe_gather ( const GridProbe *p, const float *grid,
+                        long plane_size, long nplane, float *out )
+    {
+    long n;
+
+#pragma omp parallel for schedule(static) if ( nplane * p->npts > GRIDPROBE_PAR )
+    for ( n = 0; n < nplane; n++ )
+        {
+        const float *v = grid + n * plane_size;
+        float       *o = out  + n * p->npts;
+        double       s, w;
+        float        x;
+        int          m, i, k;
+
+        for ( m = 0; m < p->npts; m++ )
+            {
+            i = p->order[m];
+            s = w = 0.0;
+            for ( k = 0; k < 4; k++ )
+                {
+                if ( ( p->off[4*i+k] < 0 ) || ( p->wt[4*i+k] <= 0.0 ) ) continue;
+                x = v[p->off[4*i+k]];
+                if ( x != x ) continue;
+                s += p->wt[4*i+k] * x;
+                w += p->wt[4*i+k];
+                }
+            o[i] = ( w > 0.0 ) ? ( float ) ( s / w ) : NAN;
+            }
+        }
+    }
+
+
+int gridprobe_extract ( VIS_DATA *vdata, const char *pointfile,
+                        int coords, int method, const char *outfile,
+                        char *message )
+    {
+    GridProbe  probe;
+    FILE      *fp;
+    float     *vals;
+    long       plane;
+    int        ni, nj, nk, nt, i, k, t, off, ok;
+
+    if ( !vdata || !vdata->grid )
+        {
+        sprintf ( message, "No grid values for gridprobe_extract() !" );
+        return FAILURE;
+        }
+    ni = vdata->col_max - vdata->col_min + 1;
+    nj = vdata->row_max - vdata->row_min + 1;
+    nk = vdata->level_max - vdata->level_min + 1;
+    nt = vdata->step_max - vdata->step_min + 1;
+    if ( ( ni < 1 ) || ( nj < 1 ) || ( nk < 1 ) || ( nt < 1 ) )
+        {
+        sprintf ( message, "Can't find ni, nj, nk, and/or nt for point extraction !" );
+        return FAILURE;
+        }
+    plane = ( long ) ni * nj;
+
+    if ( !gridprobe_read ( &probe, pointfile, message ) ) return FAILURE;
+    if ( !gridprobe_locate ( &probe, vdata->map_info, coords, message ) ||
+            !gridprobe_plan ( &probe, vdata, method, message ) )
+        {
+        gridprobe_free ( &probe );
+        return FAILURE;
+        }
+
+    if ( ! ( vals = ( float * ) malloc ( ( long ) nk * nt * probe.npts * sizeof ( float ) ) ) )
+        {
+        sprintf ( message, "Couldn't allocate %d samples at %d points !",
+                  nk * nt, probe.npts );
+        gridprobe_free ( &probe );
+        return FAILURE;
+        }
+    gridprobe_gather ( &probe, vdata->grid, plane, ( long ) nk * nt, vals );
+
+    for ( i = off = 0; i < probe.npts; i++ )
+        off += ( probe.off[4*i] < 0 );
+    if ( off )
+        fprintf ( stderr, "WARNING:  %d of %d points are outside the grid\n",
+                  off, probe.npts );
+
+    if ( ! ( fp = fopen ( outfile, "w" ) ) )
+        {
+        sprintf ( message, "Couldn't open file '%s' for writing !", outfile );
+        free ( vals );
+        gridprobe_free ( &probe );
+        return FAILURE;
+        }
+
+    ok = 1;
+    if ( ( vdata->species_short_name != NULL ) &&
+            ( vdata->units_name != NULL ) &&
+            ( vdata->selected_species > 0 ) &&
+            ( vdata->species_short_name[vdata->selected_species-1] != NULL ) &&
+            ( vdata->units_name[vdata->selected_species-1] != NULL ) )
+        ok = ( fprintf ( fp, "# %s in %s\n",
+                         vdata->species_short_name[vdata->selected_species-1],
+                         vdata->units_name[vdata->selected_species-1] ) > 0 );
+    if ( ok ) ok = ( fprintf ( fp, "# %s sampling at %d points\n",
+                                   ( method == GRIDPROBE_NEAREST ) ? "nearest" : "bilinear",
+                                   probe.npts ) > 0 );
+
+    if ( ok ) ok = ( fprintf ( fp, "# Col%s", ( nk > 1 ) ? "\t\t" : "\t" ) > 0 );
+    for ( i = 0; ok && ( i < probe.npts ); i++ )
+        ok = ( fprintf ( fp, "\t%.3f", probe.col[i] ) > 0 );
+    if ( ok ) ok = ( fprintf ( fp, "\n# Row%s", ( nk > 1 ) ? "\t\t" : "\t" ) > 0 );
+    for ( i = 0; ok && ( i < probe.npts ); i++ )
+        ok = ( fprintf ( fp, "\t%.3f", probe.row[i] ) > 0 );
+
+    if ( ok ) ok = ( fprintf ( fp, "\nDate\tTime%s", ( nk > 1 ) ? "\tLayer" : "" ) > 0 );
+    for ( i = 0; ok && ( i < probe.npts ); i++ )
+        ok = ( fprintf ( fp, "\t%s", probe.id[i] ) > 0 );
+    if ( ok ) ok = ( fprintf ( fp, "\n" ) > 0 );
+
+    for ( t = 0; ok && ( t < nt ); t++ )
+        for ( k = 0; ok && ( k < nk ); k++ )
+            {
+            const float *v = vals + ( ( long ) t * nk + k ) * probe.npts;
+
+            ok = ( vdata->sdate && vdata->stime ) ?
+                 ( fprintf ( fp, "%07d\t%06d", vdata->sdate[t], vdata->stime[t] ) > 0 ) :
+                 ( fprintf ( fp, "Step %d\t", t + vdata->step_min ) > 0 );
+            if ( ok && ( nk > 1 ) )
+                ok = ( fprintf ( fp, "\t%d", k + vdata->level_min ) > 0 );
+            for ( i = 0; ok && ( i < probe.npts ); i++ )
+                ok = ( fprintf ( fp, "\t%g", v[i] ) > 0 );
+            if ( ok ) ok = ( fprintf ( fp, "\n" ) > 0 );
+            }
+
+    fclose ( fp );
+    free ( vals );
+    gridprobe_free ( &probe );
+    if ( !ok )
+        {
+        sprintf ( message, "Error writing point values to '%s' !", outfile );
+        return FAILURE;
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+void gridprobe_free ( GridProbe *p )
+    {
+    int i;
+
+    if ( !p ) return;
+    for ( i = 0; p->id && ( i < p->npts ); i++ ) free ( p->id[i] );
+    free ( p->id );
+    free ( p->x );
+    free ( p->y );
+    free ( p->col );
+    free ( p->row );
+    free ( p->order );
+    free ( p->off );
+    free ( p->wt );
+    memset ( ( void * ) p, 0, sizeof ( GridProbe ) );
+    }
@@ -0,0 +1,109 @@
+#ifndef GRIDPROBE_H
+#define GRIDPROBE_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridprobe.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Batch extraction of time series at many points at once (monitor
+ *  sites, for example), for DriverWnd's -probePoints.
+ *
+ *  The points are read from a file of lines
+ *
+ *      <id> <x> <y>
+ *
+ *  (blank lines and lines starting with '#' are skipped), where x, y
+ *  are either longitude and latitude, or 1-based (possibly fractional)
+ *  column and row of the full grid.  They are located on the grid once,
+ *  through the VIS_DATA's map_info and MapUtilities' projections, as
+ *  TileWnd locates its observation sites;  each point then gets a plan
+ *  of up to four (offset, weight) pairs within a level-plane of the
+ *  VIS_DATA's grid, for nearest-cell or bilinear (between cell centers)
+ *  sampling.  The plans are ordered by offset, so that gathering all
+ *  the points from a plane is a single forward pass through it;  planes
+ *  are independent, and are shared out among the OpenMP threads.
+ *
+ *  Missing (NaN) neighbors are dropped from a bilinear sample, and the
+ *  remaining weights renormalized;  a point off the grid (or with only
+ *  missing neighbors) yields NaN.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define GRIDPROBE_NEAREST   (0)
+#define GRIDPROBE_BILINEAR  (1)
+
+#define GRIDPROBE_COLROW    (0)     /* point coordinates */
+#define GRIDPROBE_LONLAT    (1)
+
+typedef struct
+    {
+    int      npts;
+    char   **id;            /* point names */
+    double  *x, *y;         /* as read */
+    double  *col, *row;     /* 1-based grid coordinates:  cell centers
+                               are at integer values */
+    int     *order;         /* points in increasing plan offset */
+    long    *off;           /* plan:  [4*npts] offsets within a plane, */
+    float   *wt;            /* ... -1 if unused, and weights */
+    } GridProbe;
+
+/* reads the points:  PAVE_SUCCESS, or FAILURE with an error string
+   written into message */
+int gridprobe_read ( GridProbe *p, const char *filename, char *message );
+
+/* projects lon[0..n-1], lat[0..n-1] onto the full grid described by
+   map_info, giving 1-based col[], row[] as above */
+int gridprobe_project ( const char *map_info, long n, const double *lon,
+                        const double *lat, double *col, double *row,
+                        char *message );
+
+/* the inverse:  lon[], lat[] of the 1-based col[], row[] */
+int gridprobe_unproject ( const char *map_info, long n, const double *col,
+                          const double *row, double *lon, double *lat,
+                          char *message );
+
+/* locates the points on the full grid described by map_info, taking
+   them as GRIDPROBE_LONLAT or GRIDPROBE_COLROW */
+int gridprobe_locate ( GridProbe *p, const char *map_info, int coords,
+                       char *message );
+
+/* builds the GRIDPROBE_NEAREST or GRIDPROBE_BILINEAR plans within
+   vdata's (col_min..col_max, row_min..row_max) window */
+int gridprobe_plan ( GridProbe *p, const VIS_DATA *vdata, int method,
+                     char *message );
+
+/* out[n*npts + i] = point i sampled from plane n of grid, for each of
+   nplane planes of plane_size values */
+void gridprobe_gather ( const GridProbe *p, const float *grid,
+                        long plane_size, long nplane, float *out );
+
+/* everything above, for all of vdata's levels and steps, written as
+   one tab-separated table (a row per step and level, a column per
+   point) to outfile;  the caller keeps vdata */
+int gridprobe_extract ( VIS_DATA *vdata, const char *pointfile,
+                        int coords, int method, const char *outfile,
+                        char *message );
+
+void gridprobe_free ( GridProbe *p );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* GRIDPROBE_H */
@@ -0,0 +1,122 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridstats.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Numerically robust running statistics;  see gridstats.h.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <string.h>
+#include <math.h>
+
+#include "gridstats.h"
+
+
+/* Kahan-adds x to (*sum,*comp) */
+static void kahan_add ( double *sum, double *comp, double x )
+    {
+    double y = x - *comp,
+           t = *sum + y;
+
+    *comp = ( t - *sum ) - y;
+    *sum  = t;
+    }
+
+void gridstats_init ( GridStats *s )
+    {
+    memset ( s, 0, sizeof ( GridStats ) );
+    s->argmin = s->argmax = -1;
+    }
+
+void gridstats_add ( GridStats *s, const float *v, long len, long pos )
+    {
+    GridStats r;
+    long      i, n = 0, amin = -1, amax = -1;
+    double    sum = 0.0, m2 = 0.0, mean, d;
+    float     vmin = 0.0f, vmax = 0.0f;
+
+    for ( i = 0; i < len; i++ )
+        {
+        if ( isnan ( v[i] ) ) continue;
+        if ( !n || v[i] < vmin ) { vmin = v[i]; amin = i; }
+        if ( !n || v[i] > vmax ) { vmax = v[i]; amax = i; }
+        sum += v[i];
+        n++;
+        }
+    if ( !n )
+        return;
+    mean = sum / ( double ) n;
+    for ( i = 0; i < len; i++ )
+        {
+        if ( isnan ( v[i] ) ) continue;
+        d   = v[i] - mean;
+        m2 += d*d;
+        }
+
+    gridstats_init ( &r );
+    r.n      = n;
+    r.mean   = mean;
+    r.m2     = m2;
+    r.sum    = sum;
+    r.min    = vmin;
+    r.max    = vmax;
+    r.argmin = pos + amin;
+    r.argmax = pos + amax;
+    gridstats_merge ( s, &r );
+    }
+
+void gridstats_merge ( GridStats *a, const GridStats *b )
+    {
+    double n, delta;
+
+    if ( b->n == 0 )
+        return;
+    if ( a->n == 0 )
+        {
+        *a = *b;
+        return;
+        }
+    n     = ( double ) a->n + ( double ) b->n;
+    delta = b->mean - a->mean;
+    a->mean += delta * ( double ) b->n / n;
+    a->m2   += b->m2 + delta * delta * ( double ) a->n * ( double ) b->n / n;
+    a->n    += b->n;
+    kahan_add ( &a->sum, &a->comp, b->sum );
+    kahan_add ( &a->sum, &a->comp, -b->comp );
+
+    if ( b->min < a->min || ( b->min == a->min && b->argmin < a->argmin ) )
+        {
+        a->min    = b->min;
+        a->argmin = b->argmin;
+        }
+    if ( b->max > a->max || ( b->max == a->max && b->argmax < a->argmax ) )
+        {
+        a->max    = b->max;
+        a->argmax = b->argmax;
+        }
+    }
+
+double gridstats_sum ( const GridStats *s )
+    {
+    return s->sum - s->comp;
+    }
+
+double gridstats_variance ( const GridStats *s )
+    {
+    return ( s->n > 0 ) ? s->m2 / ( double ) s->n : 0.0;
+    }
@@ -0,0 +1,69 @@
+#ifndef GRIDSTATS_H
+#define GRIDSTATS_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridstats.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Numerically robust running statistics of float data.
+ *
+ *  calc_stats() used to derive the variance as ssq/n - mean^2, which
+ *  loses most of its digits (and can go negative) when the mean is
+ *  large relative to the spread, as for pressures or temperatures in
+ *  K.  A GridStats instead keeps the count, mean and sum of squared
+ *  deviations (Welford), merges partials exactly (Chan et al.), and
+ *  keeps the sum with Kahan compensation, so that partials computed
+ *  separately -- per plane, by different threads -- combine to the
+ *  same answer whatever the order of evaluation, provided they are
+ *  merged in a fixed order.
+ *
+ *  gridstats_add() takes a contiguous run of values, skipping NaNs, in
+ *  two vectorizable passes (sum and extremes, then squared deviations
+ *  from the run's own mean).  Positions are whatever linear index the
+ *  caller assigns the first value of the run;  ties in the extremes go
+ *  to the smallest position, as a serial scan finds them.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+typedef struct
+    {
+    long    n;              /* non-missing values */
+    double  mean;
+    double  m2;             /* sum of squared deviations from the mean */
+    double  sum, comp;      /* Kahan sum, and its compensation */
+    float   min, max;
+    long    argmin, argmax; /* positions, as given to gridstats_add() */
+    } GridStats;
+
+void gridstats_init ( GridStats *s );
+
+/* adds v[0..len-1], at positions pos..pos+len-1 */
+void gridstats_add ( GridStats *s, const float *v, long len, long pos );
+
+/* merges b into a */
+void gridstats_merge ( GridStats *a, const GridStats *b );
+
+double gridstats_sum ( const GridStats *s );
+
+/* population variance, m2/n */
+double gridstats_variance ( const GridStats *s );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* GRIDSTATS_H */
@@ -0,0 +1,53 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridtarget.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Direct-to-destination data grids;  see gridtarget.h.
+ *
+ *  The destination travels with the request (VIS_DATA grid_dest and
+ *  grid_dest_n), so there is no shared state, and the read-ahead thread
+ *  may allocate grids at the same time without a lock.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  grids come from
+ *          spill_alloc(), so formula operands may spill (spill.c)
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  the destination is a
+ *          member of the request, not a one-shot global
+ ****************************************************************************/
+
+#include <stdlib.h>
+
+#include "vis_data.h"
+#include "gridtarget.h"
+#include "spill.h"
+
+
+float *grid_alloc ( VIS_DATA *info, size_t n )
+    {
+    if ( info && info->grid_dest && ( long ) n == info->grid_dest_n &&
+            info->grid != info->grid_dest )
+        return info->grid_dest;
+    return ( n > 0 ) ? spill_alloc ( n ) : NULL;
+    }
+
+
+void grid_free ( VIS_DATA *info, float *grid )
+    {
+    if ( grid == NULL ) return;
+    if ( info && grid == info->grid_dest ) return;
+    spill_release ( grid );
+    }
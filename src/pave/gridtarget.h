@@ -0,0 +1,58 @@
+#ifndef GRIDTARGET_H
+#define GRIDTARGET_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: gridtarget.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Direct-to-destination data grids.
+ *
+ *  get_data_local() assembles the grid of a META-meta file from the
+ *  grids of its member files, each of which lands at a known place in
+ *  the final grid.  Rather than have every reader malloc() a grid of
+ *  its own, to be copied into place and freed, the caller names that
+ *  place in the request itself (grid_dest, grid_dest_n);  the readers
+ *  get their grids from grid_alloc(), which hands out the destination
+ *  when the grid is of exactly the size given, and malloc()s a grid
+ *  otherwise.  grid_free() is the matching free(), which leaves the
+ *  destination alone.  A caller can tell whether the read went straight
+ *  to the destination by comparing the grid it got back.
+ *
+ *  The destination belongs to the one request:  VIS_DATA_dup() does not
+ *  copy it, so the read-ahead thread's requests never see it.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  the destination is a
+ *          member of the request, not a one-shot global
+ ****************************************************************************/
+
+#include <stddef.h>
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+/* a grid of n floats for info:  info->grid_dest, if it is of size n
+   and not already info's grid, else spill_alloc()ed;  or NULL */
+float *grid_alloc ( VIS_DATA *info, size_t n );
+
+/* frees a grid from grid_alloc() for info, unless it is info's
+   destination */
+void grid_free ( VIS_DATA *info, float *grid );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* GRIDTARGET_H */
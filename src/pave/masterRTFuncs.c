@@ -611,8 +611,15 @@ int BusMasterRTReplyDirect ( struct BusMasterData *bmd,
 
     if ( bmd->WaitingReq != NULL )
         {
-        tmp_bmsg = BusGetMessageByModuleOption ( bmd->WaitingReq, bmsg->toModule,
-                   BUSBYTE_REQ_DIRECT_CONNECT );
+        /* The reply carries the serial of the request it answers:
+           match on that first, so that a client may have several
+           requests outstanding (to different modules) at once */
+        tmp_bmsg = BusGetMessageByModuleSeq ( bmd->WaitingReq, bmsg->toModule,
+                                              bmsg->serial );
+        if ( ( tmp_bmsg == NULL ) ||
+                ( tmp_bmsg->messageOption != BUSBYTE_REQ_DIRECT_CONNECT ) )
+            tmp_bmsg = BusGetMessageByModuleOption ( bmd->WaitingReq, bmsg->toModule,
+                       BUSBYTE_REQ_DIRECT_CONNECT );
 
         if ( tmp_bmsg == NULL )
             {
@@ -625,8 +632,8 @@ int BusMasterRTReplyDirect ( struct BusMasterData *bmd,
 
             other_bmn = BusMasterFindModuleById ( bmd->Modules, tmp_bmsg->fromModule );
             bmd->WaitingReq =
-                Bus_DequeMessageByModuleOption ( bmd->WaitingReq, bmsg->toModule,
-                                                 BUSBYTE_REQ_DIRECT_CONNECT );
+                Bus_DequeMessageByModuleSeq ( bmd->WaitingReq, bmsg->toModule,
+                                              bmsg->serial );
             if ( other_bmn == NULL )
                 {
                 printf ( "Client %d requesting Direct connection does'nt exist!! \n",
@@ -0,0 +1,759 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: metaindex.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Persistent index of get_info() headers;  see metaindex.h.
+ *
+ *  File layout:  the 8-byte magic IX_MAGIC and a native-order int32
+ *  IX_ORDER (a file from a machine of the other byte order is simply
+ *  started over), then records, each a uint32 payload length and the
+ *  payload:  path, size, mtime, then the VIS_DATA header fields in the
+ *  order of ix_encode().  Strings are an int32 length (-1 for NULL)
+ *  and the bytes.  The whole file is read into a hash table on first
+ *  use, and whatever other processes have appended since is read
+ *  whenever this one appends or prefetches.
+ *
+ *  Sidecar records (metaindex_put_record()) share the file:  the key is
+ *  "path//tag", and the payload an int32 length and the bytes.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  sidecar records
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  compaction holds the
+ *          exclusive lock across the last read;  metaindex_lookup()
+ *          frees the header it replaces
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+
+#include "vis_data.h"
+#include "metaindex.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define IX_MAGIC        "PAVEMIX1"
+#define IX_ORDER        (0x01020304)
+#define IX_HEADER       ( 8 + sizeof ( int32_t ) )
+#define IX_BUCKETS      (1024)
+#define IX_MAX_RECORD   ( 64 << 20 )        /* sanity limit on a record */
+
+extern void free_vis ( VIS_DATA *info );
+
+typedef struct ixEntry
+    {
+    char      *path;
+    long long  size;
+    long long  mtime;
+    char      *rec;         /* payload, decoded on lookup */
+    size_t     len;
+    struct ixEntry *next;
+    } IxEntry;
+
+typedef struct
+    {
+    char  *p;
+    size_t n, cap;
+    int    bad;
+    } IxBuf;
+
+static int      ixState  = 0;       /* 0: not set up;  1: on;  -1: off */
+static char     ixPath[PATH_MAX];
+static off_t    ixLoaded = 0;       /* file bytes already in ixTable */
+static ino_t    ixIno    = 0;       /* ... of this file */
+static int      ixLive   = 0;
+static int      ixDead   = 0;
+static IxEntry *ixTable[IX_BUCKETS];
+
+
+/* ---------------------------  encoding  ----------------------------- */
+
+static void put_bytes ( IxBuf *b, const void *v, size_t n )
+    {
+    char *p;
+
+    if ( b->bad ) return;
+    if ( b->n + n > b->cap )
+        {
+        b->cap = 2 * ( b->n + n ) + 256;
+        if ( ( p = ( char * ) realloc ( b->p, b->cap ) ) == NULL )
+            {
+            b->bad = 1;
+            return;
+            }
+        b->p = p;
+        }
+    memcpy ( b->p + b->n, v, n );
+    b->n += n;
+    }
+
+static void put_int ( IxBuf *b, int v )
+    {
+    int32_t w = v;
+    put_bytes ( b, &w, sizeof ( w ) );
+    }
+
+static void put_i64 ( IxBuf *b, long long v )
+    {
+    int64_t w = v;
+    put_bytes ( b, &w, sizeof ( w ) );
+    }
+
+static void put_str ( IxBuf *b, const char *s )
+    {
+    int n = s ? ( int ) strlen ( s ) : -1;
+
+    put_int ( b, n );
+    if ( n > 0 ) put_bytes ( b, s, n );
+    }
+
+static void get_bytes ( IxBuf *b, void *v, size_t n )
+    {
+    if ( b->bad || ( b->n + n > b->cap ) )
+        {
+        b->bad = 1;
+        memset ( v, 0, n );
+        return;
+        }
+    memcpy ( v, b->p + b->n, n );
+    b->n += n;
+    }
+
+static int get_int ( IxBuf *b )
+    {
+    int32_t w;
+    get_bytes ( b, &w, sizeof ( w ) );
+    return w;
+    }
+
+static long long get_i64 ( IxBuf *b )
+    {
+    int64_t w;
+    get_bytes ( b, &w, sizeof ( w ) );
+    return w;
+    }
+
+static char *get_str ( IxBuf *b )
+    {
+    char *s;
+    int   n = get_int ( b );
+
+    if ( b->bad || ( n < 0 ) || ( ( size_t ) n > b->cap - b->n ) )
+        {
+        if ( n != -1 ) b->bad = 1;
+        return NULL;
+        }
+    if ( ( s = ( char * ) malloc ( n + 1 ) ) == NULL )
+        {
+        b->bad = 1;
+        return NULL;
+        }
+    get_bytes ( b, s, n );
+    s[n] = '\0';
+    return s;
+    }
+
+static void ix_encode ( IxBuf *b, const char *path, long long size, long long mtime,
+                        VIS_DATA *info )
+    {
+    int i;
+
+    put_str ( b, path );
+    put_i64 ( b, size );
+    put_i64 ( b, mtime );
+
+    put_int ( b, ( int ) info->dataset );
+    put_int ( b, info->nspecies );
+    for ( i = 0; i < info->nspecies; i++ )
+        {
+        put_str ( b, info->species_short_name ? info->species_short_name[i] : NULL );
+        put_str ( b, info->species_long_name  ? info->species_long_name[i]  : NULL );
+        put_str ( b, info->units_name         ? info->units_name[i]         : NULL );
+        }
+    put_str ( b, info->map_info );
+    put_str ( b, info->data_label );
+    put_int ( b, info->first_date );
+    put_int ( b, info->first_time );
+    put_int ( b, info->last_date );
+    put_int ( b, info->last_time );
+    put_int ( b, info->incr_sec );
+    put_int ( b, info->ncol );
+    put_int ( b, info->nrow );
+    put_int ( b, info->nlevel );
+    put_int ( b, info->nstep );
+    put_int ( b, info->col_min );
+    put_int ( b, info->col_max );
+    put_int ( b, info->row_min );
+    put_int ( b, info->row_max );
+    put_int ( b, info->level_min );
+    put_int ( b, info->level_max );
+    put_int ( b, info->step_min );
+    put_int ( b, info->step_max );
+    put_int ( b, info->step_incr );
+    put_int ( b, info->slice );
+    put_int ( b, info->selected_species );
+    put_int ( b, info->selected_col );
+    put_int ( b, info->selected_row );
+    put_int ( b, info->selected_level );
+    put_int ( b, info->selected_step );
+    put_int ( b, ( info->sdate && info->stime ) ? info->nstep : 0 );
+    for ( i = 0; info->sdate && info->stime && ( i < info->nstep ); i++ )
+        {
+        put_int ( b, info->sdate[i] );
+        put_int ( b, info->stime[i] );
+        }
+    }
+
+/* decodes the fields after the key into v, which must be zeroed */
+static int ix_decode ( IxBuf *b, VIS_DATA *v )
+    {
+    int i, ns, ndates;
+
+    v->dataset  = ( enum dataset_type ) get_int ( b );
+    v->nspecies = ns = get_int ( b );
+    if ( ( ns < 0 ) || ( ( size_t ) ns > b->cap ) )
+        return FAILURE;
+    if ( ns > 0 )
+        {
+        v->species_short_name = ( char ** ) calloc ( ns, sizeof ( char * ) );
+        v->species_long_name  = ( char ** ) calloc ( ns, sizeof ( char * ) );
+        v->units_name         = ( char ** ) calloc ( ns, sizeof ( char * ) );
+        if ( !v->species_short_name || !v->species_long_name || !v->units_name )
+            return FAILURE;
+        }
+    for ( i = 0; i < ns; i++ )
+        {
+        v->species_short_name[i] = get_str ( b );
+        v->species_long_name[i]  = get_str ( b );
+        v->units_name[i]         = get_str ( b );
+        }
+    v->map_info         = get_str ( b );
+    v->data_label       = get_str ( b );
+    v->first_date       = get_int ( b );
+    v->first_time       = get_int ( b );
+    v->last_date        = get_int ( b );
+    v->last_time        = get_int ( b );
+    v->incr_sec         = get_int ( b );
+    v->ncol             = get_int ( b );
+    v->nrow             = get_int ( b );
+    v->nlevel           = get_int ( b );
+    v->nstep            = get_int ( b );
+    v->col_min          = get_int ( b );
+    v->col_max          = get_int ( b );
+    v->row_min          = get_int ( b );
+    v->row_max          = get_int ( b );
+    v->level_min        = get_int ( b );
+    v->level_max        = get_int ( b );
+    v->step_min         = get_int ( b );
+    v->step_max         = get_int ( b );
+    v->step_incr        = get_int ( b );
+    v->slice            = get_int ( b );
+    v->selected_species = get_int ( b );
+    v->selected_col     = get_int ( b );
+    v->selected_row     = get_int ( b );
+    v->selected_level   = get_int ( b );
+    v->selected_step    = get_int ( b );
+    ndates = get_int ( b );
+    if ( ( ndates < 0 ) || ( ( size_t ) ndates > b->cap ) )
+        return FAILURE;
+    if ( ndates > 0 )
+        {
+        v->sdate = ( int * ) malloc ( ndates * sizeof ( int ) );
+        v->stime = ( int * ) malloc ( ndates * sizeof ( int ) );
+        if ( !v->sdate || !v->stime )
+            return FAILURE;
+        for ( i = 0; i < ndates; i++ )
+            {
+            v->sdate[i] = get_int ( b );
+            v->stime[i] = get_int ( b );
+            }
+        }
+    return ( b->bad || ( b->n != b->cap ) ) ? FAILURE : PAVE_SUCCESS;
+    }
+
+
+/* ----------------------------  the table  --------------------------- */
+
+static unsigned ix_hash ( const char *s )
+    {
+    unsigned h = 2166136261u;                       /* FNV-1a */
+
+    while ( *s )
+        h = ( h ^ ( unsigned char ) *s++ ) * 16777619u;
+    return h % IX_BUCKETS;
+    }
+
+static IxEntry *ix_find ( const char *path )
+    {
+    IxEntry *e;
+
+    for ( e = ixTable[ix_hash ( path )]; e; e = e->next )
+        if ( !strcmp ( e->path, path ) ) return e;
+    return NULL;
+    }
+
+/* takes over rec */
+static void ix_insert ( char *rec, size_t len )
+    {
+    IxBuf    b;
+    IxEntry *e;
+    char    *path;
+    long long size, mtime;
+    unsigned h;
+
+    b.p = rec;  b.n = 0;  b.cap = len;  b.bad = 0;
+    path  = get_str ( &b );
+    size  = get_i64 ( &b );
+    mtime = get_i64 ( &b );
+    if ( b.bad || !path )
+        {
+        free ( path );
+        free ( rec );
+        return;
+        }
+    if ( ( e = ix_find ( path ) ) != NULL )
+        {
+        free ( path );
+        free ( e->rec );
+        ixDead++;
+        }
+    else if ( ( e = ( IxEntry * ) calloc ( 1, sizeof ( IxEntry ) ) ) != NULL )
+        {
+        h = ix_hash ( path );
+        e->path = path;
+        e->next = ixTable[h];
+        ixTable[h] = e;
+        ixLive++;
+        }
+    else
+        {
+        free ( path );
+        free ( rec );
+        return;
+        }
+    e->size  = size;
+    e->mtime = mtime;
+    e->rec   = rec;
+    e->len   = len;
+    }
+
+/* the key for filename:  its real path, size and modification time */
+static int ix_key ( const char *filename, char *path, long long *size, long long *mtime )
+    {
+    struct stat st;
+
+    if ( !filename || ( stat ( filename, &st ) != 0 ) || !S_ISREG ( st.st_mode ) )
+        return FAILURE;
+    if ( realpath ( filename, path ) == NULL )
+        return FAILURE;
+    *size  = st.st_size;
+    *mtime = st.st_mtime;
+    return PAVE_SUCCESS;
+    }
+
+
+/* ----------------------------  the file  ---------------------------- */
+
+static int ix_setup ( void )
+    {
+    char *env, *home;
+
+    if ( ixState ) return ( ixState > 0 );
+
+    ixState = -1;
+    env = getenv ( METAINDEX_ENV );
+    if ( env && ( !*env || !strcmp ( env, "off" ) ) )
+        return 0;
+    if ( env )
+        snprintf ( ixPath, sizeof ( ixPath ), "%s", env );
+    else if ( ( home = getenv ( "HOME" ) ) != NULL )
+        snprintf ( ixPath, sizeof ( ixPath ), "%s/%s", home, METAINDEX_FILE );
+    else
+        return 0;
+    ixState = 1;
+    return 1;
+    }
+
+static int ix_header_ok ( int fd )
+    {
+    char    magic[8];
+    int32_t order;
+
+    return ( pread ( fd, magic, 8, 0 ) == 8 ) &&
+           ( pread ( fd, &order, sizeof ( order ), 8 ) == sizeof ( order ) ) &&
+           !memcmp ( magic, IX_MAGIC, 8 ) && ( order == IX_ORDER );
+    }
+
+/* rewrites the index with only its live records;  called with fd locked */
+static void ix_compact ( void )
+    {
+    struct stat st;
+    char     tmpname[PATH_MAX+32];
+    off_t    end;
+    int32_t  order = IX_ORDER;
+    uint32_t len;
+    IxEntry *e;
+    FILE    *out;
+    int      h, ok;
+
+    snprintf ( tmpname, sizeof ( tmpname ), "%s.tmp%ld", ixPath, ( long ) getpid() );
+    if ( ( out = fopen ( tmpname, "w" ) ) == NULL )
+        return;
+    ok = ( fwrite ( IX_MAGIC, 8, 1, out ) == 1 ) &&
+         ( fwrite ( &order, sizeof ( order ), 1, out ) == 1 );
+    for ( h = 0; ok && ( h < IX_BUCKETS ); h++ )
+        for ( e = ixTable[h]; ok && e; e = e->next )
+            {
+            len = ( uint32_t ) e->len;
+            ok = ( fwrite ( &len, sizeof ( len ), 1, out ) == 1 ) &&
+                 ( fwrite ( e->rec, e->len, 1, out ) == 1 );
+            }
+    end = ftello ( out );
+    if ( ( fclose ( out ) != 0 ) || !ok || ( stat ( tmpname, &st ) != 0 ) ||
+            ( rename ( tmpname, ixPath ) != 0 ) )
+        {
+        unlink ( tmpname );
+        return;
+        }
+    ixDead   = 0;
+    ixLoaded = end;
+    ixIno    = st.st_ino;
+    }
+
+static int ix_load_locked ( int excl );
+
+/* reads whatever has been appended to the index since the last call,
+   and compacts it if it is mostly dead records.  Compaction holds the
+   exclusive lock from before the last read, so that no other process
+   can append a record that the rewrite would lose */
+static void ix_load ( void )
+    {
+    int excl;
+
+    if ( !ix_setup() ) return;
+    excl = ( ixDead > 64 ) && ( ixDead > ixLive );
+    if ( ix_load_locked ( excl ) && !excl )
+        ix_load_locked ( 1 );
+    }
+
+/* ix_load() under a shared lock (excl == 0), or under an exclusive one,
+   compacting if need be:  returns 1 if compaction is wanted but was not
+   done, for lack of the exclusive lock */
+static int ix_load_locked ( int excl )
+    {
+    struct stat st;
+    uint32_t len;
+    char    *rec;
+    FILE    *in;
+    int      fd, compact;
+
+    if ( ( fd = open ( ixPath, O_RDONLY ) ) < 0 )
+        return 0;
+    flock ( fd, excl ? LOCK_EX : LOCK_SH );
+    if ( ( fstat ( fd, &st ) != 0 ) || ( st.st_size < ( off_t ) IX_HEADER ) ||
+            !ix_header_ok ( fd ) )
+        {
+        flock ( fd, LOCK_UN );
+        close ( fd );
+        return 0;
+        }
+    if ( ( st.st_ino != ixIno ) || ( ixLoaded > st.st_size ) )
+        ixLoaded = 0;                       /* replaced by someone's compaction */
+    ixIno = st.st_ino;
+    if ( ixLoaded < ( off_t ) IX_HEADER )
+        ixLoaded = IX_HEADER;
+
+    if ( ( in = fdopen ( dup ( fd ), "r" ) ) != NULL )
+        {
+        fseeko ( in, ixLoaded, SEEK_SET );
+        while ( fread ( &len, sizeof ( len ), 1, in ) == 1 )
+            {
+            if ( ( len == 0 ) || ( len > IX_MAX_RECORD ) ||
+                    ( ( rec = ( char * ) malloc ( len ) ) == NULL ) )
+                break;
+            if ( fread ( rec, len, 1, in ) != 1 )
+                {
+                free ( rec );                   /* partial:  still being written */
+                break;
+                }
+            ix_insert ( rec, len );
+            ixLoaded += sizeof ( len ) + len;
+            }
+        fclose ( in );
+        }
+
+    compact = ( ixDead > 64 ) && ( ixDead > ixLive );
+    if ( compact && excl )
+        ix_compact();
+    flock ( fd, LOCK_UN );
+    close ( fd );
+    return compact && !excl;
+    }
+
+static void ix_append ( IxBuf *b )
+    {
+    struct stat st;
+    uint32_t len;
+    int32_t  order = IX_ORDER;
+    char    *rec;
+    int      fd, ok;
+
+    if ( ( fd = open ( ixPath, O_RDWR | O_CREAT | O_APPEND, 0644 ) ) < 0 )
+        return;
+    flock ( fd, LOCK_EX );
+    ok = ( fstat ( fd, &st ) == 0 );
+    if ( ok && ( st.st_size > 0 ) && !ix_header_ok ( fd ) )
+        {
+        /* not ours, or from a machine of the other byte order:  start over */
+        ok = ( ftruncate ( fd, 0 ) == 0 );
+        st.st_size = 0;
+        ixLoaded = 0;
+        }
+    if ( ok && ( st.st_size == 0 ) )
+        ok = ( write ( fd, IX_MAGIC, 8 ) == 8 ) &&
+             ( write ( fd, &order, sizeof ( order ) ) == sizeof ( order ) );
+
+    /* length and payload in one write(), so readers never see half */
+    len = ( uint32_t ) b->n;
+    if ( ok && ( ( rec = ( char * ) malloc ( sizeof ( len ) + b->n ) ) != NULL ) )
+        {
+        memcpy ( rec, &len, sizeof ( len ) );
+        memcpy ( rec + sizeof ( len ), b->p, b->n );
+        if ( write ( fd, rec, sizeof ( len ) + b->n ) != ( ssize_t ) ( sizeof ( len ) + b->n ) )
+            fprintf ( stderr, "metaindex:  could not write %s\n", ixPath );
+        free ( rec );
+        }
+    flock ( fd, LOCK_UN );
+    close ( fd );
+    }
+
+
+/* ----------------------------  interface  --------------------------- */
+
+int metaindex_lookup ( VIS_DATA *info )
+    {
+    char      path[PATH_MAX];
+    long long size, mtime;
+    IxEntry  *e;
+    IxBuf     b;
+    VIS_DATA  v;
+
+    if ( !ix_setup() ) return FAILURE;
+    if ( !ixLoaded ) ix_load();
+    if ( !ix_key ( info->filename, path, &size, &mtime ) )
+        return FAILURE;
+    if ( ( ( e = ix_find ( path ) ) == NULL ) || ( e->size != size ) || ( e->mtime != mtime ) )
+        return FAILURE;
+
+    b.p = e->rec;  b.n = 0;  b.cap = e->len;  b.bad = 0;
+    free ( get_str ( &b ) );
+    get_i64 ( &b );
+    get_i64 ( &b );
+    memset ( &v, 0, sizeof ( v ) );
+    if ( !ix_decode ( &b, &v ) )
+        {
+        free_vis ( &v );
+        return FAILURE;
+        }
+
+    /* v's header, info's filename, host and grid;  the rest of info's
+       header (names, units, map_info, label, dates, times) is freed */
+    v.filename    = info->filename;
+    v.filehost    = info->filehost;
+    v.grid        = info->grid;
+    v.grid_min    = info->grid_min;
+    v.grid_max    = info->grid_max;
+    v.grid_dest   = info->grid_dest;
+    v.grid_dest_n = info->grid_dest_n;
+    info->filename      = NULL;
+    info->filehost.ip   = NULL;
+    info->filehost.name = NULL;
+    info->grid          = NULL;
+    free_vis ( info );
+    memcpy ( info, &v, sizeof ( VIS_DATA ) );
+    return PAVE_SUCCESS;
+    }
+
+
+void metaindex_store ( VIS_DATA *info )
+    {
+    char      path[PATH_MAX];
+    long long size, mtime;
+    IxBuf     b;
+
+    if ( !ix_setup() ) return;
+    if ( !ix_key ( info->filename, path, &size, &mtime ) )
+        return;
+    memset ( &b, 0, sizeof ( b ) );
+    ix_encode ( &b, path, size, mtime, info );
+    if ( !b.bad && ( b.n <= IX_MAX_RECORD ) )
+        {
+        ix_append ( &b );
+        ix_load();
+        }
+    free ( b.p );
+    }
+
+
+/* sidecar records are keyed on "path//tag":  realpath() never
+   produces "//", so they cannot collide with a header's key */
+static int ix_sidekey ( const char *filename, const char *tag, char *key,
+                        long long *size, long long *mtime )
+    {
+    char path[PATH_MAX];
+
+    if ( !tag || !ix_key ( filename, path, size, mtime ) )
+        return FAILURE;
+    return ( snprintf ( key, PATH_MAX + 64, "%s//%s", path, tag ) < PATH_MAX + 64 )
+           ? PAVE_SUCCESS : FAILURE;
+    }
+
+int metaindex_get_record ( const char *filename, const char *tag,
+                           char **data, size_t *len )
+    {
+    char      key[PATH_MAX+64];
+    long long size, mtime;
+    IxEntry  *e;
+    IxBuf     b;
+    int       n;
+
+    if ( !ix_setup() ) return FAILURE;
+    if ( !ixLoaded ) ix_load();
+    if ( !ix_sidekey ( filename, tag, key, &size, &mtime ) )
+        return FAILURE;
+    if ( ( ( e = ix_find ( key ) ) == NULL ) || ( e->size != size ) || ( e->mtime != mtime ) )
+        return FAILURE;
+
+    b.p = e->rec;  b.n = 0;  b.cap = e->len;  b.bad = 0;
+    free ( get_str ( &b ) );
+    get_i64 ( &b );
+    get_i64 ( &b );
+    n = get_int ( &b );
+    if ( b.bad || ( n < 0 ) || ( ( size_t ) n != b.cap - b.n ) )
+        return FAILURE;
+    if ( ( *data = ( char * ) malloc ( n ? n : 1 ) ) == NULL )
+        return FAILURE;
+    get_bytes ( &b, *data, n );
+    *len = n;
+    return PAVE_SUCCESS;
+    }
+
+
+void metaindex_put_record ( const char *filename, const char *tag,
+                            const char *data, size_t len )
+    {
+    char      key[PATH_MAX+64];
+    long long size, mtime;
+    IxBuf     b;
+
+    if ( !ix_setup() ) return;
+    if ( !ix_sidekey ( filename, tag, key, &size, &mtime ) )
+        return;
+    memset ( &b, 0, sizeof ( b ) );
+    put_str ( &b, key );
+    put_i64 ( &b, size );
+    put_i64 ( &b, mtime );
+    put_int ( &b, ( int ) len );
+    put_bytes ( &b, data, len );
+    if ( !b.bad && ( b.n <= IX_MAX_RECORD ) )
+        {
+        ix_append ( &b );
+        ix_load();
+        }
+    free ( b.p );
+    }
+
+
+static void ix_prefetch_some ( char **names, int n, int first, int stride,
+                               int ( *reader ) ( VIS_DATA *info, char *message ) )
+    {
+    char     message[512];
+    VIS_DATA v;
+    int      i;
+
+    for ( i = first; i < n; i += stride )
+        {
+        memset ( &v, 0, sizeof ( v ) );
+        v.filename = strdup ( names[i] );
+        if ( v.filename && reader ( &v, message ) )
+            metaindex_store ( &v );
+        free_vis ( &v );
+        }
+    }
+
+void metaindex_prefetch ( char **names, int n,
+                          int ( *reader ) ( VIS_DATA *info, char *message ) )
+    {
+    char      path[PATH_MAX], **miss;
+    long long size, mtime;
+    IxEntry  *e;
+    pid_t    *pids;
+    long      ncpu;
+    int       i, k, nmiss, jobs;
+
+    if ( !ix_setup() || ( n < 1 ) ) return;
+    ix_load();
+
+    if ( ( miss = ( char ** ) malloc ( n * sizeof ( char * ) ) ) == NULL )
+        return;
+    for ( i = nmiss = 0; i < n; i++ )
+        {
+        if ( !ix_key ( names[i], path, &size, &mtime ) )
+            continue;           /* let get_info report it */
+        e = ix_find ( path );
+        if ( !e || ( e->size != size ) || ( e->mtime != mtime ) )
+            miss[nmiss++] = names[i];
+        }
+
+    ncpu = sysconf ( _SC_NPROCESSORS_ONLN );
+    jobs = ( nmiss < METAINDEX_MAX_JOBS ) ? nmiss : METAINDEX_MAX_JOBS;
+    if ( ( ncpu > 0 ) && ( jobs > ncpu ) ) jobs = ( int ) ncpu;
+
+    if ( jobs < 2 )
+        ix_prefetch_some ( miss, nmiss, 0, 1, reader );
+    else if ( ( pids = ( pid_t * ) malloc ( jobs * sizeof ( pid_t ) ) ) != NULL )
+        {
+        /* the legacy readers share globals (record.c's fp, for one),
+           so the workers are processes;  each appends what it reads */
+        fflush ( NULL );
+        for ( k = 0; k < jobs; k++ )
+            {
+            pids[k] = fork();
+            if ( pids[k] == 0 )
+                {
+                ix_prefetch_some ( miss, nmiss, k, jobs, reader );
+                _exit ( 0 );
+                }
+            if ( pids[k] < 0 )
+                ix_prefetch_some ( miss, nmiss, k, jobs, reader );
+            }
+        for ( k = 0; k < jobs; k++ )
+            if ( pids[k] > 0 ) waitpid ( pids[k], NULL, 0 );
+        free ( pids );
+        ix_load();
+        }
+    free ( miss );
+    }
@@ -0,0 +1,84 @@
+#ifndef METAINDEX_H
+#define METAINDEX_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: metaindex.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Persistent index of get_info() headers.
+ *
+ *  get_info_local1() remembers headers only for the life of the process,
+ *  so every new session re-opens every file of every case.  This index
+ *  keeps the VIS_DATA header fields (species, units, map_info, dates,
+ *  dimensions and default clamps) in a small binary file, keyed on the
+ *  file's real path, size and modification time, so an unchanged file is
+ *  never opened for get_info again.  A file whose size or time changes
+ *  simply misses, and is re-read and re-entered.
+ *
+ *  The index is $PAVE_METAINDEX, or ~/.pave_metaindex by default;
+ *  PAVE_METAINDEX=off turns it off.  It is an append-only log of
+ *  records, written with one write() per record under flock(), so that
+ *  several PAVE sessions (and the prefetch workers) may share it;  the
+ *  newest record for a path wins, and superseded records are dropped
+ *  when the file is next compacted.
+ *
+ *  Other modules may keep sidecar records for a file in the index too
+ *  (planesum.c's plane summaries, for one):  an opaque payload under a
+ *  tag, valid, like the header, while the file's size and modification
+ *  time are unchanged.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  sidecar records
+ ****************************************************************************/
+
+#include <stddef.h>
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define METAINDEX_ENV       "PAVE_METAINDEX"
+#define METAINDEX_FILE      ".pave_metaindex"   /* in $HOME */
+#define METAINDEX_MAX_JOBS  (8)                 /* prefetch worker processes */
+
+/* if info->filename is indexed and unchanged, fills in info's header
+   fields from the index (keeping filename and filehost) and returns
+   PAVE_SUCCESS;  otherwise returns FAILURE and leaves info alone */
+int metaindex_lookup ( VIS_DATA *info );
+
+/* enters the header fields of info, just filled in by get_info */
+void metaindex_store ( VIS_DATA *info );
+
+/* reads (with reader(), normally get_info_local2()) and enters the
+   headers of those of names[0..n-1] not already indexed, in up to
+   METAINDEX_MAX_JOBS parallel processes */
+void metaindex_prefetch ( char **names, int n,
+                          int ( *reader ) ( VIS_DATA *info, char *message ) );
+
+/* if filename has a current record under tag, sets *data to a malloc()ed
+   copy of its payload and *len to its length, and returns PAVE_SUCCESS;
+   otherwise returns FAILURE */
+int metaindex_get_record ( const char *filename, const char *tag,
+                           char **data, size_t *len );
+
+/* enters data[0..len-1] as filename's record under tag, replacing any
+   earlier one */
+void metaindex_put_record ( const char *filename, const char *tag,
+                            const char *data, size_t len );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* METAINDEX_H */
@@ -0,0 +1,494 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: nccache.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Sidecar netCDF-4 cache for legacy (UAM-IV, UAM-V, TOPLATS) inputs;
+ *  see nccache.h.
+ *
+ *  The cached copy has dimensions TSTEP, LAY, ROW, COL and one float
+ *  variable VARnnn per species (nnn is the 1-based species number, so
+ *  that species names need not be legal netCDF names), chunked one
+ *  step, one level and a block of rows at a time and deflated.  The
+ *  conversion runs in a separate program, NCCACHE_HELPER, started with
+ *  posix_spawnp() (PAVE and visd have threads, so a fork()ed copy of
+ *  them may not go on to netCDF or malloc).  The helper detaches and
+ *  converts at low priority, reading through the ordinary legacy
+ *  get_info_local2() and get_data_local1() paths, and renames its
+ *  output into place only when it is complete.
+ *
+ *  Without netCDF-4 (NC_NETCDF4 undefined) nccache_get_data() always
+ *  declines, and the legacy readers are used as before.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  convert in the NCCACHE_HELPER program instead of
+ *      a fork()ed copy of the caller;  read_cache() leaves info's bounds
+ *      alone unless it succeeds.
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "netcdf.h"
+#include "vis_data.h"
+#include "nccache.h"
+#include "gridtarget.h"
+
+#define PAVE_SUCCESS 1
+#define FAILURE 0
+
+#define CACHE_PATHLEN   ( PATH_MAX + 64 )   /* cache_name() buffers */
+#define SIDECAR_PATHLEN ( CACHE_PATHLEN + 32 )  /* with ".lock" etc. appended */
+
+#ifdef NC_NETCDF4
+
+extern char **environ;
+
+extern int   get_info_local2 ( VIS_DATA *info, char *message );
+extern int   get_data_local1 ( VIS_DATA *info, char *message );
+extern VIS_DATA *VIS_DATA_dup ( VIS_DATA *info, char *estring );
+extern void  free_vis ( VIS_DATA *info );
+extern float setNaNf ( void );
+
+static int nccacheBusy = 0;     /* set while converting:  read the legacy file */
+
+
+/* Cache file name for "filename":  <dir>/<path hash>-<size>-<mtime>.nc;
+   returns 0 if the cache is off or the file cannot be stat()ed */
+static int cache_name ( char *filename, char *path, size_t len )
+    {
+    char   *dir, abspath[PATH_MAX];
+    struct stat st;
+    unsigned long long h;
+    const unsigned char *p;
+
+    dir = getenv ( NCCACHE_ENV );
+    if ( ( dir == NULL ) || ( *dir == '\0' ) || ( filename == NULL ) )
+        return 0;
+    if ( stat ( filename, &st ) != 0 )
+        return 0;
+    if ( realpath ( filename, abspath ) == NULL )
+        strncpy ( abspath, filename, sizeof ( abspath ) - 1 );
+    abspath[sizeof ( abspath ) - 1] = '\0';
+
+    h = 14695981039346656037ULL;                    /* FNV-1a */
+    for ( p = ( const unsigned char * ) abspath; *p; p++ )
+        h = ( h ^ *p ) * 1099511628211ULL;
+
+    return snprintf ( path, len, "%s/%016llx-%lld-%ld.nc", dir, h,
+                      ( long long ) st.st_size, ( long ) st.st_mtime ) < ( int ) len;
+    }
+
+
+/* <path><suffix> into name[SIDECAR_PATHLEN] */
+static void sidecar_name ( char *name, const char *path, const char *suffix )
+    {
+    size_t n = strlen ( path );
+
+    if ( n > CACHE_PATHLEN - 1 ) n = CACHE_PATHLEN - 1;
+    memcpy ( name, path, n );
+    strncpy ( name + n, suffix, SIDECAR_PATHLEN - n - 1 );
+    name[SIDECAR_PATHLEN - 1] = '\0';
+    }
+
+
+/* UAM and UAM-V readers honor the slice;  toplats_get_data() always
+   returns every step of the whole (single-layer) grid, and so does the
+   cache for it */
+static int whole_grid ( VIS_DATA *info )
+    {
+    return ( info->dataset != UAM_DATA ) && ( info->dataset != UAMV_DATA );
+    }
+
+
+/* ---------------------------  conversion  ---------------------------- */
+
+static int convert ( VIS_DATA *info, char *path )
+    {
+    char     tmpname[SIDECAR_PATHLEN], suffix[32], name[16], message[512];
+    int      ncid, dimids[4], *varids, status, k, ok;
+    size_t   chunks[4];
+    VIS_DATA *vdata;
+
+    sprintf ( suffix, ".tmp%ld", ( long ) getpid() );
+    sidecar_name ( tmpname, path, suffix );
+    if ( nc_create ( tmpname, NC_NETCDF4 | NC_CLOBBER, &ncid ) != NC_NOERR )
+        return FAILURE;
+
+    varids = ( int * ) malloc ( info->nspecies * sizeof ( int ) );
+    chunks[0] = 1;
+    chunks[1] = 1;
+    chunks[2] = NCCACHE_CHUNK_CELLS / info->ncol;
+    if ( chunks[2] < 1 ) chunks[2] = 1;
+    if ( chunks[2] > ( size_t ) info->nrow ) chunks[2] = info->nrow;
+    chunks[3] = info->ncol;
+
+    status = ( varids == NULL ) ? NC_ENOMEM : NC_NOERR;
+    if ( status == NC_NOERR ) status = nc_def_dim ( ncid, "TSTEP", info->nstep,  dimids   );
+    if ( status == NC_NOERR ) status = nc_def_dim ( ncid, "LAY",   info->nlevel, dimids+1 );
+    if ( status == NC_NOERR ) status = nc_def_dim ( ncid, "ROW",   info->nrow,   dimids+2 );
+    if ( status == NC_NOERR ) status = nc_def_dim ( ncid, "COL",   info->ncol,   dimids+3 );
+    for ( k = 0; ( status == NC_NOERR ) && ( k < info->nspecies ); k++ )
+        {
+        sprintf ( name, "VAR%03d", k+1 );
+        status = nc_def_var ( ncid, name, NC_FLOAT, 4, dimids, varids+k );
+        if ( status == NC_NOERR )
+            status = nc_def_var_chunking ( ncid, varids[k], NC_CHUNKED, chunks );
+        if ( status == NC_NOERR )
+            status = nc_def_var_deflate ( ncid, varids[k], 1, 1, NCCACHE_DEFLATE );
+        if ( ( status == NC_NOERR ) && info->species_short_name && info->species_short_name[k] )
+            status = nc_put_att_text ( ncid, varids[k], "long_name",
+                                       strlen ( info->species_short_name[k] ),
+                                       info->species_short_name[k] );
+        if ( ( status == NC_NOERR ) && info->units_name && info->units_name[k] )
+            status = nc_put_att_text ( ncid, varids[k], "units",
+                                       strlen ( info->units_name[k] ), info->units_name[k] );
+        }
+    if ( status == NC_NOERR )
+        status = nc_put_att_text ( ncid, NC_GLOBAL, "source",
+                                   strlen ( info->filename ), info->filename );
+    if ( status == NC_NOERR )
+        status = nc_enddef ( ncid );
+
+    for ( k = 0; ( status == NC_NOERR ) && ( k < info->nspecies ); k++ )
+        {
+        vdata = VIS_DATA_dup ( info, message );
+        if ( vdata == NULL )
+            {
+            status = NC_ENOMEM;
+            break;
+            }
+        if ( vdata->grid ) free ( vdata->grid );
+        vdata->grid             = NULL;
+        vdata->slice            = XYZTSLICE;
+        vdata->selected_species = k+1;
+        vdata->col_min   = vdata->row_min = vdata->level_min = vdata->step_min = 1;
+        vdata->col_max   = info->ncol;
+        vdata->row_max   = info->nrow;
+        vdata->level_max = info->nlevel;
+        vdata->step_max  = info->nstep;
+        vdata->step_incr = 1;
+
+        ok = get_data_local1 ( vdata, message ) && ( vdata->grid != NULL );
+        status = ok ? nc_put_var_float ( ncid, varids[k], vdata->grid ) : NC_EINVAL;
+        free_vis ( vdata );
+        free ( vdata );
+        }
+
+    if ( nc_close ( ncid ) != NC_NOERR )
+        status = NC_EINVAL;
+    free ( varids );
+    if ( ( status != NC_NOERR ) || ( rename ( tmpname, path ) != 0 ) )
+        {
+        unlink ( tmpname );
+        return FAILURE;
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+/* Starts NCCACHE_HELPER on info's file unless a conversion is already
+   under way, as shown by <path>.lock, or one has failed within
+   NCCACHE_RETRY_SECS, as shown by <path>.failed (which holds the time
+   of the failure).  The helper detaches at once, and removes the lock
+   when it is done. */
+static void start_conversion ( VIS_DATA *info, char *path )
+    {
+    char   lockname[SIDECAR_PATHLEN], failname[SIDECAR_PATHLEN];
+    char  *argv[4];
+    struct stat st;
+    pid_t  pid;
+    int    fd, status;
+
+    sidecar_name ( failname, path, ".failed" );
+    if ( ( stat ( failname, &st ) == 0 ) &&
+            ( time ( NULL ) - st.st_mtime < NCCACHE_RETRY_SECS ) )
+        return;
+
+    sidecar_name ( lockname, path, ".lock" );
+    fd = open ( lockname, O_CREAT | O_EXCL | O_WRONLY, 0644 );
+    if ( ( fd < 0 ) && ( errno == EEXIST ) && ( stat ( lockname, &st ) == 0 ) &&
+            ( time ( NULL ) - st.st_mtime > NCCACHE_STALE_SECS ) )
+        {
+        unlink ( lockname );
+        fd = open ( lockname, O_CREAT | O_EXCL | O_WRONLY, 0644 );
+        }
+    if ( fd < 0 )
+        return;
+    close ( fd );
+
+    argv[0] = NCCACHE_HELPER;
+    argv[1] = info->filename;
+    argv[2] = path;
+    argv[3] = NULL;
+    fflush ( NULL );
+    if ( posix_spawnp ( &pid, NCCACHE_HELPER, NULL, NULL, argv, environ ) != 0 )
+        {
+        unlink ( lockname );
+        return;
+        }
+    if ( ( waitpid ( pid, &status, 0 ) != pid ) ||
+            !WIFEXITED ( status ) || ( WEXITSTATUS ( status ) != 0 ) )
+        unlink ( lockname );     /* not started:  no helper on PATH, say */
+    }
+
+
+int nccache_convert ( char *filename, char *path )
+    {
+    char     lockname[SIDECAR_PATHLEN], failname[SIDECAR_PATHLEN], stamp[32];
+    char     message[512];
+    VIS_DATA info;
+    int      fd, ok;
+
+    sidecar_name ( lockname, path, ".lock" );
+    sidecar_name ( failname, path, ".failed" );
+
+    nccacheBusy = 1;
+    memset ( &info, 0, sizeof ( info ) );
+    info.filename = strdup ( filename );
+    ok = ( info.filename != NULL ) && get_info_local2 ( &info, message ) &&
+         ( info.nspecies > 0 ) && ( info.ncol > 0 ) && convert ( &info, path );
+    free_vis ( &info );
+
+    if ( ok )
+        unlink ( failname );
+    else
+        {
+        fprintf ( stderr, "nccache:  could not cache %s\n", filename );
+        fd = open ( failname, O_CREAT | O_TRUNC | O_WRONLY, 0644 );
+        if ( fd >= 0 )
+            {
+            sprintf ( stamp, "%ld\n", ( long ) time ( NULL ) );
+            if ( write ( fd, stamp, strlen ( stamp ) ) < 0 )
+                unlink ( failname );
+            close ( fd );
+            }
+        }
+    unlink ( lockname );
+    return ok ? PAVE_SUCCESS : FAILURE;
+    }
+
+
+/* ------------------------------  reads  ------------------------------ */
+
+static void apply_slice ( VIS_DATA *info )
+    {
+    switch ( info->slice )
+        {
+        case XYSLICE:
+            info->level_min = info->level_max = info->selected_level;
+            info->step_min  = info->step_max  = info->selected_step;
+            break;
+        case YZSLICE:
+            info->col_min  = info->col_max  = info->selected_col;
+            info->step_min = info->step_max = info->selected_step;
+            break;
+        case XZSLICE:
+            info->row_min  = info->row_max  = info->selected_row;
+            info->step_min = info->step_max = info->selected_step;
+            break;
+        case XYZSLICE:
+            info->step_min = info->step_max = info->selected_step;
+            break;
+        case XYTSLICE:
+            info->level_min = info->level_max = info->selected_level;
+            break;
+        case YZTSLICE:
+            info->col_min = info->col_max = info->selected_col;
+            break;
+        case XZTSLICE:
+            info->row_min = info->row_max = info->selected_row;
+            break;
+        }
+    }
+
+static int read_cache ( char *path, VIS_DATA *info, char *message )
+    {
+    char    name[16];
+    int     ncid, varid, ndims, dimids[4], i, j, it, ok;
+    size_t  len, start[4], count[4], nslice, n;
+    float  *grid, vmin, vmax;
+    int     dims[4];
+    VIS_DATA box;       /* this read's bounds:  copied to info on success */
+
+    if ( nc_open ( path, NC_NOWRITE, &ncid ) != NC_NOERR )
+        return FAILURE;
+
+    sprintf ( name, "VAR%03d", info->selected_species );
+    dims[0] = info->nstep;
+    dims[1] = info->nlevel;
+    dims[2] = info->nrow;
+    dims[3] = info->ncol;
+    ok = ( nc_inq_varid ( ncid, name, &varid ) == NC_NOERR ) &&
+         ( nc_inq_varndims ( ncid, varid, &ndims ) == NC_NOERR ) && ( ndims == 4 ) &&
+         ( nc_inq_vardimid ( ncid, varid, dimids ) == NC_NOERR );
+    for ( i = 0; ok && ( i < 4 ); i++ )
+        ok = ( nc_inq_dimlen ( ncid, dimids[i], &len ) == NC_NOERR ) && ( len == ( size_t ) dims[i] );
+    if ( !ok )
+        {
+        nc_close ( ncid );
+        return FAILURE;
+        }
+
+    box = *info;
+    if ( whole_grid ( info ) )
+        {
+        box.col_min   = box.row_min = box.level_min = box.step_min = 1;
+        box.col_max   = info->ncol;
+        box.row_max   = info->nrow;
+        box.level_max = info->nlevel;
+        box.step_max  = info->nstep;
+        box.step_incr = 1;
+        }
+    else
+        apply_slice ( &box );
+
+    if ( ( box.col_min   < 1 ) || ( box.col_max   > info->ncol   ) ||
+            ( box.row_min   < 1 ) || ( box.row_max   > info->nrow   ) ||
+            ( box.level_min < 1 ) || ( box.level_max > info->nlevel ) ||
+            ( box.step_min  < 1 ) || ( box.step_max  > info->nstep  ) ||
+            ( box.col_min > box.col_max ) || ( box.row_min > box.row_max ) ||
+            ( box.level_min > box.level_max ) || ( box.step_min > box.step_max ) ||
+            ( box.step_incr < 1 ) )
+        {
+        nc_close ( ncid );
+        return FAILURE;     /* let the legacy reader report it */
+        }
+
+    count[0] = 1;
+    count[1] = box.level_max - box.level_min + 1;
+    count[2] = box.row_max   - box.row_min   + 1;
+    count[3] = box.col_max   - box.col_min   + 1;
+    start[1] = box.level_min - 1;
+    start[2] = box.row_min   - 1;
+    start[3] = box.col_min   - 1;
+    nslice   = count[1] * count[2] * count[3];
+    n        = nslice * ( ( box.step_max - box.step_min ) / box.step_incr + 1 );
+
+    grid = grid_alloc ( info, n );
+    if ( grid == NULL )
+        {
+        nc_close ( ncid );
+        sprintf ( message, "Cannnot allocate memory for data grid.\n" );
+        return FAILURE;
+        }
+
+    ok = 1;
+    if ( box.step_incr == 1 )
+        {
+        start[0] = box.step_min - 1;
+        count[0] = box.step_max - box.step_min + 1;
+        ok = ( nc_get_vara_float ( ncid, varid, start, count, grid ) == NC_NOERR );
+        }
+    else
+        {
+        for ( it = box.step_min, j = 0; ok && ( it <= box.step_max );
+                it += box.step_incr, j++ )
+            {
+            start[0] = it - 1;
+            ok = ( nc_get_vara_float ( ncid, varid, start, count, grid + j*nslice ) == NC_NOERR );
+            }
+        }
+    nc_close ( ncid );
+    if ( !ok )
+        {
+        grid_free ( info, grid );
+        return FAILURE;
+        }
+
+    /* compact the step dates and times as uam_get_data() does */
+    if ( !whole_grid ( info ) && info->sdate && info->stime )
+        {
+        for ( it = box.step_min; it <= box.step_max; it += box.step_incr )
+            {
+            info->sdate[it-box.step_min] = info->sdate[it-1];
+            info->stime[it-box.step_min] = info->stime[it-1];
+            }
+        }
+
+    vmin = vmax = setNaNf();
+    for ( i = 0, j = 0; ( size_t ) i < n; i++ )
+        {
+        if ( grid[i] != grid[i] ) continue;         /* NaN */
+        if ( !j )
+            {
+            vmin = vmax = grid[i];
+            j = 1;
+            }
+        else if ( grid[i] < vmin )
+            vmin = grid[i];
+        else if ( grid[i] > vmax )
+            vmax = grid[i];
+        }
+
+    info->col_min   = box.col_min;
+    info->col_max   = box.col_max;
+    info->row_min   = box.row_min;
+    info->row_max   = box.row_max;
+    info->level_min = box.level_min;
+    info->level_max = box.level_max;
+    info->step_min  = box.step_min;
+    info->step_max  = box.step_max;
+    info->step_incr = box.step_incr;
+    if ( info->grid ) grid_free ( info, info->grid );
+    info->grid     = grid;
+    info->grid_min = vmin;
+    info->grid_max = vmax;
+    return PAVE_SUCCESS;
+    }
+
+
+int nccache_get_data ( VIS_DATA *info, char *message )
+    {
+    char path[CACHE_PATHLEN];
+
+    if ( nccacheBusy || ( info->slice == NONESLICE ) ||
+            ( info->nspecies < 1 ) || ( info->selected_species < 1 ) ||
+            ( info->selected_species > info->nspecies ) ||
+            ( whole_grid ( info ) && ( info->nlevel != 1 ) ) ||
+            !cache_name ( info->filename, path, sizeof ( path ) ) )
+        return FAILURE;
+
+    if ( access ( path, R_OK ) == 0 )
+        return read_cache ( path, info, message );
+
+    start_conversion ( info, path );
+    return FAILURE;
+    }
+
+#else   /* no netCDF-4:  always use the legacy readers */
+
+int nccache_get_data ( VIS_DATA *info, char *message )
+    {
+    return FAILURE;
+    }
+
+int nccache_convert ( char *filename, char *path )
+    {
+    return FAILURE;
+    }
+
+#endif  /* NC_NETCDF4 */
@@ -0,0 +1,63 @@
+#ifndef NCCACHE_H
+#define NCCACHE_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: nccache.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Sidecar netCDF-4 cache for UAM-IV, UAM-V and TOPLATS inputs.
+ *
+ *  Opt-in:  set PAVE_NCCACHE to a writable directory.  The first
+ *  get_data_local1() on a legacy file starts a background conversion
+ *  into a chunked, compressed netCDF-4 copy in that directory, named
+ *  for the source file's path, size and modification time;  once that
+ *  copy exists, nccache_get_data() serves reads from it.  Changing the
+ *  source file changes the name, so stale copies are simply not found.
+ *  (For UAM-V and TOPLATS the key is the metafile; touch it after
+ *  replacing the data files it names.)  A failed conversion leaves a
+ *  ".failed" marker beside the copy's name, and that file is not tried
+ *  again for NCCACHE_RETRY_SECS.  Conversions are done by the
+ *  NCCACHE_HELPER program, which must be on PATH.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  NCCACHE_HELPER and nccache_convert()
+ ****************************************************************************/
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define NCCACHE_ENV          "PAVE_NCCACHE"
+#define NCCACHE_HELPER       "nccacheConvert"   /* the converter program */
+#define NCCACHE_CHUNK_CELLS  (16384)    /* target floats per (step,level,row-block) chunk */
+#define NCCACHE_DEFLATE      (1)        /* zlib level:  fast, and most of the gain */
+#define NCCACHE_STALE_SECS   (3600)     /* lock age at which a conversion is presumed dead */
+#define NCCACHE_RETRY_SECS   (86400)    /* after a failed conversion, wait this long to retry */
+
+/* Serves info's get_data request from the cached copy, if there is one,
+   and returns PAVE_SUCCESS.  Otherwise starts the conversion (unless one
+   is already running) and returns FAILURE, and the caller goes on to
+   the legacy reader. */
+int nccache_get_data ( VIS_DATA *info, char *message );
+
+/* NCCACHE_HELPER's work:  converts filename into the cached copy path,
+   leaving <path>.failed if it cannot, and removes <path>.lock.
+   Returns PAVE_SUCCESS or FAILURE. */
+int nccache_convert ( char *filename, char *path );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* NCCACHE_H */
@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: nccacheConvert.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  The netCDF-4 sidecar cache's converter (NCCACHE_HELPER;  see
+ *  nccache.h), started by nccache.c as
+ *
+ *      nccacheConvert <legacy file> <cached copy>
+ *
+ *  It detaches at once, so that its starter need only wait for it to
+ *  exit, and converts in the background at low priority.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "vis_data.h"
+#include "nccache.h"
+
+int main ( int argc, char *argv[] )
+    {
+    pid_t pid;
+
+    if ( argc != 3 )
+        {
+        fprintf ( stderr, "usage: %s <legacy file> <cached copy>\n", argv[0] );
+        return 2;
+        }
+
+    /* the grandchild is reparented, so nobody need wait for it */
+    fflush ( NULL );
+    pid = fork();
+    if ( pid > 0 )
+        return 0;
+    if ( pid == 0 )
+        nice ( 10 );
+    nccache_convert ( argv[1], argv[2] );       /* in the foreground, if fork() failed */
+    return 0;
+    }
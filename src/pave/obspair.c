@@ -0,0 +1,345 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: obspair.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Model/observation pairing;  see obspair.h.
+ *
+ *  The spatial hash is a counting sort of the stations by home cell
+ *  (the cell of a station's first sample on the grid), in CSR form.
+ *  Observation networks are nearly always fixed, but the obs data do
+ *  carry a location per sample;  if some station does change cells,
+ *  the pairing is marked "moving" and obspair_stations_in() falls back
+ *  to every station, leaving the callers' own per-sample tests exact.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "obspair.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define OBSPAIR_PAR     (4096)      /* fewer samples than this:  serial */
+
+typedef struct              /* running sums for one station */
+    {
+    long    n;
+    double  mo, mm;         /* Welford means ... */
+    double  coo, cmm, com;  /* ... and co-moments */
+    double  sd, sad, ssd;   /* sums of d = model - obs, |d|, d*d */
+    double  so;             /* sum of obs */
+    } PairSums;
+
+
+static int int_compare ( const void *a, const void *b )
+    {
+    return *( const int * ) a - *( const int * ) b;
+    }
+
+
+static int sample_cell ( float x, float y, int ncol, int nrow )
+    {
+    int c, r;
+
+    if ( isnan ( x ) || isnan ( y ) ) return -1;
+    if ( ( x < 0.0 ) || ( y < 0.0 ) ||
+         ( x >= ( float ) ncol ) || ( y >= ( float ) nrow ) ) return -1;
+    c = ( int ) x;
+    r = ( int ) y;
+    if ( c >= ncol ) c = ncol - 1;      /* float rounding at the edge */
+    if ( r >= nrow ) r = nrow - 1;
+    return c + ncol * r;
+    }
+
+
+int obspair_build ( ObsPair *p, int nsta, int nobs, const float *x,
+                    const float *y, int ncol, int nrow, char *message )
+    {
+    long k, nsamp, ncell;
+    int  s, c, *fill;
+
+    memset ( p, 0, sizeof ( ObsPair ) );
+    if ( ( nsta <= 0 ) || ( nobs <= 0 ) || ( ncol <= 0 ) || ( nrow <= 0 ) )
+        {
+        sprintf ( message, "obspair_build:  empty obs data or grid" );
+        return FAILURE;
+        }
+    p->nsta = nsta;
+    p->nobs = nobs;
+    p->ncol = ncol;
+    p->nrow = nrow;
+    nsamp   = ( long ) nsta * nobs;
+    ncell   = ( long ) ncol * nrow;
+
+    p->cell  = ( int * ) malloc ( nsamp * sizeof ( int ) );
+    p->home  = ( int * ) malloc ( nsta * sizeof ( int ) );
+    p->start = ( int * ) calloc ( ncell + 1, sizeof ( int ) );
+    p->sta   = ( int * ) malloc ( nsta * sizeof ( int ) );
+    fill     = ( int * ) malloc ( ( ncell + 1 ) * sizeof ( int ) );
+    if ( !p->cell || !p->home || !p->start || !p->sta || !fill )
+        {
+        if ( fill ) free ( fill );
+        obspair_free ( p );
+        sprintf ( message, "obspair_build:  allocation failure" );
+        return FAILURE;
+        }
+
+#pragma omp parallel for schedule(static) if ( nsamp > OBSPAIR_PAR )
+    for ( k = 0; k < nsamp; k++ )
+        p->cell[k] = sample_cell ( x[k], y[k], ncol, nrow );
+
+    for ( s = 0; s < nsta; s++ )
+        {
+        p->home[s] = -1;
+        for ( k = s; k < nsamp; k += nsta )
+            {
+            c = p->cell[k];
+            if ( c < 0 ) continue;
+            if ( p->home[s] < 0 )
+                p->home[s] = c;
+            else if ( c != p->home[s] )
+                p->moving = 1;
+            }
+        if ( p->home[s] >= 0 ) p->start[p->home[s] + 1]++;
+        }
+
+    for ( k = 0; k < ncell; k++ ) p->start[k+1] += p->start[k];
+    memcpy ( fill, p->start, ( ncell + 1 ) * sizeof ( int ) );
+    for ( s = 0; s < nsta; s++ )
+        if ( p->home[s] >= 0 ) p->sta[fill[p->home[s]]++] = s;
+
+    free ( fill );
+    return PAVE_SUCCESS;
+    }
+
+
+int obspair_stations_in ( const ObsPair *p, float x1, float y1,
+                          float x2, float y2, int *list )
+    {
+    int  c1, c2, r1, r2, c, r, s, n = 0;
+    long ncell;
+
+    if ( p->moving )
+        {
+        for ( s = 0; s < p->nsta; s++ ) list[s] = s;
+        return p->nsta;
+        }
+
+    if ( ( x2 < 0.0 ) || ( y2 < 0.0 ) ||
+         ( x1 >= ( float ) p->ncol ) || ( y1 >= ( float ) p->nrow ) ) return 0;
+    c1 = ( x1 > 0.0 ) ? ( int ) x1 : 0;
+    r1 = ( y1 > 0.0 ) ? ( int ) y1 : 0;
+    c2 = ( x2 < ( float ) p->ncol ) ? ( int ) x2 : p->ncol - 1;
+    r2 = ( y2 < ( float ) p->nrow ) ? ( int ) y2 : p->nrow - 1;
+    if ( c2 >= p->ncol ) c2 = p->ncol - 1;
+    if ( r2 >= p->nrow ) r2 = p->nrow - 1;
+    ncell = ( long ) ( c2 - c1 + 1 ) * ( r2 - r1 + 1 );
+
+    if ( ncell >= p->nsta )     /* more cells than stations:  scan those */
+        {
+        for ( s = 0; s < p->nsta; s++ )
+            {
+            int h = p->home[s];
+
+            if ( h < 0 ) continue;
+            c = h % p->ncol;
+            r = h / p->ncol;
+            if ( ( c >= c1 ) && ( c <= c2 ) && ( r >= r1 ) && ( r <= r2 ) )
+                list[n++] = s;
+            }
+        return n;
+        }
+
+    for ( r = r1; r <= r2; r++ )
+        {
+        int k0 = p->start[c1 + p->ncol * r];
+        int k1 = p->start[c2 + p->ncol * r + 1];
+
+        for ( ; k0 < k1; k0++ ) list[n++] = p->sta[k0];
+        }
+    qsort ( list, n, sizeof ( int ), int_compare );    /* station order */
+    return n;
+    }
+
+
+void obspair_model ( const ObsPair *p, const float *grid, int col0,
+                     int row0, int ni, int nj, int nt, const int *jstep,
+                     float *mod )
+    {
+    long plane = ( long ) ni * nj, nsamp = ( long ) p->nsta * p->nobs;
+    int *first, *next, t, o;
+
+    first = ( int * ) malloc ( p->nobs * sizeof ( int ) );
+    next  = ( int * ) malloc ( ( nt > 0 ? nt : 1 ) * sizeof ( int ) );
+    if ( !first || !next )
+        {
+        long k;
+
+        for ( k = 0; k < nsamp; k++ ) mod[k] = NAN;
+        if ( first ) free ( first );
+        if ( next  ) free ( next );
+        return;
+        }
+
+    /* the model steps of each obs step, as linked lists */
+
+    for ( o = 0; o < p->nobs; o++ ) first[o] = -1;
+    for ( t = nt - 1; t >= 0; t-- )
+        {
+        o = jstep[t];
+        if ( ( o < 0 ) || ( o >= p->nobs ) ) continue;
+        next[t]  = first[o];
+        first[o] = t;
+        }
+
+#pragma omp parallel for schedule(static) if ( nsamp > OBSPAIR_PAR )
+    for ( o = 0; o < p->nobs; o++ )
+        {
+        int s;
+
+        for ( s = 0; s < p->nsta; s++ )
+            {
+            long   k = ( long ) p->nsta * o + s, off;
+            int    c = p->cell[k], i, j, m, cnt = 0;
+            double sum = 0.0;
+
+            mod[k] = NAN;
+            if ( c < 0 ) continue;
+            i = c % p->ncol - col0;
+            j = c / p->ncol - row0;
+            if ( ( i < 0 ) || ( i >= ni ) || ( j < 0 ) || ( j >= nj ) ) continue;
+            off = i + ( long ) ni * j;
+            for ( m = first[o]; m >= 0; m = next[m] )
+                {
+                float v = grid[plane * m + off];
+
+                if ( isnan ( v ) ) continue;
+                sum += v;
+                cnt++;
+                }
+            if ( cnt ) mod[k] = ( float ) ( sum / cnt );
+            }
+        }
+
+    free ( first );
+    free ( next );
+    }
+
+
+static void sums_to_stats ( const PairSums *a, ObsPairStats *st )
+    {
+    memset ( st, 0, sizeof ( ObsPairStats ) );
+    st->n = a->n;
+    if ( a->n == 0 )
+        {
+        st->mean_obs = st->mean_mod = st->bias = st->rmse = NAN;
+        st->nmb = st->nme = st->r = NAN;
+        return;
+        }
+    st->mean_obs = a->mo;
+    st->mean_mod = a->mm;
+    st->bias     = a->sd / a->n;
+    st->rmse     = sqrt ( a->ssd / a->n );
+    st->nmb      = ( a->so != 0.0 ) ? a->sd  / a->so : NAN;
+    st->nme      = ( a->so != 0.0 ) ? a->sad / a->so : NAN;
+    st->r        = ( ( a->coo > 0.0 ) && ( a->cmm > 0.0 ) ) ?
+                   a->com / sqrt ( a->coo * a->cmm ) : NAN;
+    }
+
+
+void obspair_stats ( const ObsPair *p, const float *obs, const float *mod,
+                     ObsPairStats *station, ObsPairStats *all )
+    {
+    long      nsamp = ( long ) p->nsta * p->nobs;
+    PairSums *sums, tot;
+    int       s;
+
+    memset ( &tot, 0, sizeof ( PairSums ) );
+    sums = ( PairSums * ) calloc ( p->nsta, sizeof ( PairSums ) );
+    if ( !sums )
+        {
+        sums_to_stats ( &tot, all );
+        return;
+        }
+
+#pragma omp parallel for schedule(static) if ( nsamp > OBSPAIR_PAR )
+    for ( s = 0; s < p->nsta; s++ )
+        {
+        PairSums *a = sums + s;
+        long      k;
+
+        for ( k = s; k < nsamp; k += p->nsta )
+            {
+            double o = obs[k], m = mod[k], d, eo, em;
+
+            if ( isnan ( o ) || isnan ( m ) ) continue;
+            a->n++;
+            eo     = o - a->mo;
+            em     = m - a->mm;
+            a->mo += eo / a->n;
+            a->mm += em / a->n;
+            a->coo += eo * ( o - a->mo );
+            a->cmm += em * ( m - a->mm );
+            a->com += eo * ( m - a->mm );
+            d       = m - o;
+            a->sd  += d;
+            a->sad += fabs ( d );
+            a->ssd += d * d;
+            a->so  += o;
+            }
+        }
+
+    for ( s = 0; s < p->nsta; s++ )     /* Chan et al. pairwise merge */
+        {
+        const PairSums *b = sums + s;
+        double          n, f, dmo, dmm;
+
+        if ( station ) sums_to_stats ( b, station + s );
+        if ( b->n == 0 ) continue;
+        n   = ( double ) ( tot.n + b->n );
+        f   = ( double ) tot.n * b->n / n;
+        dmo = b->mo - tot.mo;
+        dmm = b->mm - tot.mm;
+        tot.mo  += dmo * b->n / n;
+        tot.mm  += dmm * b->n / n;
+        tot.coo += b->coo + dmo * dmo * f;
+        tot.cmm += b->cmm + dmm * dmm * f;
+        tot.com += b->com + dmo * dmm * f;
+        tot.sd  += b->sd;
+        tot.sad += b->sad;
+        tot.ssd += b->ssd;
+        tot.so  += b->so;
+        tot.n   += b->n;
+        }
+    sums_to_stats ( &tot, all );
+    free ( sums );
+    }
+
+
+void obspair_free ( ObsPair *p )
+    {
+    if ( p->cell  ) free ( p->cell );
+    if ( p->home  ) free ( p->home );
+    if ( p->start ) free ( p->start );
+    if ( p->sta   ) free ( p->sta );
+    memset ( p, 0, sizeof ( ObsPair ) );
+    }
@@ -0,0 +1,101 @@
+#ifndef OBSPAIR_H
+#define OBSPAIR_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: obspair.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Pairing of point observations with a model grid.
+ *
+ *  Observation data come as TileWnd's OBS_PLOT overlays have them:  for
+ *  each of nobs obs steps, nsta stations, with a value and a location
+ *  (here, in grid units from the grid's lower-left corner) per sample.
+ *  obspair_build() is done once per (obs data, grid):  it records the
+ *  grid cell of every sample, and a spatial hash of the stations by the
+ *  cell each one sits in, so that the stations in a rectangle (the
+ *  visible part of a tile plot, or a rubber-band selection) are found
+ *  by visiting its cells instead of every station.  A pairing stays
+ *  valid for as long as the obs data and the grid do:  a new model
+ *  formula on the same grid only needs obspair_model() and
+ *  obspair_stats() again.
+ *
+ *  obspair_model() samples a model window at every located obs sample,
+ *  averaging the model steps that fall in each obs step (hourly model
+ *  values against daily observations, for example).  obspair_stats()
+ *  takes the paired (non-missing) samples of each station in one pass,
+ *  with Welford updates, and merges the stations' partials (Chan et al.)
+ *  into the overall metrics:  mean bias, RMSE, normalized mean bias and
+ *  error (NMB, NME:  relative to the total observed), and correlation.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+typedef struct
+    {
+    int     nsta;           /* stations */
+    int     nobs;           /* obs steps */
+    int     ncol, nrow;     /* the grid */
+    int     moving;         /* does some station change cells? */
+    int    *cell;           /* [nobs*nsta]:  cell (col + ncol*row, 0-based)
+                               of each sample, or -1 if off the grid */
+    int    *home;           /* [nsta]:  cell of each station, or -1 */
+    int    *start;          /* spatial hash:  the stations in cell c are */
+    int    *sta;            /* ... sta[start[c] .. start[c+1]-1] */
+    } ObsPair;
+
+typedef struct
+    {
+    long    n;              /* paired samples */
+    double  mean_obs, mean_mod;
+    double  bias;           /* mean ( model - obs ) */
+    double  rmse;
+    double  nmb;            /* sum ( model - obs ) / sum ( obs ) */
+    double  nme;            /* sum | model - obs | / sum ( obs ) */
+    double  r;              /* correlation */
+    } ObsPairStats;
+
+/* pairs the samples at x[k], y[k] (grid units from the lower-left
+   corner;  sample k = nsta*step + station) with an ncol x nrow grid:
+   PAVE_SUCCESS, or FAILURE with an error string written into message */
+int obspair_build ( ObsPair *p, int nsta, int nobs, const float *x,
+                    const float *y, int ncol, int nrow, char *message );
+
+/* the stations (at most nsta of them) that may have samples in the
+   rectangle x1 <= x <= x2, y1 <= y <= y2, written into list[];  returns
+   how many */
+int obspair_stations_in ( const ObsPair *p, float x1, float y1,
+                          float x2, float y2, int *list );
+
+/* mod[nobs*nsta]:  for each sample, the mean over the model steps t
+   with jstep[t] == its obs step of grid[] at its cell, or NaN.  grid
+   holds nt ni x nj planes, of the window with lower-left cell
+   (col0, row0) (0-based) */
+void obspair_model ( const ObsPair *p, const float *grid, int col0,
+                     int row0, int ni, int nj, int nt, const int *jstep,
+                     float *mod );
+
+/* metrics over the samples where both obs[] and mod[] are present:  for
+   each station into station[nsta] (unless NULL), and overall */
+void obspair_stats ( const ObsPair *p, const float *obs, const float *mod,
+                     ObsPairStats *station, ObsPairStats *all );
+
+void obspair_free ( ObsPair *p );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* OBSPAIR_H */
@@ -63,7 +63,8 @@ PURPOSE:
 
     Given terminal symbols I, (, ), abs, sqrt, sqr, log, exp,
     ln, sin, cos, tan, sind, cosd, tand, minx, miny, minz, maxx,
-    maxy, maxz, mean, min, max, sum, mint, maxt, +, -, **, *, /,
+    maxy, maxz, mean, min, max, sum, mint, maxt, colsum, colint, colmax,
+    colavg, +, -, **, *, /,
     <, <=, >, >=, !=, ==, &&, ||, -| (end of input string), and e the null
     string, the following context free grammar will be implemented:
 
@@ -74,27 +75,31 @@ PURPOSE:
     A     -> B ALIST            (, I, abs, log, sqr, sqrt, exp, ln,
                     sin, cos, tan, sind, cosd, tand,
                     minx, miny, minz, maxx, maxy, maxz,
-                    mean, min, max, sum, mint, maxt
+                    mean, min, max, sum, mint, maxt,
+                    colsum, colint, colmax, colavg
     ALIST -> || B { || } ALIST  ||
     ALIST -> e          -|, )
     B     -> C BLIST            (, I, abs, log, sqr, sqrt, exp, ln,
                     sin, cos, tan, sind, cosd, tand,
                     minx, miny, minz, maxx, maxy, maxz,
-                    mean, min, max, sum, mint, maxt
+                    mean, min, max, sum, mint, maxt,
+                    colsum, colint, colmax, colavg
     BLIST -> && C { && } BLIST  &&
     BLIST -> e          -|, ), ||
 
     C     -> D CLIST            (, I, abs, log, sqr, sqrt, exp, ln,
                     sin, cos, tan, sind, cosd, tand,
                     minx, miny, minz, maxx, maxy, maxz,
-                    mean, min, max, sum, mint, maxt
+                    mean, min, max, sum, mint, maxt,
+                    colsum, colint, colmax, colavg
     CLIST -> != D { != } CLIST  !=
     CLIST -> == D { == } CLIST  ==
     CLIST -> e          -|, ), &&, ||
     D     -> E DLIST            (, I, abs, log, sqr, sqrt, exp, ln,
                     sin, cos, tan, sind, cosd, tand,
                     minx, miny, minz, maxx, maxy, maxz,
-                    mean, min, max, sum, mint, maxt
+                    mean, min, max, sum, mint, maxt,
+                    colsum, colint, colmax, colavg
     DLIST -> <= { <= } DLIST    <=
     DLIST -> >= { >= } DLIST    >=
     DLIST -> >  { >  } DLIST    >
@@ -103,21 +108,24 @@ PURPOSE:
     E     -> T ELIST            (, I, abs, log, sqr, sqrt, exp, ln,
                     sin, cos, tan, sind, cosd, tand,
                     minx, miny, minz, maxx, maxy, maxz,
-                    mean, min, max, sum, mint, maxt
+                    mean, min, max, sum, mint, maxt,
+                    colsum, colint, colmax, colavg
     ELIST -> + T  { + } ELIST   +
     ELIST -> - T  { - } ELIST   -
     ELIST -> e          -|, ), <, <=, >, >=, !=, == , &&, ||
     T     -> Q TLIST        (, I, abs, log, sqr, sqrt, exp, ln,
                                     sin, cos, tan, sind, cosd, tand,
                                     minx, miny, minz, maxx, maxy, maxz,
-                                    mean, min, max, sum, mint, maxt
+                                    mean, min, max, sum, mint, maxt,
+                                    colsum, colint, colmax, colavg
     TLIST -> * Q  { * } TLIST   *
     TLIST -> / Q  { / } TLIST   /
     TLIST -> e          -|, ), +, -, <, <=, >, >=, !=, ==, &&, ||
     Q     -> P QLIST        (, I, abs, log, sqr, sqrt, exp, ln,
                                     sin, cos, tan, sind, cosd, tand,
                                     minx, miny, minz, maxx, maxy, maxz,
-                                    mean, min, max, sum, mint, maxt
+                                    mean, min, max, sum, mint, maxt,
+                                    colsum, colint, colmax, colavg
     QLIST -> ** P { ** } QLIST  **
     QLIST -> e          -|, ), +, -, *, /, <, <=, >, >=, !=, ==, &&, ||
     P     -> abs P  { abs }     abs
@@ -144,6 +152,10 @@ PURPOSE:
     P     -> sum P  { sum   }   sum
     P     -> mint P { mint   }  mint
     P     -> maxt P { maxt   }  maxt
+    P     -> colsum P { colsum } colsum
+    P     -> colint P { colint } colint
+    P     -> colmax P { colmax } colmax
+    P     -> colavg P { colavg } colavg
     P     -> ( A )          (
     P     -> I  { I }       I
 
@@ -195,6 +207,10 @@ PURPOSE:
     empty|x   x   x    x    x    x    x    x    x    x    x    x    x   x   x   x    x
          --------------------------------------------------------------------------------
 
+    The column operators colsum, colint, colmax, and colavg have the
+    same selection sets as mint and maxt, but for P, where they take
+    actions 47, 48, 49, and 50 respectively.
+
     Stack                     INPUT SYMBOLS
     Symb.                   < any input symbol >
          ---------------------------------------------------------------------------
@@ -235,6 +251,10 @@ PURPOSE:
     sum  |                     <-  output "sum", PR   ->
     mint |                     <-  output "mint", PR  ->
     maxt |                     <-  output "maxt", PR  ->
+    colsum |                   <-  output "colsum", PR  ->
+    colint |                   <-  output "colint", PR  ->
+    colmax |                   <-  output "colmax", PR  ->
+    colavg |                   <-  output "colavg", PR  ->
          ---------------------------------------------------------------------------
                            Starting Stack: A
 
@@ -289,12 +309,17 @@ PURPOSE:
        32   pop, push sum, push P, advance
        33   pop, push mint, push P, advance
        34   pop, push maxt, push P, advance
+       47   pop, push colsum, push P, advance
+       48   pop, push colint, push P, advance
+       49   pop, push colmax, push P, advance
+       50   pop, push colavg, push P, advance
        x    reject
 
      The operator precedence (highest to lowest) is as follows:
 
        1) abs, log, sqr, sqrt, exp, ln, sin, cos, tan, sind, cosd, tand,
-          minx, miny, minz, max, maxy, maxz, mean, min, max, sum, mint, maxt
+          minx, miny, minz, max, maxy, maxz, mean, min, max, sum, mint, maxt,
+          colsum, colint, colmax, colavg
        2) **
        3) /, *
        4) +, -
@@ -423,6 +448,9 @@ PURPOSE:
     SRT  10/21/96   Added makeSureIts_netCDF() calls
     
     CJC  02/2018    Version for PAVE-3.0
+
+    CJC  10/2026    Added the colsum, colint, colmax, and colavg
+                    column operators (see colop.h)
  ****************************************************************************/
 
 #include "bts.h"
@@ -534,6 +562,10 @@ struct BusData *bd;
 #define     ACT44       (44)
 #define     ACT45       (45)
 #define     ACT46       (46)
+#define     ACT47       (47)
+#define     ACT48       (48)
+#define     ACT49       (49)
+#define     ACT50       (50)
 #define     ADDACT      (130)
 #define     SUBACT      (131)
 #define     MULACT      (132)
@@ -575,6 +607,10 @@ struct BusData *bd;
 #define     NEQACT      (168)
 #define     ANDACT      (169)
 #define     ORACT       (170)
+#define     COLSUMACT   (171)
+#define     COLINTACT   (172)
+#define     COLMAXACT   (173)
+#define     COLAVGACT   (174)
 
 /* stack item and input atom types */
 #define     UNKNOWN     (0)
@@ -635,6 +671,10 @@ struct BusData *bd;
 #define     BLIST       (55)
 #define     AND         (56)
 #define     OR          (57)
+#define     COLSUM      (58)
+#define     COLINT      (59)
+#define     COLMAX      (60)
+#define     COLAVG      (61)
 
 
 /* function prototypes for routines for this file only */
@@ -755,6 +795,14 @@ char    *actiontype ( int t )
             return ( "pop, push ALIST, push ||, push B, advance" );
         case ACT46:
             return ( "pop, push BLIST, push &&, push C, advance" );
+        case ACT47:
+            return ( "pop, push colsum, push P, advance" );
+        case ACT48:
+            return ( "pop, push colint, push P, advance" );
+        case ACT49:
+            return ( "pop, push colmax, push P, advance" );
+        case ACT50:
+            return ( "pop, push colavg, push P, advance" );
         case ADDACT:
             return ( "ADDACT" );
         case SUBACT:
@@ -837,6 +885,14 @@ char    *actiontype ( int t )
             return ( "MINTACT" );
         case MAXTACT:
             return ( "MAXTACT" );
+        case COLSUMACT:
+            return ( "COLSUMACT" );
+        case COLINTACT:
+            return ( "COLINTACT" );
+        case COLMAXACT:
+            return ( "COLMAXACT" );
+        case COLAVGACT:
+            return ( "COLAVGACT" );
         default:
             return ( "???" );
         }
@@ -965,6 +1021,14 @@ char    *itemtype ( int t )
             return ( "mint" );
         case MAXT:
             return ( "maxt" );
+        case COLSUM:
+            return ( "colsum" );
+        case COLINT:
+            return ( "colint" );
+        case COLMAX:
+            return ( "colmax" );
+        case COLAVG:
+            return ( "colavg" );
         default:
             return ( "???" );
         }
@@ -1917,6 +1981,34 @@ static  int advance ( void )
         atomType = SUM;
         fpos += 3;
         }
+    else if ( strncmp ( &formula[fpos], "COLSUM", 6 ) == 0 )
+        {
+        if ( !lparen_check ( 6 ) ) goto maybe_species;
+        strcpy ( atom, "colsum" );
+        atomType = COLSUM;
+        fpos += 6;
+        }
+    else if ( strncmp ( &formula[fpos], "COLINT", 6 ) == 0 )
+        {
+        if ( !lparen_check ( 6 ) ) goto maybe_species;
+        strcpy ( atom, "colint" );
+        atomType = COLINT;
+        fpos += 6;
+        }
+    else if ( strncmp ( &formula[fpos], "COLMAX", 6 ) == 0 )
+        {
+        if ( !lparen_check ( 6 ) ) goto maybe_species;
+        strcpy ( atom, "colmax" );
+        atomType = COLMAX;
+        fpos += 6;
+        }
+    else if ( strncmp ( &formula[fpos], "COLAVG", 6 ) == 0 )
+        {
+        if ( !lparen_check ( 6 ) ) goto maybe_species;
+        strcpy ( atom, "colavg" );
+        atomType = COLAVG;
+        fpos += 6;
+        }
 
     else if ( strncasecmp ( &formula[fpos], "d[", 2 ) == 0 )
         {
@@ -2119,6 +2211,18 @@ static int get_action ( void )
         case MAXT:
             return MAXTACT;
 
+        case COLSUM:
+            return COLSUMACT;
+
+        case COLINT:
+            return COLINTACT;
+
+        case COLMAX:
+            return COLMAXACT;
+
+        case COLAVG:
+            return COLAVGACT;
+
         case A:
             switch ( atomType )
                 {
@@ -2147,6 +2251,10 @@ static int get_action ( void )
                 case MAXIMUM:
                 case MINT:
                 case MAXT:
+                case COLSUM:
+                case COLINT:
+                case COLMAX:
+                case COLAVG:
                 case SUM:
                     return ACT43;
                 }
@@ -2184,6 +2292,10 @@ static int get_action ( void )
                 case MAXIMUM:
                 case MINT:
                 case MAXT:
+                case COLSUM:
+                case COLINT:
+                case COLMAX:
+                case COLAVG:
                 case SUM:
                     return ACT44;
                 }
@@ -2221,6 +2333,10 @@ static int get_action ( void )
                 case MAXIMUM:
                 case MINT:
                 case MAXT:
+                case COLSUM:
+                case COLINT:
+                case COLMAX:
+                case COLAVG:
                 case SUM:
                     return ACT35;
                 }
@@ -2258,6 +2374,10 @@ static int get_action ( void )
                 case MAXIMUM:
                 case MINT:
                 case MAXT:
+                case COLSUM:
+                case COLINT:
+                case COLMAX:
+                case COLAVG:
                 case SUM:
                     return ACT36;
                 }
@@ -2295,6 +2415,10 @@ static int get_action ( void )
                 case MAXIMUM:
                 case MINT:
                 case MAXT:
+                case COLSUM:
+                case COLINT:
+                case COLMAX:
+                case COLAVG:
                 case SUM:
                     return ACT1;
                 }
@@ -2332,6 +2456,10 @@ static int get_action ( void )
                 case SUM:
                 case MINT:
                 case MAXT:
+                case COLSUM:
+                case COLINT:
+                case COLMAX:
+                case COLAVG:
                 case TAND:
                     return ACT2;
                 }
@@ -2369,6 +2497,10 @@ static int get_action ( void )
                 case SUM:
                 case MINT:
                 case MAXT:
+                case COLSUM:
+                case COLINT:
+                case COLMAX:
+                case COLAVG:
                 case TAND:
                     return ACT22;
                 }
@@ -2433,6 +2565,14 @@ static int get_action ( void )
                     return ACT33;
                 case MAXT:
                     return ACT34;
+                case COLSUM:
+                    return ACT47;
+                case COLINT:
+                    return ACT48;
+                case COLMAX:
+                    return ACT49;
+                case COLAVG:
+                    return ACT50;
                 }
             strcpy ( tstring, "Can't understand '" );
             strcat ( tstring, atom );
@@ -2854,6 +2994,30 @@ static  int process ( void )
             if ( advance() ) return 2;
             break;
 
+        case ACT47:
+            if ( push ( COLSUM ) ) return 2;
+            if ( push ( P ) ) return 2;
+            if ( advance() ) return 2;
+            break;
+
+        case ACT48:
+            if ( push ( COLINT ) ) return 2;
+            if ( push ( P ) ) return 2;
+            if ( advance() ) return 2;
+            break;
+
+        case ACT49:
+            if ( push ( COLMAX ) ) return 2;
+            if ( push ( P ) ) return 2;
+            if ( advance() ) return 2;
+            break;
+
+        case ACT50:
+            if ( push ( COLAVG ) ) return 2;
+            if ( push ( P ) ) return 2;
+            if ( advance() ) return 2;
+            break;
+
         case ACT43:
             if ( push ( ALIST ) ) return 2;
             if ( push ( B ) ) return 2;
@@ -3054,6 +3218,22 @@ static  int process ( void )
             output ( "sum " );
             break;
 
+        case COLSUMACT:
+            output ( "colsum " );
+            break;
+
+        case COLINTACT:
+            output ( "colint " );
+            break;
+
+        case COLMAXACT:
+            output ( "colmax " );
+            break;
+
+        case COLAVGACT:
+            output ( "colavg " );
+            break;
+
         case GTACT:
             output ( "> " );
             break;
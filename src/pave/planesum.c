@@ -0,0 +1,376 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: planesum.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Persistent per-plane summaries of file variables;  see planesum.h.
+ *
+ *  Record layout (metaindex tag "planesum/<species>"):  native-order
+ *  int32 nlevel and nstep, then nlevel*nstep PlaneSums, level fastest.
+ *
+ *  The last PS_CACHE tables used stay in memory, so that reading a file
+ *  a step at a time does not rewrite its record (all nstep planes of
+ *  it) once per step.  A table with new planes is written back once,
+ *  when its last plane is summarized, when it is evicted, or at exit;
+ *  only by the process that loaded it, so forked readers do not.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "vis_data.h"
+#include "metaindex.h"
+#include "planesum.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define PS_HEADER       ( 2 * sizeof ( int32_t ) )
+#define PS_CACHE        (8)     /* tables kept in memory */
+
+typedef struct
+    {
+    int32_t   nlevel, nstep;
+    PlaneSum *plane;        /* plane[ ( step-1 ) * nlevel + level-1 ] */
+    char     *rec;          /* the record:  header and planes */
+    long      unknown;      /* planes with n < 0 */
+    } PsTable;
+
+typedef struct
+    {
+    char     *filename;     /* NULL:  slot free */
+    int       species;
+    long long size, mtime;  /* of the file, when loaded */
+    int       dirty;        /* planes added since it was written */
+    PsTable   ps;
+    } PsCached;
+
+static PsCached psCache[PS_CACHE];
+static int      psNext  = 0;    /* round-robin victim */
+static pid_t    psOwner = 0;    /* the process that may write them */
+
+
+static void ps_tag ( char *tag, int species )
+    {
+    sprintf ( tag, "%s/%d", PLANESUM_TAG, species );
+    }
+
+/* the record for (filename, species), or a new one of unknown planes
+   if there is none for a file of these dimensions */
+static int ps_load ( PsTable *ps, const char *filename, int species,
+                     int nlevel, int nstep )
+    {
+    char   tag[64];
+    size_t len, np = ( size_t ) nlevel * ( size_t ) nstep, i;
+
+    ps_tag ( tag, species );
+    if ( metaindex_get_record ( filename, tag, &ps->rec, &len ) )
+        {
+        if ( len >= PS_HEADER )
+            {
+            memcpy ( &ps->nlevel, ps->rec, sizeof ( int32_t ) );
+            memcpy ( &ps->nstep,  ps->rec + sizeof ( int32_t ), sizeof ( int32_t ) );
+            }
+        if ( ( len == PS_HEADER + np * sizeof ( PlaneSum ) ) &&
+                ( ps->nlevel == nlevel ) && ( ps->nstep == nstep ) )
+            {
+            ps->plane   = ( PlaneSum * ) ( ps->rec + PS_HEADER );
+            ps->unknown = 0;
+            for ( i = 0; i < np; i++ )
+                if ( ps->plane[i].n < 0 ) ps->unknown++;
+            return PAVE_SUCCESS;
+            }
+        free ( ps->rec );
+        }
+
+    if ( ( ps->rec = ( char * ) malloc ( PS_HEADER + np * sizeof ( PlaneSum ) ) ) == NULL )
+        return FAILURE;
+    ps->nlevel = nlevel;
+    ps->nstep  = nstep;
+    memcpy ( ps->rec, &ps->nlevel, sizeof ( int32_t ) );
+    memcpy ( ps->rec + sizeof ( int32_t ), &ps->nstep, sizeof ( int32_t ) );
+    ps->plane   = ( PlaneSum * ) ( ps->rec + PS_HEADER );
+    ps->unknown = np;
+    for ( i = 0; i < np; i++ )
+        {
+        memset ( ps->plane + i, 0, sizeof ( PlaneSum ) );
+        ps->plane[i].n = -1;
+        }
+    return PAVE_SUCCESS;
+    }
+
+static void ps_write ( PsCached *c )
+    {
+    char tag[64];
+
+    if ( c->dirty && ( getpid() == psOwner ) )
+        {
+        ps_tag ( tag, c->species );
+        metaindex_put_record ( c->filename, tag, c->ps.rec,
+                               PS_HEADER + ( size_t ) c->ps.nlevel * c->ps.nstep * sizeof ( PlaneSum ) );
+        }
+    c->dirty = 0;
+    }
+
+static void ps_drop ( PsCached *c, int write )
+    {
+    if ( write ) ps_write ( c );
+    free ( c->filename );
+    free ( c->ps.rec );
+    memset ( c, 0, sizeof ( PsCached ) );
+    }
+
+static void ps_write_all ( void )
+    {
+    int i;
+
+    for ( i = 0; i < PS_CACHE; i++ )
+        if ( psCache[i].filename ) ps_write ( psCache + i );
+    }
+
+/* the cached table for (filename, species), or NULL;  one for an older
+   version of the file is dropped unwritten */
+static PsCached *ps_find ( const char *filename, int species )
+    {
+    struct stat st;
+    int i;
+
+    for ( i = 0; i < PS_CACHE; i++ )
+        if ( psCache[i].filename && ( psCache[i].species == species ) &&
+                !strcmp ( psCache[i].filename, filename ) )
+            {
+            if ( ( stat ( filename, &st ) == 0 ) &&
+                    ( ( long long ) st.st_size  == psCache[i].size ) &&
+                    ( ( long long ) st.st_mtime == psCache[i].mtime ) )
+                return psCache + i;
+            ps_drop ( psCache + i, 0 );
+            return NULL;
+            }
+    return NULL;
+    }
+
+/* the table for (filename, species), from the cache, or loaded into it
+   in place of the least recently loaded one */
+static PsCached *ps_get ( const char *filename, int species, int nlevel, int nstep )
+    {
+    struct stat st;
+    PsCached *c;
+
+    if ( ( c = ps_find ( filename, species ) ) != NULL )
+        {
+        if ( ( c->ps.nlevel == nlevel ) && ( c->ps.nstep == nstep ) )
+            return c;
+        ps_drop ( c, 0 );
+        }
+    if ( stat ( filename, &st ) != 0 )
+        return NULL;
+    if ( !psOwner )
+        {
+        psOwner = getpid();
+        atexit ( ps_write_all );
+        }
+
+    c = psCache + psNext;
+    psNext = ( psNext + 1 ) % PS_CACHE;
+    if ( c->filename ) ps_drop ( c, 1 );
+    if ( ( c->filename = strdup ( filename ) ) == NULL )
+        return NULL;
+    if ( !ps_load ( &c->ps, filename, species, nlevel, nstep ) )
+        {
+        free ( c->filename );
+        c->filename = NULL;
+        return NULL;
+        }
+    c->species = species;
+    c->size    = ( long long ) st.st_size;
+    c->mtime   = ( long long ) st.st_mtime;
+    c->dirty   = 0;
+    return c;
+    }
+
+static void summarize ( PlaneSum *s, const float *v, long len )
+    {
+    double sum = 0.0;
+    float  vmin = 0.0f, vmax = 0.0f;
+    long   i, n = 0;
+
+    for ( i = 0; i < len; i++ )
+        {
+        if ( isnan ( v[i] ) ) continue;
+        if ( !n || ( v[i] < vmin ) ) vmin = v[i];
+        if ( !n || ( v[i] > vmax ) ) vmax = v[i];
+        sum += v[i];
+        n++;
+        }
+    s->n    = n;
+    s->nans = len - n;
+    s->min  = vmin;
+    s->max  = vmax;
+    s->sum  = sum;
+    }
+
+
+void planesum_record ( const VIS_DATA *info )
+    {
+    PsCached *c;
+    PsTable  *ps;
+    long     ij, *todo;
+    int      s0, s1, nk, p, np, ntodo, k, s;
+
+    if ( !info || !info->grid || !info->filename || ( info->selected_species < 1 ) )
+        return;
+    if ( ( info->col_min != 1 ) || ( info->col_max != info->ncol ) ||
+            ( info->row_min != 1 ) || ( info->row_max != info->nrow ) )
+        return;
+    switch ( info->slice )
+        {
+        case XYTSLICE:
+            if ( info->level_min != info->level_max ) return;
+            /* fall through */
+        case XYZTSLICE:
+            s0 = info->step_min;
+            s1 = info->step_max;
+            break;
+        case XYSLICE:
+            if ( info->level_min != info->level_max ) return;
+            /* fall through */
+        case XYZSLICE:
+            s0 = s1 = info->selected_step;
+            break;
+        default:
+            return;
+        }
+    if ( ( ( s1 > s0 ) && ( info->step_incr > 1 ) ) ||
+            ( info->level_min < 1 ) || ( info->level_max > info->nlevel ) ||
+            ( info->level_min > info->level_max ) ||
+            ( s0 < 1 ) || ( s1 > info->nstep ) || ( s0 > s1 ) )
+        return;
+
+    if ( ( c = ps_get ( info->filename, info->selected_species,
+                        info->nlevel, info->nstep ) ) == NULL )
+        return;
+    ps = &c->ps;
+    if ( !ps->unknown )
+        return;
+    nk = info->level_max - info->level_min + 1;
+    np = nk * ( s1 - s0 + 1 );
+    ij = ( long ) info->ncol * info->nrow;
+    if ( ( todo = ( long * ) malloc ( np * sizeof ( long ) ) ) == NULL )
+        return;
+
+    /* p indexes the planes of the grid, todo[] those of the table */
+    for ( p = ntodo = 0; p < np; p++ )
+        {
+        k = info->level_min + p % nk;
+        s = s0 + p / nk;
+        if ( ps->plane[ ( long ) ( s-1 ) * ps->nlevel + k-1 ].n < 0 )
+            todo[ntodo++] = p;
+        }
+
+#pragma omp parallel for schedule(dynamic) private(k, s) if ( ntodo * ij > 65536 )
+    for ( p = 0; p < ntodo; p++ )
+        {
+        k = info->level_min + todo[p] % nk;
+        s = s0 + todo[p] / nk;
+        summarize ( ps->plane + ( long ) ( s-1 ) * ps->nlevel + k-1,
+                    info->grid + todo[p] * ij, ij );
+        }
+
+    if ( ntodo )
+        {
+        ps->unknown -= ntodo;
+        c->dirty = 1;
+        if ( !ps->unknown ) ps_write ( c );
+        }
+    free ( todo );
+    }
+
+
+int planesum_query ( const char *filename, int species,
+                     int level0, int level1, const int *layers,
+                     int step0, int step1, PlaneSum *total )
+    {
+    char      tag[64];
+    char     *rec = NULL;
+    size_t    len;
+    int32_t   nlevel, nstep;
+    PlaneSum *plane, *q;
+    PsCached *c;
+    double    comp = 0.0, y, t;
+    int       k, s, ok = PAVE_SUCCESS;
+
+    /* the cached table, with planes perhaps not yet written, or else
+       the record */
+    if ( ( c = ps_find ( filename, species ) ) != NULL )
+        {
+        nlevel = c->ps.nlevel;
+        nstep  = c->ps.nstep;
+        len    = PS_HEADER + ( size_t ) nlevel * nstep * sizeof ( PlaneSum );
+        plane  = c->ps.plane;
+        }
+    else
+        {
+        ps_tag ( tag, species );
+        if ( !metaindex_get_record ( filename, tag, &rec, &len ) )
+            return FAILURE;
+        nlevel = nstep = 0;
+        if ( len >= PS_HEADER )
+            {
+            memcpy ( &nlevel, rec, sizeof ( int32_t ) );
+            memcpy ( &nstep,  rec + sizeof ( int32_t ), sizeof ( int32_t ) );
+            }
+        plane = ( PlaneSum * ) ( rec + PS_HEADER );
+        }
+    if ( ( len != PS_HEADER + ( size_t ) nlevel * nstep * sizeof ( PlaneSum ) ) ||
+            ( level0 < 1 ) || ( level1 > nlevel ) || ( level0 > level1 ) ||
+            ( step0  < 1 ) || ( step1  > nstep  ) || ( step0  > step1  ) )
+        {
+        if ( rec ) free ( rec );
+        return FAILURE;
+        }
+
+    memset ( total, 0, sizeof ( PlaneSum ) );
+    for ( s = step0; ok && ( s <= step1 ); s++ )
+        for ( k = level0; ok && ( k <= level1 ); k++ )
+            {
+            if ( layers && !layers[k-level0] )
+                continue;
+            q = plane + ( long ) ( s-1 ) * nlevel + k-1;
+            if ( q->n < 0 )
+                {
+                ok = FAILURE;
+                break;
+                }
+            if ( q->n && ( !total->n || ( q->min < total->min ) ) ) total->min = q->min;
+            if ( q->n && ( !total->n || ( q->max > total->max ) ) ) total->max = q->max;
+            total->n    += q->n;
+            total->nans += q->nans;
+            y = q->sum - comp;                  /* Kahan */
+            t = total->sum + y;
+            comp = ( t - total->sum ) - y;
+            total->sum = t;
+            }
+    if ( rec ) free ( rec );
+    return ok;
+    }
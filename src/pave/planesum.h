@@ -0,0 +1,73 @@
+#ifndef PLANESUM_H
+#define PLANESUM_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: planesum.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Persistent per-plane summaries of file variables.
+ *
+ *  The range of a plot (hence its legend, -autoContourRange and
+ *  drawMinMax()) and the mean() and sum() formula functions all come
+ *  from a full scan of the data by calc_stats().  For each variable of
+ *  each file it reads, get_data_local() now also keeps, for every
+ *  whole-domain (step, level) plane it has read, the plane's count of
+ *  values and of missing (NaN) values, min, max and sum.  They are kept
+ *  as sidecar records in the metadata index (metaindex.h), so they are
+ *  computed once per plane, shared between sessions, and forgotten when
+ *  the file's size or modification time changes.
+ *
+ *  Summaries over any range of steps and levels then combine exactly
+ *  (but for the rounding of the sum) from those of the planes:
+ *  retrieveData() uses them for the range of a plain variable, and for
+ *  mean() and sum() of one, which it then need not read at all.
+ *
+ *  Only whole-domain planes are summarized:  XYZT and XYZ slices, and
+ *  XYT and XY slices whose reader clamps the levels to the selected
+ *  one, of all columns and rows.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define PLANESUM_TAG    "planesum"      /* metaindex tag, with the species */
+
+typedef struct
+    {
+    long long n;            /* non-missing values;  -1 if not yet known */
+    long long nans;         /* missing (NaN) values */
+    float     min, max;     /* of the non-missing values */
+    double    sum;
+    } PlaneSum;
+
+/* summarizes those planes of info->grid, just read by get_data_local(),
+   that are not summarized already */
+void planesum_record ( const VIS_DATA *info );
+
+/* combines into *total the summaries of species (1-based) of filename
+   over levels level0..level1 (1-based;  only those k with
+   layers[k-level0] != 0, unless layers is NULL) and steps step0..step1
+   (1-based):  PAVE_SUCCESS, or FAILURE if any of them is not known */
+int planesum_query ( const char *filename, int species,
+                     int level0, int level1, const int *layers,
+                     int step0, int step1, PlaneSum *total );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* PLANESUM_H */
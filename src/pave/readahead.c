@@ -0,0 +1,420 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: readahead.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Read-ahead of single-step slices;  see readahead.h.
+ *
+ *  One stream is followed at a time:  the file, species and window of
+ *  the latest request (raKey), its step (raLast) and the step-to-step
+ *  stride (raDir).  Slots hold the steps queued, being read, or read;
+ *  each carries the generation (raGen) it was queued in, and anything
+ *  from an older generation is discarded.  One detached worker thread
+ *  reads queued steps nearest-first, each from a copy of the latest
+ *  request (raTemplate).  A fork()ed child gets no worker, so
+ *  read-ahead is simply off there.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  the atfork handler is registered by the first
+ *      readahead_lock() or ra_setup(), not only when read-ahead is on,
+ *      so that every fork()ed child gets raRead back unlocked (this went
+ *      in as ad0080f, under another request's tag).
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "vis_data.h"
+#include "gridtarget.h"
+#include "readahead.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define RA_MAX_SLOTS    (64)
+#define RA_MAX_STRIDE   (24)        /* larger jumps are not a stream */
+
+#define RA_QUEUED       (0)
+#define RA_READING      (1)
+#define RA_READY        (2)
+#define RA_FAILED       (3)
+
+extern VIS_DATA *VIS_DATA_dup ( VIS_DATA *info, char *estring );
+extern void      free_vis ( VIS_DATA *info );
+
+typedef struct
+    {
+    int       step;
+    int       state;
+    unsigned  gen;
+    VIS_DATA *vdata;        /* when RA_READY */
+    } RaSlot;
+
+typedef struct
+    {
+    char *filename;
+    int   dataset, species, slice;
+    int   col_min, col_max, row_min, row_max, level_min, level_max;
+    int   selected_col, selected_row, selected_level;
+    } RaKey;
+
+static pthread_mutex_t raMutex = PTHREAD_MUTEX_INITIALIZER;  /* everything below */
+static pthread_mutex_t raRead  = PTHREAD_MUTEX_INITIALIZER;  /* the readers      */
+static pthread_cond_t  raCond  = PTHREAD_COND_INITIALIZER;
+static pthread_once_t  raOnce  = PTHREAD_ONCE_INIT;
+
+static int       raState  = 0;      /* 0: not set up;  1: on;  -1: off */
+static int       raWorker = 0;      /* worker thread started */
+static int       raSteps;
+static size_t    raBudget;
+static RaKey     raKey;
+static int       raLast = -1;
+static int       raDir  = 0;
+static unsigned  raGen  = 0;
+static VIS_DATA *raTemplate = NULL;
+static int     ( *raReader ) ( VIS_DATA *info, char *message ) = NULL;
+static RaSlot    raSlot[RA_MAX_SLOTS];
+static int       raNslot = 0;
+
+
+static void ra_child ( void )
+    {
+    pthread_mutex_init ( &raMutex, NULL );
+    pthread_mutex_init ( &raRead,  NULL );
+    pthread_cond_init  ( &raCond,  NULL );
+    raState  = -1;
+    raWorker = 0;
+    }
+
+/* a child forked while raRead is held (by another thread, while
+   metaindex_prefetch() starts its workers, say) must get it back
+   unlocked, whether or not read-ahead was ever set up */
+static void ra_atfork ( void )
+    {
+    pthread_atfork ( NULL, NULL, ra_child );
+    }
+
+static int ra_setup ( void )
+    {
+    char *env;
+
+    pthread_once ( &raOnce, ra_atfork );
+    if ( raState ) return ( raState > 0 );
+
+    raSteps = READAHEAD_STEPS;
+    if ( ( env = getenv ( READAHEAD_ENV_STEPS ) ) != NULL )
+        raSteps = atoi ( env );
+    raBudget = READAHEAD_MB;
+    if ( ( env = getenv ( READAHEAD_ENV_MB ) ) != NULL && ( atoi ( env ) > 0 ) )
+        raBudget = ( size_t ) atoi ( env );
+    raBudget <<= 20;
+    if ( raSteps > RA_MAX_SLOTS - 1 ) raSteps = RA_MAX_SLOTS - 1;
+
+    raState = ( raSteps > 0 ) ? 1 : -1;
+    return ( raState > 0 );
+    }
+
+static int single_step ( int slice )
+    {
+    return ( slice == XYSLICE ) || ( slice == YZSLICE ) ||
+           ( slice == XZSLICE ) || ( slice == XYZSLICE );
+    }
+
+static size_t slice_bytes ( VIS_DATA *info )
+    {
+    size_t nc = info->col_max   - info->col_min   + 1;
+    size_t nr = info->row_max   - info->row_min   + 1;
+    size_t nl = info->level_max - info->level_min + 1;
+
+    switch ( info->slice )
+        {
+        case XYSLICE: return nc * nr * sizeof ( float );
+        case YZSLICE: return nr * nl * sizeof ( float );
+        case XZSLICE: return nc * nl * sizeof ( float );
+        default:      return nc * nr * nl * sizeof ( float );
+        }
+    }
+
+static void key_make ( VIS_DATA *info, RaKey *k )
+    {
+    k->filename       = info->filename;
+    k->dataset        = info->dataset;
+    k->species        = info->selected_species;
+    k->slice          = info->slice;
+    k->col_min        = info->col_min;
+    k->col_max        = info->col_max;
+    k->row_min        = info->row_min;
+    k->row_max        = info->row_max;
+    k->level_min      = info->level_min;
+    k->level_max      = info->level_max;
+    k->selected_col   = info->selected_col;
+    k->selected_row   = info->selected_row;
+    k->selected_level = info->selected_level;
+    }
+
+static int key_same ( RaKey *a, RaKey *b )
+    {
+    return a->filename && b->filename && !strcmp ( a->filename, b->filename ) &&
+           ( a->dataset   == b->dataset   ) && ( a->species   == b->species   ) &&
+           ( a->slice     == b->slice     ) &&
+           ( a->col_min   == b->col_min   ) && ( a->col_max   == b->col_max   ) &&
+           ( a->row_min   == b->row_min   ) && ( a->row_max   == b->row_max   ) &&
+           ( a->level_min == b->level_min ) && ( a->level_max == b->level_max ) &&
+           ( a->selected_col   == b->selected_col   ) &&
+           ( a->selected_row   == b->selected_row   ) &&
+           ( a->selected_level == b->selected_level );
+    }
+
+static void free_vdata ( VIS_DATA *v )
+    {
+    if ( v == NULL ) return;
+    free_vis ( v );
+    free ( v );
+    }
+
+static int find_slot ( int step )
+    {
+    int i;
+
+    for ( i = 0; i < raNslot; i++ )
+        if ( ( raSlot[i].step == step ) && ( raSlot[i].gen == raGen ) )
+            return i;
+    return -1;
+    }
+
+/* a slot being read is dropped too:  the worker finds it gone */
+static void drop_slot ( int i )
+    {
+    free_vdata ( raSlot[i].vdata );
+    raSlot[i] = raSlot[--raNslot];
+    }
+
+static void ra_clear ( void )
+    {
+    while ( raNslot > 0 )
+        drop_slot ( raNslot - 1 );
+    raGen++;
+    pthread_cond_broadcast ( &raCond );
+    }
+
+/* moves a slot's slice into info, as the reader would have left it */
+static void take_slice ( VIS_DATA *info, VIS_DATA *v )
+    {
+    if ( info->grid ) grid_free ( info, info->grid );
+    info->grid      = v->grid;
+    v->grid         = NULL;
+    info->grid_min  = v->grid_min;
+    info->grid_max  = v->grid_max;
+    info->col_min   = v->col_min;
+    info->col_max   = v->col_max;
+    info->row_min   = v->row_min;
+    info->row_max   = v->row_max;
+    info->level_min = v->level_min;
+    info->level_max = v->level_max;
+    info->step_min  = v->step_min;
+    info->step_max  = v->step_max;
+    if ( info->sdate && v->sdate ) info->sdate[0] = v->sdate[0];
+    if ( info->stime && v->stime ) info->stime[0] = v->stime[0];
+    free_vdata ( v );
+    }
+
+
+static void *ra_work ( void *arg )
+    {
+    char      message[512];
+    VIS_DATA *v;
+    unsigned  gen;
+    int       i, best, t, ok;
+    int     ( *reader ) ( VIS_DATA *info, char *message );
+
+    pthread_mutex_lock ( &raMutex );
+    for ( ;; )
+        {
+        /* the queued step nearest the latest request */
+        best = -1;
+        for ( i = 0; i < raNslot; i++ )
+            if ( ( raSlot[i].state == RA_QUEUED ) && ( raSlot[i].gen == raGen ) &&
+                    ( ( best < 0 ) || ( abs ( raSlot[i].step - raLast ) <
+                                        abs ( raSlot[best].step - raLast ) ) ) )
+                best = i;
+        if ( ( best < 0 ) || ( raTemplate == NULL ) )
+            {
+            pthread_cond_wait ( &raCond, &raMutex );
+            continue;
+            }
+
+        t      = raSlot[best].step;
+        gen    = raGen;
+        reader = raReader;
+        v      = VIS_DATA_dup ( raTemplate, message );
+        if ( v == NULL )
+            {
+            raSlot[best].state = RA_FAILED;
+            pthread_cond_broadcast ( &raCond );
+            continue;
+            }
+        v->selected_step = v->step_min = v->step_max = t;
+        raSlot[best].state = RA_READING;
+        pthread_mutex_unlock ( &raMutex );
+
+        readahead_lock();
+        ok = reader ( v, message );
+        readahead_unlock();
+
+        pthread_mutex_lock ( &raMutex );
+        i = ( gen == raGen ) ? find_slot ( t ) : -1;
+        if ( ( i >= 0 ) && ( raSlot[i].state == RA_READING ) )
+            {
+            raSlot[i].state = ok ? RA_READY : RA_FAILED;
+            raSlot[i].vdata = ok ? v : NULL;
+            if ( !ok ) free_vdata ( v );
+            }
+        else
+            free_vdata ( v );           /* cancelled meanwhile */
+        pthread_cond_broadcast ( &raCond );
+        }
+    return arg;
+    }
+
+
+int readahead_fetch ( VIS_DATA *info, char *message,
+                      int ( *reader ) ( VIS_DATA *info, char *message ) )
+    {
+    RaKey     k;
+    VIS_DATA *v;
+    char     *grid;
+    size_t    bytes;
+    pthread_t tid;
+    int       s, d, i, j, t, nmax, ret = FAILURE;
+
+    if ( !info->filename || !single_step ( info->slice ) || !ra_setup() )
+        return FAILURE;
+
+    pthread_mutex_lock ( &raMutex );
+    if ( raState < 0 )
+        {
+        pthread_mutex_unlock ( &raMutex );
+        return FAILURE;
+        }
+
+    /* the same stream?  in the same direction? */
+    key_make ( info, &k );
+    s = info->selected_step;
+    if ( !key_same ( &k, &raKey ) )
+        {
+        ra_clear();
+        free ( raKey.filename );
+        raKey = k;
+        raKey.filename = strdup ( info->filename );
+        raLast = -1;
+        raDir  = 0;
+        }
+    d = ( raLast > 0 ) ? s - raLast : 0;
+    if ( ( d != 0 ) && ( d != raDir ) )
+        {
+        ra_clear();
+        raDir = ( abs ( d ) <= RA_MAX_STRIDE ) ? d : 0;
+        }
+    raLast   = s;
+    raReader = reader;
+
+    /* already read, or being read? */
+    while ( ( i = find_slot ( s ) ) >= 0 && ( raSlot[i].state == RA_READING ) )
+        pthread_cond_wait ( &raCond, &raMutex );
+    if ( i >= 0 )
+        {
+        if ( raSlot[i].state == RA_READY )
+            {
+            v = raSlot[i].vdata;
+            raSlot[i].vdata = NULL;
+            take_slice ( info, v );
+            ret = PAVE_SUCCESS;
+            }
+        drop_slot ( i );        /* queued or failed:  the caller reads it */
+        }
+
+    /* queue the steps that should come next */
+    if ( raDir != 0 )
+        {
+        for ( i = raNslot - 1; i >= 0; i-- )
+            if ( ( ( raSlot[i].step - s ) * raDir <= 0 ) ||
+                    ( abs ( raSlot[i].step - s ) > raSteps * abs ( raDir ) ) )
+                drop_slot ( i );
+
+        free_vdata ( raTemplate );
+        grid = ( char * ) info->grid;
+        info->grid = NULL;
+        raTemplate = VIS_DATA_dup ( info, message );
+        info->grid = ( float * ) grid;
+
+        bytes = slice_bytes ( info );
+        nmax  = ( bytes > 0 ) ? ( int ) ( raBudget / bytes ) : 0;
+        if ( nmax > raSteps ) nmax = raSteps;
+        for ( j = 1; raTemplate && ( j <= nmax ) && ( raNslot < RA_MAX_SLOTS ); j++ )
+            {
+            t = s + j * raDir;
+            if ( ( t < 1 ) || ( t > info->nstep ) )
+                break;
+            if ( find_slot ( t ) >= 0 )
+                continue;
+            raSlot[raNslot].step  = t;
+            raSlot[raNslot].state = RA_QUEUED;
+            raSlot[raNslot].gen   = raGen;
+            raSlot[raNslot].vdata = NULL;
+            raNslot++;
+            }
+        if ( ( raNslot > 0 ) && !raWorker )
+            {
+            if ( pthread_create ( &tid, NULL, ra_work, NULL ) == 0 )
+                {
+                pthread_detach ( tid );
+                raWorker = 1;
+                }
+            else
+                {
+                raState = -1;
+                ra_clear();
+                }
+            }
+        pthread_cond_broadcast ( &raCond );
+        }
+
+    pthread_mutex_unlock ( &raMutex );
+    return ret;
+    }
+
+
+void readahead_lock ( void )
+    {
+    pthread_once ( &raOnce, ra_atfork );
+    pthread_mutex_lock ( &raRead );
+    }
+
+void readahead_unlock ( void )
+    {
+    pthread_mutex_unlock ( &raRead );
+    }
+
+void readahead_cancel ( void )
+    {
+    pthread_mutex_lock ( &raMutex );
+    ra_clear();
+    raLast = -1;
+    raDir  = 0;
+    pthread_mutex_unlock ( &raMutex );
+    }
@@ -0,0 +1,69 @@
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: readahead.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Read-ahead of single-step slices.
+ *
+ *  When a client steps through time one slice at a time (a formula's
+ *  '<spec>:<step>' atoms, vector plots at the selected step, a remote
+ *  PAVE driving visd step by step), each get_data() is a separate
+ *  synchronous read.  get_data_local1() passes every single-step slice
+ *  request (XYSLICE, YZSLICE, XZSLICE, XYZSLICE) through
+ *  readahead_fetch() first.  Once two successive requests for the same
+ *  file, species and window show a direction (and stride), the next
+ *  PAVE_READAHEAD (default READAHEAD_STEPS) steps that way are read by
+ *  a background thread, within PAVE_READAHEAD_MB megabytes (default
+ *  READAHEAD_MB);  later requests for those steps are answered from
+ *  memory, or wait for the read already under way.  A change of file,
+ *  species, window or direction cancels what is queued.
+ *  PAVE_READAHEAD=0 turns this off.
+ *
+ *  The legacy readers are not reentrant (static buffers in alpha.c,
+ *  the shared FILE in record.c), so every actual read, foreground or
+ *  background, is made between readahead_lock() and readahead_unlock().
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define READAHEAD_ENV_STEPS "PAVE_READAHEAD"
+#define READAHEAD_ENV_MB    "PAVE_READAHEAD_MB"
+#define READAHEAD_STEPS     (4)
+#define READAHEAD_MB        (64)
+
+/* answers info's request from the read-ahead, returning PAVE_SUCCESS;
+   or returns FAILURE, for the caller to read it (with reader(),
+   under readahead_lock()) itself.  Either way, it notes the request
+   and schedules the steps that should follow it. */
+int readahead_fetch ( VIS_DATA *info, char *message,
+                      int ( *reader ) ( VIS_DATA *info, char *message ) );
+
+/* serializes the readers */
+void readahead_lock   ( void );
+void readahead_unlock ( void );
+
+/* drops everything read ahead or queued */
+void readahead_cancel ( void );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* READAHEAD_H */
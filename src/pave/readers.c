@@ -0,0 +1,391 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: readers.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Registry of data-file readers;  see readers.h.
+ *
+ *  rdList[0..rdCount-1] are the readers, most recently registered first;
+ *  rdCache[] remembers which of them each recently identified file
+ *  needs, replaced round-robin.  The built-in readers' get_data()s go
+ *  straight to the *_get_data() routines:  the file was identified
+ *  already, and those routines open it themselves.  The legacy (UAM-IV,
+ *  UAM-V, TOPLATS) ones try the netCDF sidecar cache (nccache.c) first,
+ *  as before.  The mutex is there because the read-ahead thread reads
+ *  too;  it is held across fork() by an atfork handler.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  rdMutex atfork handlers, for metaindex_prefetch()'s
+ *      fork()ed workers
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "netcdf.h"
+#include "vis_data.h"
+#include "readers.h"
+#include "nccache.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+#define MAXLINE         (256)
+
+#include "toplats.h"
+
+#define UAM_FIRST_CW    ( 76 * 4 )  /* FILE_DESC_HEADER words (readuam.h) */
+#define TOPLATS_HEADER  "#! TOPLATS DESCRIPTION FILE"
+#define UAMV_HEADER     "#! UAMV DESCRIPTION FILE"
+
+int alpha_open     ( int *vis_fd, VIS_DATA *info, char *message );
+int alpha_get_info ( VIS_DATA *info, char *message );
+int alpha_get_data ( VIS_DATA *info, char *message );
+int toplats_open     ( TOPLATS_INFO *tinfo, VIS_DATA *info, char *message );
+int toplats_get_info ( TOPLATS_INFO *tinfo, VIS_DATA *info, char *message );
+int toplats_get_data ( TOPLATS_INFO *tinfo, VIS_DATA *info, char *message );
+int uamv_open     ( VIS_DATA *info, char *message );
+int uamv_get_info ( VIS_DATA *info, char *message );
+int uamv_get_data ( VIS_DATA *info, char *message );
+int uam_open     ( VIS_DATA *info, char *message );
+int uam_get_info ( VIS_DATA *info, char *message );
+int uam_get_data ( VIS_DATA *info, char *message );
+
+typedef struct
+    {
+    char             *path;
+    off_t             size;
+    time_t            mtime;
+    const PaveReader *reader;
+    } RdEntry;
+
+static pthread_mutex_t   rdMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t    rdOnce  = PTHREAD_ONCE_INIT;
+static const PaveReader *rdList[READER_MAX];
+static int               rdCount = 0;
+static int               rdInit  = 0;
+static RdEntry           rdCache[READER_CACHE];
+static int               rdNext  = 0;
+
+
+/* metaindex_prefetch()'s workers are fork()ed, maybe while the
+   read-ahead thread holds rdMutex:  hold it across every fork(), so
+   that the child gets it unlocked and rdCache[] whole */
+static void rd_prepare ( void )
+    {
+    pthread_mutex_lock ( &rdMutex );
+    }
+
+static void rd_release ( void )
+    {
+    pthread_mutex_unlock ( &rdMutex );
+    }
+
+static void rd_atfork ( void )
+    {
+    pthread_atfork ( rd_prepare, rd_release, rd_release );
+    }
+
+static void rd_lock ( void )
+    {
+    pthread_once ( &rdOnce, rd_atfork );
+    pthread_mutex_lock ( &rdMutex );
+    }
+
+
+/* ---------------------------- netCDF ---------------------------- */
+
+static int alpha_sniff ( const unsigned char *head, int n )
+    {
+    if ( n >= 3 && head[0] == 'C' && head[1] == 'D' && head[2] == 'F' )
+        return PAVE_SUCCESS;
+#ifdef NC_NETCDF4
+    if ( n >= 4 && head[0] == 0211 && head[1] == 'H' && head[2] == 'D' && head[3] == 'F' )
+        return PAVE_SUCCESS;
+#endif  /* NC_NETCDF4 */
+    return FAILURE;
+    }
+
+static int alpha_probe ( VIS_DATA *info, char *message )
+    {
+    int fd;
+
+    if ( !alpha_open ( &fd, info, message ) )
+        return FAILURE;
+    ncclose ( fd );
+    return PAVE_SUCCESS;
+    }
+
+static const PaveReader alphaReader =
+    {
+    "netCDF", READER_HYPERSLAB | READER_STRIDED,
+    alpha_sniff, alpha_probe, alpha_get_info, alpha_get_data
+    };
+
+
+/* ---------------------------- TOPLATS --------------------------- */
+
+static int toplats_sniff ( const unsigned char *head, int n )
+    {
+    int len = strlen ( TOPLATS_HEADER );
+
+    return ( n >= len && !strncmp ( ( const char * ) head, TOPLATS_HEADER, len ) );
+    }
+
+static int toplats_probe ( VIS_DATA *info, char *message )
+    {
+    TOPLATS_INFO tinfo;
+
+    return toplats_open ( &tinfo, info, message );
+    }
+
+static int toplats_info ( VIS_DATA *info, char *message )
+    {
+    TOPLATS_INFO tinfo;
+
+    if ( !toplats_open ( &tinfo, info, message ) )
+        return FAILURE;
+    return toplats_get_info ( &tinfo, info, message );
+    }
+
+static int toplats_data ( VIS_DATA *info, char *message )
+    {
+    TOPLATS_INFO tinfo;
+
+    if ( nccache_get_data ( info, message ) )
+        return PAVE_SUCCESS;
+    if ( !toplats_open ( &tinfo, info, message ) )
+        return FAILURE;
+    return toplats_get_data ( &tinfo, info, message );
+    }
+
+static const PaveReader toplatsReader =
+    {
+    "TOPLATS", 0,
+    toplats_sniff, toplats_probe, toplats_info, toplats_data
+    };
+
+
+/* ---------------------------- UAM-V ----------------------------- */
+
+static int uamv_sniff ( const unsigned char *head, int n )
+    {
+    int len = strlen ( UAMV_HEADER );
+
+    return ( n >= len && !strncmp ( ( const char * ) head, UAMV_HEADER, len ) );
+    }
+
+static int uamv_info ( VIS_DATA *info, char *message )
+    {
+    if ( !uamv_open ( info, message ) )
+        return FAILURE;
+    return uamv_get_info ( info, message );
+    }
+
+static int uamv_data ( VIS_DATA *info, char *message )
+    {
+    if ( nccache_get_data ( info, message ) )
+        return PAVE_SUCCESS;
+    info->dataset = UAMV_DATA;          /* as uamv_open() would set it */
+    return uamv_get_data ( info, message );
+    }
+
+static const PaveReader uamvReader =
+    {
+    "UAM-V", READER_HYPERSLAB | READER_STRIDED,
+    uamv_sniff, uamv_open, uamv_info, uamv_data
+    };
+
+
+/* ---------------------------- UAM-IV ---------------------------- */
+
+/* the first Fortran record control word, in either byte order */
+static int uam_sniff ( const unsigned char *head, int n )
+    {
+    unsigned int big, little;
+
+    if ( n < 4 )
+        return FAILURE;
+    big    = ( head[0] << 24 ) | ( head[1] << 16 ) | ( head[2] << 8 ) | head[3];
+    little = ( head[3] << 24 ) | ( head[2] << 16 ) | ( head[1] << 8 ) | head[0];
+    return ( big == UAM_FIRST_CW || little == UAM_FIRST_CW );
+    }
+
+static int uam_info ( VIS_DATA *info, char *message )
+    {
+    if ( !uam_open ( info, message ) )
+        return FAILURE;
+    return uam_get_info ( info, message );
+    }
+
+static int uam_data ( VIS_DATA *info, char *message )
+    {
+    if ( nccache_get_data ( info, message ) )
+        return PAVE_SUCCESS;
+    info->dataset = UAM_DATA;           /* as uam_open() would set it */
+    return uam_get_data ( info, message );
+    }
+
+static const PaveReader uamReader =
+    {
+    "UAM-IV", READER_HYPERSLAB | READER_STRIDED,
+    uam_sniff, uam_open, uam_info, uam_data
+    };
+
+
+/* ---------------------------- registry -------------------------- */
+
+static int add_reader ( const PaveReader *reader )
+    {
+    int i;
+
+    if ( rdCount >= READER_MAX )
+        return FAILURE;
+    for ( i = rdCount; i > 0; i-- )
+        rdList[i] = rdList[i-1];
+    rdList[0] = reader;
+    rdCount++;
+    return PAVE_SUCCESS;
+    }
+
+/* the legacy probe order:  netCDF, TOPLATS, UAM-V, UAM-IV */
+static void init_readers ( void )
+    {
+    if ( rdInit )
+        return;
+    rdInit = 1;
+    add_reader ( &uamReader );
+    add_reader ( &uamvReader );
+    add_reader ( &toplatsReader );
+    add_reader ( &alphaReader );
+    }
+
+int reader_register ( const PaveReader *reader )
+    {
+    int ret;
+
+    rd_lock();
+    init_readers();
+    ret = add_reader ( reader );
+    pthread_mutex_unlock ( &rdMutex );
+    return ret;
+    }
+
+static RdEntry *find_entry ( const char *path )
+    {
+    int i;
+
+    for ( i = 0; i < READER_CACHE; i++ )
+        if ( rdCache[i].path && !strcmp ( rdCache[i].path, path ) )
+            return rdCache + i;
+    return NULL;
+    }
+
+static const PaveReader *cached ( const char *path, struct stat *sb )
+    {
+    RdEntry *e;
+    const PaveReader *reader = NULL;
+
+    rd_lock();
+    e = find_entry ( path );
+    if ( e && e->size == sb->st_size && e->mtime == sb->st_mtime )
+        reader = e->reader;
+    pthread_mutex_unlock ( &rdMutex );
+    return reader;
+    }
+
+static void remember ( const char *path, struct stat *sb, const PaveReader *reader )
+    {
+    RdEntry *e;
+
+    rd_lock();
+    if ( ( e = find_entry ( path ) ) == NULL )
+        {
+        e = rdCache + rdNext;
+        rdNext = ( rdNext + 1 ) % READER_CACHE;
+        if ( e->path ) free ( e->path );
+        e->path = strdup ( path );
+        }
+    if ( e->path )
+        {
+        e->size   = sb->st_size;
+        e->mtime  = sb->st_mtime;
+        e->reader = reader;
+        }
+    pthread_mutex_unlock ( &rdMutex );
+    }
+
+const PaveReader *reader_find ( VIS_DATA *info, char *message )
+    {
+    unsigned char head[READER_SNIFF_BYTES];
+    const PaveReader *list[READER_MAX];
+    const PaveReader *reader = NULL;
+    struct stat sb;
+    int fd, n = 0, count, i;
+
+    if ( info->filename == NULL || stat ( info->filename, &sb ) != 0 )
+        {
+        sprintf ( message, "Cannot get status of file %s",
+                  info->filename ? info->filename : "(null)" );
+        return NULL;
+        }
+    if ( ( reader = cached ( info->filename, &sb ) ) != NULL )
+        return reader;
+
+    rd_lock();
+    init_readers();
+    count = rdCount;
+    memcpy ( list, rdList, count * sizeof ( list[0] ) );
+    pthread_mutex_unlock ( &rdMutex );
+
+    if ( ( fd = open ( info->filename, O_RDONLY ) ) >= 0 )
+        {
+        n = read ( fd, head, sizeof ( head ) );
+        close ( fd );
+        }
+    for ( i = 0; n > 0 && i < count && !reader; i++ )
+        if ( list[i]->sniff && list[i]->sniff ( head, n ) )
+            reader = list[i];
+
+    /* nothing recognized it:  ask each reader in turn, as before */
+    for ( i = 0; i < count && !reader; i++ )
+        if ( list[i]->probe && list[i]->probe ( info, message ) )
+            reader = list[i];
+
+    if ( reader )
+        remember ( info->filename, &sb, reader );
+    else
+        sprintf ( message, "%s",
+                  "File FMT not recognized. Not NETCDF, UAM-IV, UAM-V nor TOPLATS" );
+    return reader;
+    }
+
+int reader_caps ( const char *filename )
+    {
+    RdEntry *e;
+    int caps = 0;
+
+    rd_lock();
+    if ( filename && ( e = find_entry ( filename ) ) != NULL )
+        caps = e->reader->caps;
+    pthread_mutex_unlock ( &rdMutex );
+    return caps;
+    }
@@ -0,0 +1,85 @@
+#ifndef READERS_H
+#define READERS_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: readers.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Registry of data-file readers.
+ *
+ *  get_info_local2() and get_data_local2() used to find a file's format
+ *  by trying alpha_open(), toplats_open(), uamv_open() and uam_open() in
+ *  turn, each of which opens and partly parses the file, so that every
+ *  request for a UAM file cost three failed opens first.  Now each
+ *  reader is a PaveReader, and reader_find() identifies a file from its
+ *  first READER_SNIFF_BYTES bytes (netCDF magic, the TOPLATS and UAM-V
+ *  description-file headers, the UAM-IV first record control word),
+ *  falling back on the old cascade of *_open() probes only for files
+ *  that no reader recognizes.  The answer is remembered for the file
+ *  (by path, size and modification time), so a file is identified once.
+ *
+ *  Each reader declares what it can do (READER_HYPERSLAB etc.), for
+ *  callers planning reads:  get_data_local1(), for instance, reads ahead
+ *  only for readers that read just the requested window.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define READER_SNIFF_BYTES  (64)
+#define READER_MAX          (16)    /* registered readers */
+#define READER_CACHE        (64)    /* files remembered */
+
+#define READER_HYPERSLAB    (1)     /* reads just the requested window */
+#define READER_STRIDED      (2)     /* reads just every step_incr'th step */
+#define READER_THREADSAFE   (4)     /* may run outside readahead_lock() */
+
+typedef struct
+    {
+    const char *name;
+    int         caps;               /* READER_HYPERSLAB | ... */
+
+    /* recognizes the format from the first n bytes of the file;
+       NULL if the reader can only be found by probe() */
+    int ( *sniff )    ( const unsigned char *head, int n );
+
+    /* the legacy *_open() test:  PAVE_SUCCESS if the file is of this
+       format */
+    int ( *probe )    ( VIS_DATA *info, char *message );
+
+    int ( *get_info ) ( VIS_DATA *info, char *message );
+    int ( *get_data ) ( VIS_DATA *info, char *message );
+    } PaveReader;
+
+/* adds a reader, ahead of those already registered;  the built-in
+   netCDF, TOPLATS, UAM-V and UAM-IV readers are registered on first use.
+   Returns PAVE_SUCCESS, or FAILURE if the registry is full */
+int reader_register ( const PaveReader *reader );
+
+/* the reader for info->filename, or NULL (with message set);  the probes
+   call into the readers, so the caller holds readahead_lock() */
+const PaveReader *reader_find ( VIS_DATA *info, char *message );
+
+/* the capabilities of the reader found for filename, or 0 if it has not
+   been identified */
+int reader_caps ( const char *filename );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* READERS_H */
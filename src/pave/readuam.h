@@ -195,6 +195,7 @@ typedef struct hdrStruct
 	int	steplen;
 	int	speclen;
 	int	levellen;	
+	int	convert;	/* file is byte-swapped (from the header) */
 	} UAM_INFO;
 
         /* in order to get the linker to resolve Kathy's
@@ -23,17 +23,25 @@
  *      Modified:    January 31, 1995    KLP 1/31/95 malloc/no free
  *      Modified:    May 16, 1995        SRT * - hdr_info->hour1 SRT
  *      Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  uam_map_index() builds
+ *          the mapped-record index (uammap.c) for gridded files, and
+ *          uam_missing_value() factored out of uam_fetch_data()
+ *      Version 10/2026:  uam_map_index() opens the file itself, and
+ *          takes the byte order from hdr_info->convert
  ****************************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
 #include "readuam.h"
 #include "vis_data.h"
 #include "utils.h"
+#include "uammap.h"
 
 extern int dump_hdrStruct ( UAM_INFO *u, char *fname /* optional arg, can use NULL */ );
 
@@ -154,6 +162,7 @@ int uam_fetch_header ( char *filename, UAM_INFO *hdr_info )
             return ( FAILURE );
             }
         }
+    hdr_info->convert = convert;
 
     /* get file description header */
     if ( rec_read ( buf, FILE_DESC_HEADER, NO_OFFSET ) <0 )
@@ -627,6 +636,15 @@ int uam_fetch_header ( char *filename, UAM_INFO *hdr_info )
     }
 /* ========================================================================== */
 #define DEFAULT_MISSING_VALUE (-999.0)
+float uam_missing_value ( void )
+    {
+    char *missing_value_str;
+
+    if ( ( missing_value_str=getenv ( "UAM_MISSING_VALUE" ) ) == NULL )
+        return DEFAULT_MISSING_VALUE;
+    return atof ( missing_value_str );
+    }
+/* ========================================================================== */
 int uam_fetch_data ( UAM_INFO *hdr_info, float *buf,
                      int n, int spec, int level, int hour )
     {
@@ -643,16 +661,8 @@ int uam_fetch_data ( UAM_INFO *hdr_info, float *buf,
     char *locbuf = NULL;
     char *emisbuf = NULL;
     float missing_value;
-    char *missing_value_str;
 
-    if ( ( missing_value_str=getenv ( "UAM_MISSING_VALUE" ) ) == NULL )
-        {
-        missing_value = DEFAULT_MISSING_VALUE;
-        }
-    else
-        {
-        missing_value = atof ( missing_value_str );
-        }
+    missing_value = uam_missing_value();
 
     if ( hdr_info->uam_type==UAM_BNDRY )
         return get_bndry_data ( hdr_info, buf, n, spec, level, hour );
@@ -842,6 +852,56 @@ int uam_fetch_data ( UAM_INFO *hdr_info, float *buf,
     return ( PAVE_SUCCESS );
     }
 /* ========================================================================== */
+/* Mapped-record index for filename, whose header uam_fetch_header()
+   parsed into hdr_info, with the same record layout uam_fetch_data()
+   uses.  The file is opened here, not through the global fp, so the
+   map depends on nothing but hdr_info.  Point-source and boundary
+   files have no plane-per-record layout, and get NULL.  Records that
+   do not check out are left out of the index, and read through
+   uam_fetch_data() instead.
+ */
+UAM_MAP *uam_map_index ( const char *filename, UAM_INFO *hdr_info )
+    {
+#ifdef UNICOS
+    return NULL;
+#else
+    UAM_MAP *map;
+    int  t, l, s, n, nok, fd;
+    long k;
+
+    if ( ( hdr_info->uam_type == UAM_PTSR ) || ( hdr_info->uam_type == UAM_BNDRY ) )
+        return NULL;
+
+    if ( ( fd = open ( filename, O_RDONLY ) ) < 0 )
+        return NULL;
+    map = uam_map_open ( fd, hdr_info->convert,
+                         hdr_info->nstep, hdr_info->ilevel, hdr_info->ispec );
+    close ( fd );
+    if ( map == NULL )
+        return NULL;
+
+    n   = hdr_info->icol * hdr_info->irow;
+    nok = 0;
+    for ( t = 0; t < hdr_info->nstep; t++ )
+        for ( s = 0; s < hdr_info->ispec; s++ )
+            for ( l = 0; l < hdr_info->ilevel; l++ )
+                {
+                k = hdr_info->datapos
+                    + TIME_STEP_HEADER + REC_CW
+                    + ( long ) t * ( hdr_info->steplen )
+                    + s * ( hdr_info->speclen )
+                    + l * ( REC_CW + hdr_info->levellen );
+                nok += uam_map_record ( map, t, l, s, k*WORD_SIZE, UAM_REC_OFFSET, n );
+                }
+    if ( nok == 0 )
+        {
+        uam_map_close ( map );
+        return NULL;
+        }
+    return map;
+#endif /* UNICOS */
+    }
+/* ========================================================================== */
 int uam_close()
     {
     if ( fclose ( fp ) == 0 ) return ( PAVE_SUCCESS );
@@ -20,6 +20,10 @@
  *  REVISION HISTORY
  *      Author:  Atanas Trayanov, NCSC, 1994?
  *      Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  uamv_map_index() builds
+ *          the mapped-record index (uammap.c)
+ *      Version 10/2026:  uamv_map_index() opens the file itself, and
+ *          takes the byte order from hdr_info->convert
  ****************************************************************************/
 
 /* bald messes this up in some header file */
@@ -31,11 +35,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
 #include "uamv.h"
 #include "vis_data.h"
+#include "uammap.h"
 
 /* ... definitions ... */
 
@@ -390,6 +397,8 @@ int uamv_fetch_header ( char *metafile, UAMV_INFO *hdr_info )
             }
         }
 
+    hdr_info->convert = convert;
+
     datapos = hdr_info->datapos;
     nstep= ( uamv_filesize - datapos ) / ( steplen*WORD_SIZE );
 
@@ -676,6 +685,92 @@ int n, spec, level, hour;
     return ( PAVE_SUCCESS );
     }
 /* ========================================================================== */
+/* Mapped-record index for filename, whose header uamv_fetch_header()
+   parsed into hdr_info, with the same record positions uamv_fetch_data()
+   uses.  As for uam_map_index(), the file is opened here, not through
+   the global fp.  Records that do not check out are left out, and read
+   through uamv_fetch_data().
+ */
+UAM_MAP *uamv_map_index ( const char *filename, UAMV_INFO *hdr_info )
+    {
+#ifdef UNICOS
+    return NULL;
+#else
+    UAM_MAP *map;
+    int  t, l, s, n, nok, offset, fd;
+    long pos;
+
+    switch ( hdr_info->uamv_type )
+        {
+        case UAMV_WIND:
+        case UAMV_TEMP:
+        case UAMV_HEIGHT:
+        case UAMV_CLOUD:
+        case UAMV_H2O:
+        case UAMV_RAIN:
+        case UAMV_VDIF:
+        case UAMV_FAVER:
+        case UAMV_FINST:
+            break;
+        default:
+            return NULL;
+        }
+
+    if ( ( fd = open ( filename, O_RDONLY ) ) < 0 )
+        return NULL;
+    map = uam_map_open ( fd, hdr_info->convert,
+                         hdr_info->nstep, hdr_info->ilevel, hdr_info->ispec );
+    close ( fd );
+    if ( map == NULL )
+        return NULL;
+
+    n   = hdr_info->icol * hdr_info->irow;
+    nok = 0;
+    for ( t = 0; t < hdr_info->nstep; t++ )
+        for ( s = 0; s < hdr_info->ispec; s++ )
+            for ( l = 0; l < hdr_info->ilevel; l++ )
+                {
+                offset = UAMV_REC_OFFSET;
+                switch ( hdr_info->uamv_type )
+                    {
+                    case UAMV_WIND:
+                        offset = 0;
+                        pos = WORD_SIZE * ( ( long ) t * ( hdr_info->steplen )
+                                            + l * ( hdr_info->levellen )
+                                            + s * ( hdr_info->speclen )
+                                            + UAMV_REC_OFFSET + REC_CW );
+                        break;
+                    case UAMV_TEMP:
+                        pos = WORD_SIZE * ( ( long ) t * ( hdr_info->steplen )
+                                            + ( l+1 ) * ( hdr_info->levellen ) );
+                        break;
+                    case UAMV_FAVER:
+                    case UAMV_FINST:
+                        offset = 0;
+                        pos = hdr_info->datapos + WORD_SIZE * (
+                                  UAMV_TIME_STEP_HEADER + REC_CW
+                                  + ( long ) t * ( hdr_info->steplen )
+                                  + s * ( hdr_info->speclen )
+                                  + l * ( hdr_info->levellen )
+                                  + hdr_info->grid_offset );
+                        break;
+                    default:
+                        pos = WORD_SIZE * ( ( long ) t * ( hdr_info->steplen )
+                                            + s * ( hdr_info->speclen )
+                                            + l * ( hdr_info->levellen ) );
+                        break;
+                    }
+                nok += uam_map_record ( map, t, l, s, pos, offset, n );
+                }
+    if ( nok == 0 )
+        {
+        uam_map_close ( map );
+        return NULL;
+        }
+    return map;
+#endif /* UNICOS */
+    }
+/* ========================================================================== */
 int read_item ( fp,format,pointer_to_variable )
 FILE *fp;
 char * format;
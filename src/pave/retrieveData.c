@@ -259,10 +259,38 @@
  * SRT  10/21/96   Added makeSureIts_netCDF() calls, added get_data()
  * 
  * Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *
+ * Version 10/2026:  prefetchCaseInfo() issues the get_info()s for all
+ *                   the remote cases in a formula at once.
+ *
+ * Version 10/2026:  prefetchSpecies() requests the data for the plain
+ *                   remote species of a formula at once, before it is
+ *                   evaluated;  get_spec_data() takes them as it goes.
+ *
+ * Version 10/2026:  run_formula():  grids too large for memory spill to
+ *                   disk while the formula is evaluated (spill.c);  the
+ *                   result is brought back into memory before return.
+ *
+ * Version 10/2026:  fillZlevels() and totalIntegration() visit only the
+ *                   cells in the domain, through a compiled mask
+ *                   (domainmask.c), and use the right data indexes.
+ *
+ * Version 10/2026:  species_summary():  the range of a plain variable,
+ *                   and mean() and sum() of one, come from the plane
+ *                   summaries get_data_local() keeps (planesum.c)
+ *                   when they cover the whole domain;  mean() and
+ *                   sum() then need not read the data at all.
+ *
+ * Version 10/2026:  colsum(), colint(), colmax() and colavg() column
+ *                   operators (colop.c) reduce a 3-D operand to 2-D.
  *************************************************************/
 #include <math.h>
 
 #include "bts.h"
+#include "spill.h"
+#include "domainmask.h"
+#include "planesum.h"
+#include "colop.h"
 
 
 /* struct data types for this file only */
@@ -275,6 +303,15 @@ struct stack_item
     struct   stack_item *sptr;   /* pointer to the item below on stack */
     };
 
+struct prefetch_item            /* see prefetchSpecies() */
+    {
+    VIS_ASYNC_REQUEST *req;      /* NULL once done with */
+    char     caseChar;
+    int      sindex;
+    int      hrMin, hrMax;       /* *hrMin, *hrMax requested for */
+    VIS_DATA sdata;
+    };
+
 
 /* #defines for this file only */
 
@@ -282,6 +319,8 @@ struct stack_item
 #define ARRSIZE      ((long)((long)IMAX*JMAX*KMAX*TMAX*sizeof(float)))
 #define DEPARRSIZE   ((long)((long)IMAX*JMAX*TMAX*sizeof(float)))
 
+#define PREFETCH_MAX (16)   /* species requested ahead, at most */
+
 /* types of "atoms" entered by the user */
 #define         FLTPTR          0
 #define         SARRPTR         1
@@ -310,6 +349,9 @@ struct stack_item
 
 static VIS_DATA *caseInfo;
 
+static struct prefetch_item prefetch[PREFETCH_MAX];
+static int                  nprefetch = 0;
+
 static struct BusData *bd;
 
 static float floorCut,
@@ -356,6 +398,9 @@ static char  atom[25],      /* the current atom being processed */
 static
 struct  stack_item  *stack;
 
+static DomainMask domMask;      /* percents, compiled by domain_mask() */
+static int        domMaskSet = 0;
+
 
 
 /* function prototypes for routines for this file only */
@@ -376,6 +421,12 @@ static double            totalIntegration ( float *sdata,
         int thisKMAX,
         int step );
 
+static int       spec_request    ( char     caseChar,
+                                   int      spec_index,
+                                   VIS_DATA *sdata,
+                                   int      *sminP,
+                                   int      *smaxP );
+
 static int       get_spec_data   ( char     *fname,
                                    char     *hname,
                                    char     caseChar,
@@ -386,8 +437,30 @@ static int       get_spec_data   ( char     *fname,
 
 static int               process         ( void );
 
+static int               run_formula     ( void );
+
+static const DomainMask  *domain_mask     ( void );
+
+static int               next_atom       ( char *next, int n );
+
+static int               species_summary ( char c, int sindex, PlaneSum *total );
+
+static int               summary_range   ( VIS_DATA *vdata );
+
+static int               column_op       ( int op );
+
 static void          freeCaseInfo    ( void );
 
+static void          prefetchCaseInfo ( void );
+
+static void          prefetchSpecies ( void );
+
+static int           take_prefetch   ( char caseChar, int sindex, VIS_DATA *sdata );
+
+static void          drop_prefetch   ( void );
+
+static int           species_atom    ( int *fp, int *sindex, int *plain );
+
 
 static int       my_get_data ( struct BusData *bd, VIS_DATA *info, char *message );
 
@@ -469,6 +542,260 @@ void    freeCaseInfo ( void )
 
 
 
+/************************************************************
+PREFETCHCASEINFO - requests the info for every remote case
+        used in the formula at once, so that the visd's work
+        on them in parallel instead of one after another.
+        Cases that fail are left empty, for process() to
+        retry (and report) in the usual way.
+************************************************************/
+static
+void    prefetchCaseInfo ( void )
+    {
+    VIS_ASYNC_REQUEST *req[26];
+    char    used[26], name[255];
+    int     i, nremote, fp, sindex, plain;
+
+    if ( ( bd == NULL ) || ( ncases < 2 ) )
+        return;
+
+    /* which cases do the 'S' and 'D' atoms refer to? */
+    memset ( used, 0, sizeof ( used ) );
+    for ( fp = 0; ( i = species_atom ( &fp, &sindex, &plain ) ) != -1; )
+        if ( ( i >= 0 ) && ( i < ncases ) && ( i < 26 ) )
+            used[i] = 1;
+
+    nremote = 0;
+    for ( i = 0; ( i < ncases ) && ( i < 26 ); i++ )
+        {
+        req[i] = NULL;
+        if ( !used[i] || caseInfo[i].filename != NULL )
+            continue;
+        if ( getNthItem ( i+1, hostList, name ) )
+            continue;
+        if ( !name[0] || !strcmp ( name, "localhost" ) )
+            continue;
+        caseInfo[i].filehost.name = strdup ( name );
+        if ( getNthItem ( i+1, caseList, name ) ||
+                ( ( caseInfo[i].filename = strdup ( name ) ) == NULL ) ||
+                ( check_local_file ( &caseInfo[i] ) != 0 ) )
+            {
+            myFreeVis ( &caseInfo[i] );
+            continue;
+            }
+        nremote++;
+        }
+    if ( nremote < 2 )
+        {
+        for ( i = 0; ( i < ncases ) && ( i < 26 ); i++ )
+            if ( caseInfo[i].filename != NULL )
+                myFreeVis ( &caseInfo[i] );
+        return;
+        }
+
+    for ( i = 0; ( i < ncases ) && ( i < 26 ); i++ )
+        if ( caseInfo[i].filename != NULL )
+            req[i] = get_info_async ( bd, &caseInfo[i], NULL, NULL );
+
+    wait_all_vis_requests ( bd );
+
+    for ( i = 0; ( i < ncases ) && ( i < 26 ); i++ )
+        {
+        if ( caseInfo[i].filename == NULL )
+            continue;
+        if ( ( req[i] == NULL ) ||
+                ( wait_vis_request ( bd, req[i] ) == FAILURE ) ||
+                makeSureIts_netCDF ( &caseInfo[i], errorString ) )
+            {
+            myFreeVis ( &caseInfo[i] );
+            errorString[0] = '\0';
+            }
+        free_vis_request ( req[i] );
+        }
+    }
+
+
+
+
+
+/************************************************************
+SPECIES_ATOM -  scans the formula from *fp for its next atom:
+        returns -1 at the end of the formula;  else the
+        case index of an 'S' or 'D' atom, with its species
+        index in *sindex, and *plain set if it has no ':'
+        suffix;  else -2
+************************************************************/
+static
+int     species_atom ( int *fp, int *sindex, int *plain )
+    {
+    char    tok[255], *cp;
+    int     n;
+
+    while ( formula[*fp] == ' ' ) ( *fp )++;
+    if ( !formula[*fp] )
+        return -1;
+    for ( n = 0; formula[*fp] && ( formula[*fp] != ' ' ); ( *fp )++ )
+        if ( n < 254 ) tok[n++] = formula[*fp];
+    tok[n] = '\0';
+    if ( ( tok[0] != 'S' ) && ( tok[0] != 'D' ) )
+        return -2;
+    *plain = ( ( cp = strchr ( tok, ( int ) ':' ) ) == NULL );
+    if ( cp != NULL )
+        *cp = '\0';
+    if ( ( n = strlen ( tok ) ) < 2 )
+        return -2;
+    *sindex = atoi ( tok+1 );
+    return toupper ( tok[n-1] ) - 'A';
+    }
+
+
+
+/************************************************************
+PREFETCHSPECIES - requests the data for the plain species
+        (no ':' suffix) of the formula's remote cases at
+        once, before process() starts on the formula, so
+        that the visd's read them while it works, instead
+        of one get_data() after another.  get_spec_data()
+        takes them with take_prefetch(), and run_formula()
+        drops whatever is left.  A request that fails is
+        dropped, for get_spec_data() to retry (and report)
+        in the usual way.
+************************************************************/
+static
+void    prefetchSpecies ( void )
+    {
+    struct prefetch_item *pf;
+    VIS_ASYNC_REQUEST    *req[PREFETCH_MAX];
+    char    caseName[255], hostName[255];
+    int     c, p, fp, sindex, plain, smin, smax;
+
+    nprefetch = 0;
+    if ( bd == NULL )
+        return;
+
+    /* get_info() for each, all at once */
+    for ( fp = 0; ( c = species_atom ( &fp, &sindex, &plain ) ) != -1; )
+        {
+        if ( ( c < 0 ) || ( c >= ncases ) || !plain || ( sindex < 0 ) ||
+                ( nprefetch == PREFETCH_MAX ) )
+            continue;
+        for ( p = 0; p < nprefetch; p++ )
+            if ( ( prefetch[p].caseChar == 'A'+c ) && ( prefetch[p].sindex == sindex ) )
+                break;
+        if ( p < nprefetch )
+            continue;
+        if ( getNthItem ( c+1, hostList, hostName ) ||
+                !hostName[0] || !strcmp ( hostName, "localhost" ) ||
+                getNthItem ( c+1, caseList, caseName ) )
+            continue;
+        pf = &prefetch[nprefetch];
+        memset ( ( void * ) pf, 0, sizeof ( struct prefetch_item ) );
+        pf->caseChar = 'A'+c;
+        pf->sindex   = sindex;
+        if ( ( ( pf->sdata.filename = strdup ( caseName ) ) == NULL ) ||
+                ( ( pf->sdata.filehost.name = strdup ( hostName ) ) == NULL ) ||
+                ( check_local_file ( &pf->sdata ) != 0 ) ||
+                ( ( req[nprefetch] = get_info_async ( bd, &pf->sdata, NULL, NULL ) ) == NULL ) )
+            {
+            myFreeVis ( &pf->sdata );
+            continue;
+            }
+        nprefetch++;
+        }
+    wait_all_vis_requests ( bd );
+    if ( nprefetch < 2 )        /* nothing to overlap */
+        {
+        for ( p = 0; p < nprefetch; p++ )
+            free_vis_request ( req[p] );
+        drop_prefetch();
+        return;
+        }
+
+    /* then get_data() for each, all at once, as get_spec_data() would */
+    thisHour = -1;
+    dt = 0;
+    for ( p = 0; p < nprefetch; p++ )
+        {
+        pf = &prefetch[p];
+        if ( ( wait_vis_request ( bd, req[p] ) == FAILURE ) ||
+                makeSureIts_netCDF ( &pf->sdata, errorString ) ||
+                spec_request ( pf->caseChar, pf->sindex, &pf->sdata, &smin, &smax ) ||
+                ( ( pf->req = get_data_async ( bd, &pf->sdata, NULL, NULL ) ) == NULL ) )
+            {
+            myFreeVis ( &pf->sdata );
+            errorString[0] = '\0';
+            }
+        pf->hrMin = *hrMin;
+        pf->hrMax = *hrMax;
+        free_vis_request ( req[p] );
+        }
+    }
+
+
+
+/************************************************************
+TAKE_PREFETCH - moves the data prefetchSpecies() got for
+        species sindex of case caseChar into sdata, if it
+        was requested for the current steps and arrived.
+
+        Returns 1 if it did, else 0.
+************************************************************/
+static
+int     take_prefetch ( char caseChar, int sindex, VIS_DATA *sdata )
+    {
+    struct prefetch_item *pf;
+    int     p, ok;
+
+    for ( p = 0; p < nprefetch; p++ )
+        {
+        pf = &prefetch[p];
+        if ( ( pf->req == NULL ) || ( pf->caseChar != caseChar ) ||
+                ( pf->sindex != sindex ) )
+            continue;
+        ok = ( wait_vis_request ( bd, pf->req ) != FAILURE ) &&
+             ( pf->hrMin == *hrMin ) && ( pf->hrMax == *hrMax );
+        free_vis_request ( pf->req );
+        pf->req = NULL;
+        if ( !ok )
+            {
+            myFreeVis ( &pf->sdata );
+            return 0;
+            }
+        *sdata = pf->sdata;
+        memset ( ( void * ) &pf->sdata, 0, sizeof ( VIS_DATA ) );
+        return 1;
+        }
+    return 0;
+    }
+
+
+
+/************************************************************
+DROP_PREFETCH - waits for, and frees, the prefetched data
+        that get_spec_data() did not take
+************************************************************/
+static
+void    drop_prefetch ( void )
+    {
+    int     p;
+
+    for ( p = 0; p < nprefetch; p++ )
+        {
+        if ( prefetch[p].req != NULL )
+            {
+            wait_vis_request ( bd, prefetch[p].req );
+            free_vis_request ( prefetch[p].req );
+            prefetch[p].req = NULL;
+            }
+        if ( prefetch[p].sdata.filename != NULL )
+            myFreeVis ( &prefetch[p].sdata );
+        }
+    nprefetch = 0;
+    }
+
+
+
+
 
 /************************************************************
 PUSH -  pushes a data (constant or array pointer) onto stack;
@@ -570,6 +897,222 @@ static int free_up ( void )
 
 
 
+/************************************************************
+TOUCH_STACK - marks the stack's grids used, the top one last
+************************************************************/
+static void touch_stack ( struct stack_item *item )
+    {
+    if ( item == NULL )
+        return;
+    touch_stack ( item->sptr );
+    if ( item->dtype ) spill_touch ( item->vdata.grid );
+    }
+
+
+
+/************************************************************
+RUN_FORMULA - runs process() over the whole formula, letting
+          grids spill to disk (spill.c), and trimming the
+          spilled grids' resident memory after each atom;
+          returns process()'s final value
+************************************************************/
+static int run_formula ( void )
+    {
+    int returnval;
+
+    prefetchSpecies();
+    spill_scope ( 1 );
+    while ( ! ( returnval = process() ) )
+        {
+        touch_stack ( stack );
+        spill_trim();
+        }
+    spill_scope ( 0 );
+    drop_prefetch();
+    return returnval;
+    }
+
+
+
+/************************************************************
+DOMAIN_MASK - the domain mask (percents), compiled on first
+          use in each retrieveData() call;  NULL if there
+          is not enough memory
+************************************************************/
+static const DomainMask *domain_mask ( void )
+    {
+    if ( !domMaskSet )
+        {
+        if ( !domainmask_build ( &domMask, percents, IMAX, JMAX ) )
+            return NULL;
+        domMaskSet = 1;
+        }
+    return &domMask;
+    }
+
+
+
+/************************************************************
+NEXT_ATOM - copies the atom after the current one into next,
+        without advancing;  returns its length
+************************************************************/
+static int next_atom ( char *next, int n )
+    {
+    int p = fpos, len = 0;
+
+    while ( formula[p] == ' ' ) p++;
+    while ( ( formula[p] != ' ' ) && ( formula[p] != '\0' ) )
+        {
+        if ( len < n-1 ) next[len++] = formula[p];
+        p++;
+        }
+    next[len] = '\0';
+    return len;
+    }
+
+
+
+/************************************************************
+SPECIES_SUMMARY - combines the plane summaries (planesum.c)
+          of case c's species sindex (0 based) over the
+          steps and levels this retrieveData() call reads
+          for it.  Only whole-domain XY, XYT, XYZ and XYZT
+          slices of local files, with every cell in the
+          domain, qualify;  returns 1 if the summaries are
+          all known and there is data in them, else 0
+************************************************************/
+static int species_summary ( char c, int sindex, PlaneSum *total )
+    {
+    VIS_DATA *info = &caseInfo[c-'A'];
+    const DomainMask *mask;
+    const int *layers = whichLevel;
+    int  s0, s1, l0, l1;
+
+    if ( ( thisHour >= 0 ) || dt || ( stepIncr[c-'A'] > 1 ) ||
+            ( info->filename == NULL ) ||
+            ( IMAX != info->ncol ) || ( JMAX != info->nrow ) ||
+            ( ( bd != NULL ) && ( check_local_file ( info ) != 1 ) ) )
+        return 0;
+    if ( ( ( mask = domain_mask() ) == NULL ) ||
+            ( mask->ncells != ( long ) IMAX * JMAX ) )
+        return 0;
+
+    s0 = stepMin[c-'A'] + *hrMin;
+    s1 = stepMin[c-'A'] + *hrMax;
+    l0 = levelMin + 1;
+    l1 = levelMax + 1;
+    switch ( sliceType )
+        {
+        case XYSLICE:
+            s0 = s1 = stepMin[c-'A'] + selectedStep - 1;
+            /* fall through */
+        case XYTSLICE:
+            l0 = l1 = selectLevel;
+            layers = NULL;
+            break;
+        case XYZSLICE:
+            s0 = s1 = stepMin[c-'A'] + selectedStep - 1;
+            break;
+        case XYZTSLICE:
+            break;
+        default:
+            return 0;
+        }
+    if ( ( s0 < info->step_min ) || ( s1 > info->step_max ) )
+        return 0;
+
+    return planesum_query ( info->filename, sindex+1, l0, l1, layers, s0, s1, total ) &&
+           ( total->n > 0 );
+    }
+
+
+
+/************************************************************
+SUMMARY_RANGE - if the formula is just one variable, sets
+        vdata's grid_min and grid_max from its plane
+        summaries (see species_summary());  returns 1 if
+        it did, 0 if calc_stats() must scan the data
+************************************************************/
+static int summary_range ( VIS_DATA *vdata )
+    {
+    PlaneSum total;
+    char    *f = formula, c;
+    int      len;
+
+    while ( *f == ' ' ) f++;
+    len = strlen ( f );
+    while ( ( len > 0 ) && ( f[len-1] == ' ' ) ) len--;
+    if ( ( len < 3 ) || ( f[0] != 'S' ) || memchr ( f, ' ', len ) || memchr ( f, ':', len ) )
+        return 0;
+    c = toupper ( f[len-1] );
+    if ( ( c < 'A' ) || ( c >= ( 'A' + ncases ) ) ||
+            !species_summary ( c, atoi ( &f[1] ), &total ) )
+        return 0;
+    vdata->grid_min = total.min;
+    vdata->grid_max = total.max;
+    return 1;
+    }
+
+
+
+/************************************************************
+COLUMN_OP - replaces the 3-D array on top of the stack by
+        its column sums, integrals, maxima or means
+        (colop.c) over the selected levels:  a 2-D array
+        of one level, as from a 2-D variable;  returns 0
+        on success, 1 with an error message on failure
+************************************************************/
+static int column_op ( int op )
+    {
+    VIS_DATA *v = &stack->vdata;
+    float    *out, *mass = NULL;
+    long      ncell = ( long ) IMAX * JMAX;
+    int       level0, sp;
+    char      tstring[512];
+    const char *fname;
+
+    if ( ( op == COLOP_INT ) || ( op == COLOP_AVG ) )
+        {
+        /* layer masses from the operand's vertical grid */
+        level0 = ( ( sliceType == XYSLICE ) || ( sliceType == XYTSLICE ) ) ?
+                 selectLevel-1 : levelMin;
+        fname = v->filename ? v->filename : caseInfo[0].filename;
+        if ( ( mass = ( float * ) malloc ( KMAX * sizeof ( float ) ) ) == NULL )
+            return errmsg ( mem_msg );
+        if ( !colop_layer_mass ( fname, level0, KMAX, mass, tstring ) )
+            {
+            free ( mass );
+            return errmsg ( tstring );
+            }
+        }
+
+    if ( ( out = spill_alloc ( ( size_t ) ncell * TMAX ) ) == NULL )
+        {
+        if ( mass ) free ( mass );
+        return errmsg ( mem_msg );
+        }
+    colop_reduce ( op, v->grid, ncell, KMAX, ( int ) TMAX, whichLevel, mass, out );
+    if ( mass ) free ( mass );
+    spill_release ( v->grid );
+    v->grid = out;
+
+    /* now it is 2-D */
+    stack->dtype = DARRPTR;
+    v->nlevel    = 1;
+    v->level_min = v->level_max = v->selected_level = 1;
+
+    sp = ( v->selected_species > 0 ) ? v->selected_species-1 : 0;
+    if ( ( op == COLOP_INT ) && v->units_name && v->units_name[sp] )
+        {
+        snprintf ( tstring, sizeof ( tstring ), "%s*kg/m2", v->units_name[sp] );
+        free ( v->units_name[sp] );
+        v->units_name[sp] = strdup ( tstring );
+        }
+    return 0;
+    }
+
+
+
 /************************************************************
 fillZlevels -   computes the vertical profile for the
         given species data.  Note: this should
@@ -590,8 +1133,11 @@ fillZlevels -   computes the vertical profile for the
 ************************************************************/
 static int fillZlevels ( float *sdata, float *zdata, int step )
     {
-    int     i, j, k, p, t, tmin, tmax;
-    double      total, cells_on, cells_fac ;
+    int     i, k, r, t, tmin, tmax;
+    double      total, tsum, cells_fac ;
+    const DomainMask *mask;
+    const MaskRun    *run;
+    const float      *row;
 
     if ( step >= 0 )
         tmin = tmax = step;
@@ -601,12 +1147,10 @@ static int fillZlevels ( float *sdata, float *zdata, int step )
         tmax = *hrMax - *hrMin;
         }
 
-    cells_on = 0.0;
-    for ( j = 0; j < JMAX; j++ )
-        for ( i = 0; i < IMAX; i++ )
-            cells_on += ( double ) percents[INDEX ( i,j,0,0,IMAX,JMAX,1 )];
+    if ( ( mask = domain_mask() ) == NULL )
+        return errmsg ( mem_msg );
 
-    if ( cells_on == 0.0 )
+    if ( mask->total == 0.0 )
         {
         for ( k = 0; k < KMAX; k++ )
             zdata[k] = 0.0;
@@ -614,7 +1158,7 @@ static int fillZlevels ( float *sdata, float *zdata, int step )
         return 0;
         } 
 
-    cells_fac = 100.0 / ( (double)( tmax-tmin+1 ) * cells_on ) ;
+    cells_fac = 100.0 / ( (double)( tmax-tmin+1 ) * mask->total ) ;
 
     for ( k = 0; k < KMAX; k++ )
         {
@@ -623,13 +1167,14 @@ static int fillZlevels ( float *sdata, float *zdata, int step )
             {
             if ( cancelKeys() ) return errmsg ( "cancel" );
             total = 0.0;
-            for ( t = 0; t <= tmax; t++ )
-                for ( j = 0; j < JMAX; j++ )
-                    for ( i = 0; i < IMAX; i++ )
-                        {
-                        p = percents[INDEX ( i,j,0,0,IMAX,JMAX,1 )] ;
-                        total += ( sdata[INDEX ( i,j,k,t,IMAX,JMAX,KMAX )] * p );
-                        }
+            for ( t = tmin; t <= tmax; t++ )
+                for ( r = 0, run = mask->run; r < mask->nrun; r++, run++ )
+                    {
+                    row = sdata + INDEX ( 0,run->row,k,t,IMAX,JMAX,KMAX );
+                    for ( tsum = 0.0, i = run->col0; i <= run->col1; i++ )
+                        tsum += row[i];
+                    total += tsum * run->weight;
+                    }
             zdata[k] = cells_fac * total ;
             }
         }
@@ -655,9 +1200,11 @@ totalIntegration -  computes the total integration for the
 ************************************************************/
 static double totalIntegration ( float *sdata, int thisKMAX, int step )
     {
-    double  total, cells_on, cells_fac, tsum;
-    int i, j, k, t, tmin, tmax;
-    long    index;
+    double  total, cells_fac, tsum;
+    int i, k, r, t, tmin, tmax;
+    const DomainMask *mask;
+    const MaskRun    *run;
+    const float      *row;
 
     if ( step >= 0 )
         tmin = tmax = step;
@@ -667,48 +1214,27 @@ static double totalIntegration ( float *sdata, int thisKMAX, int step )
         tmax = *hrMax - *hrMin;
         }
 
-    cells_on = 0.0;
-    for ( j = 0; j < JMAX; j++ )
-        {
-        for ( i = 0; i < IMAX; i++ )
-            {
-            cells_on += ( double ) percents[INDEX ( i,j,0,0,IMAX,JMAX,1 )] ;
-            }
-        }
-
-    if ( cells_on == 0.0 ) 
+    if ( ( ( mask = domain_mask() ) == NULL ) || ( mask->total == 0.0 ) )
         {
         return 0.0 ;
         }
 
-    cells_fac = 100.0 / ( cells_on * (double)( tmax-tmin+1 ) ) ;
+    cells_fac = 100.0 / ( mask->total * (double)( tmax-tmin+1 ) ) ;
     total     = 0.0;
     for ( t = tmin; t <= tmax; t++ )
         {
-        if ( thisKMAX == KMAX )
+        for ( k = 0; k < thisKMAX; k++ )
             {
-            for ( k = 0, tsum = 0.0; k < KMAX; k++ )
+            if ( ( thisKMAX == KMAX ) && !whichLevel[k] )
+                continue;
+            for ( r = 0, run = mask->run; r < mask->nrun; r++, run++ )
                 {
-                if ( whichLevel[k] )    /* this level is selected; compute an average */
-                    {
-                    for ( tsum = 0.0, j = 0; j < JMAX; j++ )
-                        {
-                        for ( i = 0; i < IMAX; i++ )
-                            {
-                            tsum += ( sdata[index] * (float)percents[INDEX ( i,j,0,0,IMAX,JMAX,1 )] ) ;
-                            }
-                        }
-                    total += tsum * thickVals[k] ;
-                    }
-                }
-            }
-        else{
-            for ( j = 0; j < JMAX; j++ )
-                {
-                for ( i = 0; i < IMAX; i++ )
-                    {
-                    total += ( sdata[index] * ( float ) ( percents[INDEX ( i,j,0,0,IMAX,JMAX,1 )] ) );
-                    }
+                row = sdata + INDEX ( 0,run->row,k,t,IMAX,JMAX,thisKMAX );
+                for ( tsum = 0.0, i = run->col0; i <= run->col1; i++ )
+                    tsum += row[i];
+                /* selected levels are weighted by their thicknesses */
+                total += tsum * run->weight *
+                         ( ( thisKMAX == KMAX ) ? thickVals[k] : 1.0 );
                 }
             }
         }
@@ -720,64 +1246,20 @@ static double totalIntegration ( float *sdata, int thisKMAX, int step )
 
 
 /************************************************************
-GET_SPEC_DATA - retrieves data for a particular species,
-        storing it in sdata.
+SPEC_REQUEST - sets the slice, ranges, and steps of sdata
+        (already filled in by get_info()) to request species
+        spec_index of case caseChar, for the current atom,
+        with the first and last steps wanted in *sminP, *smaxP.
 
         Returns 1 if an error is encountered.
 ************************************************************/
-static int get_spec_data (
-                         char            *fname,
-                         char            *hname,
-                         char            caseChar,
-                         int         spec_index,
-                         VIS_DATA        *sdata,
-                         int         thisKMAX
-                         )
+static int spec_request ( char caseChar, int spec_index, VIS_DATA *sdata,
+                          int *sminP, int *smaxP )
     {
-    int         i, j, k, s, smin, smax, h, t;
-    char            tstring[512], tstring2[512];
+    int         s, smin, smax;
+    char            tstring[512];
     int         HACK = 0;
 
-    if ( sdata == NULL ) return errmsg ( "NULL sdata arg to get_spec_data()!!" );
-
-    /* set sdata's info to all NULL values */
-    memset ( ( void * ) sdata, 0, ( size_t ) sizeof ( VIS_DATA ) );
-
-    /* put filename in VIS_DATA struct */
-    if ( ( sdata->filename = strdup ( fname ) ) == NULL )
-        {
-        myFreeVis ( sdata );
-        return errmsg ( mem_msg );
-        }
-
-    /* put hostname in VIS_DATA struct */
-    if ( ( sdata->filehost.name = strdup ( hname ) ) == NULL )
-        {
-        myFreeVis ( sdata );
-        return errmsg ( mem_msg );
-        }
-
-    /* fill up VIS_DATA struct with template info using get_info */
-    if ( !get_info ( bd, sdata, errorString ) )
-        {
-        myFreeVis ( sdata );
-        return 1;
-        }
-
-    /* convert to netCDF (really, IO/API map_info information) data if it isn't already */
-    if ( makeSureIts_netCDF ( sdata, errorString ) )
-        {
-        myFreeVis ( sdata );
-        return 1;
-        }
-
-
-#ifdef DIAGNOSTICS
-    printf ( "Just after get_info() call in get_spec_data() !\n" );
-    if ( dump_VIS_DATA ( sdata, NULL, NULL ) ) return 2;
-#endif /* DIAGNOSTICS */
-
-
     /* set the type of slice and miscellaneous clamps
        NOTE:  kathy's routines are *1* based */
     sdata->selected_species = spec_index+1;
@@ -895,6 +1377,77 @@ static int get_spec_data (
         sdata->step_min = s;
         sdata->step_max = s;
         }
+    *sminP = smin;
+    *smaxP = smax;
+    return 0;
+    }
+
+
+
+/************************************************************
+GET_SPEC_DATA - retrieves data for a particular species,
+        storing it in sdata.
+
+        Returns 1 if an error is encountered.
+************************************************************/
+static int get_spec_data (
+                         char            *fname,
+                         char            *hname,
+                         char            caseChar,
+                         int         spec_index,
+                         VIS_DATA        *sdata,
+                         int         thisKMAX
+                         )
+    {
+    int         i, j, k, smin, smax, h, t;
+
+    if ( sdata == NULL ) return errmsg ( "NULL sdata arg to get_spec_data()!!" );
+
+    /* set sdata's info to all NULL values */
+    memset ( ( void * ) sdata, 0, ( size_t ) sizeof ( VIS_DATA ) );
+
+    /* plain species may have been requested ahead by prefetchSpecies() */
+    if ( ( thisHour < 0 ) && take_prefetch ( caseChar, spec_index, sdata ) )
+        return 0;
+
+    /* put filename in VIS_DATA struct */
+    if ( ( sdata->filename = strdup ( fname ) ) == NULL )
+        {
+        myFreeVis ( sdata );
+        return errmsg ( mem_msg );
+        }
+
+    /* put hostname in VIS_DATA struct */
+    if ( ( sdata->filehost.name = strdup ( hname ) ) == NULL )
+        {
+        myFreeVis ( sdata );
+        return errmsg ( mem_msg );
+        }
+
+    /* fill up VIS_DATA struct with template info using get_info */
+    if ( !get_info ( bd, sdata, errorString ) )
+        {
+        myFreeVis ( sdata );
+        return 1;
+        }
+
+    /* convert to netCDF (really, IO/API map_info information) data if it isn't already */
+    if ( makeSureIts_netCDF ( sdata, errorString ) )
+        {
+        myFreeVis ( sdata );
+        return 1;
+        }
+
+
+#ifdef DIAGNOSTICS
+    printf ( "Just after get_info() call in get_spec_data() !\n" );
+    if ( dump_VIS_DATA ( sdata, NULL, NULL ) ) return 2;
+#endif /* DIAGNOSTICS */
+
+
+    if ( spec_request ( caseChar, spec_index, sdata, &smin, &smax ) )
+        return 1;
+
 #ifdef DIAGNOSTICS
     fprintf ( stderr, "Just before get_data() call in get_spec_data !\n" );
     fflush ( stderr );
@@ -988,7 +1541,7 @@ static int get_spec_data (
                     ( stack->vdata.level_max - stack->vdata.level_min + 1 ) *
                     ( smax - smin + 1 ) *
                     sizeof ( float );
-            if ( ( tf = ( char * ) malloc ( msize ) ) == NULL )
+            if ( ( tf = ( char * ) spill_alloc ( msize / sizeof ( float ) ) ) == NULL )
                 {
                 myFreeVis ( sdata );
                 return errmsg ( mem_msg );
@@ -999,7 +1552,7 @@ static int get_spec_data (
                     sizeof ( float );
             for ( i = smin; i <= smax; i++ )
                 memcpy ( &tf[msize* ( i-smin )], ( char * ) sdata->grid, msize );
-            free ( sdata->grid );
+            spill_release ( sdata->grid );
             sdata->grid = ( float * ) tf;
             tf = NULL;
             }
@@ -1080,6 +1633,7 @@ static int process ( void )
     long    ind, index, index1, index2;
     int     maxi, maxj, maxk, maxt, mini, minj, mink, mint, atom_type;
     float   mean, var, std_dev, grid_min, grid_max, sum;
+    PlaneSum psum;
 
 
     if ( cancelKeys() ) return ( 1+errmsg ( "cancel" ) );
@@ -1406,6 +1960,15 @@ static int process ( void )
                 }
             }
         }
+    else if ( ( len == 6 ) && ( colop_type ( atom ) >= 0 ) )
+        {
+        if ( stack == NULL )
+            return ( 1 + errmsg (
+                         "Nothing to take colsum/colint/colmax/colavg of on stack!" ) );
+        /* a constant or a 2-D array is a column of its own */
+        if ( stack->dtype == SARRPTR )
+            if ( column_op ( colop_type ( atom ) ) ) return 2;
+        }
     else if ( ( strncasecmp ( atom, "sqrt", 4 ) == 0 ) && ( len == 4 ) )
         {
         if ( stack == NULL )
@@ -1737,8 +2300,8 @@ static int process ( void )
                     ( ( stack->vdata.species_long_name[0] =
                             strdup ( "sigmaVals" ) ) == NULL )
                     ||
-                    ( ( stack->vdata.grid = ( float * )
-                                            malloc ( ( size_t ) ARRSIZE ) ) == NULL )
+                    ( ( stack->vdata.grid =
+                                spill_alloc ( ( size_t ) ARRSIZE / sizeof ( float ) ) ) == NULL )
                 )
                     return ( 1 + errmsg ( mem_msg ) );
 
@@ -1834,13 +2397,13 @@ static int process ( void )
                        information) data if it isn't already */
                     if ( makeSureIts_netCDF ( &caseInfo[c-'A'], errorString ) )
                         return 2;
+                    }
 
-                    if ( ( caseInfo[c-'A'].ncol   != fullIMAX ) ||
-                            ( caseInfo[c-'A'].nrow   != fullJMAX ) )
-                        {
-                        sprintf ( tstring, "Case %c dims don't match IMAX, JMAX, KMAX !", c );
-                        return 1+errmsg ( tstring );
-                        }
+                if ( ( caseInfo[c-'A'].ncol   != fullIMAX ) ||
+                        ( caseInfo[c-'A'].nrow   != fullJMAX ) )
+                    {
+                    sprintf ( tstring, "Case %c dims don't match IMAX, JMAX, KMAX !", c );
+                    return 1+errmsg ( tstring );
                     }
 
                 /* make sure caseName and hostName are
@@ -1872,6 +2435,18 @@ static int process ( void )
                     return ( 1 + errmsg ( tstring ) );
                     }
 
+                /* mean() or sum() of a plain variable comes straight
+                   from its plane summaries, when they are known */
+                if ( ( atomType == 'S' ) && next_atom ( tstring2, sizeof ( tstring2 ) ) &&
+                        ( !strcasecmp ( tstring2, "mean" ) || !strcasecmp ( tstring2, "sum" ) ) &&
+                        species_summary ( c, sindex, &psum ) )
+                    {
+                    stack->dtype    = FLTPTR;
+                    stack->constant = strcasecmp ( tstring2, "mean" ) ? psum.sum
+                                      : psum.sum / ( double ) psum.n;
+                    break;
+                    }
+
                 if ( get_spec_data  ( caseName,
                                       hostName,
                                       c,
@@ -3285,6 +3860,10 @@ int retrieveData    (
     if ( ( IMAX < 1 ) || ( JMAX < 1 ) || ( KMAX < 1 ) || ( KMAX > 512 ) )
         return errmsg ( "Bad IMAX, JMAX, or KMAX!" );
 
+    /* the previous call's compiled domain mask is stale */
+    domainmask_free ( &domMask );
+    domMaskSet = 0;
+
     /* make my own space for percents and copy percentsP there */
     if ( ( percents = ( char * ) malloc ( IMAX*JMAX ) ) == NULL )
         return errmsg ( "percents malloc() failed in retrieveData()!" );
@@ -3455,6 +4034,9 @@ int retrieveData    (
     /* set case info records to all NULL values */
     memset ( ( void * ) caseInfo, 0, ( size_t ) ( ncases * sizeof ( VIS_DATA ) ) );
 
+    /* get the info for the formula's remote cases in parallel */
+    prefetchCaseInfo();
+
 
     totalInt = ( integration == ALL_INT );
     timeSeries = ( integration == TIME_INT );
@@ -3542,7 +4124,7 @@ int retrieveData    (
             }
 
         /* get all the data */
-        while ( ! ( returnval = process() ) );
+        returnval = run_formula();
 
         if ( returnval == 1 ) /* we've successfully gotten data */
             for ( h = 0; ( ( h <= *hrMax - *hrMin ) && ( returnval == 1 ) ); h++ )
@@ -3587,7 +4169,7 @@ int retrieveData    (
         }
     else
         {
-        while ( ! ( returnval = process() ) );
+        returnval = run_formula();
 
         if ( stack != NULL )
             if ( scatterInt )
@@ -3684,7 +4266,9 @@ int retrieveData    (
 
                 memcpy ( vdata, &stack->vdata, sizeof ( VIS_DATA ) );
                 memset ( &stack->vdata, 0, sizeof ( VIS_DATA ) );
-                if ( returnval == 1 )
+                if ( ( returnval == 1 ) && !spill_unspill ( vdata ) )
+                    returnval = 1 + errmsg ( "Formula result too large for memory" );
+                if ( ( returnval == 1 ) && !summary_range ( vdata ) )
                     returnval += calc_stats ( vdata, percents, whichLevel,
                                               -1, ( int ) TMAX,
                                               &maxi, &maxj, &maxk, &mint,
@@ -0,0 +1,347 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: spill.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Out-of-core grids for formula evaluation;  see spill.h.
+ *
+ *  Each spilled grid is a SpGrid on the list spHead:  its own unlinked
+ *  file, sized to a whole number of bricks and mapped MAP_SHARED, with
+ *  the clock reading (spClock) of its last use.  spill_trim() finds the
+ *  resident bricks with mincore(), and drops them by writing them back
+ *  (msync()), unmapping their pages (MADV_DONTNEED) and telling the
+ *  system it may discard the cached file pages (POSIX_FADV_DONTNEED).
+ *  spill_adopt() puts a mapping made elsewhere (getGridShm()'s) on the
+ *  same list, so that it is released the same way.  spMutex is held
+ *  across fork() (metaindex_prefetch()'s workers free grids), so that a
+ *  child gets it unlocked and the list whole.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  spill_adopt()
+ *      Version 10/2026:  spMutex atfork handlers
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include "vis_data.h"
+#include "spill.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define SPILL_BRICK     ( ( size_t ) SPILL_BRICK_MB << 20 )
+
+/* the brick at off:  adopted grids may end in a partial one */
+#define BRICK_LEN(g,off) ( ( (g)->bytes - (off) < SPILL_BRICK ) ? (g)->bytes - (off) : SPILL_BRICK )
+
+typedef struct spGrid
+    {
+    char          *addr;
+    size_t         bytes;           /* whole bricks, unless adopted */
+    int            fd;
+    unsigned long  used;
+    struct spGrid *next;
+    } SpGrid;
+
+static pthread_mutex_t spMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t  spOnce  = PTHREAD_ONCE_INIT;
+static SpGrid         *spHead  = NULL;
+static unsigned long   spClock = 0;
+static int             spOn    = 0;
+static pthread_t       spThread;
+static size_t          spLimit    = 0;      /* grids larger than this spill */
+static size_t          spResident = 0;      /* resident-brick budget */
+
+
+static void sp_prepare ( void )
+    {
+    pthread_mutex_lock ( &spMutex );
+    }
+
+static void sp_release ( void )
+    {
+    pthread_mutex_unlock ( &spMutex );
+    }
+
+static void sp_atfork ( void )
+    {
+    pthread_atfork ( sp_prepare, sp_release, sp_release );
+    }
+
+static void sp_lock ( void )
+    {
+    pthread_once ( &spOnce, sp_atfork );
+    pthread_mutex_lock ( &spMutex );
+    }
+
+
+/* PAVE_SPILL_MB etc., or a quarter of physical memory */
+static size_t env_bytes ( const char *name )
+    {
+    char  *env = getenv ( name );
+    long   pages, psize;
+
+    if ( env && atol ( env ) > 0 )
+        return ( size_t ) atol ( env ) << 20;
+    pages = sysconf ( _SC_PHYS_PAGES );
+    psize = sysconf ( _SC_PAGESIZE );
+    if ( pages > 0 && psize > 0 )
+        return ( size_t ) pages * ( size_t ) psize / 4;
+    return ( size_t ) 1 << 30;
+    }
+
+static SpGrid *find_grid ( const void *p )
+    {
+    SpGrid *g;
+
+    for ( g = spHead; g; g = g->next )
+        if ( g->addr == ( const char * ) p )
+            return g;
+    return NULL;
+    }
+
+static SpGrid *new_grid ( size_t bytes )
+    {
+    char    path[1024];
+    char   *dir;
+    SpGrid *g;
+    int     fd;
+    void   *addr;
+
+    bytes = ( ( bytes + SPILL_BRICK - 1 ) / SPILL_BRICK ) * SPILL_BRICK;
+    if ( ( dir = getenv ( SPILL_ENV_DIR ) ) == NULL &&
+            ( dir = getenv ( "TMPDIR" ) ) == NULL )
+        dir = "/tmp";
+    snprintf ( path, sizeof ( path ), "%s/pave_spill_XXXXXX", dir );
+
+    if ( ( fd = mkstemp ( path ) ) < 0 )
+        return NULL;
+    unlink ( path );
+    if ( ftruncate ( fd, ( off_t ) bytes ) != 0 )
+        {
+        close ( fd );
+        return NULL;
+        }
+    addr = mmap ( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if ( addr == MAP_FAILED || ( g = ( SpGrid * ) malloc ( sizeof ( SpGrid ) ) ) == NULL )
+        {
+        if ( addr != MAP_FAILED ) munmap ( addr, bytes );
+        close ( fd );
+        return NULL;
+        }
+    madvise ( addr, bytes, MADV_SEQUENTIAL );
+    g->addr  = ( char * ) addr;
+    g->bytes = bytes;
+    g->fd    = fd;
+#ifdef DIAGNOSTICS
+    fprintf ( stderr, "Spilling a %lu MB grid to %s\n",
+              ( unsigned long ) ( bytes >> 20 ), dir );
+#endif /* DIAGNOSTICS */
+    return g;
+    }
+
+
+void spill_scope ( int on )
+    {
+    sp_lock();
+    spOn     = on;
+    spThread = pthread_self();
+    if ( on )
+        {
+        spLimit    = env_bytes ( SPILL_ENV_MB );
+        spResident = env_bytes ( SPILL_ENV_RESIDENT );
+        }
+    pthread_mutex_unlock ( &spMutex );
+    }
+
+float *spill_alloc ( size_t n )
+    {
+    size_t  bytes = n * sizeof ( float );
+    float  *grid  = NULL;
+    SpGrid *g;
+    int     on;
+
+    sp_lock();
+    on = spOn && pthread_equal ( spThread, pthread_self() );
+    pthread_mutex_unlock ( &spMutex );
+
+    if ( n == 0 )
+        return NULL;
+    if ( !on || bytes <= spLimit )
+        grid = ( float * ) malloc ( bytes );
+    if ( grid || !on )
+        return grid;
+
+    if ( ( g = new_grid ( bytes ) ) == NULL )
+        return NULL;
+    sp_lock();
+    g->used = ++spClock;
+    g->next = spHead;
+    spHead  = g;
+    pthread_mutex_unlock ( &spMutex );
+    return ( float * ) g->addr;
+    }
+
+float *spill_adopt ( void *addr, size_t bytes, int fd )
+    {
+    SpGrid *g;
+
+    if ( ( addr == NULL ) || ( g = ( SpGrid * ) malloc ( sizeof ( SpGrid ) ) ) == NULL )
+        return NULL;
+    g->addr  = ( char * ) addr;
+    g->bytes = bytes;
+    g->fd    = fd;
+    sp_lock();
+    g->used = ++spClock;
+    g->next = spHead;
+    spHead  = g;
+    pthread_mutex_unlock ( &spMutex );
+    return ( float * ) g->addr;
+    }
+
+void spill_release ( void *grid )
+    {
+    SpGrid *g, **pg;
+
+    if ( grid == NULL )
+        return;
+    sp_lock();
+    for ( pg = &spHead; ( g = *pg ) != NULL; pg = &g->next )
+        if ( g->addr == ( char * ) grid )
+            {
+            *pg = g->next;
+            break;
+            }
+    pthread_mutex_unlock ( &spMutex );
+
+    if ( g == NULL )
+        {
+        free ( grid );
+        return;
+        }
+    munmap ( g->addr, g->bytes );
+    close ( g->fd );
+    free ( g );
+    }
+
+int spill_is ( const void *grid )
+    {
+    int ret;
+
+    sp_lock();
+    ret = ( grid && find_grid ( grid ) ) ? PAVE_SUCCESS : FAILURE;
+    pthread_mutex_unlock ( &spMutex );
+    return ret;
+    }
+
+void spill_touch ( const void *grid )
+    {
+    SpGrid *g;
+
+    sp_lock();
+    if ( grid && ( g = find_grid ( grid ) ) != NULL )
+        g->used = ++spClock;
+    pthread_mutex_unlock ( &spMutex );
+    }
+
+/* is any page of this brick resident? */
+static int brick_resident ( char *addr, size_t len )
+    {
+    static unsigned char *vec = NULL;
+    static size_t         nvec = 0;
+    size_t psize = ( size_t ) sysconf ( _SC_PAGESIZE );
+    size_t n = ( len + psize - 1 ) / psize, i;
+
+    if ( n > nvec )
+        {
+        free ( vec );
+        if ( ( vec = ( unsigned char * ) malloc ( n ) ) == NULL )
+            {
+            nvec = 0;
+            return 1;
+            }
+        nvec = n;
+        }
+    if ( mincore ( addr, len, vec ) != 0 )
+        return 1;
+    for ( i = 0; i < n; i++ )
+        if ( vec[i] & 1 )
+            return 1;
+    return 0;
+    }
+
+void spill_trim ( void )
+    {
+    SpGrid *g, *oldest;
+    size_t  resident = 0, off, len;
+    unsigned long done = 0;
+
+    sp_lock();
+    for ( g = spHead; g; g = g->next )
+        for ( off = 0; off < g->bytes; off += SPILL_BRICK )
+            if ( brick_resident ( g->addr + off, BRICK_LEN ( g, off ) ) )
+                resident += SPILL_BRICK;
+
+    /* least recently used grids first, each front to back */
+    while ( resident > spResident )
+        {
+        oldest = NULL;
+        for ( g = spHead; g; g = g->next )
+            if ( g->used > done && ( !oldest || g->used < oldest->used ) )
+                oldest = g;
+        if ( oldest == NULL )
+            break;
+        done = oldest->used;
+        for ( off = 0; off < oldest->bytes && resident > spResident; off += SPILL_BRICK )
+            {
+            len = BRICK_LEN ( oldest, off );
+            if ( !brick_resident ( oldest->addr + off, len ) )
+                continue;
+            msync ( oldest->addr + off, len, MS_SYNC );
+            madvise ( oldest->addr + off, len, MADV_DONTNEED );
+            posix_fadvise ( oldest->fd, ( off_t ) off, ( off_t ) len,
+                            POSIX_FADV_DONTNEED );
+            resident -= SPILL_BRICK;
+            }
+        }
+    pthread_mutex_unlock ( &spMutex );
+    }
+
+int spill_unspill ( VIS_DATA *info )
+    {
+    size_t n;
+    float *grid;
+
+    if ( info == NULL || !spill_is ( info->grid ) )
+        return PAVE_SUCCESS;
+    n = ( size_t ) ( info->col_max - info->col_min + 1 ) *
+        ( size_t ) ( info->row_max - info->row_min + 1 ) *
+        ( size_t ) ( info->level_max - info->level_min + 1 ) *
+        ( size_t ) ( info->step_max - info->step_min + 1 );
+    if ( ( grid = ( float * ) malloc ( n * sizeof ( float ) ) ) == NULL )
+        return FAILURE;
+    memcpy ( grid, info->grid, n * sizeof ( float ) );
+    spill_release ( info->grid );
+    info->grid = grid;
+    return PAVE_SUCCESS;
+    }
@@ -0,0 +1,93 @@
+#ifndef SPILL_H
+#define SPILL_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: spill.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Out-of-core grids for formula evaluation.
+ *
+ *  retrieveData() keeps every operand and intermediate of a formula in
+ *  memory at once, each a full ncol*nrow*nlevel*nstep grid, so that a
+ *  long XYZT formula over a large domain fails with "retrieveData()
+ *  needs more memory!" long before any one grid is too big.  While a
+ *  formula is being evaluated (between spill_scope(1) and
+ *  spill_scope(0), on that thread only), grids of more than
+ *  PAVE_SPILL_MB megabytes (default:  a quarter of physical memory), or
+ *  grids that malloc() cannot supply, are instead mapped from unlinked
+ *  spill files in PAVE_SPILL_DIR (default $TMPDIR, else /tmp).
+ *
+ *  A spilled grid is made of SPILL_BRICK_MB-megabyte bricks.  The
+ *  formula operators sweep their grids in storage order, so they stream
+ *  through the bricks, which the system pages in from the spill file as
+ *  they are reached and writes back behind them.  Between operators,
+ *  spill_trim() writes back and drops resident bricks, those of the
+ *  least recently used grids first, until no more than
+ *  PAVE_SPILL_RESIDENT_MB megabytes (default:  a quarter of physical
+ *  memory) of bricks remain resident.
+ *
+ *  Spilled grids never leave the formula evaluator:  free_vis() and
+ *  grid_free() release them properly, and retrieveData() copies its
+ *  result into ordinary memory (spill_unspill()) before returning it.
+ *  Grids that arrive from a same-host visd by shared-memory descriptor
+ *  are kept mapped, as spilled grids (spill_adopt()), and so are
+ *  released the same way.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  spill_adopt()
+ ****************************************************************************/
+
+#include <stddef.h>
+
+#include "vis_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define SPILL_ENV_MB        "PAVE_SPILL_MB"
+#define SPILL_ENV_RESIDENT  "PAVE_SPILL_RESIDENT_MB"
+#define SPILL_ENV_DIR       "PAVE_SPILL_DIR"
+#define SPILL_BRICK_MB      (16)
+
+/* turns spilling on (on != 0) for the calling thread, or off */
+void spill_scope ( int on );
+
+/* a grid of n floats:  malloc()ed, or spilled (see above);  or NULL */
+float *spill_alloc ( size_t n );
+
+/* takes over addr, a MAP_SHARED mapping of bytes (not necessarily whole
+   bricks) of the file fd, which it also takes over, as a spilled grid;
+   returns it as a grid, or NULL (having taken over nothing) */
+float *spill_adopt ( void *addr, size_t bytes, int fd );
+
+/* frees a grid from spill_alloc(), spill_adopt() or malloc() */
+void spill_release ( void *grid );
+
+/* is grid a spilled grid? */
+int spill_is ( const void *grid );
+
+/* marks grid (if spilled) as just used */
+void spill_touch ( const void *grid );
+
+/* drops resident bricks, least recently used first, down to the budget */
+void spill_trim ( void );
+
+/* moves info->grid, if spilled, into malloc()ed memory:  PAVE_SUCCESS,
+   or FAILURE (info->grid unchanged) if there is not enough memory */
+int spill_unspill ( VIS_DATA *info );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* SPILL_H */
@@ -20,6 +20,8 @@
  *  REVISION HISTORY
  *      Author"  Atanas Trayanov, MCNC? 1997?
  *      Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  toplats_get_data() takes
+ *          its grid from grid_alloc() (gridtarget.h)
  ****************************************************************************/
 
 static const char SVN_ID[] = "$Id: toplats.c 83 2018-03-12 19:24:33Z coats $";
@@ -49,6 +51,7 @@ static int ncol_full;
 
 #include "utils.h"
 #include "toplats.h"
+#include "gridtarget.h"
 
 #include "parms3.h"
 
@@ -366,7 +369,7 @@ int toplats_get_data ( TOPLATS_INFO *tinfo,
         goto DATA_FAILURE;
         }
 
-    data = ( float * ) malloc ( n * sizeof ( data[0] ) );
+    data = grid_alloc ( info, n );
     if ( ! ( data ) )
         {
         sprintf ( message,"malloc error in toplats_get_data" );
@@ -0,0 +1,341 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: tresample.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Calendar-period resampling of the time axis;  see tresample.h.
+ *
+ *  Periods are numbered absolutely (hours or days since 0001001, months
+ *  since year 0, years) in the proleptic Gregorian calendar, and found
+ *  once per step for each distinct zone offset, so that the per-cell
+ *  work is a table look-up.  Period p's accumulator is plane p % nopen
+ *  of the ring:  nopen covers the most periods the zone offsets can
+ *  straddle at once.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "tresample.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define TRESAMPLE_PAR   (65536)     /* fewer values than this:  serial */
+
+static const int month_start[2][13] =
+    {
+        { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365 },
+        { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366 }
+    };
+
+
+static int is_leap ( int y )
+    {
+    return ( ( y % 4 == 0 ) && ( y % 100 != 0 ) ) || ( y % 400 == 0 );
+    }
+
+
+/* days from 0001001 to YYYYDDD */
+
+static long day_number ( int date )
+    {
+    long y = date / 1000 - 1;
+
+    return 365 * y + y / 4 - y / 100 + y / 400 + date % 1000 - 1;
+    }
+
+
+static int day_date ( long dn )
+    {
+    int y = ( int ) ( dn / 365.2425 ) + 1;
+
+    while ( day_number ( 1000 * y + 1 ) > dn ) y--;
+    while ( day_number ( 1000 * ( y + 1 ) + 1 ) <= dn ) y++;
+    return 1000 * y + ( int ) ( dn - day_number ( 1000 * y + 1 ) ) + 1;
+    }
+
+
+static long period_of ( int period, int date, int time, int off )
+    {
+    long dn  = day_number ( date );
+    long tod = 3600 * ( time / 10000 ) + 60 * ( ( time / 100 ) % 100 )
+               + time % 100 + off;
+    long shift = ( tod >= 0 ) ? tod / 86400 : -( ( 86399 - tod ) / 86400 );
+    int  local, y, m, doy;
+
+    dn  += shift;
+    tod -= 86400 * shift;
+    switch ( period )
+        {
+        case TRESAMPLE_HOUR:
+            return 24 * dn + tod / 3600;
+        case TRESAMPLE_DAY:
+            return dn;
+        default:
+            local = day_date ( dn );
+            y     = local / 1000;
+            if ( period == TRESAMPLE_YEAR ) return y;
+            doy = local % 1000 - 1;
+            for ( m = 0; month_start[is_leap ( y )][m+1] <= doy; m++ ) ;
+            return 12L * y + m;
+        }
+    }
+
+
+static void period_start ( int period, long p, int *date, int *time )
+    {
+    int y;
+
+    *time = 0;
+    switch ( period )
+        {
+        case TRESAMPLE_HOUR:
+            *date = day_date ( p / 24 );
+            *time = 10000 * ( int ) ( p % 24 );
+            break;
+        case TRESAMPLE_DAY:
+            *date = day_date ( p );
+            break;
+        case TRESAMPLE_MONTH:
+            y     = ( int ) ( p / 12 );
+            *date = 1000 * y + month_start[is_leap ( y )][p % 12] + 1;
+            break;
+        default:
+            *date = 1000 * ( int ) p + 1;
+        }
+    }
+
+
+static long period_length ( int period )    /* shortest, in seconds */
+    {
+    switch ( period )
+        {
+        case TRESAMPLE_HOUR:  return 3600;
+        case TRESAMPLE_DAY:   return 86400;
+        case TRESAMPLE_MONTH: return 28 * 86400;
+        default:              return 365 * 86400;
+        }
+    }
+
+
+int tresample_init ( TResample *r, int mode, int period, long ncell,
+                     long nxy, const int *zonesec, int off,
+                     int first_date, int first_time,
+                     int last_date, int last_time, char *message )
+    {
+    long c, last;
+    int  z, minoff, maxoff;
+
+    memset ( r, 0, sizeof ( TResample ) );
+    if ( ( mode < TRESAMPLE_SUM ) || ( mode > TRESAMPLE_MIN ) ||
+         ( period < TRESAMPLE_HOUR ) || ( period > TRESAMPLE_YEAR ) ||
+         ( ncell <= 0 ) || ( zonesec && ( nxy <= 0 || ncell % nxy ) ) )
+        {
+        sprintf ( message, "tresample_init:  bad arguments" );
+        return FAILURE;
+        }
+    r->mode   = mode;
+    r->period = period;
+    r->ncell  = ncell;
+    r->nxy    = nxy;
+    r->ldate  = -1;
+
+    r->nzone   = 1;
+    r->zoff[0] = off;
+    if ( zonesec )
+        {
+        if ( ! ( r->zone = ( unsigned char * ) malloc ( nxy ) ) )
+            {
+            sprintf ( message, "tresample_init:  allocation failure" );
+            return FAILURE;
+            }
+        r->nzone = 0;
+        for ( c = 0; c < nxy; c++ )
+            {
+            for ( z = 0; z < r->nzone; z++ )
+                if ( r->zoff[z] == off + zonesec[c] ) break;
+            if ( z == r->nzone )
+                {
+                if ( z == TRESAMPLE_MAXZONE )
+                    {
+                    sprintf ( message, "tresample_init:  more than %d time zones",
+                              TRESAMPLE_MAXZONE );
+                    tresample_free ( r );
+                    return FAILURE;
+                    }
+                r->zoff[r->nzone++] = off + zonesec[c];
+                }
+            r->zone[c] = ( unsigned char ) z;
+            }
+        }
+
+    minoff = maxoff = r->zoff[0];
+    for ( z = 1; z < r->nzone; z++ )
+        {
+        if ( r->zoff[z] < minoff ) minoff = r->zoff[z];
+        if ( r->zoff[z] > maxoff ) maxoff = r->zoff[z];
+        }
+    r->first = period_of ( period, first_date, first_time, minoff );
+    last     = period_of ( period, last_date,  last_time,  maxoff );
+    if ( last < r->first )
+        {
+        sprintf ( message, "tresample_init:  last step precedes the first" );
+        tresample_free ( r );
+        return FAILURE;
+        }
+    r->nout  = ( int ) ( last - r->first + 1 );
+    r->nopen = ( int ) ( ( maxoff - minoff ) / period_length ( period ) ) + 2;
+    if ( r->nopen > r->nout ) r->nopen = r->nout;
+    r->lo = 0;
+    r->hi = -1;
+
+    r->count = ( int * ) malloc ( r->nopen * ncell * sizeof ( int ) );
+    if ( ( mode == TRESAMPLE_SUM ) || ( mode == TRESAMPLE_MEAN ) )
+        r->sum = ( double * ) malloc ( r->nopen * ncell * sizeof ( double ) );
+    else
+        r->ext = ( float * ) malloc ( r->nopen * ncell * sizeof ( float ) );
+    if ( !r->count || ( !r->sum && !r->ext ) )
+        {
+        sprintf ( message, "tresample_init:  allocation failure" );
+        tresample_free ( r );
+        return FAILURE;
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+/* period b (relative) to its output plane:  from its accumulator if it
+   was opened, else missing */
+
+static void close_period ( const TResample *r, long b, float *out )
+    {
+    float       *o    = out + b * r->ncell;
+    long         c, k = ( b % r->nopen ) * r->ncell;
+    const int   *n    = r->count + k;
+
+    if ( b > r->hi )
+        {
+        for ( c = 0; c < r->ncell; c++ ) o[c] = NAN;
+        return;
+        }
+
+#pragma omp parallel for schedule(static) if ( r->ncell > TRESAMPLE_PAR )
+    for ( c = 0; c < r->ncell; c++ )
+        {
+        if ( n[c] == 0 )
+            o[c] = NAN;
+        else if ( r->mode == TRESAMPLE_MEAN )
+            o[c] = ( float ) ( r->sum[k+c] / n[c] );
+        else if ( r->mode == TRESAMPLE_SUM )
+            o[c] = ( float ) r->sum[k+c];
+        else
+            o[c] = r->ext[k+c];
+        }
+    }
+
+
+int tresample_push ( TResample *r, const float *plane, int date, int time,
+                     float *out, char *message )
+    {
+    long bkt[TRESAMPLE_MAXZONE], newlo, newhi, b, c;
+    int  z;
+
+    if ( ( r->ldate >= 0 ) &&
+         ( ( date < r->ldate ) || ( ( date == r->ldate ) && ( time < r->ltime ) ) ) )
+        {
+        sprintf ( message, "tresample_push:  step %d:%06d precedes %d:%06d",
+                  date, time, r->ldate, r->ltime );
+        return FAILURE;
+        }
+
+    newlo = newhi = bkt[0] = period_of ( r->period, date, time, r->zoff[0] ) - r->first;
+    for ( z = 1; z < r->nzone; z++ )
+        {
+        bkt[z] = period_of ( r->period, date, time, r->zoff[z] ) - r->first;
+        if ( bkt[z] < newlo ) newlo = bkt[z];
+        if ( bkt[z] > newhi ) newhi = bkt[z];
+        }
+    if ( ( newlo < 0 ) || ( newhi >= r->nout ) ||
+         ( newhi - ( newlo > r->lo ? newlo : r->lo ) >= r->nopen ) )
+        {
+        sprintf ( message, "tresample_push:  step %d:%06d is outside the span",
+                  date, time );
+        return FAILURE;
+        }
+    r->ldate = date;
+    r->ltime = time;
+
+    for ( b = r->lo; b < newlo; b++ ) close_period ( r, b, out );
+    if ( newlo > r->lo ) r->lo = newlo;
+
+    for ( b = ( r->hi + 1 > r->lo ) ? r->hi + 1 : r->lo; b <= newhi; b++ )
+        {
+        long k = ( b % r->nopen ) * r->ncell;
+
+        memset ( r->count + k, 0, r->ncell * sizeof ( int ) );
+        if ( r->sum ) memset ( r->sum + k, 0, r->ncell * sizeof ( double ) );
+        }
+    if ( newhi > r->hi ) r->hi = newhi;
+
+#pragma omp parallel for schedule(static) if ( r->ncell > TRESAMPLE_PAR )
+    for ( c = 0; c < r->ncell; c++ )
+        {
+        float v = plane[c];
+        long  k = ( bkt[r->zone ? r->zone[c % r->nxy] : 0] % r->nopen ) * r->ncell + c;
+
+        if ( isnan ( v ) ) continue;
+        if ( r->sum )
+            r->sum[k] += v;
+        else if ( ( r->count[k] == 0 ) ||
+                  ( ( r->mode == TRESAMPLE_MAX ) ? ( v > r->ext[k] ) : ( v < r->ext[k] ) ) )
+            r->ext[k] = v;
+        r->count[k]++;
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+void tresample_finish ( TResample *r, float *out )
+    {
+    long b;
+
+    for ( b = r->lo; b < r->nout; b++ ) close_period ( r, b, out );
+    r->lo = r->nout;
+    }
+
+
+void tresample_dates ( const TResample *r, int *sdate, int *stime )
+    {
+    int k;
+
+    for ( k = 0; k < r->nout; k++ )
+        period_start ( r->period, r->first + k, sdate + k, stime + k );
+    }
+
+
+void tresample_free ( TResample *r )
+    {
+    if ( r->zone  ) free ( r->zone );
+    if ( r->sum   ) free ( r->sum );
+    if ( r->count ) free ( r->count );
+    if ( r->ext   ) free ( r->ext );
+    memset ( r, 0, sizeof ( TResample ) );
+    }
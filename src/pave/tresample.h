@@ -0,0 +1,102 @@
+#ifndef TRESAMPLE_H
+#define TRESAMPLE_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: tresample.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Resampling of the time axis by calendar period:  hourly, daily,
+ *  monthly or yearly sums, means, maxima or minima, in UTC, in a fixed
+ *  time zone, or in each cell's own local time.
+ *
+ *  Steps are pushed one at a time, in time order, with their own
+ *  (YYYYDDD, HHMMSS) date and time:  the time axis need be neither
+ *  regular nor contiguous, nor need its step divide the period.  Each
+ *  step goes to the period that contains its date and time plus the
+ *  offset of the cell's zone.  Since the offsets of all the cells span
+ *  at most a day or so, only the periods reached by the latest step are
+ *  open at any time:  each holds one accumulator plane, in a small ring,
+ *  and is written to its output plane as soon as the steps have passed
+ *  it in every zone, so a month of hourly data costs one plane per open
+ *  period, not the month.
+ *
+ *  A cell with no values (NaN) in a period yields NaN there;  so do
+ *  periods that no step falls in.  Output step k is the period starting
+ *  at sdate[k], stime[k] (local time, in the offset zone(s)).
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define TRESAMPLE_SUM       (0)     /* as WINAGG_SUM, ... */
+#define TRESAMPLE_MEAN      (1)
+#define TRESAMPLE_MAX       (2)
+#define TRESAMPLE_MIN       (3)
+
+#define TRESAMPLE_HOUR      (0)     /* periods */
+#define TRESAMPLE_DAY       (1)
+#define TRESAMPLE_MONTH     (2)
+#define TRESAMPLE_YEAR      (3)
+
+#define TRESAMPLE_MAXZONE   (64)    /* distinct offsets */
+
+typedef struct
+    {
+    int             mode, period;
+    long            ncell;          /* values per step */
+    long            nxy;            /* zone[] entries:  cell c is in
+                                       zone[c % nxy] */
+    int             nzone;
+    int             zoff[TRESAMPLE_MAXZONE];    /* seconds */
+    unsigned char  *zone;           /* NULL:  all in zone 0 */
+    long            first;          /* period of output step 0 */
+    int             nout;           /* output steps */
+    int             nopen;          /* accumulator planes */
+    long            lo, hi;         /* open periods, relative to first */
+    int             ldate, ltime;   /* latest step pushed */
+    double         *sum;            /* [nopen*ncell] */
+    int            *count;
+    float          *ext;
+    } TResample;
+
+/* sets up the resampling of steps from first_date:first_time through
+   last_date:last_time, with ncell values each, by mode and period.
+   Cell c is offset by off + zonesec[c % nxy] seconds (zonesec may be
+   NULL) from UTC.  r->nout is then the number of output steps.
+   PAVE_SUCCESS, or FAILURE with an error string written into message */
+int tresample_init ( TResample *r, int mode, int period, long ncell,
+                     long nxy, const int *zonesec, int off,
+                     int first_date, int first_time,
+                     int last_date, int last_time, char *message );
+
+/* adds the step plane[0..ncell-1] at date:time;  finished periods go to
+   their planes of out[r->nout*ncell].  FAILURE if the step is earlier
+   than the last one, or outside the initial span */
+int tresample_push ( TResample *r, const float *plane, int date, int time,
+                     float *out, char *message );
+
+/* finishes the periods still open, and any not yet reached */
+void tresample_finish ( TResample *r, float *out );
+
+/* sdate[k], stime[k]:  the start of output step k */
+void tresample_dates ( const TResample *r, int *sdate, int *stime );
+
+void tresample_free ( TResample *r );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* TRESAMPLE_H */
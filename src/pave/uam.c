@@ -20,6 +20,10 @@
  *  REVISION HISTORY
  *      Author:  Kathy Pearson, MCNC, December 14, 1994
  *      Version 2/2018 by Carlie J. Coats, Jr. for PAVE-3.0
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  uam_get_data() decodes planes
+ *          straight into the grid from the file's cached map (uammap.c)
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  uam_get_data() takes its grid
+ *          from grid_alloc() (gridtarget.h)
  ****************************************************************************/
  
 #include <stdio.h>
@@ -36,6 +40,8 @@
 #include "nan_incl.h"
 #include "vis_data.h"
 #include "readuam.h"
+#include "uammap.h"
+#include "gridtarget.h"
 #include "parms3.h"
 
 /* SRT 950703 indexing macro, snagged from bts.h */
@@ -49,6 +55,8 @@ void net2julian ( int sdate, int stime, int tstep_sec, int record,
                   int *jdate, int *jtime );
 int uam_close();
 int uam_fetch_header ( char *filename, UAM_INFO *hdr_info );
+UAM_MAP *uam_map_index ( const char *filename, UAM_INFO *hdr_info );
+float uam_missing_value ( void );
 int uam_fetch_data ( UAM_INFO *hdr_info, float *buf,
                      int n, int spec, int level, int hour );
 
@@ -608,6 +616,9 @@ int uam_get_data ( VIS_DATA *info, char *message )
 
     int inquiring = 0;
     int *sdate, *stime;
+    UAM_MAP *map = NULL;
+    float *plane;
+    float missing_value;
 
 #ifdef DIAGNOSTICS
     fprintf ( stderr, "Enter uam.c's uam_get_data()\n" );
@@ -722,10 +733,10 @@ int uam_get_data ( VIS_DATA *info, char *message )
     bufsize = ( *info ).ncol * ( *info ).nrow; /* SRT 950703  ncol * nrow; */
 
     if ( ( *info ).grid != NULL )
-        free ( ( *info ).grid );
+        grid_free ( info, ( *info ).grid );
     ( *info ).grid = NULL;    /* added 950718 SRT */
 
-    if ( ( ( *info ).grid = ( ( float * ) malloc ( sizeof ( float ) * ( n ) ) ) ) == NULL )
+    if ( ( ( *info ).grid = grid_alloc ( info, n ) ) == NULL )
         {
         sprintf ( message, "Cannnot allocate memory for data grid.\n" );
         goto DATA_FAILURE;
@@ -741,6 +752,13 @@ int uam_get_data ( VIS_DATA *info, char *message )
 
     /* i = 0; SRT 950703 */
 
+    if ( !uam_map_cached ( info->filename, &map ) )     /* built once per file */
+        {
+        map = uam_map_index ( info->filename, &uam_info );
+        uam_map_keep ( info->filename, map );
+        }
+    missing_value = uam_missing_value();
+
     sdate=info->sdate;
     stime=info->stime;
     for ( it = info->step_min; it <= info->step_max; it += info->step_incr )
@@ -750,6 +768,14 @@ int uam_get_data ( VIS_DATA *info, char *message )
 
         for ( iz = info->level_min; iz <= info->level_max; iz++ )
             {
+            plane = info->grid + INDEX ( 0, 0, iz - info->level_min,
+                                         ( it - info->step_min ) / info->step_incr,
+                                         ncol, nrow, nlevel );
+            if ( map && uam_map_read ( map, it - 1, iz - 1, info->selected_species - 1,
+                                       uam_info.icol, info->col_min - 1, ncol,
+                                       info->row_min - 1, nrow, plane, &missing_value ) )
+                continue;
+
             if ( uam_fetch_data ( &uam_info, levelbuf, bufsize,
                                   ( *info ).selected_species - 1, iz - 1, it - 1 ) )
                 {
@@ -791,6 +817,8 @@ int uam_get_data ( VIS_DATA *info, char *message )
             }
         }
 
+    uam_map_close ( map );       /* our reference:  the cache has its own */
+
     info->grid_min = MAXFLOAT;
     info->grid_max = ( -MAXFLOAT );
     for ( i = 0; i < n; i++ )
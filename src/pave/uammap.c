@@ -0,0 +1,329 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: uammap.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Memory-mapped record access for UAM-IV and UAM-V files;  see uammap.h.
+ *
+ *  rec_read() in record.c/recordv.c reads each plane through the global
+ *  FILE *fp, one fread() per record and one flip() per word.  Here the
+ *  file is mapped once, the record offsets are computed and checked
+ *  once, and each requested window is copied straight into the caller's
+ *  grid and byte-swapped a whole row at a time.
+ *
+ *  The maps of the last UAM_MAP_CACHE files read are kept, keyed on the
+ *  file's path, size and modification time, so that the index is built
+ *  once per file and not once per get_data.  The cache is guarded by
+ *  mapMutex, and maps are reference-counted, so that one evicted while
+ *  a reader is still using it stays mapped until that reader is done.
+ *  mapMutex is held across fork() (metaindex_prefetch()'s workers read
+ *  UAM headers), so that a child gets it unlocked and the cache whole.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  mapMutex atfork handlers
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "uammap.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+#define CW_SIZE     (sizeof(int32_t))     /* FORTRAN record control word */
+
+extern float setNaNf ( void );
+
+struct uamMapStruct
+    {
+    char   *base;       /* mapped file                                  */
+    size_t  size;
+    int     convert;    /* byte-swap words on the way out               */
+    int     nstep;
+    int     nlevel;
+    int     nspec;
+    long   *data;       /* byte offset of each record's data, or -1     */
+    int    *nword;      /* words available there                        */
+    int     refs;       /* references:  the cache's, and its users'     */
+    };
+
+#define UAM_MAP_CACHE   (8)     /* files whose maps are kept */
+
+typedef struct
+    {
+    char     *path;             /* NULL:  slot free                     */
+    long long size, mtime;
+    UAM_MAP  *map;              /* may be NULL:  the file has none      */
+    } MapCached;
+
+static MapCached       mapCache[UAM_MAP_CACHE];
+static int             mapNext  = 0;    /* round-robin victim           */
+static pthread_mutex_t mapMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t  mapOnce  = PTHREAD_ONCE_INIT;
+
+static void map_prepare ( void )
+    {
+    pthread_mutex_lock ( &mapMutex );
+    }
+
+static void map_release ( void )
+    {
+    pthread_mutex_unlock ( &mapMutex );
+    }
+
+static void map_atfork ( void )
+    {
+    pthread_atfork ( map_prepare, map_release, map_release );
+    }
+
+static void map_lock ( void )
+    {
+    pthread_once ( &mapOnce, map_atfork );
+    pthread_mutex_lock ( &mapMutex );
+    }
+
+#define MAP_SLOT(m,t,l,s)   ( ( (long)(t) * (m)->nlevel + (l) ) * (m)->nspec + (s) )
+
+static uint32_t swap32 ( uint32_t w )
+    {
+#if defined(__GNUC__)
+    return __builtin_bswap32 ( w );
+#else
+    return ( w >> 24 ) | ( ( w >> 8 ) & 0xff00 ) | ( ( w << 8 ) & 0xff0000 ) | ( w << 24 );
+#endif
+    }
+
+/* whole-row swap:  a plain loop over 32-bit words, which GCC and
+   clang turn into vector shuffles at -O2 and above */
+static void swap_words ( uint32_t *w, int n )
+    {
+    int i;
+
+    for ( i = 0; i < n; i++ )
+        w[i] = swap32 ( w[i] );
+    }
+
+static int32_t get_cw ( UAM_MAP *map, size_t pos )
+    {
+    int32_t cw;
+
+    memcpy ( &cw, map->base + pos, CW_SIZE );
+    return map->convert ? ( int32_t ) swap32 ( ( uint32_t ) cw ) : cw;
+    }
+
+
+UAM_MAP *uam_map_open ( int fd, int convert, int nstep, int nlevel, int nspec )
+    {
+    UAM_MAP *map;
+    struct stat st;
+    void *base;
+    long i, nslot;
+
+    if ( ( nstep < 1 ) || ( nlevel < 1 ) || ( nspec < 1 ) )
+        return NULL;
+    if ( ( fstat ( fd, &st ) != 0 ) || ( st.st_size <= 0 ) )
+        return NULL;
+    base = mmap ( NULL, ( size_t ) st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    if ( base == MAP_FAILED )
+        return NULL;
+
+    nslot = ( long ) nstep * nlevel * nspec;
+    map = ( UAM_MAP * ) calloc ( 1, sizeof ( UAM_MAP ) );
+    if ( map )
+        {
+        map->data  = ( long * ) malloc ( nslot * sizeof ( long ) );
+        map->nword = ( int  * ) calloc ( nslot, sizeof ( int ) );
+        }
+    if ( !map || !map->data || !map->nword )
+        {
+        if ( map )
+            {
+            free ( map->data );
+            free ( map->nword );
+            free ( map );
+            }
+        munmap ( base, ( size_t ) st.st_size );
+        return NULL;
+        }
+    for ( i = 0; i < nslot; i++ )
+        map->data[i] = -1;
+
+    map->base    = ( char * ) base;
+    map->size    = ( size_t ) st.st_size;
+    map->convert = convert;
+    map->nstep   = nstep;
+    map->nlevel  = nlevel;
+    map->nspec   = nspec;
+    map->refs    = 1;
+    return map;
+    }
+
+
+int uam_map_record ( UAM_MAP *map, int step, int level, int spec,
+                     long pos, int offset, int n )
+    {
+    int32_t cw;
+    size_t  end;
+    long    slot;
+
+    if ( !map || ( step  < 0 ) || ( step  >= map->nstep  ) ||
+            ( level < 0 ) || ( level >= map->nlevel ) ||
+            ( spec  < 0 ) || ( spec  >= map->nspec  ) || ( pos < 0 ) )
+        return FAILURE;
+
+    /* leading control word, record body, trailing control word */
+    if ( ( size_t ) pos + CW_SIZE > map->size )
+        return FAILURE;
+    cw = get_cw ( map, ( size_t ) pos );
+    if ( ( cw < 0 ) || ( ( long ) cw < ( long ) ( offset + n ) * ( long ) CW_SIZE ) )
+        return FAILURE;
+    end = ( size_t ) pos + CW_SIZE + ( size_t ) cw;
+    if ( ( end + CW_SIZE > map->size ) || ( get_cw ( map, end ) != cw ) )
+        return FAILURE;
+
+    slot = MAP_SLOT ( map, step, level, spec );
+    map->data[slot]  = pos + ( long ) CW_SIZE + ( long ) offset * ( long ) CW_SIZE;
+    map->nword[slot] = cw / ( int ) CW_SIZE - offset;
+    return PAVE_SUCCESS;
+    }
+
+
+int uam_map_read ( UAM_MAP *map, int step, int level, int spec,
+                   int icol, int col0, int ncol, int row0, int nrow,
+                   float *dst, const float *missing )
+    {
+    const char *src;
+    float *row;
+    long   slot;
+    int    r, c;
+
+    if ( !map || ( step  < 0 ) || ( step  >= map->nstep  ) ||
+            ( level < 0 ) || ( level >= map->nlevel ) ||
+            ( spec  < 0 ) || ( spec  >= map->nspec  ) )
+        return FAILURE;
+    slot = MAP_SLOT ( map, step, level, spec );
+    if ( ( map->data[slot] < 0 ) || ( col0 < 0 ) || ( row0 < 0 ) ||
+            ( col0 + ncol > icol ) ||
+            ( ( long ) ( row0 + nrow ) * icol > ( long ) map->nword[slot] ) )
+        return FAILURE;
+
+    src = map->base + map->data[slot];
+    for ( r = 0; r < nrow; r++ )
+        {
+        row = dst + ( long ) r * ncol;
+        memcpy ( row, src + ( ( long ) ( row0 + r ) * icol + col0 ) * CW_SIZE,
+                 ( size_t ) ncol * CW_SIZE );
+        if ( map->convert )
+            swap_words ( ( uint32_t * ) row, ncol );
+        if ( missing )
+            {
+            for ( c = 0; c < ncol; c++ )
+                if ( row[c] == *missing ) row[c] = setNaNf();
+            }
+        }
+    return PAVE_SUCCESS;
+    }
+
+
+static void map_free ( UAM_MAP *map )
+    {
+    munmap ( map->base, map->size );
+    free ( map->data );
+    free ( map->nword );
+    free ( map );
+    }
+
+
+void uam_map_close ( UAM_MAP *map )
+    {
+    int last;
+
+    if ( !map ) return;
+    map_lock();
+    last = ( --map->refs == 0 );
+    pthread_mutex_unlock ( &mapMutex );
+    if ( last )
+        map_free ( map );
+    }
+
+
+/* drops the cache's reference;  with mapMutex held */
+static void drop_cached ( MapCached *c )
+    {
+    if ( c->map && ( --c->map->refs == 0 ) )
+        map_free ( c->map );
+    free ( c->path );
+    memset ( c, 0, sizeof ( MapCached ) );
+    }
+
+
+int uam_map_cached ( const char *filename, UAM_MAP **map )
+    {
+    struct stat st;
+    int i, ret = FAILURE;
+
+    *map = NULL;
+    if ( !filename || ( stat ( filename, &st ) != 0 ) )
+        return FAILURE;
+    map_lock();
+    for ( i = 0; i < UAM_MAP_CACHE; i++ )
+        {
+        if ( !mapCache[i].path || strcmp ( mapCache[i].path, filename ) )
+            continue;
+        if ( ( mapCache[i].size  == ( long long ) st.st_size ) &&
+                ( mapCache[i].mtime == ( long long ) st.st_mtime ) )
+            {
+            *map = mapCache[i].map;
+            if ( *map ) ( *map )->refs++;
+            ret = PAVE_SUCCESS;
+            break;
+            }
+        drop_cached ( mapCache + i );           /* the file has changed */
+        }
+    pthread_mutex_unlock ( &mapMutex );
+    return ret;
+    }
+
+
+void uam_map_keep ( const char *filename, UAM_MAP *map )
+    {
+    struct stat st;
+    MapCached *c;
+    char *path;
+
+    if ( !filename || ( stat ( filename, &st ) != 0 ) ||
+            ( ( path = strdup ( filename ) ) == NULL ) )
+        return;
+    map_lock();
+    c = mapCache + mapNext;
+    mapNext = ( mapNext + 1 ) % UAM_MAP_CACHE;
+    if ( c->path )
+        drop_cached ( c );
+    c->path  = path;
+    c->size  = ( long long ) st.st_size;
+    c->mtime = ( long long ) st.st_mtime;
+    c->map   = map;
+    if ( map ) map->refs++;
+    pthread_mutex_unlock ( &mapMutex );
+    }
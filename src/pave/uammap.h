@@ -0,0 +1,80 @@
+#ifndef UAMMAP_H
+#define UAMMAP_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: uammap.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Memory-mapped record access for UAM-IV and UAM-V files.
+ *
+ *  A UAM_MAP holds the mapped file and a table giving, for each
+ *  (step, level, species), where that record's data starts.  The table
+ *  is built once (uam_map_index() in record.c, uamv_map_index() in
+ *  recordv.c) from the header's record layout, and every record's
+ *  FORTRAN control words are checked as it is entered.  Each builder
+ *  opens and maps the file for itself, taking the layout and byte order
+ *  from the parsed header it is given, so a map shares nothing with the
+ *  global FILE *fp through which uam_fetch_header() / uamv_fetch_header()
+ *  read the header (and still read any records left out of the map,
+ *  under readahead_lock(), like the rest of those readers).
+ *
+ *  uam_map_cached() and uam_map_keep() keep the maps of the last few
+ *  files read, so that a map is built once per file, not per get_data.
+ *  The cache is thread-safe, and maps are reference-counted:  the cache
+ *  holds a reference to each map it keeps, and uam_map_cached() hands
+ *  out another, which the caller gives back with uam_map_close().
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ *      Version 10/2026:  per-map file opens;  locked, reference-counted
+ *          cache
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+typedef struct uamMapStruct UAM_MAP;
+
+/* maps the open file fd (which the caller may then close);
+   convert != 0 if the file's byte order is not the native one */
+UAM_MAP *uam_map_open ( int fd, int convert, int nstep, int nlevel, int nspec );
+
+/* enters the record whose leading control word is at byte pos, with
+   n data words starting offset words into the record;  returns
+   PAVE_SUCCESS, or FAILURE if the control words do not check out */
+int uam_map_record ( UAM_MAP *map, int step, int level, int spec,
+                     long pos, int offset, int n );
+
+/* decodes columns [col0,col0+ncol) of rows [row0,row0+nrow) (0-based)
+   of the record's icol-wide plane into dst, row-major with stride
+   ncol;  values equal to *missing, if missing != NULL, become NaN */
+int uam_map_read ( UAM_MAP *map, int step, int level, int spec,
+                   int icol, int col0, int ncol, int row0, int nrow,
+                   float *dst, const float *missing );
+
+/* gives back a reference;  the last one unmaps and frees the map */
+void uam_map_close ( UAM_MAP *map );
+
+/* PAVE_SUCCESS, with *map a new reference to the map kept for filename
+   (NULL if it has none), if there is one for the file's current size
+   and modification time;  otherwise FAILURE */
+int uam_map_cached ( const char *filename, UAM_MAP **map );
+
+/* keeps map (which may be NULL) as filename's, in place of the oldest;
+   the cache takes a reference of its own, and the caller keeps its */
+void uam_map_keep ( const char *filename, UAM_MAP *map );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* UAMMAP_H */
@@ -19,7 +19,10 @@
  ****************************************************************************
  *  REVISION HISTORY
  *      Author:  Atanas Trayanov, NCSC, c 1994?
- *      
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  uamv_get_data() decodes planes
+ *          straight into the grid from the file's cached map (uammap.c)
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  uamv_get_data() takes its grid
+ *          from grid_alloc() (gridtarget.h)
  ****************************************************************************/
 
 #include <stdio.h>
@@ -32,6 +35,8 @@
 
 #include "vis_data.h"
 #include "uamv.h"
+#include "uammap.h"
+#include "gridtarget.h"
 #define uamv_close uam_close
 
 /* SRT 950703 indexing macro, snagged from bts.h */
@@ -45,6 +50,7 @@ void net2julian ( int sdate, int stime, int tstep_sec, int record,
                   int *jdate, int *jtime );
 int uamv_close();
 int uamv_fetch_header ( char *filename, UAMV_INFO *hdr_info );
+UAM_MAP *uamv_map_index ( const char *filename, UAMV_INFO *hdr_info );
 int uamv_fetch_data ( UAMV_INFO *hdr_info, float *buf,
                       int n, int spec, int level, int hour );
 
@@ -551,6 +557,8 @@ int uamv_get_data ( VIS_DATA *info, char *message )
 
     int inquiring = 0;
     int *sdate, *stime;
+    UAM_MAP *map = NULL;
+    float *plane;
 
 #ifdef DIAGNOSTICS
     fprintf ( stderr, "Enter uam.c's uamv_get_data()\n" );
@@ -663,10 +671,10 @@ int uamv_get_data ( VIS_DATA *info, char *message )
     bufsize = ( *info ).ncol * ( *info ).nrow; /* SRT 950703  ncol * nrow; */
 
     if ( ( *info ).grid != NULL )
-        free ( ( *info ).grid );
+        grid_free ( info, ( *info ).grid );
     ( *info ).grid = NULL;    /* added 950718 SRT */
 
-    if ( ( ( *info ).grid = ( ( float * ) malloc ( sizeof ( float ) * ( n ) ) ) ) == NULL )
+    if ( ( ( *info ).grid = grid_alloc ( info, n ) ) == NULL )
         {
         sprintf ( message, "Cannnot allocate memory for data grid.\n" );
         goto DATA_FAILURE;
@@ -681,6 +689,11 @@ int uamv_get_data ( VIS_DATA *info, char *message )
         }
 
     /* i = 0; SRT 950703 */
+    if ( !uam_map_cached ( info->filename, &map ) )     /* built once per file */
+        {
+        map = uamv_map_index ( info->filename, &uamv_info );
+        uam_map_keep ( info->filename, map );
+        }
     sdate=info->sdate;
     stime=info->stime;
     for ( it = info->step_min; it <= info->step_max; it += info->step_incr )
@@ -690,6 +703,14 @@ int uamv_get_data ( VIS_DATA *info, char *message )
 
         for ( iz = info->level_min; iz <= info->level_max; iz++ )
             {
+            plane = info->grid + INDEX ( 0, 0, iz - info->level_min,
+                                         ( it - info->step_min ) / info->step_incr,
+                                         ncol, nrow, nlevel );
+            if ( map && uam_map_read ( map, it - 1, iz - 1, info->selected_species - 1,
+                                       uamv_info.icol, info->col_min - 1, ncol,
+                                       info->row_min - 1, nrow, plane, NULL ) )
+                continue;
+
             if ( uamv_fetch_data ( &uamv_info, levelbuf, bufsize,
                                    ( *info ).selected_species - 1, iz - 1, it - 1 ) )
                 {
@@ -730,6 +751,7 @@ int uamv_get_data ( VIS_DATA *info, char *message )
                 }
             }
         }
+    uam_map_close ( map );       /* our reference:  the cache has its own */
 
     ( *info ).grid_min = ( *info ).grid[0];
     ( *info ).grid_max = ( *info ).grid[0];
@@ -108,6 +108,7 @@ typedef struct hdrStruct
 	float 	ne_utmy;
 	char *	spec_list;
 	char * 	file_id;
+	int		convert;	/* file is byte-swapped (from the header) */
 	} UAMV_INFO;
 
 #endif  /* READUAMV_H */
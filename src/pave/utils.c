@@ -42,6 +42,14 @@
  *      960517 SRT added dump_VIS_DATA_to_netCDF_file()
  *      961021 SRT added makeSureIts_netCDF()
  *      961021 SRT added is_reasonably_equal() and map_infos_areReasonablyEquivalent()
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  calc_stats() visits only
+ *          the cells in the domain, through a compiled mask (domainmask.c)
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  calc_stats() accumulates
+ *          per-plane Welford partials with Kahan sums (gridstats.c), in
+ *          parallel, merged in plane order
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  added
+ *          dump_VIS_DATA_to_DX_file(), reordering through gridperm.c;
+ *          dump_VIS_DATA_to_AVS_file() writes the grid in one call
  *  
  ****************************************************************************/
 
@@ -50,6 +58,9 @@
 #include "nan_incl.h"
 
 #include "bts.h"
+#include "domainmask.h"
+#include "gridstats.h"
+#include "gridperm.h"
 
 #include "iodecl3.h"            /* M3IO Library (Carlie Coats, MCNC) */
 
@@ -387,8 +398,8 @@ dump_VIS_DATA_to_AVS_file - returns 1 if error
 int dump_VIS_DATA_to_AVS_file ( VIS_DATA *vdata, char *fname, char *estring )
     {
     FILE    *fp;
-    int     i, j, k, t;
     int ni, nj, nk, nt;
+    size_t  n;
     char    sep[2];
 
     if ( ( !vdata ) || ( !fname ) || ( !estring ) )
@@ -486,18 +497,16 @@ int dump_VIS_DATA_to_AVS_file ( VIS_DATA *vdata, char *fname, char *estring )
         return errmsg ( estring );
         }
 
-    /* now write out the actual binary data */
-    for ( t = 0; t < nt; t++ )    /* AVS varies T slowest when reading fields */
-        for ( k = 0; k < nk; k++ )
-            for ( j = 0; j < nj; j++ )
-                for ( i = 0; i < ni; i++ ) /* AVS varies I fastest when reading fields */
-                    if ( fwrite ( &vdata->grid[INDEX ( i,j,k,t,ni,nj,nk )], sizeof ( float ), 1, fp ) != 1 )
-                        {
-                        fclose ( fp );
-                        sprintf ( estring, "Error writing data values to AVS data file '%s'!", fname );
-                        free_vis ( vdata );
-                        return errmsg ( estring );
-                        }
+    /* now write out the actual binary data:  AVS varies I fastest and
+       T slowest when reading fields, which is the grid's own order */
+    n = ( size_t ) ni * nj * nk * nt;
+    if ( fwrite ( vdata->grid, sizeof ( float ), n, fp ) != n )
+        {
+        fclose ( fp );
+        sprintf ( estring, "Error writing data values to AVS data file '%s'!", fname );
+        free_vis ( vdata );
+        return errmsg ( estring );
+        }
 
     free_vis ( vdata );
     fclose ( fp );
@@ -506,6 +515,149 @@ int dump_VIS_DATA_to_AVS_file ( VIS_DATA *vdata, char *fname, char *estring )
 
 
 
+/************************************************************
+dump_VIS_DATA_to_DX_file - returns 1 if error
+             - regardless frees the vdata struct
+
+Writes an OpenDX native field file:  a series of one field per
+step, sharing the regular positions and connections.  DX varies the
+last position index fastest, so each step is written as (level,
+row, col), level fastest, reordered by gridperm().  As in MapFile.c's
+writeDXMap(), the binary data follow each array's description.
+************************************************************/
+int dump_VIS_DATA_to_DX_file ( VIS_DATA *vdata, char *fname, char *estring )
+    {
+    static const int one = 1;
+    static const int perm[4] = { GRIDPERM_LEVEL, GRIDPERM_ROW, GRIDPERM_COL, GRIDPERM_STEP };
+    FILE    *fp;
+    int     t, ok;
+    int ni, nj, nk, nt, dims[4];
+    size_t  n;
+    float   *buf;
+
+    if ( ( !vdata ) || ( !fname ) || ( !estring ) )
+        {
+        sprintf ( estring, "Bad args to dump_VIS_DATA_to_DX_file()!" );
+        free_vis ( vdata );
+        return errmsg ( estring );
+        }
+
+    if ( !vdata->grid )
+        {
+        sprintf ( estring, "No grid values for dump_VIS_DATA_to_DX_file()!" );
+        free_vis ( vdata );
+        return errmsg ( estring );
+        }
+
+    ni = vdata->col_max - vdata->col_min + 1;
+    nj = vdata->row_max - vdata->row_min + 1;
+    nk = vdata->level_max - vdata->level_min + 1;
+    nt = vdata->step_max - vdata->step_min + 1;
+
+    if ( ( ni < 1 ) || ( nj < 1 ) || ( nk < 1 ) || ( nt < 1 ) )
+        {
+        sprintf ( estring, "Can't find ni, nj, nk, and/or nt for DX file!" );
+        free_vis ( vdata );
+        return errmsg ( estring );
+        }
+
+    n = ( size_t ) ni * nj * nk;
+    if ( ! ( buf = ( float * ) malloc ( n * nt * sizeof ( float ) ) ) )
+        {
+        sprintf ( estring, "Couldn't allocate %ld values for DX file '%s'!",
+                  ( long ) ( n * nt ), fname );
+        free_vis ( vdata );
+        return errmsg ( estring );
+        }
+    dims[0] = ni;
+    dims[1] = nj;
+    dims[2] = nk;
+    dims[3] = nt;
+    gridperm ( vdata->grid, buf, dims, perm );
+
+    if ( ! ( fp=fopen ( fname, "w" ) ) )
+        {
+        sprintf ( estring, "Couldn't open file '%s' for writing !", fname );
+        free ( buf );
+        free_vis ( vdata );
+        return errmsg ( estring );
+        }
+
+    ok = ( fprintf ( fp, "# DX Field file %s\n", fname ) > 0 );
+
+    /* write out variable name and units name only if we have them */
+    if  ( ok &&
+            ( vdata->species_short_name != NULL ) &&
+            ( vdata->units_name != NULL ) &&
+            ( vdata->selected_species > 0 ) &&
+            ( vdata->species_short_name[vdata->selected_species-1] != NULL ) &&
+            ( vdata->units_name[vdata->selected_species-1] != NULL ) )
+        ok = ( fprintf ( fp, "# %s in %s\n",
+                         vdata->species_short_name[vdata->selected_species-1],
+                         vdata->units_name[vdata->selected_species-1] ) > 0 );
+
+    if ( ok && ( nk != 1 ) )
+        ok = ( fprintf ( fp, "data mode %s ieee\n"
+                         "object \"positions\" class gridpositions counts %d %d %d\n"
+                         "origin %d %d %d\n"
+                         "delta 1 0 0\ndelta 0 1 0\ndelta 0 0 1\n"
+                         "#\n"
+                         "object \"connections\" class gridconnections counts %d %d %d\n"
+                         "attribute \"element type\" string \"cubes\"\n"
+                         "attribute \"ref\" string \"positions\"\n"
+                         "#\n",
+                         ( * ( const char * ) &one ) ? "lsb" : "msb",
+                         ni, nj, nk, vdata->col_min, vdata->row_min, vdata->level_min,
+                         ni, nj, nk ) > 0 );
+    else if ( ok )
+        ok = ( fprintf ( fp, "data mode %s ieee\n"
+                         "object \"positions\" class gridpositions counts %d %d\n"
+                         "origin %d %d\n"
+                         "delta 1 0\ndelta 0 1\n"
+                         "#\n"
+                         "object \"connections\" class gridconnections counts %d %d\n"
+                         "attribute \"element type\" string \"quads\"\n"
+                         "attribute \"ref\" string \"positions\"\n"
+                         "#\n",
+                         ( * ( const char * ) &one ) ? "lsb" : "msb",
+                         ni, nj, vdata->col_min, vdata->row_min, ni, nj ) > 0 );
+
+    /* now the data, one field per step */
+    for ( t = 0; ok && ( t < nt ); t++ )
+        {
+        ok = ( fprintf ( fp, "object \"data %d\" class array type float rank 0 "
+                         "items %ld data follows\n", t, ( long ) n ) > 0 ) &&
+             ( fwrite ( buf + n * t, sizeof ( float ), n, fp ) == n ) &&
+             ( fprintf ( fp, "\nattribute \"dep\" string \"positions\"\n"
+                         "#\n"
+                         "object \"step %d\" class field\n"
+                         "component \"positions\" value \"positions\"\n"
+                         "component \"connections\" value \"connections\"\n"
+                         "component \"data\" value \"data %d\"\n"
+                         "#\n", t, t ) > 0 );
+        }
+
+    if ( ok ) ok = ( fprintf ( fp, "object \"series\" class series\n" ) > 0 );
+    for ( t = 0; ok && ( t < nt ); t++ )
+        ok = ( fprintf ( fp, "member %d value \"step %d\" position %d\n",
+                         t, t, t + vdata->step_min ) > 0 );
+    if ( ok ) ok = ( fprintf ( fp, "#\nend\n" ) > 0 );
+
+    free ( buf );
+    fclose ( fp );
+    if ( !ok )
+        {
+        sprintf ( estring, "Error writing to DX data file '%s'!", fname );
+        free_vis ( vdata );
+        return errmsg ( estring );
+        }
+
+    free_vis ( vdata );
+    return 0;
+    }
+
+
+
 /************************************************************
 RANGE_GET - returns 1 if error (or if no cell is on)
 ************************************************************/
@@ -621,8 +773,11 @@ int calc_stats  (
     float *sumf
 )
     {
-    int   i, j, k, n=0, IMAX, JMAX, KMAX, tmin, tmax, t, vtmin, vtmax;
-    double val, sum, ssq, meand, div;
+    int   k, r, p, nplane, IMAX, JMAX, KMAX, tmin, tmax, t, vtmin, vtmax;
+    long  ij, n;
+    double variance;
+    DomainMask mask;
+    GridStats  stats, *part;
 
     if ( step >= 0 )
         {
@@ -671,75 +826,62 @@ int calc_stats  (
     JMAX = vdata->row_max - vdata->row_min + 1;
     KMAX = vdata->level_max - vdata->level_min + 1;
 
-    /* now loop over the data itself to find the min & max */
-    sum = 0.0 ;
-    ssq = 0.0 ;
-    for ( n=0, t=tmin; t<=tmax; t++ )
+    /* now accumulate each (step,layer) plane's statistics over the
+       cells in the domain, in parallel, and merge them in order */
+    if ( !domainmask_build ( &mask, percents, IMAX, JMAX ) )
+        return errmsg ( "Domain-mask malloc() failure in calc_stats() !" );
+    nplane = ( tmax-tmin+1 ) * KMAX;
+    if ( ( part = ( GridStats * ) malloc ( nplane * sizeof ( GridStats ) ) ) == NULL )
         {
-        for ( k=0; k<KMAX; k++ )
-            {
-              if ( layers[k] )
-                {
-                for ( j=0; j<JMAX; j++ )
-                    {
-                    for ( i=0; i<IMAX; i++ )
-                        {
-                        if ( percents[ INDEX( i,j,0,0,IMAX,JMAX,1 ) ] )
-                            {
-                            val = vdata->grid[INDEX ( i,j,k,t,IMAX,JMAX,KMAX )];
-                            if ( isnanf ( val ) ) continue;
-                            if ( !n )
-                                {
-                                *min  = *max = val;
-                                *mini = *maxi = vdata->col_min+i;
-                                *minj = *maxj = vdata->row_min+j;
-                                *mink = *maxk = vdata->level_min+k;
-                                *mint = *maxt = vdata->step_min+t;
-                                }
-                            else if ( val < *min )
-                                {
-                                *mini = vdata->col_min+i;
-                                *minj = vdata->row_min+j;
-                                *mink = vdata->level_min+k;
-                                *mint = vdata->step_min+t;
-                                *min = val;
-                                }
-                            else if ( val > *max )
-                                {
-                                *maxi = vdata->col_min+i;
-                                *maxj = vdata->row_min+j;
-                                *maxk = vdata->level_min+k;
-                                *maxt = vdata->step_min+t;
-                                *max = val;
-                                }
-                            sum += val ;
-                            ssq += val*val ;
-                            n++;
-                            }
-                        }
-                    }
-                }
-            }
+        domainmask_free ( &mask );
+        return errmsg ( "Partial-statistics malloc() failure in calc_stats() !" );
+        }
+
+#pragma omp parallel for schedule(dynamic) private(t, k, r) if ( mask.ncells*(long)nplane > 65536 )
+    for ( p = 0; p < nplane; p++ )
+        {
+        t = tmin + p / KMAX;
+        k = p % KMAX;
+        gridstats_init ( part + p );
+        if ( layers[k] )
+            for ( r = 0; r < mask.nrun; r++ )
+                gridstats_add ( part + p,
+                                vdata->grid + INDEX ( mask.run[r].col0,mask.run[r].row,k,t,IMAX,JMAX,KMAX ),
+                                mask.run[r].col1 - mask.run[r].col0 + 1,
+                                INDEX ( mask.run[r].col0,mask.run[r].row,k,t,IMAX,JMAX,KMAX ) );
         }
 
-    if ( !n ) return errmsg ( "No grid cells in the domain in calc_stats() !" );
+    gridstats_init ( &stats );
+    for ( p = 0; p < nplane; p++ )
+        gridstats_merge ( &stats, part + p );
+    free ( part );
+    domainmask_free ( &mask );
+
+    if ( !( n = stats.n ) ) return errmsg ( "No grid cells in the domain in calc_stats() !" );
 
 #ifdef DIAGNOSTICS
     fprintf ( stderr, "%d grid cells on in each time step in util.c's calc_stats()\n", ( int ) ( n/ ( tmax-tmin+1 ) ) );
 #endif /* DIAGNOSTICS */
 
-    /* set the sum argument */
-    *sumf = sum;
-
-    /* find the mean, standard deviation  */
-    div   = 1.0 / (double)n ;
-    sum = sum * div ;
-    ssq = ssq * div - sum*sum ;
-    ssq = ( ssq > 0.0 ? ssq : 0.0 ) ;
-
-    *mean    = sum ;
-    *var     = ssq ;
-    *std_dev = sqrt( ssq ) ;
+    /* positions are grid indexes:  unpack them */
+    ij    = ( long ) IMAX * JMAX;
+    *min  = stats.min;
+    *mini = vdata->col_min   + ( int ) ( stats.argmin % IMAX );
+    *minj = vdata->row_min   + ( int ) ( ( stats.argmin / IMAX ) % JMAX );
+    *mink = vdata->level_min + ( int ) ( ( stats.argmin / ij ) % KMAX );
+    *mint = vdata->step_min  + ( int ) ( stats.argmin / ( ij * KMAX ) );
+    *max  = stats.max;
+    *maxi = vdata->col_min   + ( int ) ( stats.argmax % IMAX );
+    *maxj = vdata->row_min   + ( int ) ( ( stats.argmax / IMAX ) % JMAX );
+    *maxk = vdata->level_min + ( int ) ( ( stats.argmax / ij ) % KMAX );
+    *maxt = vdata->step_min  + ( int ) ( stats.argmax / ( ij * KMAX ) );
+
+    /* sum, mean, (population) variance and standard deviation */
+    variance = gridstats_variance ( &stats );
+    *sumf    = gridstats_sum ( &stats );
+    *mean    = stats.mean ;
+    *var     = variance ;
+    *std_dev = sqrt ( variance ) ;
 
     return 0;
     }
@@ -60,6 +60,7 @@ Modification History
 960517 SRT added dump_VIS_DATA_to_netCDF_file()
 961021 SRT added makeSureIts_netCDF()
 961021 SRT added map_infos_areReasonablyEquivalent()
+202610 CJC added dump_VIS_DATA_to_DX_file()
 
 ************************************************************/
 
@@ -198,6 +199,8 @@ extern int strip_VIS_DATA_operator_chars(VIS_DATA *info, char *estring);
 
 extern int dump_VIS_DATA_to_AVS_file(VIS_DATA *vdata, char *fname, char *estring);
 
+extern int dump_VIS_DATA_to_DX_file(VIS_DATA *vdata, char *fname, char *estring);
+
 extern int dump_VIS_DATA_to_tabbed_ascii_file(VIS_DATA *vdata, char *fname, char *estring);
 
 extern int dump_VIS_DATA_to_netCDF_file(VIS_DATA *vdata, char *fname, char *estring);
@@ -19,6 +19,14 @@
  ****************************************************************************
  *  REVISION HISTORY
  *      Author:      Rajini Balay, NCSU,  February 25, 1995
+ *      Version 10/2026:  get_info_async(), get_data_async():  pipelined
+ *      requests to visd, completed by the bus's Xt input handlers or by
+ *      wait_vis_request()/wait_all_vis_requests().
+ *      Version 10/2026:  remote calls go over pooled, persistent connections
+ *      to visd; visd module ids and host lookups are cached.
+ *      Version 10/2026:  EVAP_GetDataShm:  a visd on the same host
+ *      (USE_LOCAL_VISD) passes the grid by shared-memory descriptor.
+ *      Version 10/2026:  the EVAP_* type ids are cached too.
  *****************************************************************************/
 
 /* bald messes this up in some header file */
@@ -42,6 +50,8 @@
 #include "busVersion.h"
 #include "busRpc.h"
 #include "busUtil.h"
+#include "busFtp.h"
+#include "spill.h"
 
 /* get_info : checks if the file is on the local machine or on a remote
  * machine and calls the appropriate function
@@ -70,7 +80,7 @@ int get_info ( struct BusData *bd, VIS_DATA *info, char *message )
 
     if ( info->grid != NULL )
         {
-        free ( info->grid );
+        spill_release ( info->grid );   /* may be getGridShm()'s mapping */
         info->grid = NULL;
         }
     if ( info->sdate != NULL )
@@ -132,11 +142,9 @@ int get_data ( struct BusData *bd, VIS_DATA *info, char *message )
 */
 int check_local_file ( VIS_DATA *info )
     {
-    char **hsav; /*added 950724 SRT*/
-    struct hostent *h_info;
-    struct in_addr *hptr;
     char local_hname[256];
     char file_ipaddr[256];
+    int  err;
 
     if ( getenv ( "USE_LOCAL_VISD" ) )
         {
@@ -150,69 +158,85 @@ int check_local_file ( VIS_DATA *info )
     if ( info->filehost.name == NULL )
         return 1;         /* Consider it as local host */
 
-    /* Find IP address of the machine where the file is located */
+    /* Find IP address of the machine where the file is located;
+       is_localhost() caches the lookups, so this is cheap to repeat */
     if ( info->filehost.ip == NULL )
         {
-
-        /*SRT NOTE: if info->filehost.name == NULL this should return
-              from this routine with an error flag, rather than
-              calling gethostbyname which will do a core dump */
-
-        h_info = gethostbyname ( info->filehost.name );
-        /*SRT*/ if ( h_info == ( struct hostent * ) NULL )
-            {
-#ifdef DIAGNOSTICS
-            fprintf ( stderr,
-                      "gethostbyname() returned NULL in visDataClient.c!\n" );
-#endif /* DIAGNOSTICS */
-            return -1;      /* Illegal hostname */
-            }
-        hptr = ( struct in_addr * ) *h_info->h_addr_list;
-        sprintf ( file_ipaddr,"%s", inet_ntoa ( *hptr ) );
+        err = is_localhost ( info->filehost.name, file_ipaddr );
         }
     else
         {
-        strcpy ( file_ipaddr, info->filehost.ip );
+        err = is_local_ipaddr ( info->filehost.ip );
         }
 
-    /* Find IP address of local machine */
-    gethostname ( local_hname, 256 );
-    h_info = gethostbyname ( local_hname );
+    /* with USE_LOCAL_VISD, local files go through a visd as well */
+    if ( ( err == 1 ) && getenv ( "USE_LOCAL_VISD" ) )
+        return 0;
+    return err;
+    }
 
-    /* Check if the IP address of the file host matches that of the local
-       machine */
-    /* hptr = (struct in_addr *) *h_info->h_addr_list; /*SRT 950724*/
-    /* while (hptr != NULL) /*SRT 950724*/
-    hsav = h_info->h_addr_list; /*added SRT 950724*/
-    while ( ( hptr = ( struct in_addr * ) *h_info->h_addr_list++ ) != NULL )
+/* visd module ids, by host IP address, so that each remote call needn't
+ * ask the bus master again.  An entry is forgotten when a call to it fails.
+ */
+#define VISD_CACHE_SIZE 8
+
+static struct
+    {
+    char ipaddress[80];
+    int  moduleId;
+    } visdCache[VISD_CACHE_SIZE];
+
+static int visdCacheNext = 0;
+
+static int cached_visd ( char *ipaddress )
+    {
+    int i;
+
+    for ( i = 0; i < VISD_CACHE_SIZE; i++ )
+        if ( visdCache[i].ipaddress[0] && !strcmp ( visdCache[i].ipaddress, ipaddress ) )
+            return visdCache[i].moduleId;
+    return -1;
+    }
+
+static void cache_visd ( char *ipaddress, int moduleId )
+    {
+    int i;
+
+    for ( i = 0; i < VISD_CACHE_SIZE; i++ )
+        if ( visdCache[i].ipaddress[0] && !strcmp ( visdCache[i].ipaddress, ipaddress ) )
+            break;
+    if ( i == VISD_CACHE_SIZE )
         {
-        sprintf ( local_hname, "%s", inet_ntoa ( *hptr ) );
-        if ( !strcmp ( file_ipaddr, local_hname ) )
-            {
-            h_info->h_addr_list = hsav; /*added SRT 950724*/
-            return 1;   /* Match found */
-            }
-        /* hptr++; /*SRT 950724*/
+        i = visdCacheNext;
+        visdCacheNext = ( visdCacheNext + 1 ) % VISD_CACHE_SIZE;
         }
-    h_info->h_addr_list = hsav; /*added SRT 950724*/
-    return 0;    /* File is not on local machine */
+    strcpy ( visdCache[i].ipaddress, ipaddress );
+    visdCache[i].moduleId = moduleId;
     }
 
-/* get_remote : Establishes a Direct Connection with the remote host
- * through the Software Bus and sends the parameters to the function
- * get_info_local and receives the results on the socket.
+static void forget_visd ( int moduleId )
+    {
+    int i;
+
+    for ( i = 0; i < VISD_CACHE_SIZE; i++ )
+        if ( visdCache[i].ipaddress[0] && ( visdCache[i].moduleId == moduleId ) )
+            visdCache[i].ipaddress[0] = '\0';
+    }
+
+static int find_visd ( struct BusData *bd, VIS_DATA *info, char *message,
+                       int *moduleId, int *sameHost )
+/* Finds (starting it if necessary) the visd module for info->filehost;
+ * sets *moduleId (-1 for the local host) and returns PAVE_SUCCESS,
+ * or FAILURE with an error in message.  *sameHost is set if that visd
+ * is on this host (USE_LOCAL_VISD).
  */
-int get_remote ( struct BusData *bd, int code, VIS_DATA *info, char *message )
     {
-    struct BusMessage bmsg;
     char moduleName[256];
-    int moduleId = -1, typeId;
-    int err;
-    char **hsav;
-    struct hostent *h_info;
-    struct in_addr *hptr;
-    char tmp_msg[512], ipaddress[80];
-    int res, i;
+    char ipaddress[80];
+    int res;
+
+    *moduleId = -1;
+    *sameHost = 0;
 
     /* Check if its a valid host and the ftp deamon exists on that machine */
     res = is_localhost ( info->filehost.name, ipaddress );
@@ -224,28 +248,94 @@ int get_remote ( struct BusData *bd, int code, VIS_DATA *info, char *message )
 #endif /* DIAGNOSTICS */
         return FAILURE;
         }
-    else if ( res == 0 ) /* then it is a remote host - check for a visd */
+    else if ( ( res == 0 ) || getenv ( "USE_LOCAL_VISD" ) ) /* check for a visd */
         {
+        *sameHost = res;
+        *moduleId = cached_visd ( ipaddress );
+        if ( *moduleId >= 0 )
+            return PAVE_SUCCESS;
+
         sprintf ( moduleName, "visd_%s", ipaddress );
-        moduleId = BusFindModuleByName ( bd, moduleName );
-        if ( moduleId < 0 ) /* we need to start the visd daemon */
+        *moduleId = BusFindModuleByName ( bd, moduleName );
+        if ( *moduleId < 0 ) /* we need to start the visd daemon */
             {
             BusVerifyClient ( bd, ipaddress, "visd", 1, 18, NULL, message );
-            moduleId = BusFindModuleByName ( bd, moduleName );
+            *moduleId = BusFindModuleByName ( bd, moduleName );
             }
-        if ( moduleId < 0 ) /* we couldn't start the visd daemon */
+        if ( *moduleId < 0 ) /* we couldn't start the visd daemon */
             return FAILURE;
+        cache_visd ( ipaddress, *moduleId );
         }
+    return PAVE_SUCCESS;
+    }
+
+
+/* The visd type ids are fixed while the bus is up:  look each one up
+ * once, so that issuing a request doesn't cost a bus round trip (which
+ * would, besides, have to step around the replies for the requests
+ * already outstanding).
+ */
+#define VIS_TYPE_INFO     (0)
+#define VIS_TYPE_DATA     (1)
+#define VIS_TYPE_DATA_SHM (2)
+
+static const char *visTypeName[3] = { "EVAP_GetInfo", "EVAP_GetData", "EVAP_GetDataShm" };
+static int visTypeId[3] = { -1, -1, -1 };
+static struct BusData *visTypeBus = NULL;
+
+static int vis_type_id ( struct BusData *bd, int which )
+    {
+    int i;
+
+    if ( bd != visTypeBus )
+        {
+        for ( i = 0; i < 3; i++ )
+            visTypeId[i] = -1;
+        visTypeBus = bd;
+        }
+    if ( visTypeId[which] < 0 )
+        visTypeId[which] = BusFindTypeByName ( bd, visTypeName[which] );
+    return visTypeId[which];
+    }
+
+
+/* get_remote : Establishes a Direct Connection with the remote host
+ * through the Software Bus and sends the parameters to the function
+ * get_info_local and receives the results on the socket.
+ */
+int get_remote ( struct BusData *bd, int code, VIS_DATA *info, char *message )
+    {
+    int moduleId = -1, typeId, sameHost;
+    int err;
+    char tmp_msg[512];
+
+    if ( find_visd ( bd, info, message, &moduleId, &sameHost ) == FAILURE )
+        return FAILURE;
+
+    err = SBUSERROR_GENERAL_FAILURE;
+#ifdef VIS_SHM_TRANSPORT
+    /* Same-host visd:  the grid comes back by shared-memory descriptor.
+       A visd that doesn't know EVAP_GetDataShm refuses the connection,
+       and we ask again the usual way.
+     */
+    if ( ( code == GET_DATA ) && sameHost )
+        {
+        typeId = vis_type_id ( bd, VIS_TYPE_DATA_SHM );
+        err = BusCallRemotePooled ( bd, moduleId, typeId, EVAPLocalStubShm,
+                                    ( char * ) info, tmp_msg );
+        }
+#endif /* VIS_SHM_TRANSPORT */
 
     if ( code == GET_INFO )
-        typeId = BusFindTypeByName ( bd, "EVAP_GetInfo" );
+        typeId = vis_type_id ( bd, VIS_TYPE_INFO );
     else
-        typeId = BusFindTypeByName ( bd, "EVAP_GetData" );
+        typeId = vis_type_id ( bd, VIS_TYPE_DATA );
 
-    /* Send a Direct Connection Request and call the function "EVAPLocalStub
-       when the connection is setup
+    /* Call the function "EVAPLocalStub" over a (pooled) direct
+       connection to the visd
      */
-    err = BusCallRemote ( bd, moduleId, typeId, EVAPLocalStub, ( char * ) info, tmp_msg );
+    if ( err != SBUSERROR_NOT )
+        err = BusCallRemotePooled ( bd, moduleId, typeId, EVAPLocalStub, ( char * ) info, tmp_msg );
     if ( err == SBUSERROR_NOT )
         {
         sscanf ( tmp_msg,"%d %s",&err, message );
@@ -256,6 +346,7 @@ int get_remote ( struct BusData *bd, int code, VIS_DATA *info, char *message )
         }
     else
         {
+        forget_visd ( moduleId );
 #ifdef DIAGNOSTICS
         fprintf ( stderr, "3 get_remote() returning FAILURE\n", message );
 #endif /* DIAGNOSTICS */
@@ -268,19 +359,56 @@ int get_remote ( struct BusData *bd, int code, VIS_DATA *info, char *message )
  */
 void EVAPLocalStub ( int fd, char *data, char *res )
     {
+#ifdef DIAGNOSTICS
+    fprintf ( stderr, "EVAPLocalStub : Direct Connection has been set up \n" );
+#endif /* DIAGNOSTICS */
+    EVAPSendStub ( fd, data );
+    EVAPRecvStub ( fd, data, res );
+    }
+
+
+/* First half of EVAPLocalStub():  packs the parameters.
+ * A failure here shows up as a read failure in EVAPRecvStub().
+ */
+void EVAPSendStub ( int fd, char *data )
+    {
+    if ( sendVisData ( fd, ( VIS_DATA * ) data ) == XFER_ERR )
+        fprintf ( stderr, "EVAPSendStub : sendVisData() failed\n" );
+    }
+
+
+/* Second half of EVAPLocalStub():  receives the results
+ */
+static void recv_results ( int fd, char *data, char *res, int shm );
+
+void EVAPRecvStub ( int fd, char *data, char *res )
+    {
+    recv_results ( fd, data, res, 0 );
+    }
+
+#ifdef VIS_SHM_TRANSPORT
+/* As EVAPLocalStub() and EVAPRecvStub(), for EVAP_GetDataShm:
+ * the grid arrives through getGridShm()
+ */
+void EVAPLocalStubShm ( int fd, char *data, char *res )
+    {
+    EVAPSendStub ( fd, data );
+    EVAPRecvStubShm ( fd, data, res );
+    }
+
+void EVAPRecvStubShm ( int fd, char *data, char *res )
+    {
+    recv_results ( fd, data, res, 1 );
+    }
+#endif /* VIS_SHM_TRANSPORT */
+
+static void recv_results ( int fd, char *data, char *res, int shm )
+    {
     VIS_DATA *info;
     char *msg, *tfname;
     int val, err;
 
-#ifdef DIAGNOSTICS
-    fprintf ( stderr, "EVAPLocalStub : Direct Connection has been set up \n" );
-#endif /* DIAGNOSTICS */
     info = ( VIS_DATA * ) data;
-    if ( ( err = sendVisData ( fd, info ) ) == XFER_ERR )
-        {
-        sprintf ( res, "%d  ", err );
-        return;
-        }
     if ( ( err = getInteger ( fd, &val ) ) == XFER_ERR )
         {
         sprintf ( res, "%d  ", err );
@@ -301,6 +429,13 @@ void EVAPLocalStub ( int fd, char *data, char *res )
         sprintf ( res, "%d  ", err );
         return;
         }
+#ifdef VIS_SHM_TRANSPORT
+    if ( shm && ( ( err = getGridShm ( fd, info ) ) == XFER_ERR ) )
+        {
+        sprintf ( res, "%d  ", err );
+        return;
+        }
+#endif /* VIS_SHM_TRANSPORT */
     if ( tfname != info->filename ) /* SRT 961024 memory management */
         if ( tfname )      /* SRT 961024 memory management */
             {
@@ -310,6 +445,137 @@ void EVAPLocalStub ( int fd, char *data, char *res )
             }           /* SRT 961024 memory management */
     }
 
+
+/* ----------------  asynchronous get_info() / get_data()  ---------------- */
+
+static void vis_request_done ( struct BusAsyncCall *call )
+    {
+    VIS_ASYNC_REQUEST *req = ( VIS_ASYNC_REQUEST * ) call->clientData;
+
+    if ( call->err == SBUSERROR_NOT )
+        {
+        req->status = FAILURE;
+        sscanf ( req->results, "%d %s", &req->status, req->message );
+        }
+    else
+        {
+        forget_visd ( call->toModule );
+        req->status = FAILURE;
+        sprintf ( req->message, "Remote call to visd failed (%d)", call->err );
+        }
+    req->done = 1;
+    if ( req->callback )
+        req->callback ( req );
+    }
+
+static VIS_ASYNC_REQUEST *vis_request ( struct BusData *bd, int code, VIS_DATA *info,
+                                        void ( *callback ) ( VIS_ASYNC_REQUEST * ),
+                                        void *clientData )
+    {
+    VIS_ASYNC_REQUEST *req;
+    int err, moduleId, typeId, sameHost;
+    void ( *recv_stub ) ( int, char *, char * );
+
+    req = ( VIS_ASYNC_REQUEST * ) calloc ( 1, sizeof ( VIS_ASYNC_REQUEST ) );
+    if ( req == NULL )
+        return NULL;
+    req->info       = info;
+    req->code       = code;
+    req->callback   = callback;
+    req->clientData = clientData;
+    req->status     = FAILURE;
+
+    err = check_local_file ( info );
+    if ( err == -1 )     /* Invalid hostname */
+        {
+        sprintf ( req->message, "Invalid hostname : %s ", info->filehost.name );
+        }
+    else if ( ( err == 1 ) || ( bd == NULL ) )
+        {
+        req->status = ( code == GET_INFO ) ? get_info_local ( info, req->message )
+                                           : get_data_local ( info, req->message );
+        }
+    else if ( find_visd ( bd, info, req->message, &moduleId, &sameHost ) != FAILURE )
+        {
+        recv_stub = EVAPRecvStub;
+        if ( code == GET_INFO )
+            {
+            if ( info->grid  ) spill_release ( info->grid );
+            if ( info->sdate ) free ( info->sdate );
+            if ( info->stime ) free ( info->stime );
+            info->grid  = NULL;
+            info->sdate = NULL;
+            info->stime = NULL;
+            typeId = vis_type_id ( bd, VIS_TYPE_INFO );
+            }
+        else
+            {
+            typeId = vis_type_id ( bd, VIS_TYPE_DATA );
+#ifdef VIS_SHM_TRANSPORT
+            if ( sameHost )
+                {
+                typeId    = vis_type_id ( bd, VIS_TYPE_DATA_SHM );
+                recv_stub = EVAPRecvStubShm;
+                }
+#endif /* VIS_SHM_TRANSPORT */
+            }
+
+        req->call = BusCallRemoteAsync ( bd, moduleId, typeId,
+                                         EVAPSendStub, recv_stub,
+                                         ( char * ) info, req->results,
+                                         vis_request_done, ( void * ) req );
+        if ( req->call != NULL )
+            return req;     /* in progress */
+
+        sprintf ( req->message, "Could not send request to visd for %s",
+                  info->filehost.name );
+        }
+
+    req->done = 1;
+    if ( req->callback )
+        req->callback ( req );
+    return req;
+    }
+
+VIS_ASYNC_REQUEST *get_info_async ( struct BusData *bd, VIS_DATA *info,
+                                    void ( *callback ) ( VIS_ASYNC_REQUEST * ),
+                                    void *clientData )
+    {
+    return vis_request ( bd, GET_INFO, info, callback, clientData );
+    }
+
+VIS_ASYNC_REQUEST *get_data_async ( struct BusData *bd, VIS_DATA *info,
+                                    void ( *callback ) ( VIS_ASYNC_REQUEST * ),
+                                    void *clientData )
+    {
+    return vis_request ( bd, GET_DATA, info, callback, clientData );
+    }
+
+int wait_vis_request ( struct BusData *bd, VIS_ASYNC_REQUEST *req )
+    {
+    if ( req == NULL )
+        return FAILURE;
+    if ( !req->done && req->call )
+        BusWaitRemote ( bd, req->call );
+    return req->status;
+    }
+
+int wait_all_vis_requests ( struct BusData *bd )
+    {
+    if ( bd == NULL )
+        return SBUSERROR_NOT;
+    return BusWaitAllRemote ( bd );
+    }
+
+void free_vis_request ( VIS_ASYNC_REQUEST *req )
+    {
+    if ( req == NULL )
+        return;
+    if ( req->call )
+        BusFreeRemote ( req->call );
+    free ( req );
+    }
+
 /* This Function attaches the client to the BusMaster -
       The name of the module is "infod_123.45.67.89" where
     123.45.67.89 is the ip-address of the host where the client runs
@@ -351,13 +617,19 @@ int initVisDataClient ( struct BusData *bd, char *modName )
 #endif
 
     /* Get id for remote GetInfo function */
-    typeId = BusFindTypeByName ( bd, "EVAP_GetInfo" );
+    typeId = vis_type_id ( bd, VIS_TYPE_INFO );
     BusAddDirectCallback ( bd, typeId, EVAP_GetInfo, NULL );
 
     /* Get id for remote GetData function */
-    typeId = BusFindTypeByName ( bd, "EVAP_GetData" );
+    typeId = vis_type_id ( bd, VIS_TYPE_DATA );
     BusAddDirectCallback ( bd, typeId, EVAP_GetData, NULL );
 
+#ifdef VIS_SHM_TRANSPORT
+    /* Same-host version of GetData */
+    typeId = vis_type_id ( bd, VIS_TYPE_DATA_SHM );
+    BusAddDirectCallback ( bd, typeId, EVAP_GetDataShm, NULL );
+#endif /* VIS_SHM_TRANSPORT */
+
     return SBUSERROR_NOT;
     }
 
@@ -376,7 +648,7 @@ void EVAP_GetInfo ( int fd, char *data )
     fprintf ( stderr, "EVAP_GetInfo : getting VisData information \n" );
 #endif /* DIAGNOSTICS */
 
-    init_vis (info ) ;
+    init_vis ( &info ) ;
     if ( ( err = getVisData ( fd, &info ) ) == XFER_ERR )
         {
         fprintf ( stderr,
@@ -423,7 +695,7 @@ void EVAP_GetData ( int fd, char *data )
     fprintf ( stderr, "EVAP_GetData : getting VisData information \n" );
 #endif /* DIAGNOSTICS */
 
-    init_vis ( info ) ;
+    init_vis ( &info ) ;
     if ( ( err = getVisData ( fd, &info ) ) == XFER_ERR )
         {
         fprintf ( stderr,
@@ -451,3 +723,48 @@ void EVAP_GetData ( int fd, char *data )
 #endif /* DIAGNOSTICS */
     sendVisData ( fd, &info );
     }
+
+#ifdef VIS_SHM_TRANSPORT
+/* Callback for GetData from a PAVE on the same host:  as EVAP_GetData(),
+   except that the grid goes back through sendGridShm()
+ */
+void EVAP_GetDataShm ( int fd, char *data )
+    {
+    VIS_DATA info;
+    char message[512];
+    float *grid;
+    int val, err;
+
+    init_vis ( &info ) ;
+    if ( ( err = getVisData ( fd, &info ) ) == XFER_ERR )
+        {
+        fprintf ( stderr,
+                  "EVAP_GetDataShm() ERROR in receiving the VisData Structure \n" );
+        val = FAILURE;
+        strcpy ( message, "visd could not read the request" );
+        sendInteger ( fd, 1, &val );
+        sendString ( fd, message, strlen ( message ) );
+        return;
+        }
+    val = get_data_local ( &info, message );
+    if ( val == FAILURE )
+        {
+        fprintf ( stderr, "ERROR in executing GETDATA \n" );
+        sendInteger ( fd, 1, &val );
+        sendString ( fd, message, strlen ( message ) );
+        return;
+        }
+    sendInteger ( fd, 1, &val );
+
+    grid = info.grid;           /* everything but the grid... */
+    info.grid = NULL;
+    if ( sendVisData ( fd, &info ) != XFER_ERR )
+        {
+        info.grid = grid;       /* ...and then the grid */
+        if ( sendGridShm ( fd, &info ) == XFER_ERR )
+            fprintf ( stderr, "EVAP_GetDataShm() ERROR in sending the grid \n" );
+        }
+    if ( grid ) free ( grid );
+    info.grid = NULL;
+    }
+#endif /* VIS_SHM_TRANSPORT */
@@ -33,6 +33,8 @@ MODIFICATION HISTORY:
 WHO  WHEN       WHAT
 ---  ----       ----
 SRT  04/06/95   Added #ifdef __cplusplus lines
+     10/2026    Added asynchronous get_info_async(), get_data_async()
+     10/2026    Added same-host shared-memory grid transfer
 */
 
 
@@ -74,15 +76,62 @@ extern "C" {
 
 #define DEBUG_EVAP	    (0)
 
+        /* same-host visd's pass grids by shared-memory descriptor
+           (see sendGridShm()); define NO_SHM_TRANSPORT to disable */
+#if defined(__linux__) && !defined(NO_SHM_TRANSPORT)
+#define VIS_SHM_TRANSPORT
+#endif
+
 int check_local_file(VIS_DATA *info);
 
 int get_info  ( struct BusData *bd, VIS_DATA *info, char *message);
 int get_data  ( struct BusData *bd, VIS_DATA *info, char *message);
 int get_remote( struct BusData *bd, int code, VIS_DATA *info, char *message);
 void EVAPLocalStub(int fd, char *data, char *results);
+void EVAPSendStub (int fd, char *data);
+void EVAPRecvStub (int fd, char *data, char *results);
 int initVisDataClient(struct BusData *bd, char *modName);
 void EVAP_GetInfo(int fd, char *data);
 void EVAP_GetData(int fd, char *data);
+#ifdef VIS_SHM_TRANSPORT
+void EVAPLocalStubShm(int fd, char *data, char *results);
+void EVAPRecvStubShm (int fd, char *data, char *results);
+void EVAP_GetDataShm(int fd, char *data);
+#endif
+
+/*  Asynchronous versions of get_info() and get_data():
+ *  the request is sent and the call returns at once; the VIS_DATA
+ *  is filled in when the results arrive (see BusCallRemoteAsync()).
+ *  Local files are read immediately, so their requests come back
+ *  already done.  Many requests, to one or several visd's, may be
+ *  outstanding at once.  "callback" (may be NULL) is called when a
+ *  request is done; wait_vis_request() / wait_all_vis_requests()
+ *  block until then.  The caller frees the request with
+ *  free_vis_request(), after it is done (but not from "callback"
+ *  if it is also being waited for).
+ */
+typedef struct VisAsyncRequest
+    {
+    struct BusAsyncCall *call;      /* NULL for local (or failed) requests */
+    VIS_DATA            *info;
+    int                  code;      /* GET_INFO or GET_DATA */
+    int                  done;
+    int                  status;    /* get_info()/get_data() return value */
+    char                 message[512];
+    char                 results[512];
+    void               ( *callback ) ( struct VisAsyncRequest *req );
+    void                *clientData;
+    } VIS_ASYNC_REQUEST;
+
+VIS_ASYNC_REQUEST *get_info_async( struct BusData *bd, VIS_DATA *info,
+                                   void ( *callback ) ( VIS_ASYNC_REQUEST * ),
+                                   void *clientData );
+VIS_ASYNC_REQUEST *get_data_async( struct BusData *bd, VIS_DATA *info,
+                                   void ( *callback ) ( VIS_ASYNC_REQUEST * ),
+                                   void *clientData );
+int  wait_vis_request     ( struct BusData *bd, VIS_ASYNC_REQUEST *req );
+int  wait_all_vis_requests( struct BusData *bd );
+void free_vis_request     ( VIS_ASYNC_REQUEST *req );
 
 int sendVisData(int fd, VIS_DATA *info);
 int getVisData (int fd, VIS_DATA *info);
@@ -96,6 +145,10 @@ int getString  (int fd, char **buf);
 int sendString (int fd, char *buf, int len);
 int readSleepLoop (int fd, char *buf, int len);
 int writeSleepLoop(int fd, char *buf, int len);
+#ifdef VIS_SHM_TRANSPORT
+int sendGridShm(int fd, VIS_DATA *info);
+int getGridShm (int fd, VIS_DATA *info);
+#endif
 
         /* in order to get the linker to resolve Kathy's
            subroutines when using CC to compile */
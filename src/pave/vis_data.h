@@ -37,6 +37,7 @@ SRT  04/06/95   Added #ifdef __cplusplus lines
 SRT  05/09/96   Added "SLICE" to end of each slice type, and replaced
 		the enum data_slice by int.  This overcomes conflicts
 		with Todd Plessel's DrawMap library code.
+CJC  10/2026    Added grid_dest, grid_dest_n (see gridtarget.h)
 */
 
 
@@ -210,6 +211,12 @@ typedef struct
 	float grid_min;			/* data grid min of data slice       */
 	float grid_max;			/* data grid max of data slice       */
 					/*************************************/
+					/* Destination for the grid, set by  */
+					/* get_data_local() for the files of */
+					/* a META-meta file;  never sent     */
+					/*************************************/
+	float *grid_dest;		/* where grid_alloc() puts the grid  */
+	long   grid_dest_n;		/* ... if it has this many points    */
 	} VIS_DATA;
 
 
@@ -20,6 +20,7 @@
  *  REVISION HISTORY
  *      Author:      Rajini Balay, NCSU
  *      Date:        February 25, 1995
+ *      Version 10/2026:  serves pooled (persistent) direct connections
  *****************************************************************************/
 
 /* bald messes this up in some header file */
@@ -44,6 +45,9 @@ int main( int argc, char *argv[] )
 
     initVisDataClient ( &bd,"visd" );
 
+    /* keep EVAP_GetInfo / EVAP_GetData connections open for re-use */
+    BusServePooledConnections ( &bd );
+
     BusEventLoop ( &bd );
 
     return 0; /* added SRT */
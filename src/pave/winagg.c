@@ -0,0 +1,260 @@
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: winagg.c
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ *  For further information on PAVE:
+ *      Usage: type -usage in PAVE's standard input
+ *      User Guide: https://cjcoats.github.io/pave/PaveManual.html
+ *      FAQ:        https://cjcoats.github.io/pave/Pave.FAQ.html
+ *
+ ****************************************************************************
+ *  Sliding-window reductions over a sequence of planes;  see winagg.h.
+ *
+ *  Each cell's deque is a ring of `width' plane seqs, dq[cell*width..],
+ *  from head[cell], len[cell] long, in increasing seq and decreasing
+ *  (for WINAGG_MAX;  increasing for WINAGG_MIN) value:  its front is the
+ *  window's extreme.  Values are looked up in the planes themselves,
+ *  which stay in w->ring while their seqs are in the window.
+ *
+ *  A double sum of floats keeps 29 bits beyond a float's, so removing a
+ *  value costs only rounding unless the value dwarfed the rest of the
+ *  sum, in which case the cell is summed again from scratch.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "winagg.h"
+
+#define PAVE_SUCCESS    (1)
+#define FAILURE         (0)
+
+/* a value this much larger than what is left of the sum without it has
+   swamped the other values' digits:  recompute the sum */
+#define WINAGG_CANCEL   ( 134217728.0 )         /* 2^27 */
+
+
+int winagg_init ( WinAgg *w, int mode, int width, long ncell )
+    {
+    memset ( w, 0, sizeof ( WinAgg ) );
+    if ( ( width < 1 ) || ( ncell < 1 ) )
+        return FAILURE;
+    w->mode  = mode;
+    w->width = width;
+    w->ncell = ncell;
+    w->ring  = ( const float ** ) calloc ( width, sizeof ( float * ) );
+    if ( ( mode == WINAGG_MAX ) || ( mode == WINAGG_MIN ) )
+        {
+        w->dq   = ( int * ) malloc ( ( size_t ) ncell * width * sizeof ( int ) );
+        w->head = ( int * ) malloc ( ( size_t ) ncell * sizeof ( int ) );
+        w->len  = ( int * ) malloc ( ( size_t ) ncell * sizeof ( int ) );
+        if ( !w->ring || !w->dq || !w->head || !w->len )
+            {
+            winagg_free ( w );
+            return FAILURE;
+            }
+        }
+    else
+        {
+        w->sum   = ( double * ) malloc ( ( size_t ) ncell * sizeof ( double ) );
+        w->count = ( int * )    malloc ( ( size_t ) ncell * sizeof ( int ) );
+        if ( !w->ring || !w->sum || !w->count )
+            {
+            winagg_free ( w );
+            return FAILURE;
+            }
+        }
+    winagg_reset ( w );
+    return PAVE_SUCCESS;
+    }
+
+
+void winagg_reset ( WinAgg *w )
+    {
+    w->seq = 0;
+    if ( w->sum )
+        {
+        memset ( w->sum,   0, ( size_t ) w->ncell * sizeof ( double ) );
+        memset ( w->count, 0, ( size_t ) w->ncell * sizeof ( int ) );
+        }
+    if ( w->dq )
+        {
+        memset ( w->head, 0, ( size_t ) w->ncell * sizeof ( int ) );
+        memset ( w->len,  0, ( size_t ) w->ncell * sizeof ( int ) );
+        }
+    }
+
+
+/* cell i's sum and count, from scratch, over the planes in the ring */
+static void resum ( WinAgg *w, long i, const float *skip )
+    {
+    double s = 0.0;
+    int    n = 0, p;
+    float  v;
+
+    for ( p = 0; p < w->width; p++ )
+        if ( w->ring[p] && ( w->ring[p] != skip ) )
+            {
+            v = w->ring[p][i];
+            if ( isnan ( v ) ) continue;
+            s += v;
+            n++;
+            }
+    w->sum[i]   = s;
+    w->count[i] = n;
+    }
+
+static void push_sum ( WinAgg *w, const float *plane, const float *old )
+    {
+    long  i;
+    float v;
+
+#pragma omp parallel for private(v) if ( w->ncell > 65536 )
+    for ( i = 0; i < w->ncell; i++ )
+        {
+        if ( old )
+            {
+            v = old[i];
+            if ( !isfinite ( v ) )
+                {
+                if ( !isnan ( v ) )
+                    resum ( w, i, old );
+                }
+            else
+                {
+                w->sum[i] -= v;
+                w->count[i]--;
+                if ( fabs ( v ) > WINAGG_CANCEL * fabs ( w->sum[i] ) )
+                    resum ( w, i, old );
+                }
+            }
+        v = plane[i];
+        if ( !isnan ( v ) )
+            {
+            w->sum[i] += v;
+            w->count[i]++;
+            }
+        }
+    }
+
+static void push_extreme ( WinAgg *w, const float *plane, int seq )
+    {
+    int   width = w->width, want_max = ( w->mode == WINAGG_MAX );
+    long  i;
+
+#pragma omp parallel for if ( w->ncell > 65536 )
+    for ( i = 0; i < w->ncell; i++ )
+        {
+        int   *dq = w->dq + i * width, h = w->head[i], n = w->len[i], s;
+        float  v = plane[i], b;
+
+        /* expire the front if it has left the window */
+        if ( ( n > 0 ) && ( dq[h] <= seq - width ) )
+            {
+            h = ( h + 1 ) % width;
+            n--;
+            }
+        if ( !isnan ( v ) )
+            {
+            /* drop from the back whatever v dominates */
+            while ( n > 0 )
+                {
+                s = dq[( h + n - 1 ) % width];
+                b = w->ring[s % width][i];
+                if ( want_max ? ( b > v ) : ( b < v ) )
+                    break;
+                n--;
+                }
+            dq[( h + n ) % width] = seq;
+            n++;
+            }
+        w->head[i] = h;
+        w->len[i]  = n;
+        }
+    }
+
+void winagg_push ( WinAgg *w, const float *plane )
+    {
+    int          slot = ( int ) ( w->seq % w->width );
+    const float *old  = ( w->seq >= w->width ) ? w->ring[slot] : NULL;
+    long         i;
+
+    if ( w->dq )
+        {
+        /* the deques look up values in the ring, so plane must be in
+           it first;  any entry for the plane it replaces expires */
+        w->ring[slot] = plane;
+        push_extreme ( w, plane, ( int ) w->seq );
+        }
+    else
+        {
+        if ( old && ( w->seq % WINAGG_REBASE == 0 ) )
+            {
+            w->ring[slot] = plane;
+            for ( i = 0; i < w->ncell; i++ )
+                resum ( w, i, NULL );
+            }
+        else
+            {
+            push_sum ( w, plane, old );
+            w->ring[slot] = plane;
+            }
+        }
+    w->seq++;
+    }
+
+
+int winagg_full ( const WinAgg *w )
+    {
+    return w->seq >= w->width;
+    }
+
+
+void winagg_result ( const WinAgg *w, float *out )
+    {
+    long i;
+    int  s;
+
+    for ( i = 0; i < w->ncell; i++ )
+        {
+        if ( w->dq )
+            {
+            if ( w->len[i] )
+                {
+                s = w->dq[i * w->width + w->head[i]];
+                out[i] = w->ring[s % w->width][i];
+                }
+            else
+                out[i] = NAN;
+            }
+        else if ( !w->count[i] )
+            out[i] = NAN;
+        else if ( w->mode == WINAGG_MEAN )
+            out[i] = ( float ) ( w->sum[i] / w->count[i] );
+        else
+            out[i] = ( float ) w->sum[i];
+        }
+    }
+
+
+void winagg_free ( WinAgg *w )
+    {
+    if ( w->ring )  free ( ( void * ) w->ring );
+    if ( w->sum )   free ( w->sum );
+    if ( w->count ) free ( w->count );
+    if ( w->dq )    free ( w->dq );
+    if ( w->head )  free ( w->head );
+    if ( w->len )   free ( w->len );
+    memset ( w, 0, sizeof ( WinAgg ) );
+    }
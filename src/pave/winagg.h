@@ -0,0 +1,83 @@
+#ifndef WINAGG_H
+#define WINAGG_H
+
+/****************************************************************************
+ *
+ *  Package for Analysis and Visualization of Environmental data
+ *  PAVE Version 3.0
+ *
+ *  File: winagg.h
+ *  Copyright (C) 2026-    Carlie J. Coats, Jr., Ph.D.
+ *
+ *  Licensed under the GNU General Public License Version 2.
+ *  See enclosed gpl.txt for more details
+ *
+ ****************************************************************************
+ *  Sliding-window reductions over a sequence of planes.
+ *
+ *  A WinAgg holds the last `width' planes pushed on it (by reference:
+ *  the caller keeps them in place) and, for every cell, their sum and
+ *  count of non-missing values, or their running max or min.  Pushing a
+ *  plane on a full window drops the oldest:  sums are updated by adding
+ *  the new value and subtracting the old one, extremes through a
+ *  monotonic deque per cell, so each push costs O(1) per cell however
+ *  wide the window.  DriverWnd's n-hour and n-layer plots (-NhourSum,
+ *  -NhourAverage, -NhourMax, -NlayerSum, -NlayerAverage) use it, so
+ *  long windows over long runs cost no more than short ones.
+ *
+ *  Missing values (NaN) are skipped;  a cell with none in its window
+ *  yields NaN.  Sums are kept in double, recomputed for a cell whenever
+ *  an infinite value, or one that swamped the rest of the sum, leaves
+ *  its window, and for all cells every WINAGG_REBASE pushes, so that
+ *  rounding cannot accumulate.
+ *
+ *  REVISION HISTORY
+ *      Version 10/2026 by Carlie J. Coats, Jr.:  ORIGINAL CODE
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#define WINAGG_SUM      (0)     /* as DriverWnd's AvgOrSum */
+#define WINAGG_MEAN     (1)
+#define WINAGG_MAX      (2)
+#define WINAGG_MIN      (3)
+
+#define WINAGG_REBASE   (256)
+
+typedef struct
+    {
+    int           mode;
+    int           width;        /* planes in a full window */
+    long          ncell;        /* values in a plane */
+    long          seq;          /* planes pushed since the reset */
+    const float **ring;         /* plane seq is ring[seq % width] */
+    double       *sum;          /* WINAGG_SUM, WINAGG_MEAN */
+    int          *count;
+    int          *dq;           /* WINAGG_MAX, WINAGG_MIN:  width seqs */
+    int          *head, *len;   /* ... per cell */
+    } WinAgg;
+
+/* sets up an empty window:  PAVE_SUCCESS, or FAILURE (out of memory) */
+int winagg_init ( WinAgg *w, int mode, int width, long ncell );
+
+/* empties the window */
+void winagg_reset ( WinAgg *w );
+
+/* pushes plane[0..ncell-1], dropping the oldest plane if the window is full */
+void winagg_push ( WinAgg *w, const float *plane );
+
+/* has the window `width' planes? */
+int winagg_full ( const WinAgg *w );
+
+/* the window's sum, mean, max or min, for every cell */
+void winagg_result ( const WinAgg *w, float *out );
+
+void winagg_free ( WinAgg *w );
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif  /* WINAGG_H */
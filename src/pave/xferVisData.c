@@ -23,6 +23,13 @@
  *
  *      Version 02/2018 by Carlie J. Coats, Jr., Ph.D. for PAVE-3.0
  *      replaced gratuitous malloc()s by stack-based local variables.
+ *
+ *      Version 10/2026:  sendGridShm(), getGridShm():  same-host grid
+ *      transfer through a shared-memory descriptor (memfd_create() and
+ *      struct ucred need _GNU_SOURCE, which CPPFLAGS defines).
+ *
+ *      Version 10/2026:  getGridShm() keeps the descriptor mapped as the
+ *      grid (spill_adopt()), rather than copying it out.
  *****************************************************************************/
 
 /* bald messes this up in some header file */
@@ -35,6 +42,9 @@
 #include <sys/types.h>    /* sys/types.h needed for netinet/in.h */
 #include <netinet/in.h>
 #include <unistd.h>     /* read, write, sleep  */
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
 
 #include "visDataClient.h"
 #include "busClient.h"
@@ -46,6 +56,7 @@
 #include "busVersion.h"
 #include "busRpc.h"
 #include "busUtil.h"
+#include "spill.h"
 
 #define bcopy(s1, s2, len) memcpy(s2, s1, (size_t)len);
 
@@ -694,3 +705,320 @@ int sendString ( int fd, char *buf, int len )
         }
     return XFER_SUCCESS;
     }
+
+
+/* ------------------  same-host grid transfer  ------------------ */
+
+#ifdef VIS_SHM_TRANSPORT
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* When visd runs on the same host as PAVE, the grid need not be
+ * converted to network byte order and pushed through the TCP
+ * connection:  visd copies it, as is, into a mapped anonymous memory
+ * file and hands PAVE the descriptor over a Unix-domain socket
+ * (SCM_RIGHTS), and PAVE copies it out of its own mapping of the file.
+ * The socket is in the abstract namespace, named in the TCP stream;
+ * visd only accepts peers with its own uid, and gives up at once if
+ * PAVE drops the TCP connection instead of connecting.
+ *
+ * After the VIS_DATA (sent without its grid) comes a mode word:
+ *      GRID_NONE    no grid
+ *      GRID_INLINE  the grid follows, as from sendVisData()
+ *      GRID_SHM     the socket name follows; connect to it for the fd
+ */
+
+#define GRID_NONE       (-1)
+#define GRID_INLINE       0
+#define GRID_SHM          1
+#define GRID_SHM_WAIT   2000    /* msec visd waits for PAVE to connect */
+
+static int grid_points ( VIS_DATA *info )
+    {
+    int ncol, nrow, nlevel, nstep;
+
+    ncol   = info->col_max - info->col_min + 1;
+    nrow   = info->row_max - info->row_min + 1;
+    nlevel = info->level_max - info->level_min + 1;
+    nstep  = ( ( info->step_max - info->step_min ) /info->step_incr ) + 1;
+    return ncol * nrow * nlevel * nstep;
+    }
+
+static socklen_t grid_sockaddr ( struct sockaddr_un *sun, char *name )
+/* abstract-namespace address:  sun_path is NUL, then the name */
+    {
+    memset ( sun, 0, sizeof ( struct sockaddr_un ) );
+    sun->sun_family = AF_UNIX;
+    strncpy ( sun->sun_path+1, name, sizeof ( sun->sun_path )-2 );
+    return ( socklen_t ) ( offsetof ( struct sockaddr_un, sun_path ) + 1 + strlen ( sun->sun_path+1 ) );
+    }
+
+static int grid_memfd ( float *grid, size_t nbytes )
+/* returns a descriptor for an unnamed shared-memory file holding grid */
+    {
+    void *p;
+    int   mfd;
+
+#ifdef MFD_CLOEXEC
+    mfd = memfd_create ( "pave-grid", MFD_CLOEXEC );
+#else
+        {
+        char shmname[64];
+
+        sprintf ( shmname, "/pave-grid-%d", ( int ) getpid() );
+        mfd = shm_open ( shmname, O_RDWR | O_CREAT | O_EXCL, 0600 );
+        if ( mfd >= 0 ) shm_unlink ( shmname );
+        }
+#endif
+    if ( mfd < 0 )
+        return -1;
+
+    if ( ftruncate ( mfd, ( off_t ) nbytes ) < 0 )
+        {
+        close ( mfd );
+        return -1;
+        }
+    p = mmap ( NULL, nbytes, PROT_WRITE, MAP_SHARED, mfd, 0 );
+    if ( p == MAP_FAILED )
+        {
+        close ( mfd );
+        return -1;
+        }
+    memcpy ( p, grid, nbytes );
+    munmap ( p, nbytes );
+    return mfd;
+    }
+
+/* visd's listening socket, made on first use */
+
+static int  gridListenFd = -1;
+static char gridListenName[64];
+
+static int grid_listener ( void )
+    {
+    struct sockaddr_un sun;
+    socklen_t len;
+    int s;
+
+    if ( gridListenFd >= 0 )
+        return gridListenFd;
+
+    sprintf ( gridListenName, "pave-visd-%d-%d", ( int ) getuid(), ( int ) getpid() );
+    len = grid_sockaddr ( &sun, gridListenName );
+    s = socket ( AF_UNIX, SOCK_STREAM, 0 );
+    if ( s < 0 )
+        return -1;
+    if ( ( bind ( s, ( struct sockaddr * ) &sun, len ) < 0 ) || ( listen ( s, 4 ) < 0 ) )
+        {
+        close ( s );
+        return -1;
+        }
+    gridListenFd = s;
+    return s;
+    }
+
+static int grid_accept ( int lsock, int fd )
+/* waits (a while) for PAVE to connect; only our own uid is accepted.
+   Gives up if PAVE closes fd, its TCP connection, instead */
+    {
+    struct pollfd pfd[2];
+    struct ucred  cred;
+    socklen_t len;
+    char c;
+    int s;
+
+    pfd[0].fd     = lsock;
+    pfd[0].events = POLLIN;
+    pfd[1].fd     = fd;
+    pfd[1].events = POLLIN;
+    for ( ;; )
+        {
+        pfd[0].revents = pfd[1].revents = 0;
+        if ( poll ( pfd, 2, GRID_SHM_WAIT ) <= 0 )
+            return -1;
+        if ( pfd[1].revents & ( POLLHUP | POLLERR | POLLNVAL ) )
+            return -1;
+        if ( pfd[1].revents & POLLIN )
+            {
+            if ( recv ( fd, &c, 1, MSG_PEEK | MSG_DONTWAIT ) == 0 )
+                return -1;
+            pfd[1].fd = -1;     /* data, not EOF:  stop watching it */
+            }
+        if ( !( pfd[0].revents & POLLIN ) )
+            continue;
+        s = accept ( lsock, NULL, NULL );
+        if ( s < 0 )
+            return -1;
+        len = sizeof ( cred );
+        if ( ( getsockopt ( s, SOL_SOCKET, SO_PEERCRED, &cred, &len ) == 0 ) &&
+                ( cred.uid == getuid() ) )
+            return s;
+        close ( s );
+        }
+    }
+
+/* Server side:  send info->grid, by descriptor if possible */
+int sendGridShm ( int fd, VIS_DATA *info )
+    {
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr *cmsg;
+    char   cbuf[CMSG_SPACE ( sizeof ( int ) )];
+    int    mode, npts, mfd, lsock, s, ok;
+
+    if ( ( info->slice == NONESLICE ) || ( info->grid == NULL ) )
+        {
+        mode = GRID_NONE;
+        return sendInteger ( fd, 1, &mode );
+        }
+
+    npts  = grid_points ( info );
+    mfd   = -1;
+    lsock = grid_listener();
+    if ( lsock >= 0 )
+        mfd = grid_memfd ( info->grid, sizeof ( float ) * ( size_t ) npts );
+
+    if ( mfd < 0 )
+        {
+        mode = GRID_INLINE;
+        if ( sendInteger ( fd, 1, &mode ) == XFER_ERR )  return  XFER_ERR ;
+        return sendFloat ( fd, npts, info->grid );
+        }
+
+    mode = GRID_SHM;
+    if ( ( sendInteger ( fd, 1, &mode ) == XFER_ERR ) ||
+            ( sendString ( fd, gridListenName, strlen ( gridListenName ) ) == XFER_ERR ) )
+        {
+        close ( mfd );
+        return XFER_ERR;
+        }
+
+    s = grid_accept ( lsock, fd );
+    if ( s < 0 )
+        {
+        fprintf ( stderr, "sendGridShm(): no connection for the grid\n" );
+        close ( mfd );
+        return XFER_ERR;
+        }
+
+    memset ( &msg, 0, sizeof ( msg ) );
+    iov.iov_base       = ( char * ) &npts;
+    iov.iov_len        = sizeof ( int );
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = cbuf;
+    msg.msg_controllen = sizeof ( cbuf );
+    cmsg = CMSG_FIRSTHDR ( &msg );
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN ( sizeof ( int ) );
+    memcpy ( CMSG_DATA ( cmsg ), &mfd, sizeof ( int ) );
+
+    ok = ( sendmsg ( s, &msg, MSG_NOSIGNAL ) == sizeof ( int ) );
+    close ( s );
+    close ( mfd );
+    return ok ? XFER_SUCCESS : XFER_ERR;
+    }
+
+/* Client side:  receive info->grid, as sent by sendGridShm().
+ * The mapped file itself becomes the grid, with no copy:  spill_adopt()
+ * registers it, so that free_vis() and grid_free() unmap it.  On
+ * failure, info->grid is left NULL.
+ */
+int getGridShm ( int fd, VIS_DATA *info )
+    {
+    struct sockaddr_un sun;
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr *cmsg;
+    struct stat     st;
+    char   cbuf[CMSG_SPACE ( sizeof ( int ) )];
+    char  *name;
+    float *grid;
+    void  *p;
+    int    mode, npts, sentpts, s, mfd;
+    size_t nbytes;
+    ssize_t n;
+
+    info->grid = NULL;
+    if ( getInteger ( fd, &mode ) == XFER_ERR )
+        return XFER_ERR;
+    if ( mode == GRID_NONE )
+        return XFER_SUCCESS;
+
+    npts = grid_points ( info );
+    if ( mode == GRID_INLINE )
+        {
+        grid = ( float * ) malloc ( sizeof ( float ) * ( size_t ) npts );
+        if ( !grid ) return XFER_ERR;
+        if ( getFloats ( fd, grid, npts ) == XFER_ERR )
+            {
+            free ( grid );
+            return XFER_ERR;
+            }
+        info->grid = grid;
+        return XFER_SUCCESS;
+        }
+
+    name = NULL;
+    if ( ( getString ( fd, &name ) == XFER_ERR ) || ( name == NULL ) )
+        return XFER_ERR;
+    s = socket ( AF_UNIX, SOCK_STREAM, 0 );
+    if ( ( s < 0 ) ||
+            ( connect ( s, ( struct sockaddr * ) &sun, grid_sockaddr ( &sun, name ) ) < 0 ) )
+        {
+        perror ( "getGridShm(): connect" );
+        free ( name );
+        if ( s >= 0 ) close ( s );
+        return XFER_ERR;
+        }
+    free ( name );
+
+    memset ( &msg, 0, sizeof ( msg ) );
+    iov.iov_base       = ( char * ) &sentpts;
+    iov.iov_len        = sizeof ( int );
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = cbuf;
+    msg.msg_controllen = sizeof ( cbuf );
+    n = recvmsg ( s, &msg, MSG_CMSG_CLOEXEC );
+    close ( s );
+    cmsg = CMSG_FIRSTHDR ( &msg );
+    if ( ( n != sizeof ( int ) ) || ( cmsg == NULL ) ||
+            ( cmsg->cmsg_level != SOL_SOCKET ) || ( cmsg->cmsg_type != SCM_RIGHTS ) )
+        {
+        fprintf ( stderr, "getGridShm(): no descriptor received\n" );
+        return XFER_ERR;
+        }
+    memcpy ( &mfd, CMSG_DATA ( cmsg ), sizeof ( int ) );
+
+    nbytes = sizeof ( float ) * ( size_t ) npts;
+    if ( ( sentpts != npts ) || ( fstat ( mfd, &st ) < 0 ) || ( ( size_t ) st.st_size != nbytes ) )
+        {
+        fprintf ( stderr, "getGridShm(): grid size mismatch\n" );
+        close ( mfd );
+        return XFER_ERR;
+        }
+
+    p = mmap ( NULL, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0 );
+    if ( p == MAP_FAILED )
+        {
+        perror ( "getGridShm(): mmap" );
+        close ( mfd );
+        return XFER_ERR;
+        }
+    if ( ( info->grid = spill_adopt ( p, nbytes, mfd ) ) == NULL )
+        {
+        munmap ( p, nbytes );
+        close ( mfd );
+        return XFER_ERR;
+        }
+    return XFER_SUCCESS;
+    }
+
+#endif /* VIS_SHM_TRANSPORT */